@@ -0,0 +1,116 @@
+#include <qlat/qlat.h>
+
+using namespace qlat;
+
+void test_philox_kat()
+// Known answer vectors of philox4x32 (10 rounds) from Random123
+{
+  TIMER("test_philox_kat");
+  const uint32_t kat[3][10] = {
+      {0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+       0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8},
+      {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff,
+       0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd},
+      {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344, 0xa4093822, 0x299f31d0,
+       0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1},
+  };
+  for (int i = 0; i < 3; ++i) {
+    array<uint32_t, 4> ctr;
+    array<uint32_t, 2> key;
+    for (int k = 0; k < 4; ++k) {
+      ctr[k] = kat[i][k];
+    }
+    key[0] = kat[i][4];
+    key[1] = kat[i][5];
+    const array<uint32_t, 4> ret = philox_4x32_10(ctr, key);
+    bool is_match = true;
+    for (int k = 0; k < 4; ++k) {
+      is_match = is_match and ret[k] == kat[i][6 + k];
+    }
+    displayln_info(
+        ssprintf("CHECK: philox4x32-10 kat %d: %08x %08x %08x %08x %s", i,
+                 ret[0], ret[1], ret[2], ret[3],
+                 is_match ? "match" : "MISMATCH"));
+    qassert(is_match);
+  }
+}
+
+void test_sequence()
+// the sequence of a site only depends on (seed, index, stream)
+{
+  TIMER("test_sequence");
+  const CounterRng crng(RngState("counter-rng-tests"), 3);
+  displayln_info(ssprintf("CHECK: seed=%016lx stream=%u", (long)crng.seed,
+                          crng.stream));
+  CounterRngState rs = make_counter_rng_state(crng, 12345);
+  for (int i = 0; i < 4; ++i) {
+    const uint64_t x = rand_gen(rs);
+    displayln_info(ssprintf("CHECK: rand_gen %d: %016lx", i, (long)x));
+  }
+  for (int i = 0; i < 4; ++i) {
+    const double x = u_rand_gen(rs, 1.0, -1.0);
+    displayln_info(ssprintf("CHECK: u_rand_gen %d: %24.17E", i, x));
+  }
+  for (int i = 0; i < 4; ++i) {
+    const double x = g_rand_gen(rs, 0.0, 1.0);
+    displayln_info(ssprintf("CHECK: g_rand_gen %d: %.12E", i, x));
+  }
+}
+
+void test_moments()
+{
+  TIMER("test_moments");
+  const CounterRng crng(RngState("test_moments"));
+  const Long n = 1024 * 1024;
+  double sum_u = 0.0;
+  double sum_g = 0.0;
+  double sum_g2 = 0.0;
+  for (Long i = 0; i < n; ++i) {
+    CounterRngState rs = make_counter_rng_state(crng, i);
+    sum_u += u_rand_gen(rs);
+    const double g = g_rand_gen(rs);
+    sum_g += g;
+    sum_g2 += g * g;
+  }
+  displayln_info(ssprintf("CHECK: u mean %.6f (expect 0.5)", sum_u / n));
+  displayln_info(ssprintf("CHECK: g mean %.6f (expect 0.0)", sum_g / n));
+  displayln_info(ssprintf("CHECK: g var  %.6f (expect 1.0)", sum_g2 / n));
+}
+
+void test_field()
+// independent of the number of nodes and threads
+{
+  TIMER("test_field");
+  const Coordinate total_site(4, 4, 4, 8);
+  Geometry geo;
+  geo.init(total_site);
+  const CounterRng crng(RngState("test_field"));
+  FieldM<ComplexD, 3> f;
+  f.init(geo);
+  set_u_rand(f, crng);
+  displayln_info(ssprintf("CHECK: set_u_rand crc32 %08X", field_crc32(f)));
+  set_g_rand(f, crng.split_stream(1));
+  displayln_info(ssprintf("CHECK: set_g_rand crc32 %08X", field_crc32(f)));
+  GaugeMomentum gm;
+  gm.init(geo);
+  set_rand_gauge_momentum(gm, 1.0, crng.split_stream(2));
+  displayln_info(
+      ssprintf("CHECK: set_rand_gauge_momentum crc32 %08X", field_crc32(gm)));
+  RealD energy = gm_hamilton_node(gm);
+  glb_sum(energy);
+  displayln_info(ssprintf("CHECK: gm_hamilton per site %.6E",
+                          energy / geo.total_volume()));
+}
+
+int main(int argc, char* argv[])
+{
+  begin(&argc, &argv);
+  test_philox_kat();
+  test_sequence();
+  test_moments();
+  test_field();
+  displayln_info("CHECK: finished successfully.");
+  Timer::display();
+  end();
+  return 0;
+}
@@ -251,10 +251,182 @@ inline void test_io()
   qassert(ucrc == ucrc2);
 }
 
+inline void test_mpi_io()
+// files written by the MPI-IO backend (q_field_io_mpi_io) and by the serial
+// backend should be interchangeable
+{
+  TIMER("test_mpi_io");
+  qmkdir_sync_node("huge-data");
+  RngState rs(get_global_rng_state(), fname);
+  const Coordinate total_site(4, 4, 4, 8);
+  Geometry geo;
+  geo.init(total_site);
+  displayln_info(ssprintf("CHECK: test_mpi_io: size_node=%s",
+                          show(geo.geon.size_node).c_str()));
+  GaugeField gf;
+  gf.init(geo);
+  set_g_rand_color_matrix_field(gf, RngState(rs, "rgf-0.1"), 0.1);
+  const crc32_t crc = field_crc32(gf);
+  displayln_info(ssprintf("CHECK: test_mpi_io: crc32 = %08X", crc));
+  const bool is_mpi_io_orig = is_field_io_mpi_io();
+  for (int is_mpi_io_write = 0; is_mpi_io_write < 2; ++is_mpi_io_write) {
+    const std::string path =
+        ssprintf("huge-data/rgf-0.1.mpi-io-%d.field", is_mpi_io_write);
+    is_field_io_mpi_io() = is_mpi_io_write;
+    write_field(gf, path);
+    for (int is_mpi_io_read = 0; is_mpi_io_read < 2; ++is_mpi_io_read) {
+      is_field_io_mpi_io() = is_mpi_io_read;
+      GaugeField gf1;
+      read_field(gf1, path);
+      const crc32_t crc1 = field_crc32(gf1);
+      gf1 -= gf;
+      displayln_info(ssprintf("CHECK: test_mpi_io: write mpi_io=%d read "
+                              "mpi_io=%d crc32 = %08X ; diff qnorm = %.5E",
+                              is_mpi_io_write, is_mpi_io_read, crc1,
+                              qnorm(gf1)));
+      qassert(crc1 == crc);
+      qassert(is_checksum_missmatch() == false);
+      qassert(qnorm(gf1) == 0.0);
+    }
+  }
+  is_field_io_mpi_io() = is_mpi_io_orig;
+  const std::string data_0 = qcat_sync_node("huge-data/rgf-0.1.mpi-io-0.field");
+  const std::string data_1 = qcat_sync_node("huge-data/rgf-0.1.mpi-io-1.field");
+  displayln_info(ssprintf("CHECK: test_mpi_io: file size %ld ; identical %d",
+                          (long)data_0.size(), data_0 == data_1));
+  qassert(data_0 == data_1);
+}
+
+inline void test_crc32()
+// crc32 (with and without PCLMUL) should agree with crc32_z of zlib for
+// unaligned offsets and lengths, and the crc32 obtained while reading with
+// serial_read_field_par and dist_read_field should be correct.
+{
+  TIMER("test_crc32");
+  qmkdir_sync_node("huge-data");
+  RngState rs(get_global_rng_state(), fname);
+  const bool is_pclmul_orig = is_crc32_pclmul();
+  displayln_info(ssprintf("INFO: test_crc32: pclmul supported %d",
+                          (int)is_crc32_pclmul_supported()));
+  std::vector<uint8_t> buf(64 * 1024 + 64);
+  for (Long i = 0; i < (Long)buf.size(); ++i) {
+    buf[i] = rand_gen(rs) % 256;
+  }
+  std::vector<Long> lens;
+  for (Long len = 0; len <= 130; ++len) {
+    lens.push_back(len);
+  }
+  lens.push_back(191);
+  lens.push_back(192);
+  lens.push_back(193);
+  lens.push_back(1000);
+  lens.push_back(4095);
+  lens.push_back(4096);
+  lens.push_back(64 * 1024 + 1);
+  const crc32_t initials[] = {0, 0x12345678, 0xFFFFFFFF};
+  for (int is_pclmul = 0; is_pclmul < 2; ++is_pclmul) {
+    is_crc32_pclmul() = is_pclmul and is_crc32_pclmul_supported();
+    Long n_mismatch = 0;
+    for (Long i = 0; i < (Long)lens.size(); ++i) {
+      for (Long offset = 0; offset < 17; ++offset) {
+        const Long len = std::min(lens[i], (Long)buf.size() - offset);
+        for (int j = 0; j < 3; ++j) {
+          const crc32_t crc_z = crc32_z(initials[j], &buf[offset], len);
+          if (qlat::crc32(initials[j], &buf[offset], len) != crc_z) {
+            n_mismatch += 1;
+          }
+          const Vector<uint8_t> v(&buf[offset], len);
+          if (crc32_par(initials[j], v) != crc_z) {
+            n_mismatch += 1;
+          }
+        }
+      }
+    }
+    displayln_info(
+        ssprintf("CHECK: test_crc32: pclmul=%d crc32 mismatches %ld",
+                 is_pclmul, (long)n_mismatch));
+  }
+  const Coordinate total_site(4, 4, 4, 8);
+  Geometry geo;
+  geo.init(total_site);
+  GaugeField gf;
+  gf.init(geo);
+  set_g_rand_color_matrix_field(gf, RngState(rs, "rgf-0.1"), 0.1);
+  const crc32_t crc = field_crc32(gf);
+  displayln_info(ssprintf("CHECK: test_crc32: crc32 = %08X", crc));
+  std::vector<Coordinate> new_size_nodes;
+  new_size_nodes.push_back(Coordinate(1, 1, 1, 1));
+  new_size_nodes.push_back(Coordinate(1, 1, 1, 2));
+  new_size_nodes.push_back(Coordinate(1, 1, 2, 8));
+  // splitting z while t is not fully split would scramble the file order
+  displayln_info(ssprintf(
+      "CHECK: test_crc32: is_serial_new_size_node_ok 1x1x2x4 %d ; 1x1x2x8 %d",
+      (int)is_serial_new_size_node_ok(total_site, Coordinate(1, 1, 2, 4)),
+      (int)is_serial_new_size_node_ok(total_site, Coordinate(1, 1, 2, 8))));
+  const bool is_checking_orig = is_checksum_missmatch();
+  for (int is_pclmul = 0; is_pclmul < 2; ++is_pclmul) {
+    is_crc32_pclmul() = is_pclmul and is_crc32_pclmul_supported();
+    for (size_t i = 0; i < new_size_nodes.size(); ++i) {
+      const Coordinate& new_size_node = new_size_nodes[i];
+      const std::string path =
+          ssprintf("huge-data/crc32-pclmul-%d-", is_pclmul) +
+          show(new_size_node);
+      qremove_all_sync_node(path + ".field");
+      serial_write_field(gf, path + ".field", new_size_node);
+      GaugeField gf1;
+      gf1.init(geo);
+      crc32_t crc1 = 0;
+      serial_read_field_par(gf1, crc1, path + ".field", new_size_node);
+      // crc1 is the crc32 of the file, which is field_crc32(gf)
+      const std::string data = qcat_sync_node(path + ".field");
+      const crc32_t crc1_file =
+          crc32_z(0, (const Bytef*)data.data(), data.size());
+      gf1 -= gf;
+      displayln_info(ssprintf(
+          "CHECK: test_crc32: pclmul=%d serial_read_field_par %s crc32 = %08X "
+          "; file crc32 = %08X ; diff qnorm = %.5E",
+          is_pclmul, show(new_size_node).c_str(), crc1, crc1_file,
+          qnorm(gf1)));
+      // dist_read_field compares the crc32 with checksums.txt
+      qremove_all_sync_node(path + ".dist");
+      dist_write_field(gf, new_size_node, path + ".dist");
+      is_checksum_missmatch() = false;
+      dist_read_field(gf1, path + ".dist");
+      const bool is_missmatch = is_checksum_missmatch();
+      const crc32_t crc2 = field_crc32(gf1);
+      // corrupt one byte of the first file, which should be detected
+      if (get_id_node() == 0) {
+        const std::string fn =
+            dist_file_name(path + ".dist", 0, product(new_size_node));
+        std::string data = qcat(fn);
+        data[data.size() / 2] ^= 1;
+        qtouch(fn, data);
+      }
+      sync_node();
+      is_checksum_missmatch() = false;
+      dist_read_field(gf1, path + ".dist");
+      const bool is_missmatch_corrupt = is_checksum_missmatch();
+      displayln_info(ssprintf(
+          "CHECK: test_crc32: pclmul=%d dist_read_field %s crc32 = %08X ; "
+          "missmatch %d ; missmatch after corruption %d",
+          is_pclmul, show(new_size_node).c_str(), crc2, (int)is_missmatch,
+          (int)is_missmatch_corrupt));
+    }
+  }
+  is_checksum_missmatch() = is_checking_orig;
+  is_crc32_pclmul() = is_pclmul_orig;
+}
+
 int main(int argc, char* argv[])
 {
-  begin(&argc, &argv);
+  std::vector<Coordinate> size_node_list;
+  size_node_list.push_back(Coordinate(1, 1, 1, 1));
+  size_node_list.push_back(Coordinate(1, 1, 1, 2));
+  size_node_list.push_back(Coordinate(2, 1, 1, 2));
+  begin(&argc, &argv, size_node_list);
   test_io();
+  test_mpi_io();
+  test_crc32();
   test_shuffle();
   displayln_info("CHECK: finished successfully.");
   Timer::display();
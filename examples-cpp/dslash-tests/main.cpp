@@ -239,12 +239,362 @@ void simple_tests()
   displayln_info(ssprintf("invert diff qnorm = %E", qnorm(sol)));
 }
 
+void multi_rhs_tests()
+// invert(Propagator4d) with num_rhs_batch > 1 (invert_multi) should give the
+// same propagator as num_rhs_batch = 1. 5 does not divide 12, so the last
+// batch is short.
+{
+  TIMER_VERBOSE("multi_rhs_tests");
+  RngState rs(get_global_rng_state(), fname);
+  const Coordinate total_site(4, 4, 4, 8);
+  // Mobius action through the zMobius code path (required by invert_multi)
+  const FermionAction fa(0.1, 4, 1.8, 1.5, true, true);
+  Geometry geo;
+  geo.init(total_site);
+  GaugeField gf;
+  gf.init(geo);
+  set_g_rand_color_matrix_field(gf, RngState(rs, "gf-0.1"), 0.1);
+  InverterDomainWall inv;
+  setup_inverter(inv, gf, fa);
+  inv.stop_rsd() = 1e-10;
+  inv.max_num_iter() = 2000;
+  Propagator4d src, sol_ref, sol;
+  src.init(geo);
+  set_u_rand(src, RngState(rs, "src"));
+  inv.num_rhs_batch() = 1;
+  invert(sol_ref, src, inv);
+  const double qnorm_ref = qnorm(sol_ref);
+  const int n_batches[] = {5, 12};
+  for (int i = 0; i < 2; ++i) {
+    inv.num_rhs_batch() = n_batches[i];
+    invert(sol, src, inv);
+    sol -= sol_ref;
+    const double diff = std::sqrt(qnorm(sol) / qnorm_ref);
+    displayln_info(ssprintf(
+        "CHECK: multi_rhs_tests: num_rhs_batch=%d ; diff small %d",
+        n_batches[i], (int)(diff < 1e-8)));
+    displayln_info(ssprintf("INFO: multi_rhs_tests: num_rhs_batch=%d ; diff %.3E",
+                            n_batches[i], diff));
+  }
+}
+
+void mixed_precision_tests()
+// The single precision defect correction (inv.ip.lower_precision = 4) should
+// reach stop_rsd and give the same solution as the double precision CG, both
+// for cg_with_herm_sym_2_mixed and for cg_with_herm_sym_2_mixed_multi.
+{
+  TIMER_VERBOSE("mixed_precision_tests");
+  RngState rs(get_global_rng_state(), fname);
+  const Coordinate total_site(4, 4, 4, 8);
+  const FermionAction fa(0.1, 4, 1.8, 1.5, true, true);
+  Geometry geo;
+  geo.init(total_site);
+  GaugeField gf;
+  gf.init(geo);
+  set_g_rand_color_matrix_field(gf, RngState(rs, "gf-0.1"), 0.1);
+  InverterDomainWall inv;
+  setup_inverter(inv, gf, fa);
+  inv.stop_rsd() = 1e-10;
+  inv.max_num_iter() = 2000;
+  const double stop_rsd = inv.stop_rsd();
+  const Long max_num_iter = inv.max_num_iter();
+  const int n_rhs = 3;
+  std::vector<FermionField5d> srcs(n_rhs), sols_ref(n_rhs), sols(n_rhs);
+  for (int k = 0; k < n_rhs; ++k) {
+    srcs[k].init(geo_eo(geo, 1), fa.ls);
+    set_u_rand(srcs[k], RngState(rs, ssprintf("src-%d", k)));
+    cg_with_herm_sym_2(sols_ref[k], srcs[k], inv, stop_rsd, max_num_iter);
+  }
+  for (int is_multi = 0; is_multi < 2; ++is_multi) {
+    if (is_multi == 0) {
+      for (int k = 0; k < n_rhs; ++k) {
+        sols[k].init();
+        cg_with_herm_sym_2_mixed(sols[k], srcs[k], inv, stop_rsd,
+                                 max_num_iter);
+      }
+    } else {
+      FermionField5d src, sol;
+      pack_fermion_field_5d_multi(src, srcs);
+      std::vector<Long> iters;
+      cg_with_herm_sym_2_mixed_multi(sol, src, inv, n_rhs,
+                                     std::vector<double>(n_rhs, stop_rsd),
+                                     max_num_iter, iters);
+      unpack_fermion_field_5d_multi(sols, sol, n_rhs);
+    }
+    for (int k = 0; k < n_rhs; ++k) {
+      FermionField5d r;
+      multiply_hermop_sym2(r, sols[k], inv);
+      r -= srcs[k];
+      const double rsd = std::sqrt(qnorm(r) / qnorm(srcs[k]));
+      const double qnorm_ref = qnorm(sols_ref[k]);
+      sols[k] -= sols_ref[k];
+      const double diff = std::sqrt(qnorm(sols[k]) / qnorm_ref);
+      displayln_info(ssprintf(
+          "CHECK: mixed_precision_tests: multi=%d k=%d ; converged %d ; "
+          "diff small %d",
+          is_multi, k, (int)(rsd <= stop_rsd), (int)(diff < 1e-7)));
+      displayln_info(ssprintf(
+          "INFO: mixed_precision_tests: multi=%d k=%d ; rsd %.3E ; diff %.3E",
+          is_multi, k, rsd, diff));
+    }
+  }
+  // A right hand side which has already converged (here the initial guess is
+  // the solution) should not be changed by the batched solve.
+  {
+    FermionField5d src, sol;
+    pack_fermion_field_5d_multi(src, srcs);
+    for (int k = 0; k < n_rhs; ++k) {
+      sols[k].init(srcs[k].geo(), srcs[k].multiplicity);
+      if (k == 0) {
+        sols[k] = sols_ref[k];
+      } else {
+        set_zero(sols[k]);
+      }
+    }
+    pack_fermion_field_5d_multi(sol, sols);
+    std::vector<Long> iters;
+    cg_with_herm_sym_2_mixed_multi(sol, src, inv, n_rhs,
+                                   std::vector<double>(n_rhs, stop_rsd),
+                                   max_num_iter, iters);
+    unpack_fermion_field_5d_multi(sols, sol, n_rhs);
+    sols[0] -= sols_ref[0];
+    displayln_info(ssprintf(
+        "CHECK: mixed_precision_tests: converged guess ; iters[0] %ld ; "
+        "unchanged %d",
+        (long)iters[0], (int)(qnorm(sols[0]) == 0.0)));
+  }
+  // Changing inv.gf directly (not with setup) should also change the single
+  // precision operator of the inner CG.
+  {
+    GaugeField gf_new;
+    gf_new.init(geo);
+    set_g_rand_color_matrix_field(gf_new, RngState(rs, "gf-new-0.1"), 0.1);
+    set_left_expanded_gauge_field(inv.gf, gf_new);
+    FermionField5d sol_ref, sol;
+    cg_with_herm_sym_2(sol_ref, srcs[0], inv, stop_rsd, max_num_iter);
+    const Long iter = cg_with_herm_sym_2_mixed(sol, srcs[0], inv, stop_rsd,
+                                               max_num_iter);
+    const double qnorm_ref = qnorm(sol_ref);
+    sol -= sol_ref;
+    const double diff = std::sqrt(qnorm(sol) / qnorm_ref);
+    FermionField5d ap, ap_d;
+    FermionField5dT<RealF> src_f, ap_f;
+    convert_field_precision<RealF, RealD>(src_f, srcs[0]);
+    multiply_hermop_sym2(ap_f, src_f, inv);
+    convert_field_precision<RealD, RealF>(ap, ap_f);
+    multiply_hermop_sym2(ap_d, srcs[0], inv);
+    const double qnorm_ap_d = qnorm(ap_d);
+    ap -= ap_d;
+    const double diff_op = std::sqrt(qnorm(ap) / qnorm_ap_d);
+    displayln_info(ssprintf(
+        "CHECK: mixed_precision_tests: new gf ; converged %d ; diff small %d ; "
+        "single precision operator diff small %d",
+        (int)(iter <= max_num_iter), (int)(diff < 1e-7),
+        (int)(diff_op < 1e-5)));
+    displayln_info(ssprintf(
+        "INFO: mixed_precision_tests: new gf ; iter %ld ; diff %.3E ; "
+        "operator diff %.3E",
+        (long)iter, diff, diff_op));
+  }
+}
+
+void aligned_tests()
+// AlignedField should convert to and from Field without changes, and the
+// operators and the CG on AlignedField should agree with the site-by-site
+// kernels on Field.
+{
+  TIMER_VERBOSE("aligned_tests");
+  RngState rs(get_global_rng_state(), fname);
+  const Coordinate total_site(4, 4, 4, 8);
+  const bool is_aligned = is_wilson_hop_aligned();
+  for (int is_mobius = 0; is_mobius < 2; ++is_mobius) {
+    const FermionAction fa = is_mobius
+                                 ? FermionAction(0.1, 4, 1.8, 1.5, true, true)
+                                 : FermionAction(0.1, 4, 1.8);
+    Geometry geo;
+    geo.init(total_site);
+    GaugeField gf;
+    gf.init(geo);
+    set_g_rand_color_matrix_field(gf, RngState(rs, "gf-0.1"), 0.1);
+    InverterDomainWall inv;
+    setup_inverter(inv, gf, fa);
+    const double stop_rsd = 1e-10;
+    const Long max_num_iter = 2000;
+    FermionField5d src;
+    src.init(geo_eo(geo, 1), fa.ls);
+    set_u_rand(src, RngState(rs, "src"));
+    AlignedField<WilsonVectorD> src_a;
+    set_aligned_field(src_a, src);
+    FermionField5d tmp;
+    set_field_from_aligned_field(tmp, src_a);
+    tmp -= src;
+    const int is_round_trip_exact = qnorm(tmp) == 0.0;
+    // reference with the site-by-site kernels
+    is_wilson_hop_aligned() = false;
+    FermionField5d ap_ref, sol_ref;
+    multiply_hermop_sym2(ap_ref, src, inv);
+    FermionField5dT<RealF> src_f, ap_f_ref;
+    convert_field_precision<RealF, RealD>(src_f, src);
+    inv.update_gf_f();
+    multiply_hermop_sym2(ap_f_ref, src_f, inv);
+    const Long iter_ref =
+        cg_with_herm_sym_2(sol_ref, src, inv, stop_rsd, max_num_iter);
+    is_wilson_hop_aligned() = true;
+    inv.update_hl();
+    AlignedField<WilsonVectorD> ap_a;
+    multiply_hermop_sym2(ap_a, src_a, inv);
+    FermionField5d ap;
+    set_field_from_aligned_field(ap, ap_a);
+    const double qnorm_ap_ref = qnorm(ap_ref);
+    ap -= ap_ref;
+    const double diff_op = std::sqrt(qnorm(ap) / qnorm_ap_ref);
+    inv.update_gf_f();
+    AlignedField<WilsonVectorF> src_f_a, ap_f_a;
+    set_aligned_field(src_f_a, src_f);
+    multiply_hermop_sym2(ap_f_a, src_f_a, inv);
+    FermionField5dT<RealF> ap_f;
+    set_field_from_aligned_field(ap_f, ap_f_a);
+    const double qnorm_ap_f_ref = qnorm(ap_f_ref);
+    ap_f -= ap_f_ref;
+    const double diff_op_f = std::sqrt(qnorm(ap_f) / qnorm_ap_f_ref);
+    FermionField5d sol;
+    const Long iter =
+        cg_with_herm_sym_2(sol, src, inv, stop_rsd, max_num_iter);
+    const double qnorm_sol_ref = qnorm(sol_ref);
+    sol -= sol_ref;
+    const double diff_sol = std::sqrt(qnorm(sol) / qnorm_sol_ref);
+    is_wilson_hop_aligned() = is_aligned;
+    displayln_info(ssprintf(
+        "CHECK: aligned_tests: mobius=%d ; round trip exact %d ; operator diff "
+        "small %d ; single precision operator diff small %d",
+        is_mobius, is_round_trip_exact, (int)(diff_op < 1e-14),
+        (int)(diff_op_f < 1e-6)));
+    displayln_info(ssprintf(
+        "CHECK: aligned_tests: mobius=%d ; converged %d ; solution diff small "
+        "%d",
+        is_mobius, (int)(iter <= max_num_iter and iter_ref <= max_num_iter),
+        (int)(diff_sol < 1e-8)));
+    displayln_info(ssprintf(
+        "INFO: aligned_tests: mobius=%d ; operator diff %.3E ; single "
+        "precision operator diff %.3E ; iter %ld iter_ref %ld ; solution diff "
+        "%.3E",
+        is_mobius, diff_op, diff_op_f, (long)iter, (long)iter_ref, diff_sol));
+  }
+}
+
+void deflate_ref(HalfVector& hv_out, const HalfVector& hv_in, LowModes& lm)
+// hv_out = hv_in + sum_i v_i <v_i, hv_in> / lm.eigen_values[i]
+// where v_i = sum_j lm.cesc[i, j] lm.cesb[j] on each block.
+// Plain serial reference for deflate, accumulated in double precision.
+{
+  TIMER("deflate_ref");
+  const Long block_size =
+      lm.cesb.block_vol_eo * lm.cesi.ls * HalfVector::c_size;
+  const Long n_basis = lm.cesb.n_basis;
+  const Long n_vec = lm.cesc.n_vec;
+  BlockedHalfVector bhv;
+  convert_half_vector(bhv, hv_in, lm.cesi.block_site);
+  const Geometry geo = geo_resize(bhv.geo());
+  std::vector<ComplexD> ps(n_vec, 0.0);
+  for (Long index = 0; index < geo.local_volume(); ++index) {
+    const Vector<ComplexF> vb = bhv.get_elems_const(index);
+    const Vector<ComplexF> vbs = lm.cesb.get_elems_const(index);
+    const Vector<ComplexF> vcs = lm.cesc.get_elems_const(index);
+    for (Long i = 0; i < n_vec; ++i) {
+      for (Long j = 0; j < n_basis; ++j) {
+        const ComplexD c = vcs[i * n_basis + j];
+        for (Long k = 0; k < block_size; ++k) {
+          ps[i] += qconj(c * (ComplexD)vbs[j * block_size + k]) *
+                   (ComplexD)vb[k];
+        }
+      }
+    }
+  }
+  glb_sum(get_data(ps));
+  for (Long i = 0; i < n_vec; ++i) {
+    ps[i] /= lm.eigen_values[i];
+  }
+  for (Long index = 0; index < geo.local_volume(); ++index) {
+    Vector<ComplexF> vb = bhv.get_elems(index);
+    const Vector<ComplexF> vbs = lm.cesb.get_elems_const(index);
+    const Vector<ComplexF> vcs = lm.cesc.get_elems_const(index);
+    for (Long k = 0; k < block_size; ++k) {
+      ComplexD s = vb[k];
+      for (Long i = 0; i < n_vec; ++i) {
+        for (Long j = 0; j < n_basis; ++j) {
+          s += (ComplexD)vcs[i * n_basis + j] *
+               (ComplexD)vbs[j * block_size + k] * ps[i];
+        }
+      }
+      vb[k] = (ComplexF)s;
+    }
+  }
+  convert_half_vector(hv_out, bhv);
+}
+
+void deflate_tests()
+// The batched deflate(ffs, ffs, lm) should give the same results as
+// deflate(ff, ff, lm) for each vector (random LowModes as in
+// benchmark_deflate), and both should agree with deflate_ref.
+{
+  TIMER_VERBOSE("deflate_tests");
+  RngState rs(get_global_rng_state(), fname);
+  const Coordinate total_site(4, 4, 4, 8);
+  const int ls = 4;
+  Geometry geo;
+  geo.init(total_site);
+  LowModes lm;
+  lm.init(geo, ls, Coordinate(2, 2, 2, 2), 10, 6);
+  set_u_rand(lm, rs.split("lm"));
+  const int n_ff = 3;
+  std::vector<FermionField5d> ins(n_ff), outs(n_ff), outs_batch;
+  for (int k = 0; k < n_ff; ++k) {
+    ins[k].init(geo_eo(geo, 1), ls);
+    set_u_rand(ins[k], rs.split(ssprintf("in-%d", k)));
+    deflate(outs[k], ins[k], lm);
+  }
+  for (int k = 0; k < n_ff; ++k) {
+    HalfVector hv_in, hv_ref, hv_out;
+    set_half_vector_from_fermion_field_5d(hv_in, ins[k]);
+    deflate_ref(hv_ref, hv_in, lm);
+    set_half_vector_from_fermion_field_5d(hv_out, outs[k]);
+    const double qnorm_ref = qnorm(hv_ref);
+    hv_out -= hv_ref;
+    const double diff = std::sqrt(qnorm(hv_out) / qnorm_ref);
+    displayln_info(ssprintf("CHECK: deflate_tests: k=%d ; ref diff small %d",
+                            k, (int)(diff < 1e-5)));
+    displayln_info(
+        ssprintf("INFO: deflate_tests: k=%d ; ref diff %.3E", k, diff));
+  }
+  deflate(outs_batch, ins, lm);
+  // in place
+  deflate(ins, ins, lm);
+  for (int k = 0; k < n_ff; ++k) {
+    const double qnorm_ref = qnorm(outs[k]);
+    outs_batch[k] -= outs[k];
+    ins[k] -= outs[k];
+    const double diff = std::sqrt(qnorm(outs_batch[k]) / qnorm_ref);
+    const double diff_in_place = std::sqrt(qnorm(ins[k]) / qnorm_ref);
+    displayln_info(ssprintf(
+        "CHECK: deflate_tests: k=%d ; diff small %d ; in place diff small %d",
+        k, (int)(diff < 1e-6), (int)(diff_in_place < 1e-6)));
+    displayln_info(ssprintf(
+        "INFO: deflate_tests: k=%d ; qnorm %.3E ; diff %.3E ; in place diff "
+        "%.3E",
+        k, qnorm_ref, diff, diff_in_place));
+  }
+}
+
 int main(int argc, char* argv[])
 {
   begin(&argc, &argv);
   get_global_rng_state() = RngState(get_global_rng_state(), "qcd-utils-tests");
   simple_dwf_tests();
   simple_tests();
+  multi_rhs_tests();
+  mixed_precision_tests();
+  aligned_tests();
+  deflate_tests();
   displayln_info("CHECK: finished successfully.");
   Timer::display();
   end();
@@ -220,12 +220,260 @@ inline void demo(const std::string& tag, const Coordinate& total_site,
   check_all_files_crc32("huge-data/" + tag);
 }
 
+inline Long show_files_crc32_info(const std::string& tag,
+                                  const std::string& path,
+                                  const bool is_check = true)
+// return the total size of the data files (excluding the index and geon-info)
+// only computed on node 0
+{
+  if (0 != get_id_node()) {
+    return 0;
+  }
+  const std::vector<std::pair<std::string, crc32_t>> fcrcs =
+      check_all_files_crc32(path);
+  Long total_size = 0;
+  for (Long i = 0; i < (Long)fcrcs.size(); ++i) {
+    const std::string fn = fcrcs[i].first.substr(path.size());
+    displayln(ssprintf("%s: %s: file crc32=%08X '%s'.",
+                       is_check ? "CHECK" : "INFO", tag.c_str(),
+                       fcrcs[i].second, fn.c_str()));
+    if (fn != "/geon-info.txt" and fn != "/index.qar" and
+        fn != "/index.qar.idx") {
+      QFile qfile = qfopen(fcrcs[i].first, "r");
+      total_size += qfile_size(qfile);
+    }
+  }
+  return total_size;
+}
+
+inline void demo_codec_async(const std::string& tag,
+                             const Coordinate& total_site,
+                             const Long n_per_tslice,
+                             const Coordinate& new_size_node)
+// write with the codecs None (raw data, the format of the files written before
+// the codecs were introduced) and ShuffleDeflate, each with the synchronous and
+// the asynchronous (write-behind) writer, and read back.
+// The files should not depend on is_async. The raw files are checked against
+// the crc32 of the files written by the previous versions (committed log).
+// The compressed sizes depend on the zlib version, so they are only shown as
+// INFO.
+{
+  TIMER_VERBOSE("demo_codec_async");
+  Geometry geo;
+  geo.init(total_site);
+  qmkdir_info("huge-data");
+  qmkdir_info("huge-data/" + tag);
+  const RngState rs = RngState("fields-io-async");
+  FieldSelection fsel;
+  mk_field_selection(fsel.f_rank, total_site, n_per_tslice, rs.split("fsel"));
+  update_field_selection(fsel);
+  const ShuffledBitSet sbs = mk_shuffled_bitset(fsel, new_size_node);
+  Field<ComplexD> f, fsf, rf;
+  SelectedField<ComplexD> sf;
+  f.init(geo, 2);
+  set_u_rand(f, rs.split("f"));
+  fsf = f;
+  only_keep_selected_points(fsf, fsel);
+  set_selected_field(sf, f, fsel);
+  const crc32_t crc_f = field_crc32(f);
+  const crc32_t crc_fsf = field_crc32(fsf);
+  displayln_info(ssprintf("CHECK: %s: crc32=%08X ; selected crc32=%08X.",
+                          tag.c_str(), crc_f, crc_fsf));
+  Long raw_size = 0;
+  for (int codec = 0; codec < 2; ++codec) {
+    for (int is_async = 0; is_async < 2; ++is_async) {
+      const std::string path =
+          ssprintf("huge-data/%s/codec-%d-async-%d.lfs", tag.c_str(), codec,
+                   is_async);
+      {
+        ShuffledFieldsWriter sfw(path, new_size_node);
+        sfw.codec = (FieldsCodec)codec;
+        set_async(sfw, is_async);
+        write(sfw, "f.field", f);
+        write(sfw, "f.sfield", sbs, sf);
+        write_float_from_double(sfw, "f.float.field", f);
+        sfw.close();
+      }
+      {
+        ShuffledFieldsWriter sfw(path, new_size_node, true);
+        sfw.codec = (FieldsCodec)codec;
+        set_async(sfw, is_async);
+        write(sfw, "fa.field", f);
+        flush(sfw);
+        write(sfw, "fa.sfield", sbs, sf);
+        sfw.close();
+      }
+      {
+        ShuffledFieldsReader sfr(path);
+        rf.init();
+        read(sfr, "f.field", rf);
+        qassert(field_crc32(rf) == crc_f);
+        rf.init();
+        read(sfr, "f.sfield", rf);
+        qassert(field_crc32(rf) == crc_fsf);
+        rf.init();
+        read(sfr, "fa.field", rf);
+        qassert(field_crc32(rf) == crc_f);
+        rf.init();
+        read(sfr, "fa.sfield", rf);
+        qassert(field_crc32(rf) == crc_fsf);
+        sfr.close();
+      }
+      rf.init();
+      read_field_double_from_float(rf, path, "f.float.field");
+      displayln_info(ssprintf("CHECK: %s: codec=%d async=%d float crc32=%08X.",
+                              tag.c_str(), codec, is_async, field_crc32(rf)));
+      const Long size = show_files_crc32_info(
+          ssprintf("%s: codec=%d async=%d", tag.c_str(), codec, is_async),
+          path, codec == 0);
+      if (codec == 0) {
+        raw_size = size;
+        displayln_info(ssprintf("CHECK: %s: codec=%d async=%d size=%ld.",
+                                tag.c_str(), codec, is_async, size));
+      } else {
+        displayln_info(ssprintf("INFO: %s: codec=%d async=%d size=%ld.",
+                                tag.c_str(), codec, is_async, size));
+      }
+    }
+  }
+  // lossy: round the mantissa to n_mantissa_bits before compression
+  const Int n_mantissa_bits = 20;
+  for (int is_async = 0; is_async < 2; ++is_async) {
+    const std::string path = ssprintf("huge-data/%s/codec-1-bits-%d-async-%d.lfs",
+                                      tag.c_str(), n_mantissa_bits, is_async);
+    {
+      ShuffledFieldsWriter sfw(path, new_size_node);
+      sfw.codec = FieldsCodec::ShuffleDeflate;
+      sfw.n_mantissa_bits = n_mantissa_bits;
+      set_async(sfw, is_async);
+      write(sfw, "f.field", f);
+      write(sfw, "f.sfield", sbs, sf);
+      sfw.close();
+    }
+    // the field to write is not changed
+    qassert(field_crc32(f) == crc_f);
+    crc32_t crc_r, crc_rs;
+    RealD rel_diff;
+    {
+      ShuffledFieldsReader sfr(path);
+      rf.init();
+      read(sfr, "f.field", rf);
+      crc_r = field_crc32(rf);
+      rf -= f;
+      rel_diff = std::sqrt(qnorm(rf) / qnorm(f));
+      rf.init();
+      read(sfr, "f.sfield", rf);
+      crc_rs = field_crc32(rf);
+      sfr.close();
+    }
+    displayln_info(ssprintf(
+        "CHECK: %s: codec=1 bits=%d async=%d crc32=%08X ; selected "
+        "crc32=%08X ; rel_diff small %d.",
+        tag.c_str(), n_mantissa_bits, is_async, crc_r, crc_rs,
+        (int)(rel_diff < std::pow(2.0, -n_mantissa_bits))));
+    const Long size = show_files_crc32_info(
+        ssprintf("%s: codec=1 bits=%d async=%d", tag.c_str(), n_mantissa_bits,
+                 is_async),
+        path, false);
+    displayln_info(ssprintf("INFO: %s: codec=1 bits=%d async=%d size=%ld.",
+                            tag.c_str(), n_mantissa_bits, is_async, size));
+    displayln_info(ssprintf(
+        "CHECK: %s: codec=1 bits=%d async=%d smaller than raw %d.",
+        tag.c_str(), n_mantissa_bits, is_async, (int)(size < raw_size)));
+  }
+}
+
+inline void demo_codec_corrupt()
+// fields_decode should return false (not throw) for corrupt payload headers
+{
+  TIMER_VERBOSE("demo_codec_corrupt");
+  std::vector<char> data(1000);
+  for (Long i = 0; i < (Long)data.size(); ++i) {
+    data[i] = (char)(i % 7);
+  }
+  const std::vector<char> payload = fields_encode(
+      FieldsCodec::ShuffleDeflate, get_data(data), 8, 8);
+  std::vector<char> decoded;
+  const bool is_ok = fields_decode(decoded, FieldsCodec::ShuffleDeflate,
+                                   get_data(payload));
+  displayln_info(ssprintf("CHECK: demo_codec_corrupt: ok=%d same=%d.",
+                          (int)is_ok, (int)(decoded == data)));
+  // header: int64 data_size @ 0 ; int32 elem_size @ 8 ; int64 offset @ 12 ;
+  // int64 block_size @ 20 ; int64 n_block @ 28 ; int64 comp_size[] @ 36.
+  std::vector<std::pair<Long, int64_t>> corruptions;
+  corruptions.push_back(std::make_pair(0, (int64_t)-1));
+  corruptions.push_back(std::make_pair(0, (int64_t)1 << 60));
+  corruptions.push_back(std::make_pair(20, (int64_t)3));
+  corruptions.push_back(std::make_pair(28, (int64_t)-1));
+  corruptions.push_back(std::make_pair(28, (int64_t)1 << 60));
+  corruptions.push_back(std::make_pair(36, (int64_t)1 << 62));
+  for (Long i = 0; i < (Long)corruptions.size(); ++i) {
+    std::vector<char> bad = payload;
+    const int64_t v = corruptions[i].second;
+    std::memcpy(&bad[corruptions[i].first], &v, sizeof(v));
+    const bool is_bad_ok =
+        fields_decode(decoded, FieldsCodec::ShuffleDeflate, get_data(bad));
+    displayln_info(ssprintf("CHECK: demo_codec_corrupt: pos=%ld ok=%d size=%ld.",
+                            (long)corruptions[i].first, (int)is_bad_ok,
+                            (long)decoded.size()));
+  }
+  const bool is_short_ok = fields_decode(
+      decoded, FieldsCodec::ShuffleDeflate, Vector<char>(payload.data(), 30));
+  displayln_info(ssprintf("CHECK: demo_codec_corrupt: short ok=%d.",
+                          (int)is_short_ok));
+}
+
+inline void demo_mmap(const std::string& tag)
+// read the files of demo_codec_async with q_qfile_mmap off and on
+{
+  TIMER_VERBOSE("demo_mmap");
+  const bool is_mmap_orig = is_qfile_mmap();
+  for (int codec = 0; codec < 2; ++codec) {
+    const std::string path =
+        ssprintf("huge-data/%s/codec-%d-async-0.lfs", tag.c_str(), codec);
+    std::vector<std::string> fns;
+    fns.push_back("f.field");
+    fns.push_back("f.sfield");
+    fns.push_back("fa.field");
+    fns.push_back("fa.sfield");
+    std::vector<Field<ComplexD>> fs(fns.size());
+    for (int is_mmap = 0; is_mmap < 2; ++is_mmap) {
+      is_qfile_mmap() = is_mmap;
+      std::string crcs;
+      RealD qnorm_diff = 0.0;
+      ShuffledFieldsReader sfr(path);
+      for (Long i = 0; i < (Long)fns.size(); ++i) {
+        Field<ComplexD> rf;
+        read(sfr, fns[i], rf);
+        crcs += ssprintf(" %08X", field_crc32(rf));
+        if (is_mmap == 0) {
+          fs[i] = rf;
+        } else {
+          rf -= fs[i];
+          qnorm_diff += qnorm(rf);
+        }
+      }
+      sfr.close();
+      Field<ComplexD> rf;
+      read_field_double_from_float(rf, path, "f.float.field");
+      crcs += ssprintf(" %08X", field_crc32(rf));
+      displayln_info(
+          ssprintf("CHECK: %s: codec=%d mmap=%d crc32:%s ; diff=%.5E.",
+                   tag.c_str(), codec, is_mmap, crcs.c_str(), qnorm_diff));
+    }
+  }
+  is_qfile_mmap() = is_mmap_orig;
+}
+
 int main(int argc, char* argv[])
 {
   begin(&argc, &argv);
   demo("t0", Coordinate(6, 6, 6, 8), 0, 16, Coordinate(2, 2, 2, 8));
   demo("t1", Coordinate(6, 6, 6, 8), 4, 2, Coordinate(2, 2, 2, 8));
   demo("t2", Coordinate(6, 6, 6, 8), 8, 0, Coordinate(2, 2, 2, 8));
+  demo_codec_async("t3", Coordinate(6, 6, 6, 8), 16, Coordinate(1, 1, 2, 2));
+  demo_mmap("t3");
+  demo_codec_corrupt();
   displayln_info("CHECK: finished successfully.");
   Timer::display();
   end();
@@ -0,0 +1,125 @@
+#include <qlat/qlat.h>
+
+using namespace qlat;
+
+inline std::vector<ColorMatrix> make_anti_hermitian_matrices(
+    const Long n, const double sigma, const RngState& rs)
+{
+  std::vector<ColorMatrix> xs(n);
+  for (Long i = 0; i < n; ++i) {
+    RngState rsi = rs.split(i);
+    xs[i] = make_g_rand_anti_hermitian_matrix(rsi, sigma);
+  }
+  return xs;
+}
+
+inline void test_accuracy(const double sigma)
+// compare with the Taylor series with a high order
+{
+  TIMER_VERBOSE("test_accuracy");
+  const ColorMatrixConstants& cmcs = ColorMatrixConstants::get_instance();
+  const std::vector<ColorMatrix> xs = make_anti_hermitian_matrices(
+      1024, sigma, RngState(ssprintf("test_accuracy %.1E", sigma)));
+  ColorMatrix unit;
+  set_unit(unit);
+  double diff_exp = 0.0;
+  double diff_unitary = 0.0;
+  double diff_j = 0.0;
+  for (Long i = 0; i < (Long)xs.size(); ++i) {
+    const ColorMatrix& x = xs[i];
+    const ColorMatrix e0 = make_matrix_exp(x, 60);
+    const ColorMatrix e1 = make_color_matrix_exp_exact(x);
+    diff_exp = std::max(diff_exp, qnorm(e1 - e0));
+    diff_unitary =
+        std::max(diff_unitary, qnorm(e1 * matrix_adjoint(e1) - unit));
+    const AdjointColorMatrix j0 = make_diff_exp_map(x, cmcs, 60);
+    const AdjointColorMatrix j1 = make_diff_exp_map_exact(x, cmcs);
+    diff_j = std::max(diff_j, qnorm(j1 - j0));
+  }
+  diff_exp = std::sqrt(diff_exp);
+  diff_unitary = std::sqrt(diff_unitary);
+  diff_j = std::sqrt(diff_j);
+  displayln_info(ssprintf("INFO: sigma=%.1E max diff exp %.2E unitary %.2E "
+                          "diff_exp_map %.2E",
+                          sigma, diff_exp, diff_unitary, diff_j));
+  displayln_info(
+      ssprintf("CHECK: sigma=%.1E exp %s unitary %s diff_exp_map %s", sigma,
+               diff_exp < 1e-13 ? "ok" : "fail",
+               diff_unitary < 1e-13 ? "ok" : "fail",
+               diff_j < 1e-12 ? "ok" : "fail"));
+}
+
+inline void test_speed()
+{
+  TIMER_VERBOSE("test_speed");
+  const ColorMatrixConstants& cmcs = ColorMatrixConstants::get_instance();
+  const Long n = 64 * 1024;
+  const std::vector<ColorMatrix> xs =
+      make_anti_hermitian_matrices(n, 0.1, RngState("test_speed"));
+  std::vector<ColorMatrix> es(n);
+  std::vector<AdjointColorMatrix> js(n);
+  double time = get_time();
+  for (Long i = 0; i < n; ++i) {
+    es[i] = make_matrix_exp(xs[i]);
+  }
+  const double time_exp_series = get_time() - time;
+  time = get_time();
+  for (Long i = 0; i < n; ++i) {
+    es[i] = make_color_matrix_exp_exact(xs[i]);
+  }
+  const double time_exp_exact = get_time() - time;
+  time = get_time();
+  for (Long i = 0; i < n; ++i) {
+    js[i] = make_diff_exp_map(xs[i], cmcs);
+  }
+  const double time_j_series = get_time() - time;
+  time = get_time();
+  for (Long i = 0; i < n; ++i) {
+    js[i] = make_diff_exp_map_exact(xs[i], cmcs);
+  }
+  const double time_j_exact = get_time() - time;
+  displayln_info(ssprintf("INFO: n=%ld exp series %.3f sec exact %.3f sec", n,
+                          time_exp_series, time_exp_exact));
+  displayln_info(ssprintf(
+      "INFO: n=%ld diff_exp_map series %.3f sec exact %.3f sec", n,
+      time_j_series, time_j_exact));
+}
+
+inline void test_gf_evolve()
+// gf_evolve followed by gf_evolve with the opposite momentum
+{
+  TIMER_VERBOSE("test_gf_evolve");
+  const Geometry geo(Coordinate(4, 4, 4, 8));
+  GaugeField gf;
+  gf.init(geo);
+  set_g_rand_color_matrix_field(gf, RngState("test_gf_evolve-gf"), 1.0);
+  GaugeMomentum gm;
+  gm.init(geo);
+  set_rand_gauge_momentum(gm, 1.0, RngState("test_gf_evolve-gm"));
+  GaugeField gf1;
+  gf1 = gf;
+  gf_evolve(gf1, gm, 0.1);
+  const double plaq = gf_avg_plaq(gf1);
+  gf_evolve(gf1, gm, -0.1);
+  gf1 -= gf;
+  displayln_info(ssprintf("CHECK: gf_evolve plaq %.10f", plaq));
+  displayln_info(ssprintf("CHECK: gf_evolve reverse diff %s",
+                          qnorm(gf1) < 1e-20 ? "ok" : "fail"));
+}
+
+int main(int argc, char* argv[])
+{
+  begin(&argc, &argv);
+  ColorMatrixConstants::get_instance().check();
+  test_accuracy(1e-4);
+  test_accuracy(1e-2);
+  test_accuracy(0.1);
+  test_accuracy(0.5);
+  test_accuracy(1.0);
+  test_speed();
+  test_gf_evolve();
+  displayln_info("CHECK: finished successfully.");
+  Timer::display();
+  end();
+  return 0;
+}
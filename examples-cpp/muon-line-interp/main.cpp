@@ -0,0 +1,95 @@
+#include <qlat/muon-line.h>
+
+using namespace qlat;
+
+IntegrationEps get_cheap_eps()
+// Far from accurate, only to make the table quickly.
+{
+  IntegrationEps eps;
+  eps.epsabs = 1e-3;
+  eps.epsrel = 1e-1;
+  eps.mineval = 1024;
+  eps.maxeval = 16 * 1024;
+  return eps;
+}
+
+RealD qnorm_diff(const std::vector<ManyMagneticMomentsCompressed>& data1,
+                 const std::vector<ManyMagneticMomentsCompressed>& data2)
+{
+  qassert(data1.size() == data2.size());
+  RealD sum = 0.0;
+  for (size_t idx = 0; idx < data1.size(); ++idx) {
+    for (size_t i = 0; i < data1[idx].size(); ++i) {
+      sum += sqr(data1[idx][i] - data2[idx][i]);
+    }
+  }
+  return sum;
+}
+
+RealD qnorm(const std::vector<ManyMagneticMomentsCompressed>& data)
+{
+  RealD sum = 0.0;
+  for (size_t idx = 0; idx < data.size(); ++idx) {
+    for (size_t i = 0; i < data[idx].size(); ++i) {
+      sum += sqr(data[idx][i]);
+    }
+  }
+  return sum;
+}
+
+void test_restart()
+// Compute the table with path_part, remove some of the saved chunks and
+// compute again. Only the removed chunks are recomputed and the final table
+// should be the same as the one of the uninterrupted run.
+{
+  TIMER_VERBOSE("test_restart");
+  const std::string path_part = "results/muon-line-interp/part";
+  // 3^5 = 243 entries, which is 4 chunks of (at most) 64 entries
+  const std::vector<int> dims(5, 3);
+  const IntegrationEps eps = get_cheap_eps();
+  qremove_all_info("results/muon-line-interp");
+  initializeMuonLineInterpolation(dims, eps, path_part);
+  const std::vector<ManyMagneticMomentsCompressed> data_ref =
+      getMuonLineInterp().data;
+  displayln_info(ssprintf("CHECK: test_restart: size %ld",
+                          (long)data_ref.size()));
+  displayln_info(
+      ssprintf("INFO: test_restart: data qnorm %.10E", qnorm(data_ref)));
+  const std::vector<Long> chunks_removed = {1, 3};
+  for (size_t i = 0; i < chunks_removed.size(); ++i) {
+    const std::string fn =
+        path_part + ssprintf("/data.txt.%010ld", (long)chunks_removed[i]);
+    qassert(does_file_exist_qar_sync_node(fn));
+    qremove_info(fn);
+  }
+  sync_node();
+  initializeMuonLineInterpolation(dims, eps, path_part);
+  const std::vector<ManyMagneticMomentsCompressed> data_restart =
+      getMuonLineInterp().data;
+  displayln_info(ssprintf(
+      "CHECK: test_restart: restart: chunks_removed %ld ; diff qnorm %.10E",
+      (long)chunks_removed.size(), qnorm_diff(data_ref, data_restart)));
+  // Every chunk is saved now, so nothing is recomputed.
+  initializeMuonLineInterpolation(dims, eps, path_part);
+  const std::vector<ManyMagneticMomentsCompressed> data_load =
+      getMuonLineInterp().data;
+  displayln_info(ssprintf("CHECK: test_restart: load: diff qnorm %.10E",
+                          qnorm_diff(data_ref, data_load)));
+  // The table is the same on all the nodes.
+  std::vector<ManyMagneticMomentsCompressed> data_node0 = data_load;
+  bcast(get_data(data_node0));
+  RealD diff_node = qnorm_diff(data_node0, data_load);
+  glb_sum(diff_node);
+  displayln_info(ssprintf("CHECK: test_restart: all nodes: diff qnorm %.10E",
+                          diff_node));
+}
+
+int main(int argc, char* argv[])
+{
+  begin(&argc, &argv);
+  test_restart();
+  displayln_info("CHECK: finished successfully.");
+  Timer::display();
+  end();
+  return 0;
+}
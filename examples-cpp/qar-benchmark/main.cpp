@@ -0,0 +1,192 @@
+#include <qlat/qlat.h>
+
+using namespace qlat;
+
+inline void make_tree(const std::string& path, const Long n_dir,
+                      const Long n_file, const RngState& rs)
+// n_dir directories, each with n_file files of random size and content
+{
+  TIMER_VERBOSE_FLOPS("make_tree");
+  for (Long i = 0; i < n_dir; ++i) {
+    const std::string path_dir = path + ssprintf("/traj-%04ld", i);
+    qmkdir_p(path_dir);
+    for (Long j = 0; j < n_file; ++j) {
+      RngState rsi = rs.split(i * n_file + j);
+      const Long size = rand_gen(rsi) % (64 * 1024);
+      std::string content(size, ' ');
+      for (Long k = 0; k < size; ++k) {
+        content[k] = (char)(rand_gen(rsi) % 256);
+      }
+      qtouch(path_dir + ssprintf("/meas-%04ld.dat", j), content);
+      timer.flops += size;
+    }
+  }
+}
+
+inline crc32_t crc32_of_tree(const std::string& path)
+// combined crc32 of the relative path names and the crc32 of the files
+{
+  TIMER_VERBOSE("crc32_of_tree");
+  const std::vector<std::pair<std::string, crc32_t>> fcrcs =
+      check_all_files_crc32(path);
+  std::string s;
+  for (Long i = 0; i < (Long)fcrcs.size(); ++i) {
+    s += fcrcs[i].first.substr(path.size()) + ssprintf(" %08X\n", fcrcs[i].second);
+  }
+  return crc32_par(s.data(), s.size());
+}
+
+inline crc32_t crc32_of_qar(const std::string& path_qar)
+// combined crc32 of the index and all the volumes
+{
+  TIMER_VERBOSE("crc32_of_qar");
+  const std::vector<std::string> paths = qls(dirname(path_qar));
+  std::string s;
+  for (Long i = 0; i < (Long)paths.size(); ++i) {
+    const std::string& p = paths[i];
+    if (p.compare(0, path_qar.size(), path_qar) == 0 and is_regular_file(p)) {
+      s += p.substr(path_qar.size()) + ssprintf(" %08X\n", compute_crc32(p));
+    }
+  }
+  return crc32_par(s.data(), s.size());
+}
+
+inline void test_qar(const std::string& tag, const Long n_threads)
+{
+  TIMER_VERBOSE("test_qar");
+  const std::string path = "results/tree";
+  const std::string path_qar = "results/" + tag + ".qar";
+  const std::string path_extract = "results/" + tag;
+  get_qar_io_n_threads() = n_threads;
+  double time = get_time();
+  qar_create(path_qar, path);
+  const double time_create = get_time() - time;
+  time = get_time();
+  qar_extract(path_qar, path_extract);
+  const double time_extract = get_time() - time;
+  displayln(ssprintf("CHECK: %s qar crc32=%08X", tag.c_str(),
+                     crc32_of_qar(path_qar)));
+  displayln(ssprintf("CHECK: %s extracted tree crc32=%08X", tag.c_str(),
+                     crc32_of_tree(path_extract)));
+  displayln(ssprintf("INFO: %s n_threads=%ld create %.3f sec extract %.3f sec",
+                     tag.c_str(), n_threads, time_create, time_extract));
+}
+
+inline void test_qar_mmap(const std::string& tag)
+// read the qar archive with q_qfile_mmap off and on, also with read_data_view
+{
+  TIMER_VERBOSE("test_qar_mmap");
+  const std::string path_qar = "results/" + tag + ".qar";
+  const bool is_mmap_orig = is_qfile_mmap();
+  is_qfile_mmap() = false;
+  QarFile qar(path_qar, QFileMode::Read);
+  const std::vector<std::string> fns = list(qar);
+  std::vector<std::string> data(fns.size());
+  Long total_size = 0;
+  for (Long i = 0; i < (Long)fns.size(); ++i) {
+    data[i] = read_data(qar, fns[i]);
+    total_size += data[i].size();
+  }
+  Vector<char> v;
+  const bool is_view_without_mmap = read_data_view(v, qar, fns[0]);
+  qar.close();
+  is_qfile_mmap() = true;
+  QarFile qar_mmap(path_qar, QFileMode::Read);
+  Long n_same = 0;
+  Long n_same_view = 0;
+  for (Long i = 0; i < (Long)fns.size(); ++i) {
+    if (read_data(qar_mmap, fns[i]) == data[i]) {
+      n_same += 1;
+    }
+    if (read_data_view(v, qar_mmap, fns[i]) and
+        std::string(v.data(), v.size()) == data[i]) {
+      n_same_view += 1;
+    }
+  }
+  qar_mmap.close();
+  displayln(ssprintf("CHECK: %s mmap n_files=%ld total_size=%ld same=%ld "
+                     "same_view=%ld view_without_mmap=%d",
+                     tag.c_str(), (long)fns.size(), (long)total_size,
+                     (long)n_same, (long)n_same_view, is_view_without_mmap));
+  // qfread_view of a plain file, in two parts
+  const std::string fn = "results/tree/traj-0000/meas-0001.dat";
+  is_qfile_mmap() = false;
+  const std::string content = qcat(fn);
+  is_qfile_mmap() = true;
+  QFile qfile = qfopen(fn, QFileMode::Read);
+  const Long size_1 = content.size() / 3;
+  Vector<char> v1, v2;
+  const bool b1 = qfread_view(v1, size_1, qfile);
+  const bool b2 = qfread_view(v2, content.size() - size_1, qfile);
+  const bool b3 = qfread_view(v, 1, qfile);
+  const bool is_same_parts =
+      b1 and b2 and std::string(v1.data(), v1.size()) +
+                            std::string(v2.data(), v2.size()) ==
+                        content;
+  qfclose(qfile);
+  displayln(ssprintf("CHECK: %s qfread_view size=%ld same=%d past_end=%d",
+                     tag.c_str(), (long)content.size(), is_same_parts, b3));
+  is_qfile_mmap() = is_mmap_orig;
+}
+
+inline void test_lat_data_mmap()
+// load the same LatData (plain file and in qar) with q_qfile_mmap off and on
+{
+  TIMER_VERBOSE("test_lat_data_mmap");
+  const bool is_mmap_orig = is_qfile_mmap();
+  LatData ld;
+  ld.info.push_back(lat_dim_number("tsep", 0, 15));
+  ld.info.push_back(lat_dim_number("op", 0, 7));
+  ld.info.push_back(lat_dim_re_im());
+  lat_data_alloc(ld);
+  RngState rs("test_lat_data_mmap");
+  for (Long i = 0; i < (Long)ld.res.size(); ++i) {
+    ld.res[i] = g_rand_gen(rs);
+  }
+  qmkdir_p("results/lat");
+  ld.save("results/lat/data.lat");
+  qar_create("results/lat.qar", "results/lat");
+  for (int is_mmap = 0; is_mmap < 2; ++is_mmap) {
+    is_qfile_mmap() = is_mmap;
+    LatData ld1;
+    ld1.load("results/lat/data.lat");
+    LatData ld2;
+    {
+      QarFile qar("results/lat.qar", QFileMode::Read);
+      QFile qfile = read(qar, "data.lat");
+      ld2.load(qfile);
+      qfclose(qfile);
+      qar.close();
+    }
+    displayln(ssprintf(
+        "CHECK: lat-data mmap=%d qnorm=%.10E file diff=%.5E qar diff=%.5E "
+        "matching=%d",
+        is_mmap, qnorm(ld1), qnorm(ld1 - ld), qnorm(ld2 - ld),
+        is_matching(ld1, ld) and is_matching(ld2, ld)));
+  }
+  is_qfile_mmap() = is_mmap_orig;
+}
+
+int main(int argc, char* argv[])
+{
+  begin(&argc, &argv);
+  if (get_id_node() == 0) {
+    qremove_all("results");
+    qmkdir("results");
+    make_tree("results/tree", 16, 128, RngState("make_tree"));
+    displayln(ssprintf("CHECK: tree crc32=%08X", crc32_of_tree("results/tree")));
+    get_qar_multi_vol_max_size() = 16L * 1024L * 1024L;
+    test_qar("serial", 0);
+    test_qar("threads-2", 2);
+    test_qar("threads-8", 8);
+    get_qar_io_max_pending_bytes() = 256L * 1024L;
+    test_qar("threads-8-small-buffer", 8);
+    test_qar_mmap("serial");
+    test_lat_data_mmap();
+  }
+  sync_node();
+  displayln_info("CHECK: finished successfully.");
+  Timer::display();
+  end();
+  return 0;
+}
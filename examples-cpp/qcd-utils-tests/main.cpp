@@ -85,11 +85,107 @@ void show_matrix()
   displayln_info(ssprintf("gamma_5 =\n") + show(gamma5));
 }
 
+WilsonMatrix get_dense_wilson_matrix(const SpinMatrix& sm)
+// sm \otimes unit color matrix
+{
+  WilsonMatrix ret;
+  set_zero(ret);
+  for (int s1 = 0; s1 < 4; ++s1) {
+    for (int s2 = 0; s2 < 4; ++s2) {
+      for (int c = 0; c < NUM_COLOR; ++c) {
+        ret(s1 * NUM_COLOR + c, s2 * NUM_COLOR + c) = sm(s1, s2);
+      }
+    }
+  }
+  return ret;
+}
+
+void test_gamma_matrix()
+{
+  TIMER_VERBOSE("test_gamma_matrix");
+  RngState rs(get_global_rng_state(), fname);
+  std::vector<GammaMatrix> gms;
+  std::vector<SpinMatrix> sms;
+  for (int mu = 0; mu < 4; ++mu) {
+    gms.push_back(GammaMatrixConstants::get_gamma(mu));
+    sms.push_back(SpinMatrixConstants::get_gamma(mu));
+    gms.push_back(GammaMatrixConstants::get_cps_gamma(mu));
+    sms.push_back(SpinMatrixConstants::get_cps_gamma(mu));
+  }
+  gms.push_back(GammaMatrixConstants::get_gamma5());
+  sms.push_back(SpinMatrixConstants::get_gamma5());
+  gms.push_back(GammaMatrixConstants::get_unit());
+  sms.push_back(SpinMatrixConstants::get_unit());
+  const array<GammaMatrix, 16> cps_gms = GammaMatrixConstants::get_cps_gms();
+  for (int idx = 0; idx < 16; ++idx) {
+    gms.push_back(GammaMatrixConstants::get_gm(idx));
+    sms.push_back(SpinMatrixConstants::get_gms()[idx]);
+    gms.push_back(cps_gms[idx]);
+    sms.push_back(SpinMatrixConstants::get_cps_gms()[idx]);
+  }
+  const int n_gm = gms.size();
+  Long n_mismatch = 0;
+  for (int i = 0; i < n_gm; ++i) {
+    if (qnorm(get_spin_matrix(gms[i]) - sms[i]) != 0.0) {
+      n_mismatch += 1;
+    }
+  }
+  displayln_info(ssprintf(
+      "CHECK: test_gamma_matrix: get_spin_matrix: n_gm %d ; n_mismatch %ld",
+      n_gm, (long)n_mismatch));
+  const int n_wm = 4;
+  RealD qnorm_diff_gm_wm = 0.0;
+  RealD qnorm_diff_wm_gm = 0.0;
+  RealD qnorm_diff_trace = 0.0;
+  RealD qnorm_diff_mcc = 0.0;
+  RealD qnorm_trace = 0.0;
+  for (int k = 0; k < n_wm; ++k) {
+    RngState rsk(rs, ssprintf("wm-%d", k));
+    WilsonMatrix m1, m2;
+    for (int i = 0; i < 4 * NUM_COLOR * 4 * NUM_COLOR; ++i) {
+      m1.p[i] = ComplexD(g_rand_gen(rsk), g_rand_gen(rsk));
+      m2.p[i] = ComplexD(g_rand_gen(rsk), g_rand_gen(rsk));
+    }
+    const array<ComplexD, 256> mcc = matrix_color_contract(m1, m2);
+    for (int i = 0; i < n_gm; ++i) {
+      const WilsonMatrix wm_gm1 = get_dense_wilson_matrix(sms[i]);
+      const WilsonMatrix gm_m1 = wm_gm1 * m1;
+      const WilsonMatrix m1_gm = m1 * wm_gm1;
+      qnorm_diff_gm_wm += qnorm(gms[i] * m1 - gm_m1);
+      qnorm_diff_wm_gm += qnorm(m1 * gms[i] - m1_gm);
+      qnorm_diff_trace += qnorm(matrix_trace(gms[i], m1) - matrix_trace(gm_m1));
+      for (int j = 0; j < n_gm; ++j) {
+        const WilsonMatrix wm_gm2 = get_dense_wilson_matrix(sms[j]);
+        const ComplexD tr = matrix_trace(m1_gm * m2 * wm_gm2);
+        qnorm_trace += qnorm(tr);
+        qnorm_diff_mcc += qnorm(matrix_trace(mcc, gms[i], gms[j]) - tr);
+      }
+    }
+  }
+  displayln_info(ssprintf("CHECK: test_gamma_matrix: GammaMatrix * "
+                          "WilsonMatrix: qnorm diff %.2E",
+                          qnorm_diff_gm_wm));
+  displayln_info(ssprintf("CHECK: test_gamma_matrix: WilsonMatrix * "
+                          "GammaMatrix: qnorm diff %.2E",
+                          qnorm_diff_wm_gm));
+  displayln_info(ssprintf("INFO: test_gamma_matrix: matrix_trace(gm, wm): "
+                          "qnorm diff %.2E",
+                          qnorm_diff_trace));
+  displayln_info(ssprintf("INFO: test_gamma_matrix: matrix_trace(mcc, gm1, "
+                          "gm2): qnorm %.10E ; qnorm diff %.2E",
+                          qnorm_trace, qnorm_diff_mcc));
+  displayln_info(
+      ssprintf("CHECK: test_gamma_matrix: matrix_trace: rel diff small: %d %d",
+               qnorm_diff_trace <= 1e-24 * qnorm_trace,
+               qnorm_diff_mcc <= 1e-24 * qnorm_trace));
+}
+
 int main(int argc, char* argv[])
 {
   begin(&argc, &argv);
   get_global_rng_state() = RngState(get_global_rng_state(), "qcd-utils-tests");
   show_matrix();
+  test_gamma_matrix();
   simple_tests();
   displayln_info("CHECK: finished successfully.");
   Timer::display();
@@ -34,11 +34,157 @@ void simple_tests()
 
 }
 
+template <class M>
+void pencil_tests(const std::string& tag, const Long n_field,
+                  const RealD eps)
+// compare the pencil FFT (single field and batch) with the per direction FFT
+{
+  TIMER_VERBOSE("pencil_tests");
+  RngState rs(get_global_rng_state(), fname + "-" + tag);
+  const Coordinate total_site(4, 4, 4, 8);
+  Geometry geo;
+  geo.init(total_site);
+  std::vector<Field<M> > fs(n_field);
+  for (Long i = 0; i < n_field; ++i) {
+    fs[i].init(geo, 12);
+    set_g_rand(fs[i], RngState(rs, ssprintf("src-%ld", (long)i)));
+  }
+  const bool is_pencil_orig = is_fft_pencil();
+  for (int is_spatial = 0; is_spatial < 2; ++is_spatial) {
+    const std::vector<int> dirs =
+        is_spatial ? std::vector<int>{0, 1, 2} : std::vector<int>{0, 1, 2, 3};
+    for (int is_forward = 0; is_forward < 2; ++is_forward) {
+      std::vector<Field<M> > fs_d(n_field);
+      std::vector<Field<M> > fs_p(n_field);
+      std::vector<Field<M> > fs_b(n_field);
+      for (Long i = 0; i < n_field; ++i) {
+        fs_d[i] = fs[i];
+        fs_p[i] = fs[i];
+        fs_b[i] = fs[i];
+      }
+      is_fft_pencil() = false;
+      for (Long i = 0; i < n_field; ++i) {
+        if (is_spatial) {
+          fft_complex_field_spatial(fs_d[i], is_forward);
+        } else {
+          fft_complex_field(fs_d[i], is_forward);
+        }
+      }
+      is_fft_pencil() = true;
+      for (Long i = 0; i < n_field; ++i) {
+        if (is_spatial) {
+          fft_complex_field_spatial(fs_p[i], is_forward);
+        } else {
+          fft_complex_field(fs_p[i], is_forward);
+        }
+      }
+      std::vector<Handle<Field<M> > > vec(n_field);
+      for (Long i = 0; i < n_field; ++i) {
+        vec[i].init(fs_b[i]);
+      }
+      fft_complex_fields_pencil(vec, dirs, is_forward);
+      RealD qnorm_d = 0.0;
+      RealD qnorm_diff_p = 0.0;
+      RealD qnorm_diff_b = 0.0;
+      for (Long i = 0; i < n_field; ++i) {
+        qnorm_d += qnorm(fs_d[i]);
+        fs_p[i] -= fs_d[i];
+        fs_b[i] -= fs_d[i];
+        qnorm_diff_p += qnorm(fs_p[i]);
+        qnorm_diff_b += qnorm(fs_b[i]);
+      }
+      const RealD ratio_p = qnorm_diff_p / qnorm_d;
+      const RealD ratio_b = qnorm_diff_b / qnorm_d;
+      displayln_info(ssprintf(
+          "CHECK: pencil %s n_field=%ld spatial=%d forward=%d qnorm: %.6E ; "
+          "pencil diff small %d ; batch diff small %d",
+          tag.c_str(), (long)n_field, is_spatial, is_forward, qnorm_d,
+          ratio_p < eps, ratio_b < eps));
+      displayln_info(ssprintf(
+          "INFO: pencil %s n_field=%ld spatial=%d forward=%d ratio: %.3E %.3E",
+          tag.c_str(), (long)n_field, is_spatial, is_forward, ratio_p,
+          ratio_b));
+    }
+  }
+  is_fft_pencil() = is_pencil_orig;
+}
+
+void precision_tests()
+// compare the ComplexF FFT with the ComplexD FFT of the same data
+{
+  TIMER_VERBOSE("precision_tests");
+  RngState rs(get_global_rng_state(), fname);
+  const Coordinate total_site(4, 4, 4, 8);
+  Geometry geo;
+  geo.init(total_site);
+  Field<ComplexD> fd;
+  Field<ComplexF> ff;
+  fd.init(geo, 12);
+  ff.init(geo, 12);
+  set_g_rand(fd, RngState(rs, "src"));
+  qacc_for(index, geo.local_volume(), {
+    // the same numbers in both precisions
+    Vector<ComplexD> vd = fd.get_elems(index);
+    Vector<ComplexF> vf = ff.get_elems(index);
+    for (int m = 0; m < vd.size(); ++m) {
+      vf[m] = (ComplexF)vd[m];
+      vd[m] = (ComplexD)vf[m];
+    }
+  });
+  const bool is_pencil_orig = is_fft_pencil();
+  for (int is_pencil = 0; is_pencil < 2; ++is_pencil) {
+    is_fft_pencil() = is_pencil;
+    for (int is_spatial = 0; is_spatial < 2; ++is_spatial) {
+      for (int is_forward = 0; is_forward < 2; ++is_forward) {
+        Field<ComplexD> fd1;
+        Field<ComplexF> ff1;
+        fd1 = fd;
+        ff1 = ff;
+        if (is_spatial) {
+          fft_complex_field_spatial(fd1, is_forward);
+          fft_complex_field_spatial(ff1, is_forward);
+        } else {
+          fft_complex_field(fd1, is_forward);
+          fft_complex_field(ff1, is_forward);
+        }
+        const RealD qnorm_d = qnorm(fd1);
+        qacc_for(index, geo.local_volume(), {
+          Vector<ComplexD> vd = fd1.get_elems(index);
+          const Vector<ComplexF> vf = ff1.get_elems_const(index);
+          for (int m = 0; m < vd.size(); ++m) {
+            vd[m] -= (ComplexD)vf[m];
+          }
+        });
+        const RealD ratio = qnorm(fd1) / qnorm_d;
+        displayln_info(
+            ssprintf("CHECK: precision pencil=%d spatial=%d forward=%d "
+                     "qnorm: %.6E ; float diff small %d",
+                     is_pencil, is_spatial, is_forward, qnorm_d,
+                     ratio < 1e-10));
+        displayln_info(
+            ssprintf("INFO: precision pencil=%d spatial=%d forward=%d "
+                     "ratio: %.3E",
+                     is_pencil, is_spatial, is_forward, ratio));
+      }
+    }
+  }
+  is_fft_pencil() = is_pencil_orig;
+}
+
 int main(int argc, char* argv[])
 {
-  begin(&argc, &argv);
+  std::vector<Coordinate> size_node_list;
+  size_node_list.push_back(Coordinate(1, 1, 1, 1));
+  size_node_list.push_back(Coordinate(1, 1, 1, 2));
+  size_node_list.push_back(Coordinate(1, 2, 1, 2));
+  begin(&argc, &argv, size_node_list);
   get_global_rng_state() = RngState(get_global_rng_state(), "qlat-fft-tests");
   simple_tests();
+  pencil_tests<ComplexD>("ComplexD", 1, 1e-24);
+  pencil_tests<ComplexD>("ComplexD", 3, 1e-24);
+  pencil_tests<ComplexF>("ComplexF", 1, 1e-10);
+  pencil_tests<ComplexF>("ComplexF", 3, 1e-10);
+  precision_tests();
   displayln_info("CHECK: finished successfully.");
   Timer::display();
   end();
@@ -53,11 +53,135 @@ void simple_tests()
                             qnorm(prop_src), qnorm(prop_qlat), qnorm(prop_vec)));
   }
 
+  {
+    TIMER_VERBOSE("test-prop_smear_time_slices");
+    // with size_node (1, 1, 2, 2) only half of the nodes have the time slices
+    const int nsmear = 10;
+    const double coef = 0.3;
+    const CoordinateD mom(0.1, 0.2, 0.3, 0.0);
+    set_left_expanded_gauge_field(gf1, gf);
+    Propagator4d prop_full;
+    prop_full = prop_src;
+    prop_smear(prop_full, gf1, coef, nsmear, mom);
+    // {0, 2, 3, 6} selects more time slices on one node than on the other
+    const std::vector<std::vector<Int>> t_slices_list = {
+        {1}, {5, 1, 5}, {0, 2, 3, 6}, {}};
+    for (int k = 0; k < (int)t_slices_list.size(); ++k) {
+      const std::vector<Int>& t_slices = t_slices_list[k];
+      Propagator4d prop_ts, prop_exp;
+      prop_ts = prop_src;
+      prop_exp = prop_src;
+      prop_smear_time_slices(prop_ts, gf1, coef, nsmear, t_slices, mom);
+      std::vector<int> is_selected(total_site[3], 0);
+      std::string t_slices_str;
+      for (int i = 0; i < (int)t_slices.size(); ++i) {
+        is_selected[t_slices[i]] = 1;
+        t_slices_str += ssprintf(" %d", t_slices[i]);
+      }
+      qthread_for(index, geo.local_volume(), {
+        const Coordinate xg =
+            geo.coordinate_g_from_l(geo.coordinate_from_index(index));
+        if (is_selected[xg[3]] == 1) {
+          prop_exp.get_elem(index) = prop_full.get_elem(index);
+        }
+      });
+      prop_exp -= prop_ts;
+      displayln_info(
+          ssprintf("CHECK: prop_smear_time_slices: %d: t_slices=[%s ] ; qnorm "
+                   "%.10E ; diff qnorm %.10E",
+                   k, t_slices_str.c_str(), qnorm(prop_ts), qnorm(prop_exp)));
+    }
+  }
+  {
+    TIMER_VERBOSE("test-compressed_gauge_field");
+    // reconstruct-12 links should give the same results as the full links
+    is_checking_compressed_gauge_field() = true;
+    const int nsmear = 10;
+    const double coef = 0.3;
+    const CoordinateD mom(0.1, 0.2, 0.3, 0.0);
+    set_left_expanded_gauge_field(gf1, gf);
+    CompressedGaugeField cgf1;
+    set_compressed_gauge_field(cgf1, gf1);
+    Propagator4d prop_full, prop_comp;
+    prop_full = prop_src;
+    prop_comp = prop_src;
+    prop_smear(prop_full, gf1, coef, nsmear, mom);
+    prop_smear(prop_comp, cgf1, coef, nsmear, mom);
+    const double prop_qnorm = qnorm(prop_full);
+    prop_comp -= prop_full;
+    const double prop_diff = std::sqrt(qnorm(prop_comp) / prop_qnorm);
+    displayln_info(
+        ssprintf("CHECK: prop_smear compressed: qnorm %.10E ; diff small %d",
+                 prop_qnorm, (int)(prop_diff < 1e-12)));
+    GaugeField gfe, gf_ape_full, gf_ape_comp;
+    gfe.init(geo_resize(geo, 1));
+    gfe = gf;
+    refresh_expanded(gfe);
+    CompressedGaugeField cgfe;
+    set_compressed_gauge_field(cgfe, gfe);
+    gf_ape_smear_no_comm(gf_ape_full, gfe, 0.5);
+    gf_ape_smear_no_comm(gf_ape_comp, cgfe, 0.5);
+    const double ape_qnorm = qnorm(gf_ape_full);
+    gf_ape_comp -= gf_ape_full;
+    const double ape_diff = std::sqrt(qnorm(gf_ape_comp) / ape_qnorm);
+    displayln_info(
+        ssprintf("CHECK: gf_ape_smear compressed: qnorm %.10E ; diff small %d",
+                 ape_qnorm, (int)(ape_diff < 1e-12)));
+    // Wilson hop (multiply_wilson_{d,ddag}_e_o_{no_comm,comm_overlap}) with
+    // the SIMD block kernel (aligned=1) and the site kernel (aligned=0)
+    const int ls = 2;
+    const Geometry geo_in = geo_resize(geo_eo(geo, 1), 1);
+    const bool is_aligned_orig = is_wilson_hop_aligned();
+    for (int is_aligned = 1; is_aligned >= 0; --is_aligned) {
+      is_wilson_hop_aligned() = is_aligned;
+      for (int k = 0; k < 4; ++k) {
+        const bool is_dag = k % 2 == 1;
+        const bool is_overlap = k / 2 == 1;
+        FermionField5d ff_full, ff_comp, ff_in_full, ff_in_comp;
+        ff_in_full.init(geo_in, ls);
+        set_u_rand(ff_in_full, RngState(rs, "ff-in"));
+        refresh_expanded_1(ff_in_full);
+        ff_in_comp.init(geo_in, ls);
+        set_u_rand(ff_in_comp, RngState(rs, "ff-in"));
+        refresh_expanded_1(ff_in_comp);
+        if (not is_overlap and not is_dag) {
+          multiply_wilson_d_e_o_no_comm(ff_full, ff_in_full, gf1);
+          multiply_wilson_d_e_o_no_comm(ff_comp, ff_in_comp, cgf1);
+        } else if (not is_overlap and is_dag) {
+          multiply_wilson_ddag_e_o_no_comm(ff_full, ff_in_full, gf1);
+          multiply_wilson_ddag_e_o_no_comm(ff_comp, ff_in_comp, cgf1);
+        } else if (is_overlap and not is_dag) {
+          multiply_wilson_d_e_o_comm_overlap(ff_full, ff_in_full, gf1);
+          multiply_wilson_d_e_o_comm_overlap(ff_comp, ff_in_comp, cgf1);
+        } else {
+          multiply_wilson_ddag_e_o_comm_overlap(ff_full, ff_in_full, gf1);
+          multiply_wilson_ddag_e_o_comm_overlap(ff_comp, ff_in_comp, cgf1);
+        }
+        const double hop_qnorm = qnorm(ff_full);
+        ff_comp -= ff_full;
+        const double hop_diff = std::sqrt(qnorm(ff_comp) / hop_qnorm);
+        displayln_info(ssprintf(
+            "CHECK: wilson hop compressed: aligned=%d dag=%d overlap=%d ; "
+            "qnorm %.10E ; diff small %d",
+            is_aligned, (int)is_dag, (int)is_overlap, hop_qnorm,
+            (int)(hop_diff < 1e-12)));
+        displayln_info(ssprintf(
+            "INFO: wilson hop compressed: aligned=%d dag=%d overlap=%d ; "
+            "diff %.3E",
+            is_aligned, (int)is_dag, (int)is_overlap, hop_diff));
+      }
+    }
+    is_wilson_hop_aligned() = is_aligned_orig;
+  }
 }
 
 int main(int argc, char* argv[])
 {
-  begin(&argc, &argv);
+  std::vector<Coordinate> size_node_list;
+  size_node_list.push_back(Coordinate(1, 1, 1, 1));
+  size_node_list.push_back(Coordinate(1, 1, 1, 2));
+  size_node_list.push_back(Coordinate(1, 1, 2, 2));
+  begin(&argc, &argv, size_node_list);
   get_global_rng_state() = RngState(get_global_rng_state(), "qlat-smear-tests");
   simple_tests();
   displayln_info("CHECK: finished successfully.");
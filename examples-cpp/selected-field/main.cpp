@@ -427,6 +427,190 @@ inline void test_shift(const std::string& tag, const Long n_per_tslice, const Lo
   }
 }
 
+inline Long idx_from_xg_linear(const Coordinate& xg,
+                               const PointsSelection& psel)
+{
+  for (Long idx = 0; idx < (Long)psel.size(); ++idx) {
+    if (psel[idx] == xg) {
+      return idx;
+    }
+  }
+  return -1;
+}
+
+inline void test_points_index(const std::string& tag, const Long n_points)
+// compare the hash index of PointsSelection with a linear search
+{
+  TIMER_VERBOSE("test_points_index");
+  const Coordinate total_site(4, 4, 4, 8);
+  Geometry geo;
+  geo.init(total_site);
+  const RngState rs = RngState("test_points_index").split(tag);
+  const PointsSelection psel0 =
+      mk_random_point_selection(total_site, n_points, rs.split("psel0"));
+  // psel: shuffled points of psel0, some repeated and some not in psel0
+  std::vector<Coordinate> xgs;
+  {
+    RngState rsi = rs.split("psel");
+    for (Long i = 0; i < n_points; ++i) {
+      const Long r = rand_gen(rsi) % 4;
+      if (r == 0) {
+        xgs.push_back(Coordinate(-1, -1, -1, -1 - i));
+      } else {
+        xgs.push_back(psel0[rand_gen(rsi) % n_points]);
+      }
+    }
+  }
+  const PointsSelection psel(total_site, xgs);
+  Long n_found = 0;
+  Long n_mismatch = 0;
+  for (Long idx = 0; idx < (Long)psel.size(); ++idx) {
+    const Long idx0 = idx_from_xg(psel[idx], psel0);
+    if (idx0 != idx_from_xg_linear(psel[idx], psel0)) {
+      n_mismatch += 1;
+    }
+    if (idx0 >= 0) {
+      n_found += 1;
+    }
+  }
+  displayln_info(ssprintf("CHECK: %s: idx_from_xg n_found=%ld mismatch=%ld",
+                          tag.c_str(), (long)n_found, (long)n_mismatch));
+  //
+  Field<ComplexD> f;
+  f.init(geo, 2);
+  set_u_rand(f, rs.split("f-init"));
+  SelectedPoints<ComplexD> sp0;
+  set_selected_points(sp0, f, psel0);
+  SelectedPoints<ComplexD> sp;
+  set_selected_points(sp, sp0, psel, psel0);
+  SelectedPoints<ComplexD> sp_ref;
+  sp_ref.init(psel, 2);
+  set_zero(sp_ref);
+  for (Long idx = 0; idx < (Long)psel.size(); ++idx) {
+    const Long idx0 = idx_from_xg_linear(psel[idx], psel0);
+    if (idx0 >= 0) {
+      sp_ref.get_elem(idx, 0) = sp0.get_elem(idx0, 0);
+      sp_ref.get_elem(idx, 1) = sp0.get_elem(idx0, 1);
+    }
+  }
+  sp_ref -= sp;
+  displayln_info(ssprintf("CHECK: %s: set_selected_points(sp,sp0,psel,psel0) "
+                          "qnorm(sp)=%.10E diff=%.5E",
+                          tag.c_str(), qnorm(sp), qnorm(sp_ref)));
+  //
+  const PointsSelection psel_i = intersect(psel, psel0);
+  Long n_intersect_ref = 0;
+  bool is_intersect_ok = true;
+  for (Long idx = 0; idx < (Long)psel.size(); ++idx) {
+    if (idx_from_xg_linear(psel[idx], psel0) >= 0) {
+      if (n_intersect_ref >= (Long)psel_i.size() or
+          psel_i[n_intersect_ref] != psel[idx]) {
+        is_intersect_ok = false;
+      }
+      n_intersect_ref += 1;
+    }
+  }
+  is_intersect_ok = is_intersect_ok and n_intersect_ref == (Long)psel_i.size();
+  displayln_info(ssprintf(
+      "CHECK: %s: is_containing(psel0,psel)=%d is_containing(psel0,psel_i)=%d "
+      "is_containing(psel,psel0)=%d intersect size=%ld ok=%d",
+      tag.c_str(), is_containing(psel0, psel), is_containing(psel0, psel_i),
+      is_containing(psel, psel0), (long)psel_i.size(), is_intersect_ok));
+  //
+  // change the points in place after the index is built
+  PointsSelection psel1;
+  psel1 = psel0;
+  const Long idx_0 = idx_from_xg(psel1[0], psel1);
+  const Coordinate xg_0 = psel1[0];
+  psel1[0] = Coordinate(-2, -2, -2, -2);
+  displayln_info(ssprintf(
+      "CHECK: %s: after change idx_from_xg old=%ld new=%ld contain=%d",
+      tag.c_str(), (long)idx_from_xg(xg_0, psel1),
+      (long)idx_from_xg(Coordinate(-2, -2, -2, -2), psel1),
+      is_containing(psel1, psel0)));
+  qassert(idx_0 == 0);
+  qassert(n_mismatch == 0);
+  qassert(qnorm(sp_ref) == 0.0);
+  qassert(is_intersect_ok);
+}
+
+inline void test_points_gather(const std::string& tag, const Long n_points)
+// compare set_selected_points with the sum of the zero filled points of all
+// the nodes (glb_sum_byte_vec)
+{
+  TIMER_VERBOSE("test_points_gather");
+  const Coordinate total_site(4, 4, 4, 8);
+  Geometry geo;
+  geo.init(total_site);
+  const RngState rs = RngState("test_points_gather").split(tag);
+  // random points, some repeated and some outside of the lattice
+  std::vector<Coordinate> xgs;
+  {
+    RngState rsi = rs.split("psel");
+    for (Long i = 0; i < n_points; ++i) {
+      Coordinate xg;
+      for (int m = 0; m < 4; ++m) {
+        xg[m] = rand_gen(rsi) % total_site[m];
+      }
+      if (i % 16 == 0) {
+        xg[3] = -1;
+      } else if (i % 16 == 1 and i > 1) {
+        xg = xgs[i / 2];
+      }
+      xgs.push_back(xg);
+    }
+  }
+  Field<ComplexD> f;
+  f.init(geo, 2);
+  set_u_rand(f, rs.split("f-init"));
+  for (int i = 0; i < 2; ++i) {
+    const PointsDistType points_dist_type =
+        i == 0 ? PointsDistType::Global : PointsDistType::Local;
+    PointsSelection psel(total_site, xgs);
+    psel.points_dist_type = points_dist_type;
+    SelectedPoints<ComplexD> sp_ref;
+    sp_ref.init(psel, 2);
+    set_zero(sp_ref);
+    for (Long idx = 0; idx < (Long)psel.size(); ++idx) {
+      const Coordinate xl = geo.coordinate_l_from_g(psel[idx]);
+      if (geo.is_local(xl)) {
+        sp_ref.get_elem(idx, 0) = f.get_elem(xl, 0);
+        sp_ref.get_elem(idx, 1) = f.get_elem(xl, 1);
+      }
+    }
+    glb_sum_byte_vec(get_data(sp_ref.points));
+    SelectedPoints<ComplexD> sp;
+    set_selected_points(sp, f, psel);
+    SelectedPoints<ComplexD> sp_m;
+    set_selected_points(sp_m, f, psel, 1);
+    RealD qnorm_diff_m = 0.0;
+    for (Long idx = 0; idx < (Long)psel.size(); ++idx) {
+      qnorm_diff_m += qnorm(sp_m.get_elem(idx) - sp_ref.get_elem(idx, 1));
+    }
+    std::string gather_info;
+    if (points_dist_type == PointsDistType::Global) {
+      SelectedPoints<ComplexD> sp_local;
+      set_selected_points_local(sp_local, f, psel);
+      Long n_points_local = sp_local.n_points;
+      glb_sum(n_points_local);
+      SelectedPoints<ComplexD> sp_g;
+      gather_selected_points(sp_g, sp_local, psel,
+                             get_points_gather_plan(psel, geo));
+      sp_g -= sp_ref;
+      gather_info = ssprintf(" ; local sum n_points=%ld gather diff=%.5E",
+                             (long)n_points_local, qnorm(sp_g));
+      qassert(qnorm(sp_g) == 0.0);
+    }
+    sp -= sp_ref;
+    displayln_info(ssprintf(
+        "CHECK: %s: %s qnorm=%.10E diff=%.5E m diff=%.5E%s", tag.c_str(),
+        show(points_dist_type).c_str(), qnorm(sp_ref), qnorm(sp),
+        qnorm_diff_m, gather_info.c_str()));
+    qassert(qnorm(sp) == 0.0);
+    qassert(qnorm_diff_m == 0.0);
+  }
+}
+
 int main(int argc, char* argv[])
 {
   begin(&argc, &argv);
@@ -438,6 +622,8 @@ int main(int argc, char* argv[])
   test_shift("shift-16-1024", 2, 8);
   test_shift("shift-0-1024", 0, 8);
   test_shift("shift-16-0", 2, 0);
+  test_points_index("points-index-256", 256);
+  test_points_gather("points-gather-256", 256);
   displayln_info("CHECK: finished successfully.");
   Timer::display();
   end();
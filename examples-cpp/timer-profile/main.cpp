@@ -0,0 +1,103 @@
+#include <qlat/qlat.h>
+
+using namespace qlat;
+
+void profile_work_thread()
+{
+  TIMER("profile_work_thread");
+  RealD sum = 0.0;
+  for (Long i = 0; i < 100000; ++i) {
+    sum += 1.0 / (1.0 + i);
+  }
+  qassert(sum > 0.0);
+}
+
+void profile_work()
+{
+  TIMER("profile_work");
+  {
+    TIMER("profile_work_inner");
+    profile_work_thread();
+  }
+#pragma omp parallel
+  {
+    profile_work_thread();
+  }
+}
+
+Long count_substr(const std::string& str, const std::string& pattern)
+{
+  Long count = 0;
+  for (size_t pos = str.find(pattern); pos != std::string::npos;
+       pos = str.find(pattern, pos + pattern.size())) {
+    count += 1;
+  }
+  return count;
+}
+
+void check_profile(const std::string& path, const Long level)
+// Check the summary and the trace written by Timer::write_profile on all nodes.
+{
+  TIMER_VERBOSE("check_profile");
+  const int id_node = get_id_node();
+  const std::string summary =
+      qcat(path + ssprintf("/summary-node-%05d.txt", id_node));
+  const std::string trace =
+      qcat(path + ssprintf("/trace-node-%05d.json", id_node));
+  Long num_node_with_files = summary.empty() or trace.empty() ? 0 : 1;
+  glb_sum(num_node_with_files);
+  displayln_info(ssprintf("CHECK: check_profile: level=%ld ; files %d", level,
+                          (int)(num_node_with_files == get_num_node())));
+  const std::vector<std::string> names = {"profile_work", "profile_work_inner",
+                                          "profile_work_thread"};
+  for (const std::string& name : names) {
+    Long num_summary = count_substr(summary, " " + name + "\n");
+    Long num_trace = count_substr(trace, "\"name\":\"" + name + "\"");
+    glb_sum(num_summary);
+    glb_sum(num_trace);
+    displayln_info(ssprintf(
+        "CHECK: check_profile: level=%ld ; %s ; in summary %d ; in trace %d",
+        level, name.c_str(), (int)(num_summary > 0), (int)(num_trace > 0)));
+  }
+  // Only level >= 2 records the timers called from the other threads.
+  Long num_thread_summary = count_substr(summary, "# thread 1 ;");
+  Long num_thread_trace = count_substr(trace, "\"tid\":1,");
+  glb_sum(num_thread_summary);
+  glb_sum(num_thread_trace);
+  displayln_info(ssprintf(
+      "CHECK: check_profile: level=%ld ; thread 1 in summary %d ; in trace %d",
+      level, (int)(num_thread_summary > 0), (int)(num_thread_trace > 0)));
+  displayln_info(ssprintf("INFO: check_profile: level=%ld ; thread 1 events %ld",
+                          level, num_thread_trace));
+}
+
+void timer_profile_tests()
+{
+  TIMER_VERBOSE("timer_profile_tests");
+  displayln_info(ssprintf("CHECK: timer_profile_tests: profile_level=%ld",
+                          Timer::profile_level()));
+  displayln_info(ssprintf("CHECK: timer_profile_tests: profile_path='%s'",
+                          Timer::profile_path().c_str()));
+  const Long num_threads = omp_get_max_threads();
+  displayln_info(ssprintf("CHECK: timer_profile_tests: num_threads>1 %d",
+                          (int)(num_threads > 1)));
+  profile_work();
+  Timer::write_profile("huge-data/profile-1");
+  check_profile("huge-data/profile-1", Timer::profile_level());
+  Timer::profile_level() = 2;
+  Timer::reset_profile();
+  profile_work();
+  Timer::write_profile("huge-data/profile-2");
+  check_profile("huge-data/profile-2", Timer::profile_level());
+  Timer::profile_level() = 1;
+}
+
+int main(int argc, char* argv[])
+{
+  begin(&argc, &argv);
+  timer_profile_tests();
+  displayln_info("CHECK: finished successfully.");
+  Timer::display();
+  end();
+  return 0;
+}
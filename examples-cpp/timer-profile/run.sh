@@ -0,0 +1,11 @@
+#!/usr/bin/env bash
+
+pwd
+rm -rf huge-data
+q_verbose=10 OMP_NUM_THREADS=2 q_timer_profile=1 q_timer_profile_path=huge-data/profile-end time timeout -s KILL 30m mpiexec -n 2 $mpi_options ./qlat.x >log.out 2>log.err
+for fn in huge-data/profile-end/summary-node-00000.txt huge-data/profile-end/trace-node-00001.json ; do
+    if grep -q 'profile_work_inner' "$fn" 2>/dev/null ; then ok=1 ; else ok=0 ; fi
+    echo "CHECK: end() wrote $fn: $ok" >>log.out
+done
+cat log.out | grep -v '^Grid :\|^Timer\|^check_status:\|^display_geometry_node : id_node =' >log
+cat log.out log.err > log.full
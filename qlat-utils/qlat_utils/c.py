@@ -99,6 +99,10 @@ __all__ += [
         'timer_reset',
         'timer_fork',
         'timer_merge',
+        'get_timer_profile_level',
+        'set_timer_profile_level',
+        'timer_reset_profile',
+        'timer_write_profile',
         'timer',
         'timer_fname',
         'timer_verbose',
@@ -278,6 +278,12 @@ cdef extern from "qlat-utils/timer.h" namespace "qlat":
         void fork(Long max_call_times_for_always_show_info)
         @staticmethod
         void merge()
+        @staticmethod
+        Long& profile_level()
+        @staticmethod
+        void reset_profile()
+        @staticmethod
+        void write_profile(const std_string& path) except +
 
 cdef extern from "qlat-utils/utils-io.h" namespace "qlat":
 
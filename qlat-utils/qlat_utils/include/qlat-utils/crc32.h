@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include <qlat-utils/env.h>
 #include <qlat-utils/utils-vec.h>
 #include <qlat-utils/utils.h>
 #include <qlat-utils/show.h>
@@ -29,8 +30,24 @@ namespace qlat
 //   return crc;
 // }
 
+bool is_crc32_pclmul_supported();
+
+crc32_t crc32_pclmul(const crc32_t initial, const void* data, const Long len);
+
+API inline bool& is_crc32_pclmul()
+// qlat parameter
+// If true, crc32 use the carry-less multiplication (PCLMULQDQ) instructions.
+{
+  static bool b = is_crc32_pclmul_supported() and
+                  get_env_long_default("q_crc32_pclmul", 1) != 0;
+  return b;
+}
+
 inline crc32_t crc32(const crc32_t initial, const void* data, const Long len)
 {
+  if (is_crc32_pclmul()) {
+    return crc32_pclmul(initial, data, len);
+  }
   return crc32_z(initial, (const unsigned char*)data, len);
 }
 
@@ -134,6 +151,13 @@ inline void crc32_check()
       qassert(false);
     }
   }
+  for (int i = 0; i < 300; ++i) {
+    const crc32_t crc_z = crc32_z(check_value, &test_data[i], 3 * i + 1);
+    if (crc32_pclmul(check_value, &test_data[i], 3 * i + 1) != crc_z) {
+      displayln(ssprintf("i=%d, len=%d", i, 3 * i + 1));
+      qassert(false);
+    }
+  }
   for (int i = 0; i < 4; ++i) {
     const Vector<uint8_t> v((const uint8_t*)&test_data[0], i * 16 * 1024 + 37);
     qassert(v.data_size() <= limit);
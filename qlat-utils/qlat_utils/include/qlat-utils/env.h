@@ -51,6 +51,25 @@ API inline Long& get_qar_multi_vol_max_size()
   return size;
 }
 
+API inline Long& get_qar_io_n_threads()
+// qlat parameter
+// number of threads reading (writing) the files in `qar_create` (`qar_extract`)
+// 0 means the files are read (written) by the calling thread
+{
+  static Long n = get_env_long_default("q_qar_io_n_threads", 8);
+  return n;
+}
+
+API inline Long& get_qar_io_max_pending_bytes()
+// qlat parameter
+// size in bytes
+// bound of the data held in memory by `qar_create` and `qar_extract`
+{
+  static Long size =
+      get_env_long_default("q_qar_io_max_pending_bytes", 1024L * 1024L * 1024L);
+  return size;
+}
+
 API inline mode_t& default_dir_mode()
 // qlat parameter
 {
@@ -67,4 +86,12 @@ API inline Long& write_from_qfile_chunk_size()
   return size;
 }
 
+API inline bool& is_qfile_mmap()
+// qlat parameter
+// If true, `qfopen(path, QFileMode::Read)` opens files with `QFileType::MMap`.
+{
+  static bool b = get_env_long_default("q_qfile_mmap", 0) != 0;
+  return b;
+}
+
 }  // namespace qlat
@@ -308,18 +308,42 @@ struct API SpinVectorT : MvectorT<4, ComplexT<T>> {
   }
 };
 
+template <class T>
+struct API CompressedColorMatrixT : MvectorT<2 * NUM_COLOR, ComplexT<T>> {
+  // First two rows of an SU(3) matrix (reconstruct-12).
+  // p[i * NUM_COLOR + j] = m(i, j) for i = 0, 1
+  qacc CompressedColorMatrixT() {}
+  qacc CompressedColorMatrixT(const MvectorT<2 * NUM_COLOR, ComplexT<T>>& m)
+  {
+    *this = m;
+  }
+  //
+  qacc CompressedColorMatrixT& operator=(
+      const MvectorT<2 * NUM_COLOR, ComplexT<T>>& m)
+  {
+    *this = (const CompressedColorMatrixT&)m;
+    return *this;
+  }
+};
+
 using WilsonVector = WilsonVectorT<Real>;
 
 using SpinVector = SpinVectorT<Real>;
 
+using CompressedColorMatrix = CompressedColorMatrixT<Real>;
+
 using WilsonVectorD = WilsonVectorT<RealD>;
 
 using SpinVectorD = SpinVectorT<RealD>;
 
+using CompressedColorMatrixD = CompressedColorMatrixT<RealD>;
+
 using WilsonVectorF = WilsonVectorT<RealF>;
 
 using SpinVectorF = SpinVectorT<RealF>;
 
+using CompressedColorMatrixF = CompressedColorMatrixT<RealF>;
+
 // --------------------
 
 }  // namespace qlat
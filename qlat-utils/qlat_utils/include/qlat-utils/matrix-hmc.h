@@ -1,6 +1,7 @@
 #pragma once
 
 #include <qlat-utils/matrix.h>
+#include <qlat-utils/rng-counter.h>
 #include <qlat-utils/rng-state.h>
 #include <qlat-utils/utils-vec.h>
 
@@ -133,6 +134,18 @@ inline ColorMatrix make_g_rand_anti_hermitian_matrix(RngState& rs,
   return make_anti_hermitian_matrix(a);
 }
 
+qacc ColorMatrix make_g_rand_anti_hermitian_matrix(CounterRngState& rs,
+                                                   const double sigma)
+// same distribution as make_g_rand_anti_hermitian_matrix(RngState&, sigma)
+{
+  const double s = sigma / std::sqrt(2.0);
+  array<double, 8> a;
+  for (int i = 0; i < 8; ++i) {
+    a[i] = g_rand_gen(rs, 0.0, s);
+  }
+  return make_anti_hermitian_matrix(a);
+}
+
 qacc double neg_half_tr_square(const ColorMatrix& m)
 // ret == (basis**2).sum()
 // basis = basis_projection_anti_hermitian_matrix(m)
@@ -167,6 +180,122 @@ qacc ColorMatrixT<T> make_color_matrix_exp(const ColorMatrixT<T>& a,
   return ret;
 }
 
+struct API ColorMatrixExpCoefs {
+  // exp(i q) = f[0] + f[1] q + f[2] q^2
+  // d f[j] = b1[j] d c1 + b2[j] d c0
+  // q is hermitian and traceless, c0 = tr(q^3) / 3, c1 = tr(q^2) / 2.
+  array<ComplexD, 3> f;
+  array<ComplexD, 3> b1;
+  array<ComplexD, 3> b2;
+};
+
+qacc ColorMatrixExpCoefs make_color_matrix_exp_coefs(
+    const RealD c0_, const RealD c1, const bool is_computing_b = false)
+// Cayley-Hamilton form of the exponential.
+// Morningstar, Peardon, Phys. Rev. D 69, 054501 (2004) (hep-lat/0311018)
+// b1 and b2 are only computed if is_computing_b.
+// Need c1 > 0 (q != 0).
+{
+  ColorMatrixExpCoefs ret;
+  const bool is_neg = c0_ < 0.0;
+  const RealD c0 = is_neg ? -c0_ : c0_;
+  const RealD c0_max = 2.0 * std::pow(c1 / 3.0, 1.5);
+  const RealD theta = std::acos(std::min(1.0, c0 / c0_max));
+  const RealD u = std::sqrt(c1 / 3.0) * std::cos(theta / 3.0);
+  const RealD w = std::sqrt(c1) * std::sin(theta / 3.0);
+  const RealD u2 = sqr(u);
+  const RealD w2 = sqr(w);
+  const RealD cos_w = std::cos(w);
+  const RealD xi0 =
+      w2 < 1e-4 ? 1.0 - w2 / 6.0 * (1.0 - w2 / 20.0 * (1.0 - w2 / 42.0))
+                : std::sin(w) / w;
+  const ComplexD ii(0.0, 1.0);
+  const ComplexD e2iu = qpolar(1.0, 2.0 * u);
+  const ComplexD emiu = qpolar(1.0, -u);
+  const RealD d = 9.0 * u2 - w2;
+  array<ComplexD, 3> h;
+  h[0] = (u2 - w2) * e2iu +
+         emiu * (8.0 * u2 * cos_w + 2.0 * u * (3.0 * u2 + w2) * xi0 * ii);
+  h[1] = 2.0 * u * e2iu - emiu * (2.0 * u * cos_w - (3.0 * u2 - w2) * xi0 * ii);
+  h[2] = e2iu - emiu * (cos_w + 3.0 * u * xi0 * ii);
+  for (int j = 0; j < 3; ++j) {
+    ret.f[j] = h[j] / d;
+  }
+  if (is_computing_b) {
+    const RealD xi1 =
+        w2 < 1e-4
+            ? -1.0 / 3.0 *
+                  (1.0 - w2 / 10.0 * (1.0 - w2 / 28.0 * (1.0 - w2 / 54.0)))
+            : cos_w / w2 - std::sin(w) / (w2 * w);
+    array<ComplexD, 3> r1, r2;
+    r1[0] = 2.0 * (u + (u2 - w2) * ii) * e2iu +
+            2.0 * emiu *
+                (4.0 * u * (2.0 - u * ii) * cos_w +
+                 ii * (9.0 * u2 + w2 - u * (3.0 * u2 + w2) * ii) * xi0);
+    r1[1] = 2.0 * (1.0 + 2.0 * u * ii) * e2iu +
+            emiu * (-2.0 * (1.0 - u * ii) * cos_w +
+                    ii * (6.0 * u + (w2 - 3.0 * u2) * ii) * xi0);
+    r1[2] = 2.0 * ii * e2iu + ii * emiu * (cos_w - 3.0 * (1.0 - u * ii) * xi0);
+    r2[0] = -2.0 * e2iu + 2.0 * u * ii * emiu *
+                              (cos_w + (1.0 + 4.0 * u * ii) * xi0 +
+                               3.0 * u2 * xi1);
+    r2[1] = -ii * emiu * (cos_w + (1.0 + 2.0 * u * ii) * xi0 - 3.0 * u2 * xi1);
+    r2[2] = emiu * (xi0 - 3.0 * u * ii * xi1);
+    const RealD dd = 0.5 / sqr(d);
+    for (int j = 0; j < 3; ++j) {
+      ret.b1[j] = (2.0 * u * r1[j] + (3.0 * u2 - w2) * r2[j] -
+                   2.0 * (15.0 * u2 + w2) * ret.f[j]) *
+                  dd;
+      ret.b2[j] = (r1[j] - 3.0 * u * r2[j] - 24.0 * u * ret.f[j]) * dd;
+    }
+  }
+  if (is_neg) {
+    // f[j](-c0) = (-1)^j f[j](c0)^*
+    // b1[j](-c0) = (-1)^j b1[j](c0)^*
+    // b2[j](-c0) = (-1)^(j+1) b2[j](c0)^*
+    for (int j = 0; j < 3; ++j) {
+      const RealD sign = j % 2 == 0 ? 1.0 : -1.0;
+      ret.f[j] = sign * qconj(ret.f[j]);
+      ret.b1[j] = sign * qconj(ret.b1[j]);
+      ret.b2[j] = -sign * qconj(ret.b2[j]);
+    }
+  }
+  return ret;
+}
+
+template <class T>
+qacc ColorMatrixT<T> make_color_matrix_exp_exact(const ColorMatrixT<T>& a)
+// return exp(a) for anti-hermitian a (same as make_matrix_exp(a))
+// Cayley-Hamilton closed form, no truncation.
+{
+  const ComplexD tr_a = matrix_trace(a);
+  const ComplexD c = tr_a / 3.0;
+  ColorMatrixT<T> q = a;
+  for (int i = 0; i < NUM_COLOR; ++i) {
+    q(i, i) -= (ComplexT<T>)c;
+  }
+  q *= (ComplexT<T>)ComplexD(0.0, -1.0);
+  const ColorMatrixT<T> q2 = q * q;
+  const RealD c1 = 0.5 * matrix_trace(q2).real();
+  ColorMatrixT<T> ret;
+  if (c1 < 1e-24) {
+    // exp(i q) = 1 + i q - q^2 / 2 + O(q^3)
+    set_unit(ret);
+    ret += ComplexD(0.0, 1.0) * q;
+    ret += -0.5 * q2;
+  } else {
+    const RealD c0 = matrix_trace(q2, q).real() / 3.0;
+    const ColorMatrixExpCoefs coefs = make_color_matrix_exp_coefs(c0, c1);
+    set_unit(ret, coefs.f[0]);
+    ret += coefs.f[1] * q;
+    ret += coefs.f[2] * q2;
+  }
+  if (c != 0.0) {
+    ret *= (ComplexT<T>)(std::exp(c.real()) * qpolar(1.0, c.imag()));
+  }
+  return ret;
+}
+
 template <class T>
 qacc ColorMatrixT<T> matrix_evolve(const ColorMatrixT<T>& gf_cm,
                                    const ColorMatrixT<T>& gm_cm,
@@ -174,7 +303,7 @@ qacc ColorMatrixT<T> matrix_evolve(const ColorMatrixT<T>& gf_cm,
 // return exp(gm_cm * step_size) * gf_cm
 {
   const ColorMatrixT<T> t = (ComplexT<T>)step_size * gm_cm;
-  return make_matrix_exp(t) * gf_cm;
+  return make_color_matrix_exp_exact(t) * gf_cm;
 }
 
 template <class T>
@@ -184,7 +313,7 @@ qacc ColorMatrixT<T> matrix_evolve_dual(const ColorMatrixT<T>& gf_cm,
 // return gf_cm * exp(-gm_cm * step_size)
 {
   const ColorMatrixT<T> t = (ComplexT<T>)(-step_size) * gm_cm;
-  return gf_cm * make_matrix_exp(t);
+  return gf_cm * make_color_matrix_exp_exact(t);
 }
 
 qacc ColorMatrix make_tr_less_anti_herm_matrix(const ColorMatrix& m)
@@ -212,6 +341,9 @@ qacc AdjointColorMatrix make_diff_exp_map(const ColorMatrix& m,
                                           const ColorMatrixConstants& cmcs,
                                           const int max_order = 20);
 
+qacc AdjointColorMatrix make_diff_exp_map_exact(
+    const ColorMatrix& m, const ColorMatrixConstants& cmcs);
+
 qacc AdjointColorMatrix make_diff_exp_map_diff_ref(
     const ColorMatrix& m, const int a, const ColorMatrixConstants& cmcs);
 
@@ -323,6 +455,14 @@ struct API ColorMatrixConstants {
         make_diff_exp_map(-(ComplexD)coef * x, *this);
     qassert(qnorm(j_x - matrix_adjoint(j_n_x)) < 1e-20);
     qassert(qnorm(j_n_x - exp_adx * j_x) < 1e-20);
+    for (int i = 0; i < 3; ++i) {
+      const double coef_i = i == 0 ? coef : i == 1 ? -0.5 : 1e-3;
+      const ColorMatrix xi = (ComplexD)coef_i * x;
+      qassert(qnorm(make_color_matrix_exp_exact(xi) - make_matrix_exp(xi)) <
+              1e-20);
+      qassert(qnorm(make_diff_exp_map_exact(xi, *this) -
+                    make_diff_exp_map(xi, *this)) < 1e-20);
+    }
     for (int a = 0; a < 8; ++a) {
       const AdjointColorMatrix am0 = make_diff_exp_map_diff_ref(x, a, *this);
       const AdjointColorMatrix am1 = make_diff_exp_map_diff(x, a, *this);
@@ -389,6 +529,46 @@ qacc AdjointColorMatrix make_diff_exp_map(const ColorMatrix& m,
   return make_diff_exp_map(make_adjoint_representation(m, cmcs), max_order);
 }
 
+qacc AdjointColorMatrix make_diff_exp_map_exact(
+    const ColorMatrix& m, const ColorMatrixConstants& cmcs)
+// Same as make_diff_exp_map(m, cmcs) for tr_less_anti_hermitian_matrix m.
+// ret(b, a) = basis[b] of exp(-m) d/dt exp(m + t ts[a]) at t = 0
+// Use the derivative of the Cayley-Hamilton coefficients of exp(m).
+{
+  const ComplexD ii(0.0, 1.0);
+  const ColorMatrix q = -ii * m;
+  const ColorMatrix q2 = q * q;
+  const RealD c1 = 0.5 * matrix_trace(q2).real();
+  if (c1 < 1e-4) {
+    // b1 and b2 lose precision as q -> 0, series converges quickly.
+    return make_diff_exp_map(m, cmcs, 12);
+  }
+  const RealD c0 = matrix_trace(q2, q).real() / 3.0;
+  const ColorMatrixExpCoefs coefs = make_color_matrix_exp_coefs(c0, c1, true);
+  ColorMatrix exp_n_m;
+  set_unit(exp_n_m, qconj(coefs.f[0]));
+  exp_n_m += qconj(coefs.f[1]) * q;
+  exp_n_m += qconj(coefs.f[2]) * q2;
+  AdjointColorMatrix ret;
+  for (int a = 0; a < 8; ++a) {
+    const ColorMatrix dq = -ii * cmcs.ts[a];
+    const ComplexD dc1 = matrix_trace(q, dq);
+    const ComplexD dc0 = matrix_trace(q2, dq);
+    ColorMatrix d_exp;
+    set_unit(d_exp, coefs.b1[0] * dc1 + coefs.b2[0] * dc0);
+    d_exp += (coefs.b1[1] * dc1 + coefs.b2[1] * dc0) * q;
+    d_exp += (coefs.b1[2] * dc1 + coefs.b2[2] * dc0) * q2;
+    d_exp += coefs.f[1] * dq;
+    d_exp += coefs.f[2] * (dq * q + q * dq);
+    const array<double, 8> basis =
+        basis_projection_anti_hermitian_matrix(exp_n_m * d_exp);
+    for (int b = 0; b < 8; ++b) {
+      ret(b, a) = basis[b];
+    }
+  }
+  return ret;
+}
+
 qacc AdjointColorMatrix make_diff_exp_map_diff_ref(
     const ColorMatrix& m, const int a, const ColorMatrixConstants& cmcs)
 {
@@ -5,6 +5,7 @@
 #include <qlat-utils/vector.h>
 
 #include <cmath>
+#include <cstdint>
 
 namespace qlat
 {  //
@@ -721,7 +722,7 @@ qacc WilsonVectorT<T> operator*(const SpinMatrixT<T>& sm,
   for (int s1 = 0; s1 < 4; ++s1) {
     for (int s2 = 0; s2 < 4; ++s2) {
       const ComplexT<T>& sm_s1_s2 = sm.p[s1 * 4 + s2];
-      if (sm_s1_s2 == 0.0) {
+      if (sm_s1_s2 == (T)0.0) {
         continue;
       }
       for (int c1 = 0; c1 < NUM_COLOR; ++c1) {
@@ -733,6 +734,290 @@ qacc WilsonVectorT<T> operator*(const SpinMatrixT<T>& sm,
   return ret;
 }
 
+template <class T>
+qacc CompressedColorMatrixT<T> compress_color_matrix(const ColorMatrixT<T>& m)
+// only keep the first two rows
+// m should be in SU(3) to be recovered by uncompress_color_matrix
+{
+  CompressedColorMatrixT<T> ret;
+  for (int i = 0; i < 2 * NUM_COLOR; ++i) {
+    ret.p[i] = m.p[i];
+  }
+  return ret;
+}
+
+template <class T>
+qacc ColorMatrixT<T> uncompress_color_matrix(const CompressedColorMatrixT<T>& c)
+// third row is the complex conjugate of the cross product of the first two
+{
+  ColorMatrixT<T> ret;
+  for (int i = 0; i < 2 * NUM_COLOR; ++i) {
+    ret.p[i] = c.p[i];
+  }
+  ret.p[6] = qconj(c.p[1] * c.p[5] - c.p[2] * c.p[4]);
+  ret.p[7] = qconj(c.p[2] * c.p[3] - c.p[0] * c.p[5]);
+  ret.p[8] = qconj(c.p[0] * c.p[4] - c.p[1] * c.p[3]);
+  return ret;
+}
+
+struct API GammaMatrix {
+  // Spin matrix with exactly one non-zero element in each row, which is one
+  // of 1, i, -1, -i. Gamma matrices and all their products are of this form.
+  //
+  // gm(s, perm[s]) = ii^phase[s]
+  int8_t perm[4];
+  int8_t phase[4];  // 0: 1 ; 1: i ; 2: -1 ; 3: -i
+};
+
+qacc constexpr GammaMatrix operator*(const GammaMatrix& gm1,
+                                     const GammaMatrix& gm2)
+{
+  GammaMatrix ret = {{0, 0, 0, 0}, {0, 0, 0, 0}};
+  for (int s = 0; s < 4; ++s) {
+    const int s3 = gm1.perm[s];
+    ret.perm[s] = gm2.perm[s3];
+    ret.phase[s] = (gm1.phase[s] + gm2.phase[s3]) % 4;
+  }
+  return ret;
+}
+
+qacc constexpr GammaMatrix operator-(const GammaMatrix& gm)
+{
+  GammaMatrix ret = gm;
+  for (int s = 0; s < 4; ++s) {
+    ret.phase[s] = (gm.phase[s] + 2) % 4;
+  }
+  return ret;
+}
+
+qacc constexpr bool operator==(const GammaMatrix& gm1, const GammaMatrix& gm2)
+{
+  for (int s = 0; s < 4; ++s) {
+    if (gm1.perm[s] != gm2.perm[s] or gm1.phase[s] != gm2.phase[s]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+struct API GammaMatrixConstants {
+  // Same as the matrices of SpinMatrixConstants with the same names.
+  //
+  qacc static constexpr GammaMatrix get_unit()
+  {
+    return {{0, 1, 2, 3}, {0, 0, 0, 0}};
+  }
+  qacc static constexpr GammaMatrix get_gamma(const int mu)
+  // mu = 0, 1, 2, 3, 5
+  {
+    return mu == 0   ? GammaMatrix{{3, 2, 1, 0}, {3, 3, 1, 1}}
+           : mu == 1 ? GammaMatrix{{3, 2, 1, 0}, {2, 0, 0, 2}}
+           : mu == 2 ? GammaMatrix{{2, 3, 0, 1}, {3, 1, 1, 3}}
+           : mu == 3 ? GammaMatrix{{2, 3, 0, 1}, {0, 0, 0, 0}}
+                     : get_gamma5();
+  }
+  qacc static constexpr GammaMatrix get_cps_gamma(const int mu)
+  // mu = 0, 1, 2, 3, 5
+  {
+    return mu == 0 or mu == 2 ? -get_gamma(mu) : get_gamma(mu);
+  }
+  qacc static constexpr GammaMatrix get_gamma5()
+  {
+    return {{0, 1, 2, 3}, {0, 0, 2, 2}};
+  }
+  qacc static constexpr GammaMatrix get_gm(const int idx)
+  // idx = a + 2 * b + 4 * c + 8 * d
+  // gms[idx] = gamma_x^a * gamma_y^b * gamma_z^c * gamma_t^d
+  {
+    GammaMatrix ret = get_unit();
+    for (int mu = 0; mu < 4; ++mu) {
+      if ((idx >> mu) & 1) {
+        ret = ret * get_gamma(mu);
+      }
+    }
+    return ret;
+  }
+  qacc static constexpr GammaMatrix get_cps_gm(const int idx)
+  // same as get_gm(idx) but with CPS's convention gamma matrices
+  {
+    GammaMatrix ret = get_unit();
+    for (int mu = 0; mu < 4; ++mu) {
+      if ((idx >> mu) & 1) {
+        ret = ret * get_cps_gamma(mu);
+      }
+    }
+    return ret;
+  }
+  qacc static array<GammaMatrix, 4> get_cps_gammas()
+  {
+    array<GammaMatrix, 4> ret;
+    for (int mu = 0; mu < 4; ++mu) {
+      ret[mu] = get_cps_gamma(mu);
+    }
+    return ret;
+  }
+  qacc static array<GammaMatrix, 16> get_cps_gms()
+  {
+    array<GammaMatrix, 16> ret;
+    for (int idx = 0; idx < 16; ++idx) {
+      ret[idx] = get_cps_gm(idx);
+    }
+    return ret;
+  }
+};
+
+template <class T>
+qacc ComplexT<T> gamma_phase_mul(const int phase, const ComplexT<T>& x)
+// return ii^phase * x
+{
+  switch (phase) {
+    case 0:
+      return x;
+    case 1:
+      return ComplexT<T>(-x.imag(), x.real());
+    case 2:
+      return -x;
+    default:
+      return ComplexT<T>(x.imag(), -x.real());
+  }
+}
+
+template <class T = Real>
+qacc SpinMatrixT<T> get_spin_matrix(const GammaMatrix& gm)
+{
+  SpinMatrixT<T> ret;
+  set_zero(ret);
+  for (int s = 0; s < 4; ++s) {
+    ret.p[s * 4 + gm.perm[s]] = gamma_phase_mul(gm.phase[s], ComplexT<T>(1));
+  }
+  return ret;
+}
+
+template <class T>
+qacc WilsonMatrixT<T> operator*(const GammaMatrix& gm,
+                                const WilsonMatrixT<T>& m)
+// Only permute the rows of m and multiply with the phases.
+{
+  WilsonMatrixT<T> ret;
+  for (int s1 = 0; s1 < 4; ++s1) {
+    const int s3 = gm.perm[s1];
+    const int phase = gm.phase[s1];
+    for (int c1 = 0; c1 < NUM_COLOR; ++c1) {
+      const int s1_c1 = (s1 * NUM_COLOR + c1) * (4 * NUM_COLOR);
+      const int s3_c1 = (s3 * NUM_COLOR + c1) * (4 * NUM_COLOR);
+      for (int s2_c2 = 0; s2_c2 < 4 * NUM_COLOR; ++s2_c2) {
+        ret.p[s1_c1 + s2_c2] = gamma_phase_mul(phase, m.p[s3_c1 + s2_c2]);
+      }
+    }
+  }
+  return ret;
+}
+
+template <class T>
+qacc WilsonMatrixT<T> operator*(const WilsonMatrixT<T>& m,
+                                const GammaMatrix& gm)
+// Only permute the columns of m and multiply with the phases.
+{
+  WilsonMatrixT<T> ret;
+  for (int s3 = 0; s3 < 4; ++s3) {
+    const int s1 = gm.perm[s3];
+    const int phase = gm.phase[s3];
+    for (int s2_c2 = 0; s2_c2 < 4 * NUM_COLOR; ++s2_c2) {
+      const int s2_c2_s1 = s2_c2 * (4 * NUM_COLOR) + s1 * NUM_COLOR;
+      const int s2_c2_s3 = s2_c2 * (4 * NUM_COLOR) + s3 * NUM_COLOR;
+      for (int c1 = 0; c1 < NUM_COLOR; ++c1) {
+        ret.p[s2_c2_s1 + c1] = gamma_phase_mul(phase, m.p[s2_c2_s3 + c1]);
+      }
+    }
+  }
+  return ret;
+}
+
+template <class T>
+qacc ComplexD matrix_trace(const GammaMatrix& gm, const WilsonMatrixT<T>& m)
+{
+  ComplexD ret = 0;
+  for (int s1 = 0; s1 < 4; ++s1) {
+    const int s3_s1 =
+        gm.perm[s1] * (NUM_COLOR * 4 * NUM_COLOR) + s1 * NUM_COLOR;
+    ComplexT<T> sum = 0;
+    for (int c1 = 0; c1 < NUM_COLOR; ++c1) {
+      sum += m.p[s3_s1 + c1 * (4 * NUM_COLOR + 1)];
+    }
+    ret += (ComplexD)gamma_phase_mul(gm.phase[s1], sum);
+  }
+  return ret;
+}
+
+template <class T>
+qacc ComplexD matrix_trace(const WilsonMatrixT<T>& m, const GammaMatrix& gm)
+{
+  return matrix_trace(gm, m);
+}
+
+template <class T>
+qacc array<ComplexT<T>, 256> matrix_color_contract(const WilsonMatrixT<T>& m1,
+                                                   const WilsonMatrixT<T>& m2)
+// ret[((s1 * 4 + s2) * 4 + s3) * 4 + s4] =
+// \sum_{c1, c2} m1(s1 * 3 + c1, s2 * 3 + c2) * m2(s3 * 3 + c2, s4 * 3 + c1)
+//
+// Used to compute matrix_trace(m1 * gm1 * m2 * gm2) for many gm1 and gm2.
+{
+  array<ComplexT<T>, 256> ret;
+  for (int s1 = 0; s1 < 4; ++s1) {
+    for (int s2 = 0; s2 < 4; ++s2) {
+      for (int s3 = 0; s3 < 4; ++s3) {
+        for (int s4 = 0; s4 < 4; ++s4) {
+          ComplexT<T> sum = 0;
+          for (int c1 = 0; c1 < NUM_COLOR; ++c1) {
+            for (int c2 = 0; c2 < NUM_COLOR; ++c2) {
+              sum += m1.p[(s1 * NUM_COLOR + c1) * (4 * NUM_COLOR) +
+                          s2 * NUM_COLOR + c2] *
+                     m2.p[(s3 * NUM_COLOR + c2) * (4 * NUM_COLOR) +
+                          s4 * NUM_COLOR + c1];
+            }
+          }
+          ret[((s1 * 4 + s2) * 4 + s3) * 4 + s4] = sum;
+        }
+      }
+    }
+  }
+  return ret;
+}
+
+template <class T>
+qacc ComplexD matrix_trace(const array<ComplexT<T>, 256>& mcc,
+                           const GammaMatrix& gm1, const GammaMatrix& gm2)
+// return matrix_trace(m1 * gm1 * m2 * gm2)
+// mcc = matrix_color_contract(m1, m2)
+{
+  ComplexT<T> ret = 0;
+  for (int s2 = 0; s2 < 4; ++s2) {
+    const int s3 = gm1.perm[s2];
+    for (int s4 = 0; s4 < 4; ++s4) {
+      const int s1 = gm2.perm[s4];
+      ret += gamma_phase_mul((gm1.phase[s2] + gm2.phase[s4]) % 4,
+                             mcc[((s1 * 4 + s2) * 4 + s3) * 4 + s4]);
+    }
+  }
+  return (ComplexD)ret;
+}
+
+template <class T>
+qacc WilsonVectorT<T> operator*(const GammaMatrix& gm,
+                                const WilsonVectorT<T>& m)
+{
+  WilsonVectorT<T> ret;
+  for (int s1 = 0; s1 < 4; ++s1) {
+    const int s2 = gm.perm[s1];
+    for (int c1 = 0; c1 < NUM_COLOR; ++c1) {
+      ret.p[s1 * NUM_COLOR + c1] =
+          gamma_phase_mul(gm.phase[s1], m.p[s2 * NUM_COLOR + c1]);
+    }
+  }
+  return ret;
+}
+
 template <class T>
 qacc void convert_mspincolor_from_wm(WilsonMatrixT<T>& msc,
                                      const WilsonMatrixT<T>& wm)
@@ -29,6 +29,7 @@ enum struct QFileMode {
 enum struct QFileType {
   CFile,
   String,
+  MMap,
 };
 
 // ---------------------
@@ -65,6 +66,7 @@ struct QFileBase {
   virtual Long remaining_size();
   //
   virtual Long read_data(Vector<char> v);
+  virtual bool read_view(Vector<char>& v, const Long size);
   virtual std::string read_all();
   virtual std::string cat();
   virtual std::string getline();
@@ -160,6 +162,47 @@ struct QFileObjString : QFileBase {
 
 // ---------------------
 
+struct QFileObjMMap : QFileBase {
+  // can not copy
+  // Read only. The whole file is mapped into memory. `read` is a memcpy from
+  // the mapping and `read_view` gives a view of the mapping without copying.
+  // The view is valid until the file is closed.
+  //
+  std::string path_v;
+  QFileMode mode_v;
+  bool is_null;
+  char* data_v;  // NULL if file is empty
+  Long file_size;
+  Long pos;
+  bool is_eof;
+  //
+  QFileObjMMap(const std::string& path_, const QFileMode mode_);
+  void init(const std::string& path_, const QFileMode mode_);
+  //
+  QFileObjMMap();
+  ~QFileObjMMap();
+  QFileObjMMap(const QFileObjMMap&) = delete;
+  QFileObjMMap& operator=(const QFileObjMMap&) = delete;
+  //
+  void init();
+  void close();
+  QFileType ftype() const;
+  const std::string& path() const;
+  QFileMode mode() const;
+  bool null() const;
+  Long size() const;
+  bool eof() const;
+  Long tell() const;
+  int flush() const;
+  int seek(const Long offset, const int whence);
+  Long read(void* ptr, const Long size, const Long nmemb);
+  Long write(const void* ptr, const Long size, const Long nmemb);
+  const std::string& content();
+  bool read_view(Vector<char>& v, const Long size);
+};
+
+// ---------------------
+
 struct QFileObj : QFileBase {
   // Interface to a `QFileBase` object which allow a view of a portion of the
   // file specified by offset_start and offset_end. The view can be nested.
@@ -219,6 +262,7 @@ struct QFileObj : QFileBase {
   Long read(void* ptr, const Long size, const Long nmemb);
   Long write(const void* ptr, const Long size, const Long nmemb);
   const std::string& content();
+  bool read_view(Vector<char>& v, const Long size);
 };
 
 using QFileMap = std::map<Long, std::weak_ptr<QFileObj>>;
@@ -271,6 +315,7 @@ struct API QFile : QFileBase {
   Long read(void* ptr, const Long size, const Long nmemb);
   Long write(const void* ptr, const Long size, const Long nmemb);
   const std::string& content();
+  bool read_view(Vector<char>& v, const Long size);
 };
 
 // ---------------------
@@ -323,6 +368,8 @@ Long qfile_remaining_size(QFile& qfile);
 
 Long qfread(void* ptr, const Long size, const Long nmemb, QFile& qfile);
 
+bool qfread_view(Vector<char>& v, const Long size, QFile& qfile);
+
 Long qfwrite(const void* ptr, const Long size, const Long nmemb,
              QFile& qfile);
 
@@ -355,6 +402,15 @@ Long qread_data(const Vector<M>& v, QFile& qfile)
 
 Long qread_data(const Vector<char>& v, QFile& qfile);
 
+template <class M>
+Long qread_data_crc32(const Vector<M>& v, crc32_t& crc, QFile& qfile)
+// interface function
+{
+  return qread_data_crc32(get_data_char(v), crc, qfile);
+}
+
+Long qread_data_crc32(const Vector<char>& v, crc32_t& crc, QFile& qfile);
+
 template <class M>
 Long qread_data_all(std::vector<M>& v, QFile& qfile)
 // interface function
@@ -622,6 +678,9 @@ QFile read(const QarFile& qar, const std::string& fn);
 
 std::string read_data(const QarFile& qar, const std::string& fn);
 
+bool read_data_view(Vector<char>& v, const QarFile& qar,
+                    const std::string& fn);
+
 std::string read_info(const QarFile& qar, const std::string& fn);
 
 bool verify_index(const QarFile& qar);
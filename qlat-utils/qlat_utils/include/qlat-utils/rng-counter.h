@@ -0,0 +1,155 @@
+#pragma once
+
+#include <qlat-utils/array.h>
+#include <qlat-utils/qacc.h>
+#include <qlat-utils/rng-state.h>
+
+#include <cmath>
+#include <cstdint>
+
+namespace qlat
+{  //
+
+// Counter-based random number generator (Philox-4x32-10).
+//
+// Salmon, Moraes, Dror, Shaw, "Parallel random numbers: as easy as 1, 2, 3",
+// SC11. Same output as philox4x32 (10 rounds) of the Random123 library.
+//
+// Unlike RngState, the random numbers are a pure function of
+// (seed, index, stream, position in the sequence), so no state needs to be
+// stored per site and the generation can be done inside qacc_for.
+
+qacc void philox_4x32_mulhilo(uint32_t& hi, uint32_t& lo, const uint32_t a,
+                              const uint32_t b)
+{
+  const uint64_t p = (uint64_t)a * (uint64_t)b;
+  hi = (uint32_t)(p >> 32);
+  lo = (uint32_t)p;
+}
+
+qacc array<uint32_t, 4> philox_4x32_10(const array<uint32_t, 4>& ctr_,
+                                       const array<uint32_t, 2>& key_)
+{
+  const uint32_t m0 = 0xD2511F53;
+  const uint32_t m1 = 0xCD9E8D57;
+  const uint32_t w0 = 0x9E3779B9;
+  const uint32_t w1 = 0xBB67AE85;
+  array<uint32_t, 4> ctr = ctr_;
+  uint32_t k0 = key_[0];
+  uint32_t k1 = key_[1];
+  for (int r = 0; r < 10; ++r) {
+    if (r > 0) {
+      k0 += w0;
+      k1 += w1;
+    }
+    uint32_t hi0, lo0, hi1, lo1;
+    philox_4x32_mulhilo(hi0, lo0, m0, ctr[0]);
+    philox_4x32_mulhilo(hi1, lo1, m1, ctr[2]);
+    const uint32_t c1 = ctr[1];
+    const uint32_t c3 = ctr[3];
+    ctr[0] = hi1 ^ c1 ^ k0;
+    ctr[1] = lo1;
+    ctr[2] = hi0 ^ c3 ^ k1;
+    ctr[3] = lo0;
+  }
+  return ctr;
+}
+
+struct API CounterRng {
+  // Key of the counter-based generator: a 64 bit seed and a 32 bit stream.
+  // Site generators are obtained with make_counter_rng_state(crng, index).
+  uint64_t seed;
+  uint32_t stream;
+  //
+  qacc CounterRng()
+  {
+    seed = 0;
+    stream = 0;
+  }
+  qacc CounterRng(const uint64_t seed_, const uint32_t stream_ = 0)
+  {
+    seed = seed_;
+    stream = stream_;
+  }
+  explicit CounterRng(const RngState& rs, const uint32_t stream_ = 0)
+  // seed derived from rs
+  {
+    RngState rs1 = rs;
+    seed = rand_gen(rs1);
+    stream = stream_;
+  }
+  //
+  qacc CounterRng split_stream(const uint32_t stream_) const
+  {
+    return CounterRng(seed, stream_);
+  }
+};
+
+struct API CounterRngState {
+  // Generator for one (seed, index, stream), e.g. index = gindex of a site.
+  // Counter: (index lo, index hi, stream, block). Each block gives 128 bits.
+  array<uint32_t, 2> key;
+  array<uint32_t, 4> ctr;
+  array<uint32_t, 4> buf;
+  int avail;  // number of unused uint32_t in buf
+  double gaussian;
+  bool gaussian_avail;
+};
+
+qacc CounterRngState make_counter_rng_state(const CounterRng& crng,
+                                            const uint64_t index)
+{
+  CounterRngState rs;
+  rs.key[0] = (uint32_t)crng.seed;
+  rs.key[1] = (uint32_t)(crng.seed >> 32);
+  rs.ctr[0] = (uint32_t)index;
+  rs.ctr[1] = (uint32_t)(index >> 32);
+  rs.ctr[2] = crng.stream;
+  rs.ctr[3] = 0;
+  rs.buf.fill(0);
+  rs.avail = 0;
+  rs.gaussian = 0.0;
+  rs.gaussian_avail = false;
+  return rs;
+}
+
+qacc uint64_t rand_gen(CounterRngState& rs)
+{
+  if (rs.avail < 2) {
+    rs.buf = philox_4x32_10(rs.ctr, rs.key);
+    rs.ctr[3] += 1;
+    rs.avail = 4;
+  }
+  const uint64_t lo = rs.buf[4 - rs.avail];
+  const uint64_t hi = rs.buf[5 - rs.avail];
+  rs.avail -= 2;
+  return (hi << 32) | lo;
+}
+
+qacc double u_rand_gen(CounterRngState& rs, const double upper = 1.0,
+                       const double lower = 0.0)
+// uniform in (lower, upper), never exactly at the end points
+{
+  const double fac = 1.0 / (double)(1ULL << 53);
+  const double u = ((double)(rand_gen(rs) >> 11) + 0.5) * fac;
+  return u * (upper - lower) + lower;
+}
+
+qacc double g_rand_gen(CounterRngState& rs, const double center = 0.0,
+                       const double sigma = 1.0)
+// Box-Muller without rejection (no data dependent loop)
+{
+  if (rs.gaussian_avail) {
+    rs.gaussian_avail = false;
+    return rs.gaussian * sigma + center;
+  }
+  const double u1 = u_rand_gen(rs);
+  const double u2 = u_rand_gen(rs);
+  const double r = std::sqrt(-2.0 * std::log(u1));
+  const double theta = 2.0 * 3.141592653589793 * u2;
+  rs.gaussian = r * std::sin(theta);
+  rs.gaussian_avail = true;
+  return r * std::cos(theta) * sigma + center;
+}
+
+}  // namespace qlat
@@ -285,6 +285,70 @@ struct API TimerInfo {
   void show_avg(const std::string& info, const int fname_len) const;
 };
 
+struct API TimerProfileNode {
+  // One call path in the call tree of TimerProfile.
+  // Time is inclusive. Flops are the ones added by the function itself (same
+  // as Timer::flops), i.e. exclusive.
+  Long info_index;  // -1 for the root
+  Long parent;      // -1 for the root
+  std::map<Long, Long> children;  // info_index -> node index
+  Long call_times;
+  double accumulated_time;
+  double accumulated_children_time;
+  Long accumulated_flops;
+  //
+  TimerProfileNode() { init(); }
+  //
+  void init()
+  {
+    info_index = -1;
+    parent = -1;
+    children.clear();
+    reset();
+  }
+  //
+  void reset()
+  {
+    call_times = 0;
+    accumulated_time = 0;
+    accumulated_children_time = 0;
+    accumulated_flops = 0;
+  }
+  //
+  double exclusive_time() const
+  {
+    return accumulated_time - accumulated_children_time;
+  }
+};
+
+struct API TimerTraceEvent {
+  Long info_index;
+  double start_time;
+  double stop_time;
+  Long flops;
+};
+
+struct API TimerProfile {
+  // Call tree and trace events recorded by one thread.
+  int id_thread;
+  std::vector<TimerProfileNode> nodes;  // nodes[0] is the root
+  Long current_node;
+  std::vector<double> start_time_stack;
+  std::vector<TimerTraceEvent> events;
+  Long num_dropped_events;
+  //
+  TimerProfile() { init(); }
+  //
+  void init();
+  //
+  void reset();
+  // keep the call tree and the currently running calls
+  //
+  void start(const Long info_index, const double time);
+  //
+  void stop(const Long info_index, const double time, const Long dflops);
+};
+
 struct API Timer {
   const char* cname;
   Long info_index;
@@ -295,6 +359,7 @@ struct API Timer {
   Long start_flops;
   Long stop_flops;
   Long flops;
+  bool is_recording_profile;
   //
   API static std::map<std::string, Long>& get_timer_info_index_map()
   {
@@ -379,6 +444,49 @@ struct API Timer {
     return max_len;
   }
   //
+  API static Long& profile_level()
+  // qlat parameter
+  // 0: off ; 1: call tree and trace of the main thread ; 2: all threads
+  {
+    static Long level = get_env_long_default("q_timer_profile", 0);
+    return level;
+  }
+  //
+  API static std::string& profile_path()
+  // qlat parameter
+  // If not empty, write_profile(profile_path()) is called in end().
+  {
+    static std::string path = get_env_default("q_timer_profile_path", "");
+    return path;
+  }
+  //
+  API static Long& profile_max_num_events()
+  // qlat parameter
+  // maximum number of trace events kept per thread
+  {
+    static Long max_num_events =
+        get_env_long_default("q_timer_profile_max_num_events", 1000 * 1000);
+    return max_num_events;
+  }
+  //
+  API static std::vector<TimerProfile*>& get_profile_list()
+  // one TimerProfile for each thread which has recorded anything
+  {
+    static std::vector<TimerProfile*> profile_list;
+    return profile_list;
+  }
+  //
+  API static TimerProfile& get_profile();
+  // TimerProfile of the current thread
+  //
+  API static void reset_profile();
+  //
+  API static void write_profile(const std::string& path);
+  // Write to directory path (on every node):
+  // trace-node-XXXXX.json: Chrome / Perfetto trace event format
+  // summary-node-XXXXX.txt: call tree with inclusive and exclusive time
+  // Should not be called while other threads are recording.
+  //
   Timer() { init(); }
   Timer(const std::string& fname_str)
   {
@@ -427,6 +535,7 @@ struct API Timer {
 struct API TimerCtrl {
   Timer* ptimer;
   bool verbose;
+  bool is_thread_profile;  // only record in the profile of the thread
   //
   TimerCtrl() { init(); }
   TimerCtrl(Timer& timer, bool verbose_ = false)
@@ -437,7 +546,12 @@ struct API TimerCtrl {
   //
   ~TimerCtrl()
   {
-    if (NULL != ptimer) {
+    if (NULL == ptimer) {
+      return;
+    }
+    if (is_thread_profile) {
+      Timer::get_profile().stop(ptimer->info_index, get_time(), 0);
+    } else {
       ptimer->stop(verbose);
     }
   }
@@ -446,10 +560,18 @@ struct API TimerCtrl {
   {
     ptimer = NULL;
     verbose = false;
+    is_thread_profile = false;
   }
   void init(Timer& timer, bool verbose_ = false)
   {
-    if (get_id_thread() != 0) return;
+    if (get_id_thread() != 0) {
+      if (Timer::profile_level() >= 2) {
+        ptimer = &timer;
+        is_thread_profile = true;
+        Timer::get_profile().start(ptimer->info_index, get_time());
+      }
+      return;
+    }
     ptimer = &timer;
     verbose = verbose_;
     ptimer->start(verbose);
@@ -361,6 +361,22 @@ struct IsBasicDataType<SpinVectorF> {
   using ElementaryType = RealF;
 };
 
+template <>
+struct IsBasicDataType<CompressedColorMatrixD> {
+  static constexpr bool value = true;
+  static constexpr bool is_complex = true;
+  static const std::string get_type_name() { return "CompressedColorMatrixD"; }
+  using ElementaryType = RealD;
+};
+
+template <>
+struct IsBasicDataType<CompressedColorMatrixF> {
+  static constexpr bool value = true;
+  static constexpr bool is_complex = true;
+  static const std::string get_type_name() { return "CompressedColorMatrixF"; }
+  using ElementaryType = RealF;
+};
+
 template <>
 struct IsBasicDataType<Coordinate> {
   static constexpr bool value = true;
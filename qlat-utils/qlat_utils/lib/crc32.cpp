@@ -0,0 +1,124 @@
+#include <qlat-utils/crc32.h>
+
+#if defined(__x86_64__) and (defined(__GNUC__) or defined(__clang__)) and \
+    (not defined(__NVCC__))
+#define QLAT_CRC32_PCLMUL
+#include <immintrin.h>
+#endif
+
+namespace qlat
+{  //
+
+#ifdef QLAT_CRC32_PCLMUL
+
+__attribute__((target("pclmul,sse4.1"))) static uint32_t crc32_pclmul_fold(
+    const uint8_t* buf, Long len, const uint32_t crc_init)
+// len >= 64 and len % 16 == 0
+// crc_init and the return value are the (not inverted) internal state.
+//
+// Gopal, Ozturk, et al., "Fast CRC Computation for Generic Polynomials Using
+// PCLMULQDQ Instruction", Intel (2009). Constants in the bit-reflected domain.
+{
+  alignas(16) static const uint64_t k1k2[] = {0x0154442bd4, 0x01c6e41596};
+  alignas(16) static const uint64_t k3k4[] = {0x01751997d0, 0x00ccaa009e};
+  alignas(16) static const uint64_t k5k0[] = {0x0163cd6124, 0x0000000000};
+  alignas(16) static const uint64_t poly[] = {0x01db710641, 0x01f7011641};
+  __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+  x1 = _mm_loadu_si128((const __m128i*)(buf + 0x00));
+  x2 = _mm_loadu_si128((const __m128i*)(buf + 0x10));
+  x3 = _mm_loadu_si128((const __m128i*)(buf + 0x20));
+  x4 = _mm_loadu_si128((const __m128i*)(buf + 0x30));
+  x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(crc_init));
+  x0 = _mm_load_si128((const __m128i*)k1k2);
+  buf += 64;
+  len -= 64;
+  // fold 4 x 128 bits in parallel
+  while (len >= 64) {
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+    x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+    x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+    x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+    y5 = _mm_loadu_si128((const __m128i*)(buf + 0x00));
+    y6 = _mm_loadu_si128((const __m128i*)(buf + 0x10));
+    y7 = _mm_loadu_si128((const __m128i*)(buf + 0x20));
+    y8 = _mm_loadu_si128((const __m128i*)(buf + 0x30));
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), y5);
+    x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), y6);
+    x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), y7);
+    x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), y8);
+    buf += 64;
+    len -= 64;
+  }
+  // fold into 128 bits
+  x0 = _mm_load_si128((const __m128i*)k3k4);
+  x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+  x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+  x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+  x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+  x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+  x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+  // fold the remaining 128 bits blocks
+  while (len >= 16) {
+    x2 = _mm_loadu_si128((const __m128i*)buf);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+    buf += 16;
+    len -= 16;
+  }
+  // fold 128 bits to 64 bits
+  x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+  x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+  x1 = _mm_srli_si128(x1, 8);
+  x1 = _mm_xor_si128(x1, x2);
+  x0 = _mm_loadl_epi64((const __m128i*)k5k0);
+  x2 = _mm_srli_si128(x1, 4);
+  x1 = _mm_and_si128(x1, x3);
+  x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+  // Barrett reduction to 32 bits
+  x0 = _mm_load_si128((const __m128i*)poly);
+  x2 = _mm_and_si128(x1, x3);
+  x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+  x2 = _mm_and_si128(x2, x3);
+  x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+  return _mm_extract_epi32(x1, 1);
+}
+
+bool is_crc32_pclmul_supported()
+{
+  return __builtin_cpu_supports("pclmul") and __builtin_cpu_supports("sse4.1");
+}
+
+crc32_t crc32_pclmul(const crc32_t initial, const void* data, const Long len)
+// Same result as crc32_z of zlib. Only call if is_crc32_pclmul_supported().
+{
+  const uint8_t* ptr = (const uint8_t*)data;
+  if (len < 64) {
+    return crc32_z(initial, ptr, len);
+  }
+  const Long len_fold = len - len % 16;
+  const crc32_t crc = ~crc32_pclmul_fold(ptr, len_fold, ~initial);
+  return crc32_z(crc, ptr + len_fold, len - len_fold);
+}
+
+#else
+
+bool is_crc32_pclmul_supported() { return false; }
+
+crc32_t crc32_pclmul(const crc32_t initial, const void* data, const Long len)
+{
+  return crc32_z(initial, (const unsigned char*)data, len);
+}
+
+#endif
+
+}  // namespace qlat
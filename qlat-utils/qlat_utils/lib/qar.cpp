@@ -1,4 +1,12 @@
+#include <fcntl.h>
 #include <qlat-utils/qar.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 namespace qlat
 {  //
@@ -88,6 +96,8 @@ std::string show(const QFileType ftype)
     return "CFile";
   } else if (ftype == QFileType::String) {
     return "String";
+  } else if (ftype == QFileType::MMap) {
+    return "MMap";
   } else {
     qassert(false);
     return "";
@@ -100,6 +110,8 @@ QFileType read_qfile_type(const std::string& ftype)
     return QFileType::CFile;
   } else if (ftype == "String") {
     return QFileType::String;
+  } else if (ftype == "MMap") {
+    return QFileType::MMap;
   } else {
     qassert(false);
     return QFileType::CFile;
@@ -134,6 +146,16 @@ Long QFileBase::read_data(Vector<char> v)
   return total_bytes;
 }
 
+bool QFileBase::read_view(Vector<char>& v, const Long size)
+// Set `v` to the next `size` bytes of the file without copying and advance the
+// position. Return false (and do nothing) if not supported by this type of
+// file or not enough data remains.
+{
+  (void)v;
+  (void)size;
+  return false;
+}
+
 std::string QFileBase::read_all()
 {
   TIMER_FLOPS("QFileBase::read_all()");
@@ -617,6 +639,203 @@ const std::string& QFileObjString::content()
 
 // ----------------------------------------------------
 
+QFileObjMMap::QFileObjMMap(const std::string& path_, const QFileMode mode_)
+{
+  is_null = true;
+  data_v = NULL;
+  init(path_, mode_);
+}
+
+void QFileObjMMap::init(const std::string& path_, const QFileMode mode_)
+{
+  TIMER("QFileObjMMap::init(path,mode)");
+  init();
+  if (mode_ != QFileMode::Read) {
+    qwarn(fname + ssprintf(": '%s' with '%s'. Only support read.",
+                           path_.c_str(), show(mode_).c_str()));
+    return;
+  }
+  const int fd = ::open(path_.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    ::close(fd);
+    return;
+  }
+  const Long size = st.st_size;
+  char* data = NULL;
+  if (size > 0) {
+    void* p = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+      qwarn(fname +
+            ssprintf(": mmap '%s' size=%ld failed.", path_.c_str(), size));
+      ::close(fd);
+      return;
+    }
+    data = (char*)p;
+    madvise(data, size, MADV_SEQUENTIAL);
+  }
+  // The mapping stays valid after the file descriptor is closed.
+  ::close(fd);
+  path_v = path_;
+  mode_v = mode_;
+  data_v = data;
+  file_size = size;
+  is_null = false;
+}
+
+QFileObjMMap::QFileObjMMap()
+{
+  is_null = true;
+  data_v = NULL;
+  init();
+}
+
+QFileObjMMap::~QFileObjMMap() { close(); }
+
+void QFileObjMMap::init()
+{
+  close();
+  path_v = "";
+  mode_v = QFileMode::Read;
+  data_v = NULL;
+  file_size = 0;
+  pos = 0;
+  is_eof = false;
+}
+
+void QFileObjMMap::close()
+{
+  if (is_null) {
+    return;
+  }
+  TIMER("QFileObjMMap::close()");
+  if (data_v != NULL) {
+    munmap(data_v, file_size);
+    data_v = NULL;
+  }
+  is_null = true;
+}
+
+QFileType QFileObjMMap::ftype() const { return QFileType::MMap; }
+
+const std::string& QFileObjMMap::path() const { return path_v; }
+
+QFileMode QFileObjMMap::mode() const { return mode_v; }
+
+bool QFileObjMMap::null() const { return is_null; }
+
+Long QFileObjMMap::size() const
+{
+  if (null()) {
+    return -1;
+  }
+  return file_size;
+}
+
+bool QFileObjMMap::eof() const
+{
+  qassert(not null());
+  return is_eof;
+}
+
+Long QFileObjMMap::tell() const
+{
+  qassert(not null());
+  return pos;
+}
+
+int QFileObjMMap::flush() const
+{
+  qassert(not null());
+  return 0;
+}
+
+int QFileObjMMap::seek(const Long offset, const int whence)
+{
+  qassert(not null());
+  Long pos_new = 0;
+  if (whence == SEEK_SET) {
+    pos_new = offset;
+  } else if (whence == SEEK_END) {
+    pos_new = file_size + offset;
+  } else if (whence == SEEK_CUR) {
+    pos_new = pos + offset;
+  } else {
+    qassert(false);
+  }
+  if (pos_new < 0) {
+    return 1;
+  }
+  is_eof = false;
+  pos = pos_new;
+  return 0;
+}
+
+Long QFileObjMMap::read(void* ptr, const Long size, const Long nmemb)
+{
+  TIMER_FLOPS("QFileObjMMap::read(ptr,size,nmemb)");
+  qassert(not null());
+  qassert(pos >= 0);
+  if (size == 0 or nmemb == 0) {
+    return 0;
+  }
+  Long actual_nmemb = nmemb;
+  if (pos + size * nmemb > file_size) {
+    is_eof = true;
+    if (pos >= file_size) {
+      return 0;
+    }
+    actual_nmemb = (file_size - pos) / size;
+  }
+  std::memcpy(ptr, &data_v[pos], size * actual_nmemb);
+  pos = pos + size * actual_nmemb;
+  timer.flops += size * actual_nmemb;
+  return actual_nmemb;
+}
+
+Long QFileObjMMap::write(const void* ptr, const Long size, const Long nmemb)
+{
+  (void)ptr;
+  (void)size;
+  (void)nmemb;
+  TIMER_VERBOSE("QFileObjMMap::write(ptr,size,nmemb)");
+  qassert(not null());
+  qerr(fname + ssprintf(": '%s' is read only.", path_v.c_str()));
+  return 0;
+}
+
+const std::string& QFileObjMMap::content()
+{
+  TIMER_VERBOSE("QFileObjMMap::content()");
+  qassert(not null());
+  qerr(fname + ssprintf(": Cannot obtain content. Not available for this type."));
+  static std::string ret = "";
+  return ret;
+}
+
+bool QFileObjMMap::read_view(Vector<char>& v, const Long size)
+// Large views are also hinted with MADV_WILLNEED so that the kernel starts
+// reading ahead before the data is touched.
+{
+  qassert(not null());
+  qassert(pos >= 0);
+  qassert(size >= 0);
+  if (pos + size > file_size) {
+    return false;
+  }
+  v = Vector<char>(data_v + pos, size);
+  if (size >= 1024L * 1024L) {
+    const Long page_size = sysconf(_SC_PAGESIZE);
+    const Long start = pos / page_size * page_size;
+    madvise(data_v + start, pos + size - start, MADV_WILLNEED);
+  }
+  pos += size;
+  return true;
+}
+
 QFileObj::QFileObj(const QFileType ftype_, const std::string& path_,
                    const QFileMode mode_)
 {
@@ -650,7 +869,8 @@ void QFileObj::init(const QFileType ftype_, const std::string& path_,
                     path_.c_str(), show(mode_).c_str()));
   }
   qassert(fp == nullptr);
-  if (ftype_ == QFileType::CFile and mode_ == QFileMode::Read and (not is_regular_file(path_))) {
+  if ((ftype_ == QFileType::CFile or ftype_ == QFileType::MMap) and
+      mode_ == QFileMode::Read and (not is_regular_file(path_))) {
     qwarn(ssprintf("QFile: '%s' open '%s' with '%s'. Not regular file.",
                    show(ftype_).c_str(), path_.c_str(), show(mode_).c_str()));
   }
@@ -658,6 +878,8 @@ void QFileObj::init(const QFileType ftype_, const std::string& path_,
     fp.reset(new QFileObjCFile(path_, mode_));
   } else if (ftype_ == QFileType::String) {
     fp.reset(new QFileObjString(path_, mode_));
+  } else if (ftype_ == QFileType::MMap) {
+    fp.reset(new QFileObjMMap(path_, mode_));
   } else {
     qassert(false);
   }
@@ -986,6 +1208,25 @@ const std::string& QFileObj::content()
   return fp->content();
 }
 
+bool QFileObj::read_view(Vector<char>& v, const Long size)
+{
+  qassert(not null());
+  qassert(mode() == QFileMode::Read);
+  qassert(size >= 0);
+  if (offset_end != -1 and offset_start + pos + size > offset_end) {
+    return false;
+  }
+  const int code = seek(pos, SEEK_SET);
+  qassert(code == 0);
+  if (not fp->read_view(v, size)) {
+    return false;
+  }
+  pos += size;
+  is_eof = false;
+  qassert(offset_start + pos == fp->tell());
+  return true;
+}
+
 // ----------------------------------------------------
 
 QFile::QFile(const std::weak_ptr<QFileObj>& wp) { init(wp); }
@@ -1166,6 +1407,12 @@ const std::string& QFile::content()
   return p->content();
 }
 
+bool QFile::read_view(Vector<char>& v, const Long size)
+{
+  qassert(not null());
+  return p->read_view(v, size);
+}
+
 // ----------------------------------------------------
 
 void add_qfile(const QFile& qfile)
@@ -1277,12 +1524,15 @@ QFile qfopen(const QFileType ftype, const std::string& path,
 // Will create directories needed for write / append
 {
   TIMER("qfopen(ftype,path,mode)");
-  if (ftype == QFileType::CFile) {
+  if (ftype == QFileType::CFile or ftype == QFileType::MMap) {
     if (mode == QFileMode::Read) {
       const std::string key = get_qar_read_cache_key(path);
       if (key == "") {
         return QFile();
       } else if (key == path) {
+        if (is_qfile_mmap()) {
+          return QFile(QFileType::MMap, path, mode);
+        }
         return QFile(ftype, path, mode);
       } else if (key == path + "/") {
         return QFile();
@@ -1294,6 +1544,7 @@ QFile qfopen(const QFileType ftype, const std::string& path,
         return qfile;
       }
     } else if (mode == QFileMode::Write or mode == QFileMode::Append) {
+      qassert(ftype == QFileType::CFile);
       const std::string path_dir = dirname(path);
       qmkdir_p(path_dir);
       return QFile(ftype, path, mode);
@@ -1376,6 +1627,15 @@ Long qfread(void* ptr, const Long size, const Long nmemb, QFile& qfile)
   return qfile.read(ptr, size, nmemb);
 }
 
+bool qfread_view(Vector<char>& v, const Long size, QFile& qfile)
+// interface function
+// Only succeed if qfile is opened with `QFileType::MMap` (possibly a file
+// inside a qar archive) and has at least `size` bytes left.
+// `v` is valid until qfile (and its parent) is closed.
+{
+  return qfile.read_view(v, size);
+}
+
 Long qfwrite(const void* ptr, const Long size, const Long nmemb, QFile& qfile)
 // interface function
 // Crash if there is no enough space
@@ -1452,6 +1712,30 @@ Long qread_data(const Vector<char>& v, QFile& qfile)
   return qfile.read_data(v);
 }
 
+Long qread_data_crc32(const Vector<char>& v, crc32_t& crc, QFile& qfile)
+// interface function
+// Same as qread_data, and update crc to be the crc32 of the data read appended
+// to the data before. The crc32 is computed chunk by chunk right after each
+// chunk is read (chunk size is write_from_qfile_chunk_size()).
+{
+  TIMER_FLOPS("qread_data_crc32(v,crc,qfile)");
+  const Long chunk_size = write_from_qfile_chunk_size();
+  qassert(chunk_size > 0);
+  Long total_bytes = 0;
+  while (total_bytes < v.size()) {
+    const Long size = std::min(chunk_size, v.size() - total_bytes);
+    const Vector<char> vc(v.data() + total_bytes, size);
+    const Long size_read = qfile.read_data(vc);
+    crc = crc32_par(crc, get_data(vc, size_read));
+    total_bytes += size_read;
+    if (size_read < size) {
+      break;
+    }
+  }
+  timer.flops += total_bytes;
+  return total_bytes;
+}
+
 std::string qcat(QFile& qfile)
 {
   return qfile.cat();
@@ -2557,6 +2841,25 @@ std::string read_data(const QarFile& qar, const std::string& fn)
   return ret;
 }
 
+bool read_data_view(Vector<char>& v, const QarFile& qar,
+                    const std::string& fn)
+// Set `v` to the content of `fn` without copying. Return false if `fn` is not
+// found or the qar volume is not opened with `QFileType::MMap` (see
+// `is_qfile_mmap()`). `v` is valid until qar is closed.
+{
+  TIMER("read_data_view(qar,fn)");
+  QFile qfile = read(qar, fn);
+  if (qfile.null()) {
+    return false;
+  }
+  qfseek_end(qfile, 0);
+  const Long size = qftell(qfile);
+  qfseek_set(qfile, 0);
+  const bool is_ok = qfread_view(v, size, qfile);
+  qfclose(qfile);
+  return is_ok;
+}
+
 std::string read_info(const QarFile& qar, const std::string& fn)
 {
   TIMER("read_info(qar,fn)");
@@ -3145,6 +3448,321 @@ void update_qar_cache_due_to_change_of_directory(const std::string& path)
 
 // ----------------------------------------------------
 
+// ----------------------------------------------------
+// Thread pipelines used by `qar_create` and `qar_extract`.
+// The worker threads only read / write the input / output regular files with
+// the C library (`QFile` and `TIMER` are not thread safe). All `QarFile`
+// operations stay on the calling thread and are done in the same order as the
+// serial code, so the resulting files are byte-identical.
+
+struct QarIoTask {
+  std::string path;
+  std::string data;
+  bool is_done;
+  bool is_large;  // not loaded, the calling thread copies it with `QFile`
+  bool is_ok;
+};
+
+struct QarIoPipeline;
+
+static void stop_qar_io_pipeline(QarIoPipeline& pl);
+
+struct QarIoPipeline {
+  std::vector<QarIoTask> tasks;
+  std::vector<std::thread> threads;
+  std::mutex mutex;
+  std::condition_variable cv;
+  Long i_next;     // next task to be claimed by a worker
+  Long i_consume;  // next task to be consumed by the calling thread
+  Long window;
+  Long pending_bytes;
+  Long max_pending_bytes;
+  Long max_file_size;
+  bool is_stopping;
+  //
+  ~QarIoPipeline()
+  // join the threads if an error is thrown before stop_qar_io_pipeline
+  {
+    stop_qar_io_pipeline(*this);
+  }
+};
+
+static bool qar_io_read_file(std::string& data, bool& is_large,
+                             const std::string& path, const Long max_size)
+// Only use the C library. Can be called from any thread.
+{
+  is_large = false;
+  FILE* fp = std::fopen(path.c_str(), "r");
+  if (fp == NULL) {
+    return false;
+  }
+  bool is_ok = std::fseek(fp, 0, SEEK_END) == 0;
+  const Long size = std::ftell(fp);
+  is_ok = is_ok and size >= 0 and std::fseek(fp, 0, SEEK_SET) == 0;
+  if (is_ok and size > max_size) {
+    is_large = true;
+  } else if (is_ok) {
+    data.resize(size);
+    is_ok = size == 0 or (Long)std::fread(&data[0], 1, size, fp) == size;
+  }
+  is_ok = (std::fclose(fp) == 0) and is_ok;
+  return is_ok;
+}
+
+static bool qar_io_write_file(const std::string& path, const std::string& data)
+// Only use the C library. Can be called from any thread.
+{
+  FILE* fp = std::fopen(path.c_str(), "w");
+  if (fp == NULL) {
+    return false;
+  }
+  bool is_ok = data.size() == 0 or
+               std::fwrite(data.data(), 1, data.size(), fp) == data.size();
+  is_ok = (std::fclose(fp) == 0) and is_ok;
+  return is_ok;
+}
+
+static void qar_io_read_loop(QarIoPipeline& pl)
+// Claim tasks in order. Task `i_consume` can always be claimed, so the calling
+// thread never waits for a task which cannot be loaded.
+{
+  const Long n_tasks = pl.tasks.size();
+  while (true) {
+    Long i = 0;
+    {
+      std::unique_lock<std::mutex> lock(pl.mutex);
+      pl.cv.wait(lock, [&] {
+        return pl.is_stopping or pl.i_next >= n_tasks or
+               pl.i_next == pl.i_consume or
+               (pl.i_next < pl.i_consume + pl.window and
+                pl.pending_bytes < pl.max_pending_bytes);
+      });
+      if (pl.is_stopping or pl.i_next >= n_tasks) {
+        return;
+      }
+      i = pl.i_next;
+      pl.i_next += 1;
+    }
+    QarIoTask& task = pl.tasks[i];
+    std::string data;
+    bool is_large = false;
+    const bool is_ok =
+        qar_io_read_file(data, is_large, task.path, pl.max_file_size);
+    {
+      std::lock_guard<std::mutex> lock(pl.mutex);
+      pl.pending_bytes += data.size();
+      std::swap(task.data, data);
+      task.is_large = is_large;
+      task.is_ok = is_ok;
+      task.is_done = true;
+    }
+    pl.cv.notify_all();
+  }
+}
+
+static void qar_io_write_loop(QarIoPipeline& pl)
+// Write the tasks in the order they are added. Stop when all tasks added are
+// done and `is_stopping` is set.
+{
+  while (true) {
+    Long i = 0;
+    {
+      std::unique_lock<std::mutex> lock(pl.mutex);
+      pl.cv.wait(lock, [&] {
+        return pl.i_next < pl.i_consume or pl.is_stopping;
+      });
+      if (pl.i_next >= pl.i_consume) {
+        return;
+      }
+      i = pl.i_next;
+      pl.i_next += 1;
+    }
+    QarIoTask& task = pl.tasks[i];
+    if (task.is_large) {
+      continue;
+    }
+    const bool is_ok = qar_io_write_file(task.path, task.data);
+    {
+      std::lock_guard<std::mutex> lock(pl.mutex);
+      pl.pending_bytes -= task.data.size();
+      std::string().swap(task.data);
+      task.is_ok = is_ok;
+      task.is_done = true;
+    }
+    pl.cv.notify_all();
+  }
+}
+
+static void init_qar_io_pipeline(QarIoPipeline& pl, const Long n_tasks)
+{
+  const Long n_threads = get_qar_io_n_threads();
+  qassert(n_threads > 0);
+  pl.tasks.resize(n_tasks);
+  for (Long i = 0; i < n_tasks; ++i) {
+    QarIoTask& task = pl.tasks[i];
+    task.is_done = false;
+    task.is_large = false;
+    task.is_ok = false;
+  }
+  pl.i_next = 0;
+  pl.i_consume = 0;
+  pl.window = 4 * n_threads;
+  pl.pending_bytes = 0;
+  pl.max_pending_bytes = get_qar_io_max_pending_bytes();
+  pl.max_file_size = std::max(pl.max_pending_bytes / n_threads, (Long)1);
+  pl.is_stopping = false;
+}
+
+static void stop_qar_io_pipeline(QarIoPipeline& pl)
+{
+  {
+    std::lock_guard<std::mutex> lock(pl.mutex);
+    pl.is_stopping = true;
+  }
+  pl.cv.notify_all();
+  for (Long i = 0; i < (Long)pl.threads.size(); ++i) {
+    pl.threads[i].join();
+  }
+  pl.threads.clear();
+}
+
+static void qar_create_write_files(QarFile& qar,
+                                   const std::vector<std::string>& reg_files,
+                                   const Long path_prefix_len)
+// Worker threads read the files ahead. Append to qar in the order of reg_files.
+{
+  TIMER_VERBOSE_FLOPS("qar_create_write_files");
+  const Long n_threads = get_qar_io_n_threads();
+  if (n_threads <= 0) {
+    for (Long i = 0; i < (Long)reg_files.size(); ++i) {
+      const std::string path = reg_files[i];
+      const std::string fn = path.substr(path_prefix_len);
+      QFile qfile_in(path, QFileMode::Read);
+      qassert(not qfile_in.null());
+      timer.flops += write_from_qfile(qar, fn, "", qfile_in);
+      qfclose(qfile_in);
+    }
+    return;
+  }
+  QarIoPipeline pl;
+  init_qar_io_pipeline(pl, reg_files.size());
+  for (Long i = 0; i < (Long)reg_files.size(); ++i) {
+    pl.tasks[i].path = reg_files[i];
+  }
+  for (Long i = 0; i < n_threads; ++i) {
+    pl.threads.push_back(std::thread(qar_io_read_loop, std::ref(pl)));
+  }
+  for (Long i = 0; i < (Long)reg_files.size(); ++i) {
+    QarIoTask& task = pl.tasks[i];
+    {
+      std::unique_lock<std::mutex> lock(pl.mutex);
+      pl.cv.wait(lock, [&] { return task.is_done; });
+    }
+    if (not task.is_ok) {
+      stop_qar_io_pipeline(pl);
+      qerr(fname + ssprintf(": failed to read '%s'.", task.path.c_str()));
+    }
+    const std::string fn = task.path.substr(path_prefix_len);
+    if (task.is_large) {
+      QFile qfile_in(task.path, QFileMode::Read);
+      qassert(not qfile_in.null());
+      timer.flops += write_from_qfile(qar, fn, "", qfile_in);
+      qfclose(qfile_in);
+    } else {
+      timer.flops += write_from_data(qar, fn, "", get_data_char(task.data));
+    }
+    {
+      std::lock_guard<std::mutex> lock(pl.mutex);
+      pl.pending_bytes -= task.data.size();
+      std::string().swap(task.data);
+      pl.i_consume = i + 1;
+    }
+    pl.cv.notify_all();
+  }
+  stop_qar_io_pipeline(pl);
+}
+
+static void qar_extract_read_files(const QarFile& qar,
+                                   const std::vector<std::string>& contents,
+                                   const std::string& path_folder_acc)
+// Read from qar in the order of contents. Worker threads write the files.
+// The directories should already exist.
+{
+  TIMER_VERBOSE_FLOPS("qar_extract_read_files");
+  const Long n_threads = get_qar_io_n_threads();
+  if (n_threads <= 0) {
+    for (Long i = 0; i < (Long)contents.size(); ++i) {
+      const std::string& fn = contents[i];
+      QFile qfile_in = read(qar, fn);
+      qassert(not qfile_in.null());
+      QFile qfile_out(path_folder_acc + "/" + fn, QFileMode::Write);
+      qassert(not qfile_out.null());
+      timer.flops += write_from_qfile(qfile_out, qfile_in);
+      qfclose(qfile_in);
+      qfclose(qfile_out);
+    }
+    return;
+  }
+  QarIoPipeline pl;
+  init_qar_io_pipeline(pl, contents.size());
+  for (Long i = 0; i < n_threads; ++i) {
+    pl.threads.push_back(std::thread(qar_io_write_loop, std::ref(pl)));
+  }
+  for (Long i = 0; i < (Long)contents.size(); ++i) {
+    const std::string& fn = contents[i];
+    QarIoTask& task = pl.tasks[i];
+    task.path = path_folder_acc + "/" + fn;
+    QFile qfile_in = read(qar, fn);
+    qassert(not qfile_in.null());
+    qfseek_end(qfile_in, 0);
+    const Long data_len = qftell(qfile_in);
+    qfseek_set(qfile_in, 0);
+    if (data_len > pl.max_file_size) {
+      QFile qfile_out(task.path, QFileMode::Write);
+      qassert(not qfile_out.null());
+      timer.flops += write_from_qfile(qfile_out, qfile_in);
+      qfclose(qfile_in);
+      qfclose(qfile_out);
+      {
+        std::lock_guard<std::mutex> lock(pl.mutex);
+        task.is_large = true;
+        task.is_ok = true;
+        task.is_done = true;
+        pl.i_consume = i + 1;
+      }
+      pl.cv.notify_all();
+      continue;
+    }
+    {
+      std::unique_lock<std::mutex> lock(pl.mutex);
+      pl.cv.wait(lock, [&] {
+        return pl.pending_bytes == 0 or
+               pl.pending_bytes + data_len <= pl.max_pending_bytes;
+      });
+    }
+    task.data.resize(data_len);
+    const Long total_bytes = qread_data(get_data_char(task.data), qfile_in);
+    qassert(total_bytes == data_len);
+    qfclose(qfile_in);
+    timer.flops += total_bytes;
+    {
+      std::lock_guard<std::mutex> lock(pl.mutex);
+      pl.pending_bytes += data_len;
+      pl.i_consume = i + 1;
+    }
+    pl.cv.notify_all();
+  }
+  stop_qar_io_pipeline(pl);
+  for (Long i = 0; i < (Long)contents.size(); ++i) {
+    const QarIoTask& task = pl.tasks[i];
+    if (not task.is_ok) {
+      qerr(fname + ssprintf(": failed to write '%s'.", task.path.c_str()));
+    }
+  }
+}
+
+// ----------------------------------------------------
+
 int qar_build_index(const std::string& path_qar)
 {
   TIMER_VERBOSE("qar_build_index");
@@ -3199,14 +3817,7 @@ int qar_create(const std::string& path_qar, const std::string& path_folder_,
     }
   }
   QarFile qar(path_qar + ".acc", QFileMode::Append);
-  for (Long i = 0; i < (Long)reg_files.size(); ++i) {
-    const std::string path = reg_files[i];
-    const std::string fn = path.substr(path_prefix_len);
-    QFile qfile_in(path, QFileMode::Read);
-    qassert(not qfile_in.null());
-    write_from_qfile(qar, fn, "", qfile_in);
-    qfclose(qfile_in);
-  }
+  qar_create_write_files(qar, reg_files, path_prefix_len);
   const Long num_vol = qar.size();
   qar.close();
   int ret_rename = 0;
@@ -3274,14 +3885,8 @@ int qar_extract(const std::string& path_qar, const std::string& path_folder_,
       qassert(code == 0);
       dirs.insert(dn);
     }
-    QFile qfile_in = read(qar, fn);
-    qassert(not qfile_in.null());
-    QFile qfile_out(path_folder + ".acc/" + fn, QFileMode::Write);
-    qassert(not qfile_out.null());
-    timer.flops += write_from_qfile(qfile_out, qfile_in);
-    qfclose(qfile_in);
-    qfclose(qfile_out);
   }
+  qar_extract_read_files(qar, contents, path_folder + ".acc");
   const Long num_vol = qar.size();
   qar.close();
   qrename(path_folder + ".acc", path_folder);
@@ -1,4 +1,5 @@
 #include <qlat-utils/timer.h>
+#include <qlat-utils/utils-io.h>
 
 namespace qlat
 {  //
@@ -87,6 +88,73 @@ void TimerInfo::show_avg(const std::string& info, const int fname_len) const
   }
 }
 
+void TimerProfile::init()
+{
+  id_thread = 0;
+  nodes.resize(1);
+  nodes[0].init();
+  current_node = 0;
+  start_time_stack.clear();
+  events.clear();
+  num_dropped_events = 0;
+}
+
+void TimerProfile::reset()
+{
+  for (Long i = 0; i < (Long)nodes.size(); ++i) {
+    nodes[i].reset();
+  }
+  events.clear();
+  num_dropped_events = 0;
+}
+
+void TimerProfile::start(const Long info_index, const double time)
+{
+  const Long parent = current_node;
+  Long child = nodes[parent].children[info_index];
+  if (child == 0) {
+    // node 0 is the root, which cannot be a child
+    child = nodes.size();
+    nodes[parent].children[info_index] = child;
+    TimerProfileNode node;
+    node.info_index = info_index;
+    node.parent = parent;
+    nodes.push_back(node);
+  }
+  current_node = child;
+  start_time_stack.push_back(time);
+}
+
+void TimerProfile::stop(const Long info_index, const double time,
+                        const Long dflops)
+{
+  if (current_node == 0 or nodes[current_node].info_index != info_index) {
+    displayln_c_stdout(ssprintf(
+        "TimerProfile::stop: thread %d: stack is corrupted (info_index=%ld)",
+        id_thread, info_index));
+    qassert(false);
+  }
+  const double start_time = start_time_stack.back();
+  start_time_stack.pop_back();
+  const double dtime = time - start_time;
+  TimerProfileNode& node = nodes[current_node];
+  node.call_times += 1;
+  node.accumulated_time += dtime;
+  node.accumulated_flops += dflops;
+  current_node = node.parent;
+  nodes[current_node].accumulated_children_time += dtime;
+  if ((Long)events.size() < Timer::profile_max_num_events()) {
+    TimerTraceEvent event;
+    event.info_index = info_index;
+    event.start_time = start_time;
+    event.stop_time = time;
+    event.flops = dflops;
+    events.push_back(event);
+  } else {
+    num_dropped_events += 1;
+  }
+}
+
 static bool compare_time_info_p(const TimerInfo* p1, const TimerInfo* p2)
 {
   return p1->accumulated_time < p2->accumulated_time;
@@ -96,6 +164,7 @@ void Timer::init()
 {
   cname = "Timer";
   is_using_total_flops = false;
+  is_recording_profile = false;
   get_start_time();
   initialize_papi();
   info_index = -1;
@@ -225,6 +294,10 @@ void Timer::start(bool verbose)
   start_flops = is_using_total_flops ? get_total_flops() : 0;
   flops = 0;
   start_time = get_time();
+  is_recording_profile = profile_level() > 0;
+  if (is_recording_profile) {
+    get_profile().start(info_index, start_time);
+  }
 }
 
 void Timer::stop(bool verbose)
@@ -258,6 +331,10 @@ void Timer::stop(bool verbose)
   }
   info.dtime = stop_time - start_time;
   info.dflops = stop_flops - start_flops;
+  if (is_recording_profile) {
+    get_profile().stop(info_index, stop_time, info.dflops);
+    is_recording_profile = false;
+  }
   bool is_show = false;
   if (get_verbose_level() > 0) {
     if (verbose ||
@@ -346,4 +423,135 @@ void Timer::display_stack_always()
   displayln_c_stdout("display_stack end");
 }
 
+TimerProfile& Timer::get_profile()
+{
+  static thread_local TimerProfile* p_profile = NULL;
+  if (NULL == p_profile) {
+    p_profile = new TimerProfile();
+    p_profile->id_thread = get_id_thread();
+#pragma omp critical(qlat_timer_profile_list)
+    get_profile_list().push_back(p_profile);
+  }
+  return *p_profile;
+}
+
+void Timer::reset_profile()
+{
+  std::vector<TimerProfile*>& profile_list = get_profile_list();
+  for (Long i = 0; i < (Long)profile_list.size(); ++i) {
+    profile_list[i]->reset();
+  }
+}
+
+static std::string json_escape(const std::string& str)
+{
+  std::string ret;
+  for (const char c : str) {
+    if (c == '"' or c == '\\') {
+      ret += '\\';
+      ret += c;
+    } else if ((unsigned char)c < 0x20) {
+      ret += ssprintf("\\u%04x", (int)c);
+    } else {
+      ret += c;
+    }
+  }
+  return ret;
+}
+
+static void write_profile_summary_node(FILE* fp, const TimerProfile& profile,
+                                       const std::vector<Long>& incl_flops,
+                                       const Long node_index, const int depth,
+                                       const double total_time)
+{
+  const std::vector<TimerInfo>& tdb = Timer::get_timer_database();
+  const TimerProfileNode& node = profile.nodes[node_index];
+  if (node_index != 0) {
+    const std::string& fname = tdb[node.info_index].fname;
+    fprintf(fp,
+            "%7.3f%% %7.3f%% %8ld calls; %.3E,%.3E sec; %.3E,%.3E flops; "
+            "%s%s\n",
+            node.accumulated_time / total_time * 100,
+            node.exclusive_time() / total_time * 100, (long)node.call_times,
+            node.accumulated_time, node.exclusive_time(),
+            (double)incl_flops[node_index], (double)node.accumulated_flops,
+            std::string(2 * (depth - 1), ' ').c_str(), fname.c_str());
+  }
+  std::vector<std::pair<double, Long>> children;
+  for (auto it = node.children.begin(); it != node.children.end(); ++it) {
+    children.push_back(
+        std::make_pair(-profile.nodes[it->second].accumulated_time,
+                       it->second));
+  }
+  std::sort(children.begin(), children.end());
+  for (Long i = 0; i < (Long)children.size(); ++i) {
+    write_profile_summary_node(fp, profile, incl_flops, children[i].second,
+                               depth + 1, total_time);
+  }
+}
+
+void Timer::write_profile(const std::string& path)
+{
+  TIMER_VERBOSE("Timer::write_profile");
+  qmkdir_p(path);
+  const std::vector<TimerInfo>& tdb = get_timer_database();
+  const std::vector<TimerProfile*>& profile_list = get_profile_list();
+  const int id_node = get_id_node();
+  const double time_origin = get_actual_start_time();
+  const double total_time = get_total_time();
+  {
+    const std::string fn = path + ssprintf("/trace-node-%05d.json", id_node);
+    FILE* fp = qopen(fn + ".partial", "w");
+    qassert(fp != NULL);
+    fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(fp,
+            "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,"
+            "\"args\":{\"name\":\"node %d\"}}",
+            id_node, id_node);
+    for (Long k = 0; k < (Long)profile_list.size(); ++k) {
+      const TimerProfile& profile = *profile_list[k];
+      for (Long i = 0; i < (Long)profile.events.size(); ++i) {
+        const TimerTraceEvent& event = profile.events[i];
+        fprintf(fp,
+                ",\n{\"name\":\"%s\",\"cat\":\"qlat\",\"ph\":\"X\","
+                "\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%d,"
+                "\"args\":{\"flops\":%ld}}",
+                json_escape(tdb[event.info_index].fname).c_str(),
+                (event.start_time - time_origin) * 1.0E6,
+                (event.stop_time - event.start_time) * 1.0E6, id_node,
+                profile.id_thread, (long)event.flops);
+      }
+    }
+    fprintf(fp, "\n]}\n");
+    qfclose(fp);
+    qrename(fn + ".partial", fn);
+  }
+  {
+    const std::string fn = path + ssprintf("/summary-node-%05d.txt", id_node);
+    FILE* fp = qopen(fn + ".partial", "w");
+    qassert(fp != NULL);
+    fprintf(fp, "# node %d ; total %.4E sec\n", id_node, total_time);
+    fprintf(fp,
+            "# incl%% excl%% number of calls; Incl,Excl sec; Incl,Excl flops; "
+            "call path\n");
+    for (Long k = 0; k < (Long)profile_list.size(); ++k) {
+      const TimerProfile& profile = *profile_list[k];
+      fprintf(fp, "# thread %d ; %ld trace events (%ld dropped)\n",
+              profile.id_thread, (long)profile.events.size(),
+              (long)profile.num_dropped_events);
+      // children always have larger node index than their parent
+      std::vector<Long> incl_flops(profile.nodes.size());
+      for (Long i = (Long)profile.nodes.size() - 1; i >= 0; --i) {
+        incl_flops[i] += profile.nodes[i].accumulated_flops;
+        if (i > 0) {
+          incl_flops[profile.nodes[i].parent] += incl_flops[i];
+        }
+      }
+      write_profile_summary_node(fp, profile, incl_flops, 0, 0, total_time);
+    }
+    qfclose(fp);
+    qrename(fn + ".partial", fn);
+  }
+}
+
 }  // namespace qlat
@@ -239,6 +239,28 @@ def timer_fork(cc.Long max_call_times_for_always_show_info=-1):
 def timer_merge():
     cc.Timer.merge()
 
+def get_timer_profile_level():
+    return cc.Timer.profile_level()
+
+def set_timer_profile_level(cc.Long level):
+    """
+    0: off ; 1: call tree and trace of the main thread ; 2: all threads
+    Default is set by env ``q_timer_profile``.
+    """
+    cdef cc.Long* p_ret = &cc.Timer.profile_level()
+    p_ret[0] = level
+    assert cc.Timer.profile_level() == level
+
+def timer_reset_profile():
+    cc.Timer.reset_profile()
+
+def timer_write_profile(const cc.std_string& path):
+    """
+    Write Chrome / Perfetto trace and call tree summary to directory ``path``.
+    Every node writes its own files.
+    """
+    cc.Timer.write_profile(path)
+
 ### -------------------------------------------------------------------
 
 class TimerFork:
@@ -83,6 +83,7 @@ EXPORT_FUNCTION(get_multiplicity_field)
 EXPORT_FUNCTION(get_multiplicity_sfield)
 EXPORT_FUNCTION(get_mview_field)
 EXPORT_FUNCTION(get_n_elems_sfield)
+EXPORT_FUNCTION(get_num_rhs_batch_inverter_domain_wall)
 EXPORT_FUNCTION(get_omega_fermion_action)
 EXPORT_FUNCTION(get_polar_field_scalar_action)
 EXPORT_FUNCTION(get_sizeof_m_field)
@@ -186,6 +187,7 @@ EXPORT_FUNCTION(set_mul_cfield_field)
 EXPORT_FUNCTION(set_mul_complex_field)
 EXPORT_FUNCTION(set_mul_double_field)
 EXPORT_FUNCTION(set_mul_double_sfield)
+EXPORT_FUNCTION(set_num_rhs_batch_inverter_domain_wall)
 EXPORT_FUNCTION(set_phase_field)
 EXPORT_FUNCTION(set_point_src_prop)
 EXPORT_FUNCTION(set_qm_action)
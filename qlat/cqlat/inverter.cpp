@@ -100,3 +100,25 @@ EXPORT(set_max_mixed_precision_cycle_inverter_domain_wall, {
   inv.max_mixed_precision_cycle() = max_mixed_precision_cycle;
   Py_RETURN_NONE;
 })
+
+EXPORT(get_num_rhs_batch_inverter_domain_wall, {
+  using namespace qlat;
+  PyObject* p_inv = NULL;
+  if (!PyArg_ParseTuple(args, "O", &p_inv)) {
+    return NULL;
+  }
+  const InverterDomainWall& inv = py_convert_type<InverterDomainWall>(p_inv);
+  return py_convert(inv.num_rhs_batch());
+})
+
+EXPORT(set_num_rhs_batch_inverter_domain_wall, {
+  using namespace qlat;
+  PyObject* p_inv = NULL;
+  int num_rhs_batch = 1;
+  if (!PyArg_ParseTuple(args, "Oi", &p_inv, &num_rhs_batch)) {
+    return NULL;
+  }
+  InverterDomainWall& inv = py_convert_type<InverterDomainWall>(p_inv);
+  inv.num_rhs_batch() = num_rhs_batch;
+  Py_RETURN_NONE;
+})
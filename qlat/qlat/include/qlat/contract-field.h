@@ -79,6 +79,21 @@ API inline array<SpinMatrix, 8>& get_va_matrices()
   return ms;
 }
 
+qacc array<GammaMatrix, 8> get_va_gamma_matrices()
+// Same as get_va_matrices(), but as GammaMatrix.
+{
+  array<GammaMatrix, 8> ms;
+  ms[0] = GammaMatrixConstants::get_cps_gm(1);
+  ms[1] = GammaMatrixConstants::get_cps_gm(2);
+  ms[2] = GammaMatrixConstants::get_cps_gm(4);
+  ms[3] = GammaMatrixConstants::get_cps_gm(8);
+  ms[4] = GammaMatrixConstants::get_cps_gm(14);
+  ms[5] = -GammaMatrixConstants::get_cps_gm(13);
+  ms[6] = GammaMatrixConstants::get_cps_gm(11);
+  ms[7] = -GammaMatrixConstants::get_cps_gm(7);
+  return ms;
+}
+
 // -----------------------------------------------------------------------------------
 
 inline void field_permute_mu_nu(FieldM<ComplexD, 8 * 8>& f)
@@ -140,8 +155,8 @@ inline void contract_meson_vv_unshifted_acc_x(
 {
   (void)xg_x;
   (void)xg_y;
-  const array<SpinMatrix, 8>& va_ms = get_va_matrices();
-  const SpinMatrix& gamma5 = SpinMatrixConstants::get_gamma5();
+  const array<GammaMatrix, 8> va_ms = get_va_gamma_matrices();
+  const GammaMatrix gamma5 = GammaMatrixConstants::get_gamma5();
   if (exact) {
     qassert(wsp1.exact_tslice_mask[t_wall]);
     qassert(wsp2.exact_tslice_mask[t_wall]);
@@ -153,11 +168,11 @@ inline void contract_meson_vv_unshifted_acc_x(
   const WilsonMatrix wm1_tsrc_x =
       gamma5 * (WilsonMatrix)matrix_adjoint(wm1_x_tsrc) * gamma5;
   const WilsonMatrix wm_y_tsrc_x = wm2_y_tsrc * gamma5 * wm1_tsrc_x;
+  const array<ComplexD, 256> mcc = matrix_color_contract(wm_y_tsrc_x, wm3_x_y);
   for (int mu = 0; mu < 8; ++mu) {
-    const WilsonMatrix wm = wm_y_tsrc_x * va_ms[mu] * wm3_x_y;
     for (int nu = 0; nu < 8; ++nu) {
       const int mu_nu = 8 * mu + nu;
-      v[mu_nu] += coef * matrix_trace(wm, va_ms[nu]);
+      v[mu_nu] += coef * matrix_trace(mcc, va_ms[mu], va_ms[nu]);
     }
   }
 }
@@ -278,7 +293,7 @@ inline WilsonMatrix get_wsnk_prop_avg(const WallSrcProps& wsp, const int t_snk,
                                       const bool exact_snk, const int t_src,
                                       const bool exact_src)
 {
-  const SpinMatrix& gamma5 = SpinMatrixConstants::get_gamma5();
+  const GammaMatrix gamma5 = GammaMatrixConstants::get_gamma5();
   return (ComplexD)0.5 *
          (get_wsnk_prop(wsp, t_src, exact_src).get_elem(t_snk) +
           gamma5 *
@@ -296,8 +311,8 @@ inline void contract_meson_vv_meson_unshifted_acc_x(
 {
   (void)xg_x;
   (void)xg_y;
-  const array<SpinMatrix, 8>& va_ms = get_va_matrices();
-  const SpinMatrix& gamma5 = SpinMatrixConstants::get_gamma5();
+  const array<GammaMatrix, 8> va_ms = get_va_gamma_matrices();
+  const GammaMatrix gamma5 = GammaMatrixConstants::get_gamma5();
   if (exact_src) {
     qassert(wsp1.exact_tslice_mask[t_wall_src]);
     qassert(wsp2.exact_tslice_mask[t_wall_src]);
@@ -319,11 +334,12 @@ inline void contract_meson_vv_meson_unshifted_acc_x(
       get_wsnk_prop_avg(wsp3, t_wall_src, exact_src, t_wall_snk, exact_snk) *
       gamma5;
   const WilsonMatrix wm_y_tsrc_tsnk_x = wm2_y_tsrc * wm3_tsrc_tsnk * wm1_tsnk_x;
+  const array<ComplexD, 256> mcc =
+      matrix_color_contract(wm_y_tsrc_tsnk_x, wm4_x_y);
   for (int mu = 0; mu < 8; ++mu) {
-    const WilsonMatrix wm = wm_y_tsrc_tsnk_x * va_ms[mu] * wm4_x_y;
     for (int nu = 0; nu < 8; ++nu) {
       const int mu_nu = 8 * mu + nu;
-      v[mu_nu] += coef * matrix_trace(wm, va_ms[nu]);
+      v[mu_nu] += coef * matrix_trace(mcc, va_ms[mu], va_ms[nu]);
     }
   }
 }
@@ -499,8 +515,8 @@ inline void contract_chvp(SelectedField<ComplexD>& chvp,
 // fsel.prob is NOT accounted.
 {
   TIMER_VERBOSE("contract_chvp");
-  const array<SpinMatrix, 8>& va_ms = get_va_matrices();
-  const SpinMatrix& gamma5 = SpinMatrixConstants::get_gamma5();
+  const array<GammaMatrix, 8> va_ms = get_va_gamma_matrices();
+  const GammaMatrix gamma5 = GammaMatrixConstants::get_gamma5();
   qassert(fsel.n_elems == prop1_x_y.n_elems);
   qassert(fsel.n_elems == prop2_x_y.n_elems);
   const int multiplicity = 8 * 8;
@@ -511,12 +527,12 @@ inline void contract_chvp(SelectedField<ComplexD>& chvp,
     const WilsonMatrix& wm2_x_y = prop2_x_y.get_elem(idx);
     const WilsonMatrix wm2_y_x =
         gamma5 * (WilsonMatrix)matrix_adjoint(wm2_x_y) * gamma5;
+    const array<ComplexD, 256> mcc = matrix_color_contract(wm2_y_x, wm1_x_y);
     Vector<ComplexD> chvp_v = chvp.get_elems(idx);
     for (int mu = 0; mu < 8; ++mu) {
-      const WilsonMatrix wm = wm2_y_x * va_ms[mu] * wm1_x_y;
       for (int nu = 0; nu < 8; ++nu) {
         const int mu_nu = 8 * mu + nu;
-        chvp_v[mu_nu] = matrix_trace(wm, va_ms[nu]);
+        chvp_v[mu_nu] = matrix_trace(mcc, va_ms[mu], va_ms[nu]);
       }
     }
   });
@@ -533,8 +549,8 @@ inline void contract_chvp_16(FieldM<ComplexD, 16>& chvp,
 // nu: polarization at source location y
 {
   TIMER_VERBOSE("contract_chvp_16");
-  const array<SpinMatrix, 4>& gammas = SpinMatrixConstants::get_cps_gammas();
-  const SpinMatrix& gamma5 = SpinMatrixConstants::get_gamma5();
+  const array<GammaMatrix, 4> gammas = GammaMatrixConstants::get_cps_gammas();
+  const GammaMatrix gamma5 = GammaMatrixConstants::get_gamma5();
   const Geometry& geo = prop1_x_y.geo();
   const Int multiplicity = prop1_x_y.multiplicity;
   qassert(multiplicity == 1);
@@ -550,12 +566,12 @@ inline void contract_chvp_16(FieldM<ComplexD, 16>& chvp,
     const WilsonMatrix& wm2_x_y = prop2_x_y.get_elem(index);
     const WilsonMatrix wm2_y_x =
         gamma5 * (WilsonMatrix)matrix_adjoint(wm2_x_y) * gamma5;
+    const array<ComplexD, 256> mcc = matrix_color_contract(wm2_y_x, wm1_x_y);
     Vector<ComplexD> chvp_v = chvp.get_elems(index);
     for (int mu = 0; mu < 4; ++mu) {
-      const WilsonMatrix wm = wm2_y_x * gammas[mu] * wm1_x_y;
       for (int nu = 0; nu < 4; ++nu) {
         const int mu_nu = 4 * mu + nu;
-        chvp_v[mu_nu] = matrix_trace(wm, gammas[nu]);
+        chvp_v[mu_nu] = matrix_trace(mcc, gammas[mu], gammas[nu]);
       }
     }
   });
@@ -164,12 +164,12 @@ inline LatData contract_two_point_function(const SelProp& prop1,
 // prop2(x)^\dagger gamma5) gms[op_snk] ) 0 <= tsep < total_site[3]
 {
   TIMER_VERBOSE("contract_two_point_function");
-  const array<SpinMatrix, 16>& gms = SpinMatrixConstants::get_cps_gms();
-  const SpinMatrix& gamma5 = SpinMatrixConstants::get_gamma5();
+  const array<GammaMatrix, 16> gms = GammaMatrixConstants::get_cps_gms();
+  const GammaMatrix gamma5 = GammaMatrixConstants::get_gamma5();
   const Geometry& geo = prop1.geo();
   const Coordinate total_site = geo.total_site();
-  vector<array<WilsonMatrix, 16> > gwm_ts(omp_get_max_threads() *
-                                          total_site[3]);
+  vector<array<ComplexD, 256> > gwm_ts(omp_get_max_threads() *
+                                       total_site[3]);
   set_zero(gwm_ts);
 #pragma omp parallel for
   for (Long idx = 0; idx < (Long)fsel.indices.size(); ++idx) {
@@ -180,15 +180,17 @@ inline LatData contract_two_point_function(const SelProp& prop1,
     const WilsonMatrix wm = prop1.get_elem(idx);
     const WilsonMatrix wmd =
         gamma5 * (WilsonMatrix)matrix_adjoint(prop2.get_elem(idx)) * gamma5;
-    for (int op_src = 0; op_src < 16; ++op_src) {
-      gwm_ts[omp_get_thread_num() * total_site[3] + tsep][op_src] +=
-          wm * gms[op_src] * wmd;
+    const array<ComplexD, 256> mcc = matrix_color_contract(wm, wmd);
+    array<ComplexD, 256>& gwm =
+        gwm_ts[omp_get_thread_num() * total_site[3] + tsep];
+    for (int k = 0; k < 256; ++k) {
+      gwm[k] += mcc[k];
     }
   }
   for (int i = 1; i < omp_get_max_threads(); ++i) {
     for (int t = 0; t < total_site[3]; ++t) {
-      for (int op_src = 0; op_src < 16; ++op_src) {
-        gwm_ts[t][op_src] += gwm_ts[i * total_site[3] + t][op_src];
+      for (int k = 0; k < 256; ++k) {
+        gwm_ts[t][k] += gwm_ts[i * total_site[3] + t][k];
       }
     }
   }
@@ -199,7 +201,7 @@ inline LatData contract_two_point_function(const SelProp& prop1,
     for (int op_src = 0; op_src < 16; ++op_src) {
       for (int op_snk = 0; op_snk < 16; ++op_snk) {
         m_ts[t][op_src * 16 + op_snk] =
-            matrix_trace(gwm_ts[t][op_src], gms[op_snk]);
+            matrix_trace(gwm_ts[t], gms[op_src], gms[op_snk]);
       }
     }
   }
@@ -223,8 +225,8 @@ inline LatData contract_two_point_wall_snk_function(
 // prop2[t]^\dagger gamma5 gms[op_snk] ) 0 <= tsep < total_site[3]
 {
   TIMER_VERBOSE("contract_two_point_wall_snk_function");
-  const array<SpinMatrix, 16>& gms = SpinMatrixConstants::get_cps_gms();
-  const SpinMatrix& gamma5 = SpinMatrixConstants::get_gamma5();
+  const array<GammaMatrix, 16> gms = GammaMatrixConstants::get_cps_gms();
+  const GammaMatrix gamma5 = GammaMatrixConstants::get_gamma5();
   qassert(prop1.n_points == (Long)total_site[3]);
   qassert(prop2.n_points == (Long)total_site[3]);
   vector<array<ComplexD, 16 * 16> > m_ts(total_site[3]);
@@ -236,10 +238,11 @@ inline LatData contract_two_point_wall_snk_function(
                              (WilsonMatrix)matrix_adjoint(prop2.get_elem(
                                  mod(tslice + t, total_site[3]))) *
                              gamma5;
+    const array<ComplexD, 256> mcc = matrix_color_contract(wm, wmd);
     for (int op_src = 0; op_src < 16; ++op_src) {
-      const WilsonMatrix wm_t = wm * gms[op_src] * wmd;
       for (int op_snk = 0; op_snk < 16; ++op_snk) {
-        m_ts[t][op_src * 16 + op_snk] = matrix_trace(wm_t, gms[op_snk]);
+        m_ts[t][op_src * 16 + op_snk] =
+            matrix_trace(mcc, gms[op_src], gms[op_snk]);
       }
     }
   }
@@ -372,8 +375,8 @@ inline LatData contract_three_point_function(const SelProp& prop_a,
 // wm_ab (type3)
 {
   TIMER("contract_three_point_function");
-  const array<SpinMatrix, 16>& gms = SpinMatrixConstants::get_cps_gms();
-  const SpinMatrix& gamma5 = SpinMatrixConstants::get_gamma5();
+  const array<GammaMatrix, 16> gms = GammaMatrixConstants::get_cps_gms();
+  const GammaMatrix gamma5 = GammaMatrixConstants::get_gamma5();
   const Geometry& geo = fsel.f_rank.geo();
   const Coordinate total_site = geo.total_site();
   qassert(is_matching_geo(prop_a.geo(), geo));
@@ -495,7 +498,7 @@ inline ComplexD contract_meson_snk_src(const WallSrcProps& wsp1,
                                       const bool exact_snk, const int t_src,
                                       const bool exact_src)
 {
-  const SpinMatrix& gamma5 = SpinMatrixConstants::get_gamma5();
+  const GammaMatrix gamma5 = GammaMatrixConstants::get_gamma5();
   const WilsonMatrix& wm1_snk_src =
       get_wsnk_prop(wsp1, t_src, exact_src).get_elem(t_snk);
   const WilsonMatrix& wm2_snk_src =
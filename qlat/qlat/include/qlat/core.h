@@ -6,6 +6,7 @@
 #include <qlat-utils/core.h>
 #include <qlat-utils/mat.h>
 #include <qlat-utils/matrix-hmc.h>
+#include <qlat-utils/rng-counter.h>
 #include <qlat-utils/utils-vec.h>
 #include <qlat-utils/coordinate.h>
 #include <qlat-utils/mat-vec.h>
@@ -978,6 +979,10 @@ template <class T = Real>
 struct API GaugeFieldT : FieldM<ColorMatrixT<T>, 4> {
 };
 
+template <class T = Real>
+struct API CompressedGaugeFieldT : FieldM<CompressedColorMatrixT<T>, 4> {
+};
+
 template <class T = Real>
 struct API GaugeTransformT : FieldM<ColorMatrixT<T>, 1> {
 };
@@ -996,6 +1001,8 @@ struct API FermionField5dT : Field<WilsonVectorT<T> > {
 
 using GaugeField = GaugeFieldT<>;
 
+using CompressedGaugeField = CompressedGaugeFieldT<>;
+
 using GaugeTransform = GaugeTransformT<>;
 
 using Propagator4d = Propagator4dT<>;
@@ -1314,6 +1321,52 @@ void set_g_rand(Field<M>& f, const RngState& rs, const RealD center = 0.0,
   set_zero(f);
 }
 
+template <class M,
+          QLAT_ENABLE_IF(is_data_value_type<M>() and is_composed_of_real<M>())>
+void set_u_rand(Field<M>& f, const CounterRng& crng, const RealD upper = 1.0,
+                const RealD lower = -1.0)
+// site with global index gindex uses make_counter_rng_state(crng, gindex)
+{
+  TIMER("set_u_rand(f,crng,upper,lower)");
+  using Real = typename IsDataValueType<M>::ElementaryType;
+  const Geometry& geo = f.geo();
+  qacc_for(index, geo.local_volume(), {
+    const Geometry& geo = f.geo();
+    const Coordinate xl = geo.coordinate_from_index(index);
+    const Coordinate xg = geo.coordinate_g_from_l(xl);
+    const Long gindex = geo.g_index_from_g_coordinate(xg);
+    CounterRngState rsi = make_counter_rng_state(crng, gindex);
+    Vector<M> v = f.get_elems(xl);
+    Vector<Real> dv((Real*)v.data(), v.data_size() / sizeof(Real));
+    for (Int m = 0; m < dv.size(); ++m) {
+      dv[m] = u_rand_gen(rsi, upper, lower);
+    }
+  });
+}
+
+template <class M,
+          QLAT_ENABLE_IF(is_data_value_type<M>() and is_composed_of_real<M>())>
+void set_g_rand(Field<M>& f, const CounterRng& crng, const RealD center = 0.0,
+                const RealD sigma = 1.0)
+// site with global index gindex uses make_counter_rng_state(crng, gindex)
+{
+  TIMER("set_g_rand(f,crng,center,sigma)");
+  using Real = typename IsDataValueType<M>::ElementaryType;
+  const Geometry& geo = f.geo();
+  qacc_for(index, geo.local_volume(), {
+    const Geometry& geo = f.geo();
+    const Coordinate xl = geo.coordinate_from_index(index);
+    const Coordinate xg = geo.coordinate_g_from_l(xl);
+    const Long gindex = geo.g_index_from_g_coordinate(xg);
+    CounterRngState rsi = make_counter_rng_state(crng, gindex);
+    Vector<M> v = f.get_elems(xl);
+    Vector<Real> dv((Real*)v.data(), v.data_size() / sizeof(Real));
+    for (Int m = 0; m < dv.size(); ++m) {
+      dv[m] = g_rand_gen(rsi, center, sigma);
+    }
+  });
+}
+
 // --------------------
 
 #define QLAT_CALL_WITH_TYPES(FUNC) \
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <qlat/fermion-action.h>
+#include <qlat/field-aligned.h>
+#include <qlat/qcd-prop.h>
 #include <qlat/qcd-utils.h>
 #include <qlat/qcd.h>
 
@@ -21,6 +23,17 @@ API inline bool& is_cg_verbose()
   return b;
 }
 
+API inline bool& is_wilson_hop_aligned()
+// qlat parameter
+// use multiply_wilson_hop_e_o_block (sites gathered into structure-of-arrays
+// blocks, one site per SIMD lane) for the e-o hopping term
+// cg_with_herm_sym_2 converts the vectors to AlignedField once per solve and
+// keeps the CG vectors in that layout (see cg_with_herm_sym_2_aligned)
+{
+  static bool b = get_env_long_default("q_wilson_hop_aligned", 1) != 0;
+  return b;
+}
+
 struct LowModesInfo {
   bool initialized;
   std::string path;
@@ -221,135 +234,207 @@ inline Long save_low_modes_decompress(LowModes& lm, const std::string& path)
   return total_bytes;
 }
 
-inline void deflate(HalfVector& hv_out, const HalfVector& hv_in, LowModes& lm)
-// hv_out can be the same as hv_in
+inline void deflate(std::vector<BlockedHalfVector>& bhvs, LowModes& lm)
+// bhvs[n] <- deflate(bhvs[n]) for all n
+// lm should be initialized already.
+// Each block of lm.cesb and lm.cesc is loaded once for all the vectors (the
+// projections are matrix-matrix products per block), and the inner products
+// of all the vectors are summed with a single glb_sum.
 {
-  force_low_modes(lm);
-  if (not lm.initialized) {
-    hv_out.init(geo_resize(hv_in.geo()), hv_in.multiplicity);
-    set_zero(hv_out);
+  TIMER_FLOPS("deflate(bhvs,lm)");
+  const int n_hv = bhvs.size();
+  if (n_hv == 0) {
     return;
   }
-  TIMER("deflate(hv,hv,lm)");
+  qassert(lm.initialized);
   const int ls = lm.cesi.ls;
   const Long block_size = lm.cesb.block_vol_eo * ls * HalfVector::c_size;
   const Long n_basis = lm.cesb.n_basis;
   const Long n_vec = lm.cesc.n_vec;
   qassert(n_vec == (Long)lm.eigen_values.size());
-  BlockedHalfVector bhv;
-  convert_half_vector(bhv, hv_in, lm.cesi.block_site);
-  const Geometry geo = geo_resize(bhv.geo());
-  Field<ComplexD> chv, phv;
-  chv.init(geo, n_basis);
-  phv.init(geo, n_vec);
-  set_zero(chv);
-  set_zero(phv);
+  const Geometry geo = geo_resize(bhvs[0].geo());
+  for (int n = 0; n < n_hv; ++n) {
+    qassert(bhvs[n].geo() == geo);
+    qassert(bhvs[n].multiplicity == block_size);
+  }
+  // tile of the fine vectors which stays in cache while looping over basis
+  const Long k_tile = 256;
+  const int n_threads = omp_get_max_threads();
+  std::vector<ComplexD> psums(n_threads * n_hv * n_vec, 0.0);
   {
     TIMER("deflate-project");
-#pragma omp parallel for
-    for (Long index = 0; index < geo.local_volume(); ++index) {
-      // const Coordinate xl = geo.coordinate_from_index(index);
-      const Vector<ComplexF> vb = bhv.get_elems_const(index);
-      const Vector<ComplexF> vbs = lm.cesb.get_elems_const(index);
-      const Vector<ComplexF> vcs = lm.cesc.get_elems_const(index);
-      // project to coarse grid
-      Vector<ComplexD> vc = chv.get_elems(index);
-      for (int j = 0; j < n_basis; ++j) {
-        ComplexD& vc_j = vc.p[j];
-        const Vector<ComplexF> vbs_j(vbs.p + j * block_size, block_size);
-        for (Long k = 0; k < block_size; ++k) {
-          const ComplexF& vb_k = vb.p[k];
-          vc_j += qconj(vbs_j.p[k]) * vb_k;
+#pragma omp parallel
+    {
+      std::vector<Vector<ComplexF> > vbs_n(n_hv);
+      std::vector<ComplexD> vc(n_hv * n_basis);
+      std::vector<ComplexD> ps(n_hv * n_vec, 0.0);
+#pragma omp for
+      for (Long index = 0; index < geo.local_volume(); ++index) {
+        const Vector<ComplexF> vbs = lm.cesb.get_elems_const(index);
+        const Vector<ComplexF> vcs = lm.cesc.get_elems_const(index);
+        for (int n = 0; n < n_hv; ++n) {
+          vbs_n[n] = bhvs[n].get_elems(index);
         }
-      }
-      // compute inner products
-      Vector<ComplexD> vp = phv.get_elems(index);
-      for (int i = 0; i < n_vec; ++i) {
-        ComplexD& vp_i = vp.p[i];
-        const Vector<ComplexF> vcs_i(vcs.p + i * n_basis, n_basis);
-        for (int j = 0; j < n_basis; ++j) {
-          const ComplexD& vc_j = vc.p[j];
-          vp_i += (ComplexD)qconj(vcs_i.p[j]) * vc_j;
+        // project to coarse grid
+        std::fill(vc.begin(), vc.end(), 0.0);
+        for (Long k0 = 0; k0 < block_size; k0 += k_tile) {
+          const Long k1 = std::min(k0 + k_tile, block_size);
+          for (Long j = 0; j < n_basis; ++j) {
+            const ComplexF* vbs_j = vbs.p + j * block_size;
+            for (int n = 0; n < n_hv; ++n) {
+              const ComplexF* vb = vbs_n[n].p;
+              ComplexD s = 0.0;
+              for (Long k = k0; k < k1; ++k) {
+                s += qconj(vbs_j[k]) * vb[k];
+              }
+              vc[n * n_basis + j] += s;
+            }
+          }
+        }
+        // compute inner products
+        for (Long i = 0; i < n_vec; ++i) {
+          const ComplexF* vcs_i = vcs.p + i * n_basis;
+          for (int n = 0; n < n_hv; ++n) {
+            const ComplexD* vc_n = &vc[n * n_basis];
+            ComplexD s = 0.0;
+            for (Long j = 0; j < n_basis; ++j) {
+              s += (ComplexD)qconj(vcs_i[j]) * vc_n[j];
+            }
+            ps[n * n_vec + i] += s;
+          }
         }
       }
+      const int id = omp_get_thread_num();
+      std::memcpy(&psums[id * n_hv * n_vec], ps.data(),
+                  ps.size() * sizeof(ComplexD));
     }
   }
-  std::vector<ComplexD> phv_sum(n_vec, 0.0);
+  std::vector<ComplexD> phv_sum(n_hv * n_vec, 0.0);
   {
     TIMER("deflate-glbsum");
     // glb sum inner products
-    for (Long index = 0; index < geo.local_volume(); ++index) {
-      // const Coordinate xl = geo.coordinate_from_index(index);
-      Vector<ComplexD> vp = phv.get_elems(index);
 #pragma omp parallel for
-      for (int i = 0; i < n_vec; ++i) {
-        phv_sum[i] += vp[i];
+    for (Long i = 0; i < n_hv * n_vec; ++i) {
+      for (int id = 0; id < n_threads; ++id) {
+        phv_sum[i] += psums[id * n_hv * n_vec + i];
       }
     }
-    phv.init();
+    clear(psums);
     glb_sum_double_vec(get_data(phv_sum));
     // scale by eigen values
 #pragma omp parallel for
-    for (int i = 0; i < n_vec; ++i) {
-      phv_sum[i] /= lm.eigen_values[i];
+    for (Long i = 0; i < n_hv * n_vec; ++i) {
+      phv_sum[i] /= lm.eigen_values[i % n_vec];
     }
   }
   {
     TIMER("deflate-produce");
-    // producing coarse space vector
-    set_zero(chv);
-#pragma omp parallel for
-    for (Long index = 0; index < geo.local_volume(); ++index) {
-      // const Coordinate xl = geo.coordinate_from_index(index);
-      const Vector<ComplexF> vbs = lm.cesb.get_elems_const(index);
-      const Vector<ComplexF> vcs = lm.cesc.get_elems_const(index);
-      // compute inner products
-      Vector<ComplexD> vc = chv.get_elems(index);
-      for (int i = 0; i < n_vec; ++i) {
-        const ComplexD& phv_sum_i = phv_sum[i];
-        const Vector<ComplexF> vcs_i(vcs.p + i * n_basis, n_basis);
-        for (int j = 0; j < n_basis; ++j) {
-          ComplexD& vc_j = vc.p[j];
-          vc_j += (ComplexD)(vcs_i.p[j]) * phv_sum_i;
+#pragma omp parallel
+    {
+      std::vector<Vector<ComplexF> > vbs_n(n_hv);
+      std::vector<ComplexD> vc(n_hv * n_basis);
+      std::vector<ComplexF> vcf(n_hv * n_basis);
+#pragma omp for
+      for (Long index = 0; index < geo.local_volume(); ++index) {
+        const Vector<ComplexF> vbs = lm.cesb.get_elems_const(index);
+        const Vector<ComplexF> vcs = lm.cesc.get_elems_const(index);
+        for (int n = 0; n < n_hv; ++n) {
+          vbs_n[n] = bhvs[n].get_elems(index);
         }
-      }
-      // project to fine grid
-      Vector<ComplexF> vb = bhv.get_elems(index);
-      for (int j = 0; j < n_basis; ++j) {
-        const ComplexF& vc_j = (ComplexF)vc[j];
-        const Vector<ComplexF> vbs_j(vbs.p + j * block_size, block_size);
-        for (Long k = 0; k < block_size; ++k) {
-          ComplexF& vb_k = vb.p[k];
-          vb_k += vbs_j.p[k] * vc_j;
+        // producing coarse space vector
+        std::fill(vc.begin(), vc.end(), 0.0);
+        for (Long i = 0; i < n_vec; ++i) {
+          const ComplexF* vcs_i = vcs.p + i * n_basis;
+          for (int n = 0; n < n_hv; ++n) {
+            const ComplexD& phv_sum_i = phv_sum[n * n_vec + i];
+            ComplexD* vc_n = &vc[n * n_basis];
+            for (Long j = 0; j < n_basis; ++j) {
+              vc_n[j] += (ComplexD)vcs_i[j] * phv_sum_i;
+            }
+          }
+        }
+        for (Long j = 0; j < n_hv * n_basis; ++j) {
+          vcf[j] = (ComplexF)vc[j];
+        }
+        // project to fine grid
+        for (Long k0 = 0; k0 < block_size; k0 += k_tile) {
+          const Long k1 = std::min(k0 + k_tile, block_size);
+          for (Long j = 0; j < n_basis; ++j) {
+            const ComplexF* vbs_j = vbs.p + j * block_size;
+            for (int n = 0; n < n_hv; ++n) {
+              const ComplexF& vc_j = vcf[n * n_basis + j];
+              ComplexF* vb = vbs_n[n].p;
+              for (Long k = k0; k < k1; ++k) {
+                vb[k] += vbs_j[k] * vc_j;
+              }
+            }
+          }
         }
       }
     }
   }
-  convert_half_vector(hv_out, bhv);
+  timer.flops += 16 * n_hv * n_basis * (block_size + n_vec) *
+                 geo.local_volume();
 }
 
-inline void deflate(FermionField5d& out, const FermionField5d& in, LowModes& lm)
-// out can be the same as in
+inline void deflate(HalfVector& hv_out, const HalfVector& hv_in, LowModes& lm)
+// hv_out can be the same as hv_in
 {
   force_low_modes(lm);
   if (not lm.initialized) {
-    out.init(geo_resize(in.geo()), in.multiplicity);
-    set_zero(out);
+    hv_out.init(geo_resize(hv_in.geo()), hv_in.multiplicity);
+    set_zero(hv_out);
     return;
   }
-  TIMER_VERBOSE("deflate(5d,5d,lm)");
-  const Geometry& geo = geo_resize(in.geo());
+  TIMER("deflate(hv,hv,lm)");
+  std::vector<BlockedHalfVector> bhvs(1);
+  convert_half_vector(bhvs[0], hv_in, lm.cesi.block_site);
+  deflate(bhvs, lm);
+  convert_half_vector(hv_out, bhvs[0]);
+}
+
+inline void deflate(std::vector<HalfVector>& hvs_out,
+                    const std::vector<HalfVector>& hvs_in, LowModes& lm)
+// hvs_out can be the same as hvs_in
+// Same as deflate(hvs_out[n], hvs_in[n], lm) for all n, but faster.
+{
+  force_low_modes(lm);
+  const int n_hv = hvs_in.size();
+  if (not lm.initialized) {
+    hvs_out.resize(n_hv);
+    for (int n = 0; n < n_hv; ++n) {
+      hvs_out[n].init(geo_resize(hvs_in[n].geo()), hvs_in[n].multiplicity);
+      set_zero(hvs_out[n]);
+    }
+    return;
+  }
+  TIMER("deflate(hvs,hvs,lm)");
+  std::vector<BlockedHalfVector> bhvs(n_hv);
+  for (int n = 0; n < n_hv; ++n) {
+    convert_half_vector(bhvs[n], hvs_in[n], lm.cesi.block_site);
+  }
+  deflate(bhvs, lm);
+  hvs_out.resize(n_hv);
+  for (int n = 0; n < n_hv; ++n) {
+    convert_half_vector(hvs_out[n], bhvs[n]);
+    bhvs[n].init();
+  }
+}
+
+inline void set_half_vector_from_fermion_field_5d(HalfVector& hv,
+                                                  const FermionField5d& ff)
+{
+  TIMER("set_half_vector_from_fermion_field_5d");
+  const Geometry geo = geo_resize(ff.geo());
   qassert(geo.eo == 1 or geo.eo == 2);
-  const int ls = in.multiplicity;
-  qassert(ls == lm.cesi.ls);
-  HalfVector hv;
+  const int ls = ff.multiplicity;
   init_half_vector(hv, geo, ls);
 #pragma omp parallel for
   for (Long index = 0; index < geo.local_volume(); ++index) {
     const Coordinate xl = geo.coordinate_from_index(index);
     qassert((xl[0] + xl[1] + xl[2] + xl[3]) % 2 == 2 - geo.eo);
     Vector<ComplexF> vhv = hv.get_elems(index);
-    const Vector<WilsonVector> vin = in.get_elems_const(index);
+    const Vector<WilsonVector> vin = ff.get_elems_const(index);
     qassert(vhv.size() ==
             vin.size() * (Long)sizeof(WilsonVector) / (Long)sizeof(ComplexD));
     const Vector<ComplexD> vff((const ComplexD*)vin.data(), vhv.size());
@@ -357,18 +442,25 @@ inline void deflate(FermionField5d& out, const FermionField5d& in, LowModes& lm)
       vhv[m] = vff[m];
     }
   }
-  deflate(hv, hv, lm);
-  if (is_initialized(out) and out.geo().eo == 3 - geo.eo) {
-    out.geo().eo = geo.eo;
+}
+
+inline void set_fermion_field_5d_from_half_vector(FermionField5d& ff,
+                                                  const HalfVector& hv)
+{
+  TIMER("set_fermion_field_5d_from_half_vector");
+  const Geometry geo = geo_resize(hv.geo());
+  qassert(geo.eo == 1 or geo.eo == 2);
+  if (is_initialized(ff) and ff.geo().eo == 3 - geo.eo) {
+    ff.geo().eo = geo.eo;
   }
-  out.init(geo, in.multiplicity);
-  qassert(out.geo().eo == geo.eo);
+  ff.init(geo, hv.ls);
+  qassert(ff.geo().eo == geo.eo);
 #pragma omp parallel for
   for (Long index = 0; index < geo.local_volume(); ++index) {
     const Coordinate xl = geo.coordinate_from_index(index);
     qassert((xl[0] + xl[1] + xl[2] + xl[3]) % 2 == 2 - geo.eo);
-    const Vector<ComplexF> vhv = hv.get_elems(index);
-    Vector<WilsonVector> vout = out.get_elems(index);
+    const Vector<ComplexF> vhv = hv.get_elems_const(index);
+    Vector<WilsonVector> vout = ff.get_elems(index);
     qassert(vhv.size() ==
             vout.size() * (Long)sizeof(WilsonVector) / (Long)sizeof(ComplexD));
     Vector<ComplexD> vff((ComplexD*)vout.data(), vhv.size());
@@ -378,6 +470,52 @@ inline void deflate(FermionField5d& out, const FermionField5d& in, LowModes& lm)
   }
 }
 
+inline void deflate(FermionField5d& out, const FermionField5d& in, LowModes& lm)
+// out can be the same as in
+{
+  force_low_modes(lm);
+  if (not lm.initialized) {
+    out.init(geo_resize(in.geo()), in.multiplicity);
+    set_zero(out);
+    return;
+  }
+  TIMER_VERBOSE("deflate(5d,5d,lm)");
+  qassert(in.multiplicity == lm.cesi.ls);
+  HalfVector hv;
+  set_half_vector_from_fermion_field_5d(hv, in);
+  deflate(hv, hv, lm);
+  set_fermion_field_5d_from_half_vector(out, hv);
+}
+
+inline void deflate(std::vector<FermionField5d>& outs,
+                    const std::vector<FermionField5d>& ins, LowModes& lm)
+// outs can be the same as ins
+// Same as deflate(outs[n], ins[n], lm) for all n, but faster.
+{
+  force_low_modes(lm);
+  const int n_ff = ins.size();
+  if (not lm.initialized) {
+    outs.resize(n_ff);
+    for (int n = 0; n < n_ff; ++n) {
+      outs[n].init(geo_resize(ins[n].geo()), ins[n].multiplicity);
+      set_zero(outs[n]);
+    }
+    return;
+  }
+  TIMER_VERBOSE("deflate(5ds,5ds,lm)");
+  std::vector<HalfVector> hvs(n_ff);
+  for (int n = 0; n < n_ff; ++n) {
+    qassert(ins[n].multiplicity == lm.cesi.ls);
+    set_half_vector_from_fermion_field_5d(hvs[n], ins[n]);
+  }
+  deflate(hvs, hvs, lm);
+  outs.resize(n_ff);
+  for (int n = 0; n < n_ff; ++n) {
+    set_fermion_field_5d_from_half_vector(outs[n], hvs[n]);
+    hvs[n].init();
+  }
+}
+
 inline void benchmark_deflate(const Geometry& geo, const int ls,
                               const Coordinate& block_site, const Long neig,
                               const Long nkeep, const RngState& rs)
@@ -404,13 +542,84 @@ inline void benchmark_deflate(const Geometry& geo, const int ls,
   sync_node();
 }
 
+template <class T1, class T2, class M1, class M2>
+void convert_field_precision(Field<M1>& f1, const Field<M2>& f2)
+// f1 has the same geo (including expansion) as f2
+// M1 is made of T1 and M2 is made of T2 (e.g. T1 = RealF and T2 = RealD)
+{
+  TIMER("convert_field_precision");
+  qassert(sizeof(M1) * sizeof(T2) == sizeof(M2) * sizeof(T1));
+  if (is_initialized(f1) and not(f1.geo() == f2.geo())) {
+    f1.init();
+  }
+  f1.init(f2.geo(), f2.multiplicity);
+  const Vector<M2> v2 = get_data(f2);
+  Vector<M1> v1 = get_data(f1);
+  const Vector<T2> d2((T2*)v2.data(), v2.data_size() / sizeof(T2));
+  Vector<T1> d1((T1*)v1.data(), v1.data_size() / sizeof(T1));
+  qassert(d1.size() == d2.size());
+  qacc_for(i, d1.size(), { d1[i] = d2[i]; });
+}
+
+template <class T = Real>
+struct API WilsonHopLinksT {
+  // Links of the e-o hopping term in the AlignedField layout.
+  // links[eo - 1] is on the local sites of parity eo (the sites of the output
+  // of the hopping term) with
+  //   m = mu     : U_mu(x)
+  //   m = 4 + mu : U_mu(x - mu)^\dagger
+  array<AlignedField<ColorMatrixT<T>>, 2> links;
+  //
+  void init()
+  {
+    links[0].init();
+    links[1].init();
+  }
+  //
+  WilsonHopLinksT() { init(); }
+};
+
+template <class T>
+bool is_initialized(const WilsonHopLinksT<T>& hl)
+{
+  return is_initialized(hl.links[0]) and is_initialized(hl.links[1]);
+}
+
+template <class T>
+void set_wilson_hop_links(WilsonHopLinksT<T>& hl, const GaugeFieldT<T>& gf)
+// gf needs to be left expanded and refreshed
+// (see set_left_expanded_gauge_field)
+{
+  TIMER("set_wilson_hop_links");
+  qassert(gf.multiplicity == 4);
+  for (int eo = 1; eo <= 2; ++eo) {
+    Geometry geo = geo_resize(gf.geo());
+    geo.eo = eo;
+    Field<ColorMatrixT<T>> f;
+    f.init(geo, 8);
+#pragma omp parallel for
+    for (Long index = 0; index < geo.local_volume(); ++index) {
+      const Coordinate xl = geo.coordinate_from_index(index);
+      Vector<ColorMatrixT<T>> v = f.get_elems(index);
+      for (int mu = 0; mu < 4; ++mu) {
+        v[mu] = gf.get_elem(xl, mu);
+        v[4 + mu] =
+            matrix_adjoint(gf.get_elem(coordinate_shifts(xl, -mu - 1), mu));
+      }
+    }
+    set_aligned_field(hl.links[eo - 1], f);
+  }
+}
+
 struct InverterParams {
   double stop_rsd;
   Long max_num_iter;
   Long max_mixed_precision_cycle;
   int solver_type;  // 0 -> CG, 1-> EIGCG, 2->MSPCG
   int higher_precision;
-  int lower_precision;
+  int lower_precision;  // 4 -> single precision inner CG (see invert)
+  double lower_precision_stop_rsd;  // min stop_rsd of each inner CG
+  int num_rhs_batch;  // number of right hand sides solved together
   //
   void init()
   {
@@ -420,6 +629,8 @@ struct InverterParams {
     solver_type = 0;
     higher_precision = 8;
     lower_precision = 8;
+    lower_precision_stop_rsd = 1.0e-5;
+    num_rhs_batch = 1;
   }
   //
   InverterParams() { init(); }
@@ -429,6 +640,9 @@ struct InverterDomainWall {
   box_acc<Geometry> geo;
   FermionAction fa;
   GaugeField gf;
+  mutable GaugeFieldT<RealF> gf_f;  // single precision copy of gf
+  mutable WilsonHopLinksT<RealD> hl;  // links of gf (aligned CG only)
+  mutable WilsonHopLinksT<RealF> hl_f;  // links of gf_f (aligned CG only)
   InverterParams ip;
   Handle<LowModes> lm;
   //
@@ -439,6 +653,9 @@ struct InverterDomainWall {
     geo.init();
     fa.init();
     gf.init();
+    gf_f.init();
+    hl.init();
+    hl_f.init();
     ip.init();
     lm.init();
   }
@@ -449,6 +666,9 @@ struct InverterDomainWall {
     TIMER_VERBOSE("Inv::setup(gf,fa)");
     geo.set(geo_resize(gf_.geo()));
     gf.init();
+    gf_f.init();
+    hl.init();
+    hl_f.init();
     set_left_expanded_gauge_field(gf, gf_);
     fa = fa_;
     lm.init();
@@ -460,6 +680,9 @@ struct InverterDomainWall {
     TIMER_VERBOSE("Inv::setup(gf,fa)");
     geo.set(geo_resize(gf_.geo()));
     gf.init();
+    gf_f.init();
+    hl.init();
+    hl_f.init();
     set_left_expanded_gauge_field(gf, gf_);
     fa = fa_;
     ip = ip_;
@@ -471,6 +694,9 @@ struct InverterDomainWall {
     TIMER_VERBOSE("Inv::setup(gf,fa,lm)");
     geo.set(geo_resize(gf_.geo()));
     gf.init();
+    gf_f.init();
+    hl.init();
+    hl_f.init();
     set_left_expanded_gauge_field(gf, gf_);
     fa = fa_;
     lm.init(lm_);
@@ -487,6 +713,44 @@ struct InverterDomainWall {
   {
     return ip.max_mixed_precision_cycle;
   }
+  //
+  int& num_rhs_batch() { return ip.num_rhs_batch; }
+  const int& num_rhs_batch() const { return ip.num_rhs_batch; }
+  //
+  void update_gf_f() const
+  // Called at the start of each mixed precision solve, so that changes made
+  // directly to gf are always seen by the single precision operator.
+  {
+    convert_field_precision<RealF, RealD>(gf_f, gf);
+    if (is_wilson_hop_aligned()) {
+      set_wilson_hop_links(hl_f, gf_f);
+    }
+  }
+  //
+  void update_hl() const
+  // Called at the start of each aligned double precision solve (see
+  // update_gf_f).
+  {
+    set_wilson_hop_links(hl, gf);
+  }
+  //
+  const GaugeFieldT<RealF>& get_gf_f() const
+  {
+    qassert(is_initialized(gf_f));
+    return gf_f;
+  }
+  //
+  const WilsonHopLinksT<RealD>& get_hl() const
+  {
+    qassert(is_initialized(hl));
+    return hl;
+  }
+  //
+  const WilsonHopLinksT<RealF>& get_hl_f() const
+  {
+    qassert(is_initialized(hl_f));
+    return hl_f;
+  }
 };
 
 template <class Inv>
@@ -774,8 +1038,19 @@ inline void project_eo(FermionField5d& ff, const int eo)
   set_half_fermion(ff, half, eo);
 }
 
-inline void multiply_m_e_e(FermionField5d& out, const FermionField5d& in,
-                           const FermionAction& fa)
+template <class T>
+int get_num_rhs(const FermionField5dT<T>& ff, const FermionAction& fa)
+// ff may hold several right hand sides, each with fa.ls components per site.
+// ff.multiplicity = num_rhs * fa.ls
+{
+  qassert(fa.ls > 0);
+  qassert(ff.multiplicity % fa.ls == 0);
+  return ff.multiplicity / fa.ls;
+}
+
+template <class T>
+void multiply_m_e_e(FermionField5dT<T>& out, const FermionField5dT<T>& in,
+                    const FermionAction& fa)
 // out can be the same object as in
 // works for _o_o as well
 {
@@ -786,12 +1061,12 @@ inline void multiply_m_e_e(FermionField5d& out, const FermionField5d& in,
   out.init(geo_resize(in.geo()), in.multiplicity);
   qassert(is_matching_geo(out.geo(), in.geo()));
   qassert(in.geo().eo == 1 or in.geo().eo == 2);
-  const SpinMatrix& gamma5 = SpinMatrixConstants::get_gamma5();
-  const SpinMatrix& unit = SpinMatrixConstants::get_unit();
-  const SpinMatrix p_p = (ComplexD)0.5 * (unit + gamma5);
-  const SpinMatrix p_m = (ComplexD)0.5 * (unit - gamma5);
-  FermionField5d in_copy;
-  ConstHandle<FermionField5d> hin;
+  const SpinMatrixT<T>& gamma5 = SpinMatrixConstantsT<T>::get_gamma5();
+  const SpinMatrixT<T>& unit = SpinMatrixConstantsT<T>::get_unit();
+  const SpinMatrixT<T> p_p = 0.5 * (unit + gamma5);
+  const SpinMatrixT<T> p_m = 0.5 * (unit - gamma5);
+  FermionField5dT<T> in_copy;
+  ConstHandle<FermionField5dT<T>> hin;
   if (&out != &in) {
     hin.init(in);
   } else {
@@ -805,27 +1080,32 @@ inline void multiply_m_e_e(FermionField5d& out, const FermionField5d& in,
     bee[m] = 1.0 + fa.bs[m] * (4.0 - fa.m5);
     cee[m] = 1.0 - fa.cs[m] * (4.0 - fa.m5);
   }
+  const ComplexT<T> mmass = -fa.mass;
+  const int n_rhs = get_num_rhs(in, fa);
 #pragma omp parallel for
   for (Long index = 0; index < geo.local_volume(); ++index) {
     const Coordinate xl = geo.coordinate_from_index(index);
-    const Vector<WilsonVector> iv = hin().get_elems_const(xl);
-    Vector<WilsonVector> v = out.get_elems(xl);
-    for (int m = 0; m < fa.ls; ++m) {
-      v[m] = (ComplexD)bee[m] * iv[m];
-      const WilsonVector tmp =
-          (p_m * (m < fa.ls - 1
-                      ? iv[m + 1]
-                      : (WilsonVector)((ComplexD)(-fa.mass) * iv[0]))) +
-          (p_p * (m > 0
-                      ? iv[m - 1]
-                      : (WilsonVector)((ComplexD)(-fa.mass) * iv[fa.ls - 1])));
-      v[m] -= (ComplexD)cee[m] * tmp;
+    const Vector<WilsonVectorT<T>> iv_all = hin().get_elems_const(xl);
+    Vector<WilsonVectorT<T>> v_all = out.get_elems(xl);
+    for (int k = 0; k < n_rhs; ++k) {
+      const Vector<WilsonVectorT<T>> iv(iv_all.data() + k * fa.ls, fa.ls);
+      Vector<WilsonVectorT<T>> v(v_all.data() + k * fa.ls, fa.ls);
+      for (int m = 0; m < fa.ls; ++m) {
+        v[m] = (ComplexT<T>)bee[m] * iv[m];
+        const WilsonVectorT<T> iv_p =
+            m < fa.ls - 1 ? iv[m + 1] : (WilsonVectorT<T>)(mmass * iv[0]);
+        const WilsonVectorT<T> iv_m =
+            m > 0 ? iv[m - 1] : (WilsonVectorT<T>)(mmass * iv[fa.ls - 1]);
+        const WilsonVectorT<T> tmp = (p_m * iv_p) + (p_p * iv_m);
+        v[m] -= (ComplexT<T>)cee[m] * tmp;
+      }
     }
   }
 }
 
-inline void multiply_mdag_e_e(FermionField5d& out, const FermionField5d& in,
-                              const FermionAction& fa)
+template <class T>
+void multiply_mdag_e_e(FermionField5dT<T>& out, const FermionField5dT<T>& in,
+                       const FermionAction& fa)
 // out can be the same object as in
 // works for _o_o as well
 {
@@ -836,12 +1116,12 @@ inline void multiply_mdag_e_e(FermionField5d& out, const FermionField5d& in,
   out.init(geo_resize(in.geo()), in.multiplicity);
   qassert(is_matching_geo(out.geo(), in.geo()));
   qassert(in.geo().eo == 1 or in.geo().eo == 2);
-  const SpinMatrix& gamma5 = SpinMatrixConstants::get_gamma5();
-  const SpinMatrix& unit = SpinMatrixConstants::get_unit();
-  const SpinMatrix p_p = (ComplexD)0.5 * (unit + gamma5);
-  const SpinMatrix p_m = (ComplexD)0.5 * (unit - gamma5);
-  FermionField5d in_copy;
-  ConstHandle<FermionField5d> hin;
+  const SpinMatrixT<T>& gamma5 = SpinMatrixConstantsT<T>::get_gamma5();
+  const SpinMatrixT<T>& unit = SpinMatrixConstantsT<T>::get_unit();
+  const SpinMatrixT<T> p_p = 0.5 * (unit + gamma5);
+  const SpinMatrixT<T> p_m = 0.5 * (unit - gamma5);
+  FermionField5dT<T> in_copy;
+  ConstHandle<FermionField5dT<T>> hin;
   if (&out != &in) {
     hin.init(in);
   } else {
@@ -855,59 +1135,56 @@ inline void multiply_mdag_e_e(FermionField5d& out, const FermionField5d& in,
     bee[m] = qconj(1.0 + fa.bs[m] * (4.0 - fa.m5));
     cee[m] = qconj(1.0 - fa.cs[m] * (4.0 - fa.m5));
   }
+  const ComplexT<T> mmass_cee_0 =
+      (ComplexT<T>)(-qconj((ComplexD)fa.mass) * cee[0]);
+  const ComplexT<T> mmass_cee_l =
+      (ComplexT<T>)(-qconj((ComplexD)fa.mass) * cee[fa.ls - 1]);
+  const int n_rhs = get_num_rhs(in, fa);
 #pragma omp parallel for
   for (Long index = 0; index < geo.local_volume(); ++index) {
     const Coordinate xl = geo.coordinate_from_index(index);
-    const Vector<WilsonVector> iv = hin().get_elems_const(xl);
-    Vector<WilsonVector> v = out.get_elems(xl);
-    for (int m = 0; m < fa.ls; ++m) {
-      v[m] = (ComplexD)bee[m] * iv[m];
-      const WilsonVector tmp =
-          (p_p * (m < fa.ls - 1
-                      ? (WilsonVector)((ComplexD)cee[m + 1] * iv[m + 1])
-                      : (WilsonVector)(
-                            (ComplexD)(-qconj((ComplexD)fa.mass) * cee[0]) *
-                            iv[0]))) +
-          (p_m * (m > 0
-                      ? (WilsonVector)((ComplexD)cee[m - 1] * iv[m - 1])
-                      : (WilsonVector)((ComplexD)(-qconj((ComplexD)fa.mass) *
-                                                  cee[fa.ls - 1]) *
-                                       iv[fa.ls - 1])));
-      v[m] -= tmp;
+    const Vector<WilsonVectorT<T>> iv_all = hin().get_elems_const(xl);
+    Vector<WilsonVectorT<T>> v_all = out.get_elems(xl);
+    for (int k = 0; k < n_rhs; ++k) {
+      const Vector<WilsonVectorT<T>> iv(iv_all.data() + k * fa.ls, fa.ls);
+      Vector<WilsonVectorT<T>> v(v_all.data() + k * fa.ls, fa.ls);
+      for (int m = 0; m < fa.ls; ++m) {
+        v[m] = (ComplexT<T>)bee[m] * iv[m];
+        const WilsonVectorT<T> iv_p =
+            m < fa.ls - 1
+                ? (WilsonVectorT<T>)((ComplexT<T>)cee[m + 1] * iv[m + 1])
+                : (WilsonVectorT<T>)(mmass_cee_0 * iv[0]);
+        const WilsonVectorT<T> iv_m =
+            m > 0 ? (WilsonVectorT<T>)((ComplexT<T>)cee[m - 1] * iv[m - 1])
+                  : (WilsonVectorT<T>)(mmass_cee_l * iv[fa.ls - 1]);
+        const WilsonVectorT<T> tmp = (p_p * iv_p) + (p_m * iv_m);
+        v[m] -= tmp;
+      }
     }
   }
 }
 
-inline void multiply_m_e_e_inv(FermionField5d& out, const FermionField5d& in,
-                               const FermionAction& fa)
-// out can be the same object as in
-// works for _o_o as well
+inline void set_m_e_e_inv_coefs(std::vector<ComplexD>& lee,
+                                std::vector<ComplexD>& leem,
+                                std::vector<ComplexD>& dee,
+                                std::vector<ComplexD>& uee,
+                                std::vector<ComplexD>& ueem,
+                                const FermionAction& fa)
+// coefficients of the LDU decomposition of M_ee used by multiply_m_e_e_inv
 {
-  TIMER("multiply_m_e_e_inv");
-  if (is_initialized(out) and out.geo().eo == 3 - in.geo().eo) {
-    out.geo().eo = in.geo().eo;
-  }
-  out.init(geo_resize(in.geo()), in.multiplicity);
-  qassert(is_matching_geo(out.geo(), in.geo()));
-  qassert(out.geo().eo == in.geo().eo);
-  qassert(in.geo().eo == 1 or in.geo().eo == 2);
-  const SpinMatrix& gamma5 = SpinMatrixConstants::get_gamma5();
-  const SpinMatrix& unit = SpinMatrixConstants::get_unit();
-  const SpinMatrix p_p = (ComplexD)0.5 * (unit + gamma5);
-  const SpinMatrix p_m = (ComplexD)0.5 * (unit - gamma5);
-  const Geometry& geo = out.geo();
   std::vector<ComplexD> bee(fa.ls), cee(fa.ls);
   for (int m = 0; m < fa.ls; ++m) {
     bee[m] = 1.0 + fa.bs[m] * (4.0 - fa.m5);
     cee[m] = 1.0 - fa.cs[m] * (4.0 - fa.m5);
   }
-  std::vector<ComplexD> lee(fa.ls - 1), leem(fa.ls - 1);
+  lee.resize(fa.ls - 1);
+  leem.resize(fa.ls - 1);
   for (int m = 0; m < fa.ls - 1; ++m) {
     lee[m] = -cee[m + 1] / bee[m];
     leem[m] = m == 0 ? fa.mass * cee[fa.ls - 1] / bee[0]
                      : leem[m - 1] * cee[m - 1] / bee[m];
   }
-  std::vector<ComplexD> dee(fa.ls, 0.0);
+  dee.assign(fa.ls, 0.0);
   dee[fa.ls - 1] = fa.mass * cee[fa.ls - 1];
   for (int m = 0; m < fa.ls - 1; ++m) {
     dee[fa.ls - 1] *= cee[m] / bee[m];
@@ -915,48 +1192,79 @@ inline void multiply_m_e_e_inv(FermionField5d& out, const FermionField5d& in,
   for (int m = 0; m < fa.ls; ++m) {
     dee[m] += bee[m];
   }
-  std::vector<ComplexD> uee(fa.ls - 1), ueem(fa.ls - 1);
+  uee.resize(fa.ls - 1);
+  ueem.resize(fa.ls - 1);
   for (int m = 0; m < fa.ls - 1; ++m) {
     uee[m] = -cee[m] / bee[m];
     ueem[m] =
         m == 0 ? fa.mass * cee[0] / bee[0] : ueem[m - 1] * cee[m] / bee[m];
   }
+}
+
+template <class T>
+void multiply_m_e_e_inv(FermionField5dT<T>& out, const FermionField5dT<T>& in,
+                        const FermionAction& fa)
+// out can be the same object as in
+// works for _o_o as well
+{
+  TIMER("multiply_m_e_e_inv");
+  if (is_initialized(out) and out.geo().eo == 3 - in.geo().eo) {
+    out.geo().eo = in.geo().eo;
+  }
+  out.init(geo_resize(in.geo()), in.multiplicity);
+  qassert(is_matching_geo(out.geo(), in.geo()));
+  qassert(out.geo().eo == in.geo().eo);
+  qassert(in.geo().eo == 1 or in.geo().eo == 2);
+  const SpinMatrixT<T>& gamma5 = SpinMatrixConstantsT<T>::get_gamma5();
+  const SpinMatrixT<T>& unit = SpinMatrixConstantsT<T>::get_unit();
+  const SpinMatrixT<T> p_p = 0.5 * (unit + gamma5);
+  const SpinMatrixT<T> p_m = 0.5 * (unit - gamma5);
+  const Geometry& geo = out.geo();
+  std::vector<ComplexD> lee, leem, dee, uee, ueem;
+  set_m_e_e_inv_coefs(lee, leem, dee, uee, ueem, fa);
+  const int n_rhs = get_num_rhs(in, fa);
 #pragma omp parallel for
   for (Long index = 0; index < geo.local_volume(); ++index) {
     const Coordinate xl = geo.coordinate_from_index(index);
-    const Vector<WilsonVector> iv = in.get_elems_const(xl);
-    Vector<WilsonVector> v = out.get_elems(xl);
-    if (v.data() != iv.data()) {
-      std::memcpy(v.data(), iv.data(), iv.data_size());
-    }
-    WilsonVector tmp;
-    // {L^m_{ee}}^{-1}
-    set_zero(tmp);
-    for (int m = 0; m < fa.ls - 1; ++m) {
-      tmp += (ComplexD)(-leem[m]) * v[m];
-    }
-    v[fa.ls - 1] += p_m * tmp;
-    // {L'_{ee}}^{-1}
-    for (int m = 1; m < fa.ls; ++m) {
-      v[m] += (ComplexD)(-lee[m - 1]) * (p_p * v[m - 1]);
-    }
-    // {D_{ee}}^{-1}
-    for (int m = 0; m < fa.ls; ++m) {
-      v[m] *= (ComplexD)(1.0 / dee[m]);
-    }
-    // {U^'_{ee}}^{-1}
-    for (int m = fa.ls - 2; m >= 0; --m) {
-      v[m] += (ComplexD)(-uee[m]) * (p_m * v[m + 1]);
-    }
-    // {U^m_{ee}}^{-1}
-    for (int m = 0; m < fa.ls - 1; ++m) {
-      v[m] += (ComplexD)(-ueem[m]) * (p_p * v[fa.ls - 1]);
+    const Vector<WilsonVectorT<T>> iv_all = in.get_elems_const(xl);
+    Vector<WilsonVectorT<T>> v_all = out.get_elems(xl);
+    for (int k = 0; k < n_rhs; ++k) {
+      const Vector<WilsonVectorT<T>> iv(iv_all.data() + k * fa.ls, fa.ls);
+      Vector<WilsonVectorT<T>> v(v_all.data() + k * fa.ls, fa.ls);
+      if (v.data() != iv.data()) {
+        std::memcpy(v.data(), iv.data(), iv.data_size());
+      }
+      WilsonVectorT<T> tmp;
+      // {L^m_{ee}}^{-1}
+      set_zero(tmp);
+      for (int m = 0; m < fa.ls - 1; ++m) {
+        tmp += (ComplexT<T>)(-leem[m]) * v[m];
+      }
+      v[fa.ls - 1] += p_m * tmp;
+      // {L'_{ee}}^{-1}
+      for (int m = 1; m < fa.ls; ++m) {
+        v[m] += (ComplexT<T>)(-lee[m - 1]) * (p_p * v[m - 1]);
+      }
+      // {D_{ee}}^{-1}
+      for (int m = 0; m < fa.ls; ++m) {
+        v[m] *= (ComplexT<T>)(1.0 / dee[m]);
+      }
+      // {U^'_{ee}}^{-1}
+      for (int m = fa.ls - 2; m >= 0; --m) {
+        v[m] += (ComplexT<T>)(-uee[m]) * (p_m * v[m + 1]);
+      }
+      // {U^m_{ee}}^{-1}
+      for (int m = 0; m < fa.ls - 1; ++m) {
+        v[m] += (ComplexT<T>)(-ueem[m]) * (p_p * v[fa.ls - 1]);
+      }
     }
   }
 }
 
-inline void multiply_mdag_e_e_inv(FermionField5d& out, const FermionField5d& in,
-                                  const FermionAction& fa)
+template <class T>
+void multiply_mdag_e_e_inv(FermionField5dT<T>& out,
+                           const FermionField5dT<T>& in,
+                           const FermionAction& fa)
 // out can be the same object as in
 // works for _o_o as well
 {
@@ -968,39 +1276,14 @@ inline void multiply_mdag_e_e_inv(FermionField5d& out, const FermionField5d& in,
   qassert(is_matching_geo(out.geo(), in.geo()));
   qassert(out.geo().eo == in.geo().eo);
   qassert(in.geo().eo == 1 or in.geo().eo == 2);
-  const SpinMatrix& gamma5 = SpinMatrixConstants::get_gamma5();
-  const SpinMatrix& unit = SpinMatrixConstants::get_unit();
-  const SpinMatrix p_p = (ComplexD)0.5 * (unit + gamma5);
-  const SpinMatrix p_m = (ComplexD)0.5 * (unit - gamma5);
+  const SpinMatrixT<T>& gamma5 = SpinMatrixConstantsT<T>::get_gamma5();
+  const SpinMatrixT<T>& unit = SpinMatrixConstantsT<T>::get_unit();
+  const SpinMatrixT<T> p_p = 0.5 * (unit + gamma5);
+  const SpinMatrixT<T> p_m = 0.5 * (unit - gamma5);
   const Geometry& geo = out.geo();
-  std::vector<ComplexD> bee(fa.ls), cee(fa.ls);
-  for (int m = 0; m < fa.ls; ++m) {
-    bee[m] = 1.0 + fa.bs[m] * (4.0 - fa.m5);
-    cee[m] = 1.0 - fa.cs[m] * (4.0 - fa.m5);
-  }
-  std::vector<ComplexD> lee(fa.ls - 1), leem(fa.ls - 1);
-  for (int m = 0; m < fa.ls - 1; ++m) {
-    lee[m] = -cee[m + 1] / bee[m];
-    leem[m] = m == 0 ? fa.mass * cee[fa.ls - 1] / bee[0]
-                     : leem[m - 1] * cee[m - 1] / bee[m];
-  }
-  std::vector<ComplexD> dee(fa.ls, 0.0);
-  dee[fa.ls - 1] = fa.mass * cee[fa.ls - 1];
-  for (int m = 0; m < fa.ls - 1; ++m) {
-    dee[fa.ls - 1] *= cee[m] / bee[m];
-  }
-  for (int m = 0; m < fa.ls; ++m) {
-    dee[m] += bee[m];
-  }
-  std::vector<ComplexD> uee(fa.ls - 1), ueem(fa.ls - 1);
-  for (int m = 0; m < fa.ls - 1; ++m) {
-    uee[m] = -cee[m] / bee[m];
-    ueem[m] =
-        m == 0 ? fa.mass * cee[0] / bee[0] : ueem[m - 1] * cee[m] / bee[m];
-  }
+  std::vector<ComplexD> lee, leem, dee, uee, ueem;
+  set_m_e_e_inv_coefs(lee, leem, dee, uee, ueem, fa);
   for (int m = 0; m < fa.ls; ++m) {
-    bee[m] = qconj(bee[m]);
-    cee[m] = qconj(cee[m]);
     dee[m] = qconj(dee[m]);
   }
   for (int m = 0; m < fa.ls - 1; ++m) {
@@ -1009,50 +1292,176 @@ inline void multiply_mdag_e_e_inv(FermionField5d& out, const FermionField5d& in,
     uee[m] = qconj(uee[m]);
     ueem[m] = qconj(ueem[m]);
   }
+  const int n_rhs = get_num_rhs(in, fa);
 #pragma omp parallel for
   for (Long index = 0; index < geo.local_volume(); ++index) {
     const Coordinate xl = geo.coordinate_from_index(index);
-    const Vector<WilsonVector> iv = in.get_elems_const(xl);
-    Vector<WilsonVector> v = out.get_elems(xl);
-    if (v.data() != iv.data()) {
-      std::memcpy(v.data(), iv.data(), iv.data_size());
+    const Vector<WilsonVectorT<T>> iv_all = in.get_elems_const(xl);
+    Vector<WilsonVectorT<T>> v_all = out.get_elems(xl);
+    for (int k = 0; k < n_rhs; ++k) {
+      const Vector<WilsonVectorT<T>> iv(iv_all.data() + k * fa.ls, fa.ls);
+      Vector<WilsonVectorT<T>> v(v_all.data() + k * fa.ls, fa.ls);
+      if (v.data() != iv.data()) {
+        std::memcpy(v.data(), iv.data(), iv.data_size());
+      }
+      WilsonVectorT<T> tmp;
+      // {U^m_{ee}}^\dagger^{-1}
+      set_zero(tmp);
+      for (int m = 0; m < fa.ls - 1; ++m) {
+        tmp += (ComplexT<T>)(-ueem[m]) * v[m];
+      }
+      v[fa.ls - 1] += p_p * tmp;
+      // {U^'_{ee}}^\dagger^{-1}
+      for (int m = 1; m < fa.ls; ++m) {
+        v[m] += (ComplexT<T>)(-uee[m - 1]) * (p_m * v[m - 1]);
+      }
+      // {D_{ee}}^\dagger^{-1}
+      for (int m = 0; m < fa.ls; ++m) {
+        v[m] *= (ComplexT<T>)(1.0 / dee[m]);
+      }
+      // {L'_{ee}}^\dagger^{-1}
+      for (int m = fa.ls - 2; m >= 0; --m) {
+        v[m] += (ComplexT<T>)(-lee[m]) * (p_p * v[m + 1]);
+      }
+      // {L^m_{ee}}^\dagger^{-1}
+      for (int m = 0; m < fa.ls - 1; ++m) {
+        v[m] += (ComplexT<T>)(-leem[m]) * (p_m * v[fa.ls - 1]);
+      }
+    }
+  }
+}
+
+template <class T, class GM>
+void multiply_wilson_hop_e_o_site(Vector<WilsonVectorT<T>> v, const Long index,
+                                  const FermionField5dT<T>& in,
+                                  const Field<GM>& gf,
+                                  const GeometryNeighborTable& nt_in,
+                                  const GeometryNeighborTable& nt_gf,
+                                  const array<SpinMatrixT<T>, 4>& p_mu_fwd,
+                                  const array<SpinMatrixT<T>, 4>& p_mu_bwd)
+// v -= \sum_mu U_mu(x) p_mu_fwd[mu] in(x+mu)
+//      + U_mu(x-mu)^\dagger p_mu_bwd[mu] in(x-mu)
+// x = geo.coordinate_from_index(index)
+// nt_in = get_geometry_neighbor_table(geo, in.geo())
+// nt_gf = get_geometry_neighbor_table(geo, gf.geo())
+// gf is GaugeFieldT<T> or CompressedGaugeFieldT<T>
+{
+  const int ls = v.size();
+  const Long* in_offsets = &nt_in.neighbor_offsets[index * 8];
+  const Long* gf_offsets = &nt_gf.neighbor_offsets[index * 8];
+  const Long gf_offset = nt_gf.site_offsets[index] * 4;
+  for (int mu = 0; mu < 4; ++mu) {
+    const ColorMatrixT<T>& u_p = get_gauge_link(gf, gf_offset + mu);
+    const ColorMatrixT<T> u_m =
+        matrix_adjoint(get_gauge_link(gf, gf_offsets[4 + mu] * 4 + mu));
+    const WilsonVectorT<T>* iv_p = &in.get_elem_offset(in_offsets[mu] * ls);
+    const WilsonVectorT<T>* iv_m =
+        &in.get_elem_offset(in_offsets[4 + mu] * ls);
+    for (int m = 0; m < ls; ++m) {
+      v[m] -= u_p * (p_mu_fwd[mu] * iv_p[m]);
+      v[m] -= u_m * (p_mu_bwd[mu] * iv_m[m]);
+    }
+  }
+}
+
+template <class T, int N, class GM>
+qacc void gauge_link_block_gather(T* block, const Field<GM>& gf,
+                                  const Long* offsets, const Int n)
+// Same as aligned_block_gather for the links at offsets[lane] of gf
+// (reconstructed on the fly if gf is a CompressedGaugeFieldT<T>)
+{
+  constexpr Int n_real = sizeof(ColorMatrixT<T>) / sizeof(T);
+  for (Int lane = 0; lane < n; ++lane) {
+    const ColorMatrixT<T>& u = get_gauge_link(gf, offsets[lane]);
+    const T* p = (const T*)&u;
+    for (Int c = 0; c < n_real; ++c) {
+      block[c * N + lane] = p[c];
     }
-    WilsonVector tmp;
-    // {U^m_{ee}}^\dagger^{-1}
-    set_zero(tmp);
-    for (int m = 0; m < fa.ls - 1; ++m) {
-      tmp += (ComplexD)(-ueem[m]) * v[m];
+  }
+}
+
+template <class T, class GM>
+void multiply_wilson_hop_e_o_block(FermionField5dT<T>& out,
+                                   const Long* indices, const int n,
+                                   const FermionField5dT<T>& in,
+                                   const Field<GM>& gf,
+                                   const GeometryNeighborTable& nt_in,
+                                   const GeometryNeighborTable& nt_gf,
+                                   const array<SpinMatrixT<T>, 4>& mp_mu_fwd,
+                                   const array<SpinMatrixT<T>, 4>& mp_mu_bwd)
+// Same as multiply_wilson_hop_e_o_site for the n sites indices[lane]
+// (0 < n <= N, with N = get_simd_n_lane<T>()).
+// Sites are gathered into structure-of-arrays blocks (see field-aligned.h),
+// one site per SIMD lane.
+// mp_mu_fwd[mu] = -p_mu_fwd[mu] ; mp_mu_bwd[mu] = -p_mu_bwd[mu]
+{
+  constexpr int N = get_simd_n_lane<T>();
+  constexpr int n_bytes = get_simd_n_bytes();
+  constexpr int n_real_cm = sizeof(ColorMatrixT<T>) / sizeof(T);
+  constexpr int n_real_wv = sizeof(WilsonVectorT<T>) / sizeof(T);
+  const int ls = out.multiplicity;
+  alignas(n_bytes) T u_p[4][n_real_cm * N];
+  alignas(n_bytes) T u_m[4][n_real_cm * N];
+  alignas(n_bytes) T iv[n_real_wv * N];
+  alignas(n_bytes) T pv[n_real_wv * N];
+  alignas(n_bytes) T acc[n_real_wv * N];
+  for (int i = 0; i < n_real_wv * N; ++i) {
+    iv[i] = 0;
+    acc[i] = 0;
+  }
+  Long cm_offsets[N];
+  for (int mu = 0; mu < 4; ++mu) {
+    for (int i = 0; i < n_real_cm * N; ++i) {
+      u_p[mu][i] = 0;
+      u_m[mu][i] = 0;
     }
-    v[fa.ls - 1] += p_p * tmp;
-    // {U^'_{ee}}^\dagger^{-1}
-    for (int m = 1; m < fa.ls; ++m) {
-      v[m] += (ComplexD)(-uee[m - 1]) * (p_m * v[m - 1]);
+    for (int lane = 0; lane < n; ++lane) {
+      const Long gf_offset = nt_gf.site_offsets[indices[lane]] * 4;
+      cm_offsets[lane] = gf_offset + mu;
     }
-    // {D_{ee}}^\dagger^{-1}
-    for (int m = 0; m < fa.ls; ++m) {
-      v[m] *= (ComplexD)(1.0 / dee[m]);
+    gauge_link_block_gather<T, N>(u_p[mu], gf, cm_offsets, n);
+    for (int lane = 0; lane < n; ++lane) {
+      const Long* gf_offsets = &nt_gf.neighbor_offsets[indices[lane] * 8];
+      cm_offsets[lane] = gf_offsets[4 + mu] * 4 + mu;
     }
-    // {L'_{ee}}^\dagger^{-1}
-    for (int m = fa.ls - 2; m >= 0; --m) {
-      v[m] += (ComplexD)(-lee[m]) * (p_p * v[m + 1]);
+    gauge_link_block_gather<T, N>(u_m[mu], gf, cm_offsets, n);
+  }
+  const WilsonVectorT<T>* wv_ptrs[N];
+  WilsonVectorT<T>* out_ptrs[N];
+  for (int m = 0; m < ls; ++m) {
+    for (int lane = 0; lane < n; ++lane) {
+      out_ptrs[lane] = &out.get_elem(indices[lane], m);
     }
-    // {L^m_{ee}}^\dagger^{-1}
-    for (int m = 0; m < fa.ls - 1; ++m) {
-      v[m] += (ComplexD)(-leem[m]) * (p_m * v[fa.ls - 1]);
+    aligned_block_gather<T, N>(acc, (const WilsonVectorT<T>* const*)out_ptrs,
+                               n);
+    for (int mu = 0; mu < 4; ++mu) {
+      for (int lane = 0; lane < n; ++lane) {
+        const Long* in_offsets = &nt_in.neighbor_offsets[indices[lane] * 8];
+        wv_ptrs[lane] = &in.get_elem_offset(in_offsets[mu] * ls + m);
+      }
+      aligned_block_gather<T, N>(iv, wv_ptrs, n);
+      aligned_spin_matrix_mul<T, N>(pv, mp_mu_fwd[mu], iv);
+      aligned_color_matrix_mul_add<T, N>(acc, u_p[mu], pv);
+      for (int lane = 0; lane < n; ++lane) {
+        const Long* in_offsets = &nt_in.neighbor_offsets[indices[lane] * 8];
+        wv_ptrs[lane] = &in.get_elem_offset(in_offsets[4 + mu] * ls + m);
+      }
+      aligned_block_gather<T, N>(iv, wv_ptrs, n);
+      aligned_spin_matrix_mul<T, N>(pv, mp_mu_bwd[mu], iv);
+      aligned_color_matrix_adj_mul_add<T, N>(acc, u_m[mu], pv);
     }
+    aligned_block_scatter<T, N>(out_ptrs, acc, n);
   }
 }
 
-inline void multiply_wilson_d_e_o_no_comm(FermionField5d& out,
-                                          const FermionField5d& in,
-                                          const GaugeField& gf)
-// set_left_expanded_gauge_field(gf, gf_);
-// in.geo() = geo_resize(geo, 1);
-// in.multiplicity = ls;
-// refresh_expanded_1(in);
+template <class T, class GM>
+Geometry init_wilson_hop_e_o_out(FermionField5dT<T>& out,
+                                 const FermionField5dT<T>& in,
+                                 const Field<GM>& gf)
+// return the geometry of out (with the opposite eo of in)
 {
-  TIMER("multiply_wilson_d_e_o_no_comm(5d,5d,gf)");
   qassert(&out != &in);
+  qassert(gf.multiplicity == 4);
   qassert(is_matching_geo(gf.geo(), in.geo()));
   qassert(in.geo().eo == 1 or in.geo().eo == 2);
   Geometry geo = geo_resize(in.geo());
@@ -1067,98 +1476,219 @@ inline void multiply_wilson_d_e_o_no_comm(FermionField5d& out,
   qassert(is_matching_geo(out.geo(), in.geo()));
   qassert(out.geo().eo != in.geo().eo);
   qassert(out.geo().eo == 1 or out.geo().eo == 2);
-  const array<SpinMatrix, 4>& gammas =
-      SpinMatrixConstants::get_cps_gammas();
-  const SpinMatrix& unit = SpinMatrixConstants::get_unit();
-  array<SpinMatrix, 4> p_mu_p;
-  array<SpinMatrix, 4> p_mu_m;
+  return geo;
+}
+
+template <class T>
+void set_wilson_hop_projectors(array<SpinMatrixT<T>, 4>& p_mu_p,
+                               array<SpinMatrixT<T>, 4>& p_mu_m)
+{
+  const array<SpinMatrixT<T>, 4>& gammas =
+      SpinMatrixConstantsT<T>::get_cps_gammas();
+  const SpinMatrixT<T>& unit = SpinMatrixConstantsT<T>::get_unit();
   for (int mu = 0; mu < 4; ++mu) {
-    p_mu_p[mu] = (ComplexD)0.5 * (unit + gammas[mu]);
-    p_mu_m[mu] = (ComplexD)0.5 * (unit - gammas[mu]);
+    p_mu_p[mu] = 0.5 * (unit + gammas[mu]);
+    p_mu_m[mu] = 0.5 * (unit - gammas[mu]);
+  }
+}
+
+template <class T>
+void set_wilson_hop_neg_projectors(array<SpinMatrixT<T>, 4>& mp_mu_p,
+                                   array<SpinMatrixT<T>, 4>& mp_mu_m)
+// negative of set_wilson_hop_projectors (used by the block kernel)
+{
+  const array<SpinMatrixT<T>, 4>& gammas =
+      SpinMatrixConstantsT<T>::get_cps_gammas();
+  const SpinMatrixT<T>& unit = SpinMatrixConstantsT<T>::get_unit();
+  for (int mu = 0; mu < 4; ++mu) {
+    mp_mu_p[mu] = -0.5 * (unit + gammas[mu]);
+    mp_mu_m[mu] = -0.5 * (unit - gammas[mu]);
   }
+}
+
+template <class T, class GM>
+void multiply_wilson_d_e_o_no_comm(FermionField5dT<T>& out,
+                                   const FermionField5dT<T>& in,
+                                   const Field<GM>& gf)
+// set_left_expanded_gauge_field(gf, gf_);
+// in.geo() = geo_resize(geo, 1);
+// in.multiplicity = ls;
+// refresh_expanded_1(in);
+// gf can also be the CompressedGaugeFieldT<T> of the expanded gf
+{
+  TIMER("multiply_wilson_d_e_o_no_comm(5d,5d,gf)");
+  const Geometry geo = init_wilson_hop_e_o_out(out, in, gf);
+  array<SpinMatrixT<T>, 4> p_mu_p;
+  array<SpinMatrixT<T>, 4> p_mu_m;
+  set_wilson_hop_projectors(p_mu_p, p_mu_m);
+  QLAT_PUSH_DIAGNOSTIC_DISABLE_DANGLING_REF;
+  const GeometryNeighborTable& nt_in =
+      get_geometry_neighbor_table(geo, in.geo());
+  const GeometryNeighborTable& nt_gf =
+      get_geometry_neighbor_table(geo, gf.geo());
+  QLAT_DIAGNOSTIC_POP;
+  if (is_wilson_hop_aligned()) {
+    constexpr int N = get_simd_n_lane<T>();
+    const Long n_block = (geo.local_volume() + N - 1) / N;
+    array<SpinMatrixT<T>, 4> mp_mu_p;
+    array<SpinMatrixT<T>, 4> mp_mu_m;
+    set_wilson_hop_neg_projectors(mp_mu_p, mp_mu_m);
 #pragma omp parallel for
-  for (Long index = 0; index < geo.local_volume(); ++index) {
-    const Coordinate xl = geo.coordinate_from_index(index);
-    Vector<WilsonVector> v = out.get_elems(xl);
-    for (int mu = 0; mu < 4; ++mu) {
-      const Coordinate xl_p = coordinate_shifts(xl, mu);
-      const Coordinate xl_m = coordinate_shifts(xl, -mu - 1);
-      const ColorMatrix u_p = gf.get_elem(xl, mu);
-      const ColorMatrix u_m = matrix_adjoint(gf.get_elem(xl_m, mu));
-      const Vector<WilsonVector> iv_p = in.get_elems_const(xl_p);
-      const Vector<WilsonVector> iv_m = in.get_elems_const(xl_m);
-      for (int m = 0; m < ls; ++m) {
-        v[m] -= u_p * (p_mu_m[mu] * iv_p[m]);
-        v[m] -= u_m * (p_mu_p[mu] * iv_m[m]);
+    for (Long block = 0; block < n_block; ++block) {
+      Long indices[N];
+      const int n = std::min((Long)N, geo.local_volume() - block * N);
+      for (int lane = 0; lane < n; ++lane) {
+        indices[lane] = block * N + lane;
       }
+      multiply_wilson_hop_e_o_block(out, indices, n, in, gf, nt_in, nt_gf,
+                                    mp_mu_m, mp_mu_p);
     }
+    return;
+  }
+#pragma omp parallel for
+  for (Long index = 0; index < geo.local_volume(); ++index) {
+    multiply_wilson_hop_e_o_site(out.get_elems(index), index, in, gf, nt_in,
+                                 nt_gf, p_mu_m, p_mu_p);
   }
 }
 
-inline void multiply_wilson_ddag_e_o_no_comm(FermionField5d& out,
-                                             const FermionField5d& in,
-                                             const GaugeField& gf)
+template <class T, class GM>
+void multiply_wilson_ddag_e_o_no_comm(FermionField5dT<T>& out,
+                                      const FermionField5dT<T>& in,
+                                      const Field<GM>& gf)
 // set_left_expanded_gauge_field(gf, gf_);
 // in.geo() = geo_resize(geo, 1);
 // in.multiplicity = ls;
 // refresh_expanded_1(in);
+// gf can also be the CompressedGaugeFieldT<T> of the expanded gf
 {
   TIMER("multiply_wilson_ddag_e_o_no_comm(5d,5d,gf)");
-  qassert(&out != &in);
-  qassert(is_matching_geo(gf.geo(), in.geo()));
-  qassert(in.geo().eo == 1 or in.geo().eo == 2);
-  Geometry geo = geo_resize(in.geo());
-  geo.eo = 3 - in.geo().eo;
-  if (is_initialized(out) and out.geo().eo == 3 - geo.eo) {
-    out.geo().eo = geo.eo;
-  }
-  out.init(geo, in.multiplicity);
-  set_zero(out);
-  const int ls = in.multiplicity;
-  qassert(out.multiplicity == ls);
-  qassert(is_matching_geo(out.geo(), in.geo()));
-  qassert(out.geo().eo != in.geo().eo);
-  qassert(out.geo().eo == 1 or out.geo().eo == 2);
-  const array<SpinMatrix, 4>& gammas =
-      SpinMatrixConstants::get_cps_gammas();
-  const SpinMatrix& unit = SpinMatrixConstants::get_unit();
-  array<SpinMatrix, 4> p_mu_p;
-  array<SpinMatrix, 4> p_mu_m;
-  for (int mu = 0; mu < 4; ++mu) {
-    p_mu_p[mu] = (ComplexD)0.5 * (unit + gammas[mu]);
-    p_mu_m[mu] = (ComplexD)0.5 * (unit - gammas[mu]);
-  }
+  const Geometry geo = init_wilson_hop_e_o_out(out, in, gf);
+  array<SpinMatrixT<T>, 4> p_mu_p;
+  array<SpinMatrixT<T>, 4> p_mu_m;
+  set_wilson_hop_projectors(p_mu_p, p_mu_m);
+  QLAT_PUSH_DIAGNOSTIC_DISABLE_DANGLING_REF;
+  const GeometryNeighborTable& nt_in =
+      get_geometry_neighbor_table(geo, in.geo());
+  const GeometryNeighborTable& nt_gf =
+      get_geometry_neighbor_table(geo, gf.geo());
+  QLAT_DIAGNOSTIC_POP;
+  if (is_wilson_hop_aligned()) {
+    constexpr int N = get_simd_n_lane<T>();
+    const Long n_block = (geo.local_volume() + N - 1) / N;
+    array<SpinMatrixT<T>, 4> mp_mu_p;
+    array<SpinMatrixT<T>, 4> mp_mu_m;
+    set_wilson_hop_neg_projectors(mp_mu_p, mp_mu_m);
 #pragma omp parallel for
-  for (Long index = 0; index < geo.local_volume(); ++index) {
-    const Coordinate xl = geo.coordinate_from_index(index);
-    Vector<WilsonVector> v = out.get_elems(xl);
-    for (int mu = 0; mu < 4; ++mu) {
-      const Coordinate xl_p = coordinate_shifts(xl, mu);
-      const Coordinate xl_m = coordinate_shifts(xl, -mu - 1);
-      const ColorMatrix u_p = gf.get_elem(xl, mu);
-      const ColorMatrix u_m = matrix_adjoint(gf.get_elem(xl_m, mu));
-      const Vector<WilsonVector> iv_p = in.get_elems_const(xl_p);
-      const Vector<WilsonVector> iv_m = in.get_elems_const(xl_m);
-      for (int m = 0; m < ls; ++m) {
-        v[m] -= u_p * (p_mu_p[mu] * iv_p[m]);
-        v[m] -= u_m * (p_mu_m[mu] * iv_m[m]);
+    for (Long block = 0; block < n_block; ++block) {
+      Long indices[N];
+      const int n = std::min((Long)N, geo.local_volume() - block * N);
+      for (int lane = 0; lane < n; ++lane) {
+        indices[lane] = block * N + lane;
       }
+      multiply_wilson_hop_e_o_block(out, indices, n, in, gf, nt_in, nt_gf,
+                                    mp_mu_p, mp_mu_m);
     }
+    return;
+  }
+#pragma omp parallel for
+  for (Long index = 0; index < geo.local_volume(); ++index) {
+    multiply_wilson_hop_e_o_site(out.get_elems(index), index, in, gf, nt_in,
+                                 nt_gf, p_mu_p, p_mu_m);
   }
 }
 
-inline void multiply_m_e_o(FermionField5d& out, const FermionField5d& in,
-                           const GaugeField& gf, const FermionAction& fa)
+template <class T, class GM>
+void multiply_wilson_d_e_o_comm_overlap(FermionField5dT<T>& out,
+                                        FermionField5dT<T>& in,
+                                        const Field<GM>& gf)
+// set_left_expanded_gauge_field(gf, gf_);
+// in.geo() = geo_resize(geo, 1);
+// in.multiplicity = ls;
+// Same as refresh_expanded_1(in); multiply_wilson_d_e_o_no_comm(out, in, gf);
+// but the interior sites are computed while the halo of in is in flight.
+{
+  TIMER("multiply_wilson_d_e_o_comm_overlap(5d,5d,gf)");
+  const Geometry geo = init_wilson_hop_e_o_out(out, in, gf);
+  array<SpinMatrixT<T>, 4> p_mu_p;
+  array<SpinMatrixT<T>, 4> p_mu_m;
+  set_wilson_hop_projectors(p_mu_p, p_mu_m);
+  QLAT_PUSH_DIAGNOSTIC_DISABLE_DANGLING_REF;
+  const GeometryNeighborTable& nt_in =
+      get_geometry_neighbor_table(geo, in.geo());
+  const GeometryNeighborTable& nt_gf =
+      get_geometry_neighbor_table(geo, gf.geo());
+  QLAT_DIAGNOSTIC_POP;
+  if (is_wilson_hop_aligned()) {
+    constexpr int N = get_simd_n_lane<T>();
+    array<SpinMatrixT<T>, 4> mp_mu_p;
+    array<SpinMatrixT<T>, 4> mp_mu_m;
+    set_wilson_hop_neg_projectors(mp_mu_p, mp_mu_m);
+    refresh_expanded_1_overlap_blocks<N>(
+        in, geo, [&](const Long* indices, const int n) {
+          multiply_wilson_hop_e_o_block(out, indices, n, in, gf, nt_in, nt_gf,
+                                        mp_mu_m, mp_mu_p);
+        });
+    return;
+  }
+  refresh_expanded_1_overlap(in, geo, [&](const Long index) {
+    multiply_wilson_hop_e_o_site(out.get_elems(index), index, in, gf, nt_in,
+                                 nt_gf, p_mu_m, p_mu_p);
+  });
+}
+
+template <class T, class GM>
+void multiply_wilson_ddag_e_o_comm_overlap(FermionField5dT<T>& out,
+                                           FermionField5dT<T>& in,
+                                           const Field<GM>& gf)
+// set_left_expanded_gauge_field(gf, gf_);
+// in.geo() = geo_resize(geo, 1);
+// in.multiplicity = ls;
+// Same as refresh_expanded_1(in); multiply_wilson_ddag_e_o_no_comm(out, in,
+// gf); but the interior sites are computed while the halo of in is in flight.
+{
+  TIMER("multiply_wilson_ddag_e_o_comm_overlap(5d,5d,gf)");
+  const Geometry geo = init_wilson_hop_e_o_out(out, in, gf);
+  array<SpinMatrixT<T>, 4> p_mu_p;
+  array<SpinMatrixT<T>, 4> p_mu_m;
+  set_wilson_hop_projectors(p_mu_p, p_mu_m);
+  QLAT_PUSH_DIAGNOSTIC_DISABLE_DANGLING_REF;
+  const GeometryNeighborTable& nt_in =
+      get_geometry_neighbor_table(geo, in.geo());
+  const GeometryNeighborTable& nt_gf =
+      get_geometry_neighbor_table(geo, gf.geo());
+  QLAT_DIAGNOSTIC_POP;
+  if (is_wilson_hop_aligned()) {
+    constexpr int N = get_simd_n_lane<T>();
+    array<SpinMatrixT<T>, 4> mp_mu_p;
+    array<SpinMatrixT<T>, 4> mp_mu_m;
+    set_wilson_hop_neg_projectors(mp_mu_p, mp_mu_m);
+    refresh_expanded_1_overlap_blocks<N>(
+        in, geo, [&](const Long* indices, const int n) {
+          multiply_wilson_hop_e_o_block(out, indices, n, in, gf, nt_in, nt_gf,
+                                        mp_mu_p, mp_mu_m);
+        });
+    return;
+  }
+  refresh_expanded_1_overlap(in, geo, [&](const Long index) {
+    multiply_wilson_hop_e_o_site(out.get_elems(index), index, in, gf, nt_in,
+                                 nt_gf, p_mu_p, p_mu_m);
+  });
+}
+
+template <class T>
+void multiply_m_e_o(FermionField5dT<T>& out, const FermionField5dT<T>& in,
+                    const GaugeFieldT<T>& gf, const FermionAction& fa)
 // out can be the same object as in
 // works for _o_e as well
 {
   TIMER("multiply_m_e_o(5d,5d,gf,fa)");
-  const SpinMatrix& gamma5 = SpinMatrixConstants::get_gamma5();
-  const SpinMatrix& unit = SpinMatrixConstants::get_unit();
-  const SpinMatrix p_p = (ComplexD)0.5 * (unit + gamma5);
-  const SpinMatrix p_m = (ComplexD)0.5 * (unit - gamma5);
+  const SpinMatrixT<T>& gamma5 = SpinMatrixConstantsT<T>::get_gamma5();
+  const SpinMatrixT<T>& unit = SpinMatrixConstantsT<T>::get_unit();
+  const SpinMatrixT<T> p_p = 0.5 * (unit + gamma5);
+  const SpinMatrixT<T> p_m = 0.5 * (unit - gamma5);
   const int in_geo_eo = in.geo().eo;
-  FermionField5d in1;
+  FermionField5dT<T> in1;
   in1.init(geo_resize(in.geo(), 1), in.multiplicity);
   const Geometry& geo = in.geo();
   std::vector<ComplexD> beo(fa.ls), ceo(fa.ls);
@@ -1166,41 +1696,45 @@ inline void multiply_m_e_o(FermionField5d& out, const FermionField5d& in,
     beo[m] = fa.bs[m];
     ceo[m] = -fa.cs[m];
   }
+  const ComplexT<T> mmass = -fa.mass;
+  const int n_rhs = get_num_rhs(in, fa);
 #pragma omp parallel for
   for (Long index = 0; index < geo.local_volume(); ++index) {
     const Coordinate xl = geo.coordinate_from_index(index);
-    const Vector<WilsonVector> iv = in.get_elems_const(xl);
-    Vector<WilsonVector> v = in1.get_elems(xl);
-    for (int m = 0; m < fa.ls; ++m) {
-      v[m] = (ComplexD)beo[m] * iv[m];
-      const WilsonVector tmp =
-          (p_m * (m < fa.ls - 1
-                      ? iv[m + 1]
-                      : (WilsonVector)((ComplexD)(-fa.mass) * iv[0]))) +
-          (p_p * (m > 0
-                      ? iv[m - 1]
-                      : (WilsonVector)((ComplexD)(-fa.mass) * iv[fa.ls - 1])));
-      v[m] -= (ComplexD)ceo[m] * tmp;
+    const Vector<WilsonVectorT<T>> iv_all = in.get_elems_const(xl);
+    Vector<WilsonVectorT<T>> v_all = in1.get_elems(xl);
+    for (int k = 0; k < n_rhs; ++k) {
+      const Vector<WilsonVectorT<T>> iv(iv_all.data() + k * fa.ls, fa.ls);
+      Vector<WilsonVectorT<T>> v(v_all.data() + k * fa.ls, fa.ls);
+      for (int m = 0; m < fa.ls; ++m) {
+        v[m] = (ComplexT<T>)beo[m] * iv[m];
+        const WilsonVectorT<T> iv_p =
+            m < fa.ls - 1 ? iv[m + 1] : (WilsonVectorT<T>)(mmass * iv[0]);
+        const WilsonVectorT<T> iv_m =
+            m > 0 ? iv[m - 1] : (WilsonVectorT<T>)(mmass * iv[fa.ls - 1]);
+        const WilsonVectorT<T> tmp = (p_m * iv_p) + (p_p * iv_m);
+        v[m] -= (ComplexT<T>)ceo[m] * tmp;
+      }
     }
   }
-  refresh_expanded_1(in1);
-  multiply_wilson_d_e_o_no_comm(out, in1, gf);
+  multiply_wilson_d_e_o_comm_overlap(out, in1, gf);
   qassert(is_matching_geo(out.geo(), in.geo()));
   qassert(out.geo().eo != in_geo_eo);
   qassert(in.geo().eo == 1 or in.geo().eo == 2);
   qassert(out.geo().eo == 1 or out.geo().eo == 2);
 }
 
-inline void multiply_mdag_e_o(FermionField5d& out, const FermionField5d& in,
-                              const GaugeField& gf, const FermionAction& fa)
+template <class T>
+void multiply_mdag_e_o(FermionField5dT<T>& out, const FermionField5dT<T>& in,
+                       const GaugeFieldT<T>& gf, const FermionAction& fa)
 // out can be the same object as in
 // works for _o_e as well
 {
   TIMER("multiply_mdag_e_o(5d,5d,gf,fa)");
-  const SpinMatrix& gamma5 = SpinMatrixConstants::get_gamma5();
-  const SpinMatrix& unit = SpinMatrixConstants::get_unit();
-  const SpinMatrix p_p = (ComplexD)0.5 * (unit + gamma5);
-  const SpinMatrix p_m = (ComplexD)0.5 * (unit - gamma5);
+  const SpinMatrixT<T>& gamma5 = SpinMatrixConstantsT<T>::get_gamma5();
+  const SpinMatrixT<T>& unit = SpinMatrixConstantsT<T>::get_unit();
+  const SpinMatrixT<T> p_p = 0.5 * (unit + gamma5);
+  const SpinMatrixT<T> p_m = 0.5 * (unit - gamma5);
   const int in_geo_eo = in.geo().eo;
   qassert(is_matching_geo(gf.geo(), in.geo()));
   qassert(in.geo().eo == 1 or in.geo().eo == 2);
@@ -1211,36 +1745,41 @@ inline void multiply_mdag_e_o(FermionField5d& out, const FermionField5d& in,
     beo[m] = qconj(fa.bs[m]);
     ceo[m] = qconj(-fa.cs[m]);
   }
-  FermionField5d in1;
+  FermionField5dT<T> in1;
   in1.init(geo_resize(in.geo(), 1), in.multiplicity);
   in1 = in;
-  refresh_expanded_1(in1);
-  FermionField5d out1;
-  multiply_wilson_ddag_e_o_no_comm(out1, in1, gf);
+  FermionField5dT<T> out1;
+  multiply_wilson_ddag_e_o_comm_overlap(out1, in1, gf);
   in1.init();
   if (is_initialized(out) and out.geo().eo == 3 - geo.eo) {
     out.geo().eo = geo.eo;
   }
   out.init(geo, in.multiplicity);
+  const ComplexT<T> mmass_ceo_0 =
+      (ComplexT<T>)(-qconj((ComplexD)fa.mass) * ceo[0]);
+  const ComplexT<T> mmass_ceo_l =
+      (ComplexT<T>)(-qconj((ComplexD)fa.mass) * ceo[fa.ls - 1]);
+  const int n_rhs = get_num_rhs(in, fa);
 #pragma omp parallel for
   for (Long index = 0; index < geo.local_volume(); ++index) {
     const Coordinate xl = geo.coordinate_from_index(index);
-    const Vector<WilsonVector> iv = out1.get_elems_const(xl);
-    Vector<WilsonVector> v = out.get_elems(xl);
-    for (int m = 0; m < fa.ls; ++m) {
-      v[m] = (ComplexD)beo[m] * iv[m];
-      const WilsonVector tmp =
-          (p_p * (m < fa.ls - 1
-                      ? (WilsonVector)((ComplexD)ceo[m + 1] * iv[m + 1])
-                      : (WilsonVector)(
-                            (ComplexD)(-qconj((ComplexD)fa.mass) * ceo[0]) *
-                            iv[0]))) +
-          (p_m * (m > 0
-                      ? (WilsonVector)((ComplexD)ceo[m - 1] * iv[m - 1])
-                      : (WilsonVector)((ComplexD)(-qconj((ComplexD)fa.mass) *
-                                                  ceo[fa.ls - 1]) *
-                                       iv[fa.ls - 1])));
-      v[m] -= tmp;
+    const Vector<WilsonVectorT<T>> iv_all = out1.get_elems_const(xl);
+    Vector<WilsonVectorT<T>> v_all = out.get_elems(xl);
+    for (int k = 0; k < n_rhs; ++k) {
+      const Vector<WilsonVectorT<T>> iv(iv_all.data() + k * fa.ls, fa.ls);
+      Vector<WilsonVectorT<T>> v(v_all.data() + k * fa.ls, fa.ls);
+      for (int m = 0; m < fa.ls; ++m) {
+        v[m] = (ComplexT<T>)beo[m] * iv[m];
+        const WilsonVectorT<T> iv_p =
+            m < fa.ls - 1
+                ? (WilsonVectorT<T>)((ComplexT<T>)ceo[m + 1] * iv[m + 1])
+                : (WilsonVectorT<T>)(mmass_ceo_0 * iv[0]);
+        const WilsonVectorT<T> iv_m =
+            m > 0 ? (WilsonVectorT<T>)((ComplexT<T>)ceo[m - 1] * iv[m - 1])
+                  : (WilsonVectorT<T>)(mmass_ceo_l * iv[fa.ls - 1]);
+        const WilsonVectorT<T> tmp = (p_p * iv_p) + (p_m * iv_m);
+        v[m] -= tmp;
+      }
     }
   }
   qassert(is_matching_geo(out.geo(), in.geo()));
@@ -1289,13 +1828,14 @@ inline void multiply_mdag(FermionField5d& out, const FermionField5d& in,
   set_half_fermion(out, out_o, 1);
 }
 
-inline void multiply_mpc_sym2(FermionField5d& out, const FermionField5d& in,
-                              const GaugeField& gf, const FermionAction& fa)
+template <class T>
+void multiply_mpc_sym2(FermionField5dT<T>& out, const FermionField5dT<T>& in,
+                       const GaugeFieldT<T>& gf, const FermionAction& fa)
 // out can be the same object as in
 // odd <- odd (works for even <- even as well)
 {
   TIMER("multiply_mpc_sym2");
-  FermionField5d tmp;
+  FermionField5dT<T> tmp;
   multiply_m_e_e_inv(tmp, in, fa);
   multiply_m_e_o(tmp, tmp, gf, fa);
   multiply_m_e_e_inv(tmp, tmp, fa);
@@ -1308,13 +1848,14 @@ inline void multiply_mpc_sym2(FermionField5d& out, const FermionField5d& in,
   out -= tmp;
 }
 
-inline void multiply_mpcdag_sym2(FermionField5d& out, const FermionField5d& in,
-                                 const GaugeField& gf, const FermionAction& fa)
+template <class T>
+void multiply_mpcdag_sym2(FermionField5dT<T>& out, const FermionField5dT<T>& in,
+                          const GaugeFieldT<T>& gf, const FermionAction& fa)
 // out can be the same object as in
 // odd <- odd (works for even <- even as well)
 {
   TIMER("multiply_mpcdag_sym2");
-  FermionField5d tmp;
+  FermionField5dT<T> tmp;
   multiply_mdag_e_o(tmp, in, gf, fa);
   multiply_mdag_e_e_inv(tmp, tmp, fa);
   multiply_mdag_e_o(tmp, tmp, gf, fa);
@@ -1327,15 +1868,484 @@ inline void multiply_mpcdag_sym2(FermionField5d& out, const FermionField5d& in,
   out -= tmp;
 }
 
-inline void multiply_hermop_sym2(FermionField5d& out, const FermionField5d& in,
-                                 const GaugeField& gf, const FermionAction& fa)
+template <class T>
+void multiply_hermop_sym2(FermionField5dT<T>& out, const FermionField5dT<T>& in,
+                          const GaugeFieldT<T>& gf, const FermionAction& fa)
 // out can be the same object as in
 // odd <- odd (works for even <- even as well)
 {
   TIMER_FLOPS("multiply_hermop_sym2");
   multiply_mpc_sym2(out, in, gf, fa);
   multiply_mpcdag_sym2(out, out, gf, fa);
-  timer.flops += 5500 * fa.ls * gf.geo().local_volume();
+  timer.flops += 5500 * in.multiplicity * gf.geo().local_volume();
+}
+
+// --------------------
+// The even-odd preconditioned operator on fermion fields in the AlignedField
+// layout (see field-aligned.h). The links are the WilsonHopLinksT of the left
+// expanded gf. The inverters keep the CG vectors in this layout for all the
+// iterations (see cg_with_herm_sym_2).
+// gamma5 = diag(1, 1, -1, -1): (1 + gamma5) / 2 keeps the first and
+// (1 - gamma5) / 2 the last 2 * NUM_COLOR complex numbers of a WilsonVector.
+
+template <class T>
+int get_num_rhs(const AlignedField<WilsonVectorT<T>>& ff,
+                const FermionAction& fa)
+{
+  qassert(fa.ls > 0);
+  qassert(ff.multiplicity % fa.ls == 0);
+  return ff.multiplicity / fa.ls;
+}
+
+template <class T>
+void multiply_wilson_hop_e_o_aligned_block(
+    AlignedField<WilsonVectorT<T>>& out, const Long block,
+    const AlignedField<WilsonVectorT<T>>& in,
+    const AlignedField<ColorMatrixT<T>>& links,
+    const GeometryNeighborTable& nt_in, const AlignedSiteTable& ast_in,
+    const array<SpinMatrixT<T>, 4>& mp_mu_fwd,
+    const array<SpinMatrixT<T>, 4>& mp_mu_bwd)
+// Same as multiply_wilson_hop_e_o_block for the sites of the block-th block of
+// out. The links (links.get_block_const(block, dir)) and out are used in
+// place. Only the neighbors in in are loaded lane by lane.
+// The padding lanes have zero links, so they stay zero.
+// ast_in = get_aligned_site_table(in.geo(), N)
+{
+  constexpr int N = AlignedField<WilsonVectorT<T>>::N;
+  constexpr int n_bytes = get_simd_n_bytes();
+  constexpr int n_real_wv = AlignedField<WilsonVectorT<T>>::n_real;
+  const int ls = out.multiplicity;
+  const Long local_volume = out.geo().local_volume();
+  Long iv_idx[8][N];
+  for (int lane = 0; lane < N; ++lane) {
+    const Long index = block * N + lane;
+    for (int dir = 0; dir < 8; ++dir) {
+      const Long position =
+          index < local_volume
+              ? ast_in.positions[nt_in.neighbor_offsets[index * 8 + dir]]
+              : 0;
+      iv_idx[dir][lane] = in.get_real_index(position, 0);
+    }
+  }
+  alignas(n_bytes) T iv[n_real_wv * N];
+  alignas(n_bytes) T pv[n_real_wv * N];
+  for (int m = 0; m < ls; ++m) {
+    T* acc = out.get_block(block, m);
+    const Long m_idx = m * n_real_wv * N;
+    for (int dir = 0; dir < 8; ++dir) {
+      for (int c = 0; c < n_real_wv; ++c) {
+        for (int lane = 0; lane < N; ++lane) {
+          iv[c * N + lane] = in.data[iv_idx[dir][lane] + m_idx + c * N];
+        }
+      }
+      aligned_spin_matrix_mul<T, N>(
+          pv, dir < 4 ? mp_mu_fwd[dir] : mp_mu_bwd[dir - 4], iv);
+      aligned_color_matrix_mul_add<T, N>(acc, links.get_block_const(block, dir),
+                                         pv);
+    }
+  }
+}
+
+template <class T>
+Geometry init_wilson_hop_e_o_out(AlignedField<WilsonVectorT<T>>& out,
+                                 const AlignedField<WilsonVectorT<T>>& in,
+                                 const WilsonHopLinksT<T>& hl)
+// return the geometry of out (with the opposite eo of in)
+{
+  qassert(&out != &in);
+  qassert(is_initialized(hl));
+  qassert(is_matching_geo(hl.links[0].geo(), in.geo()));
+  qassert(in.geo().eo == 1 or in.geo().eo == 2);
+  Geometry geo = geo_resize(in.geo());
+  geo.eo = 3 - in.geo().eo;
+  if (is_initialized(out) and out.geo().eo == 3 - geo.eo) {
+    out.geo().eo = geo.eo;
+  }
+  out.init(geo, in.multiplicity);
+  set_zero(out);
+  qassert(out.multiplicity == in.multiplicity);
+  qassert(out.geo().eo != in.geo().eo);
+  return geo;
+}
+
+template <class T>
+void multiply_wilson_d_e_o_no_comm(AlignedField<WilsonVectorT<T>>& out,
+                                   const AlignedField<WilsonVectorT<T>>& in,
+                                   const WilsonHopLinksT<T>& hl)
+// in.geo() = geo_resize(geo, 1);
+// refresh_expanded_1(in);
+{
+  TIMER("multiply_wilson_d_e_o_no_comm(af,af,hl)");
+  constexpr int N = AlignedField<WilsonVectorT<T>>::N;
+  const Geometry geo = init_wilson_hop_e_o_out(out, in, hl);
+  const AlignedField<ColorMatrixT<T>>& links = hl.links[geo.eo - 1];
+  array<SpinMatrixT<T>, 4> mp_mu_p;
+  array<SpinMatrixT<T>, 4> mp_mu_m;
+  set_wilson_hop_neg_projectors(mp_mu_p, mp_mu_m);
+  QLAT_PUSH_DIAGNOSTIC_DISABLE_DANGLING_REF;
+  const GeometryNeighborTable& nt_in =
+      get_geometry_neighbor_table(geo, in.geo());
+  const AlignedSiteTable& ast_in = get_aligned_site_table(in.geo(), N);
+  QLAT_DIAGNOSTIC_POP;
+#pragma omp parallel for
+  for (Long block = 0; block < out.n_block_local; ++block) {
+    multiply_wilson_hop_e_o_aligned_block(out, block, in, links, nt_in, ast_in,
+                                          mp_mu_m, mp_mu_p);
+  }
+}
+
+template <class T>
+void multiply_wilson_ddag_e_o_no_comm(AlignedField<WilsonVectorT<T>>& out,
+                                      const AlignedField<WilsonVectorT<T>>& in,
+                                      const WilsonHopLinksT<T>& hl)
+// in.geo() = geo_resize(geo, 1);
+// refresh_expanded_1(in);
+{
+  TIMER("multiply_wilson_ddag_e_o_no_comm(af,af,hl)");
+  constexpr int N = AlignedField<WilsonVectorT<T>>::N;
+  const Geometry geo = init_wilson_hop_e_o_out(out, in, hl);
+  const AlignedField<ColorMatrixT<T>>& links = hl.links[geo.eo - 1];
+  array<SpinMatrixT<T>, 4> mp_mu_p;
+  array<SpinMatrixT<T>, 4> mp_mu_m;
+  set_wilson_hop_neg_projectors(mp_mu_p, mp_mu_m);
+  QLAT_PUSH_DIAGNOSTIC_DISABLE_DANGLING_REF;
+  const GeometryNeighborTable& nt_in =
+      get_geometry_neighbor_table(geo, in.geo());
+  const AlignedSiteTable& ast_in = get_aligned_site_table(in.geo(), N);
+  QLAT_DIAGNOSTIC_POP;
+#pragma omp parallel for
+  for (Long block = 0; block < out.n_block_local; ++block) {
+    multiply_wilson_hop_e_o_aligned_block(out, block, in, links, nt_in, ast_in,
+                                          mp_mu_p, mp_mu_m);
+  }
+}
+
+template <class T>
+void multiply_wilson_d_e_o_comm_overlap(AlignedField<WilsonVectorT<T>>& out,
+                                        AlignedField<WilsonVectorT<T>>& in,
+                                        const WilsonHopLinksT<T>& hl)
+// in.geo() = geo_resize(geo, 1);
+// Same as refresh_expanded_1(in); multiply_wilson_d_e_o_no_comm(out, in, hl);
+// but the interior blocks are computed while the halo of in is in flight.
+{
+  TIMER("multiply_wilson_d_e_o_comm_overlap(af,af,hl)");
+  constexpr int N = AlignedField<WilsonVectorT<T>>::N;
+  const Geometry geo = init_wilson_hop_e_o_out(out, in, hl);
+  const AlignedField<ColorMatrixT<T>>& links = hl.links[geo.eo - 1];
+  array<SpinMatrixT<T>, 4> mp_mu_p;
+  array<SpinMatrixT<T>, 4> mp_mu_m;
+  set_wilson_hop_neg_projectors(mp_mu_p, mp_mu_m);
+  QLAT_PUSH_DIAGNOSTIC_DISABLE_DANGLING_REF;
+  const GeometryNeighborTable& nt_in =
+      get_geometry_neighbor_table(geo, in.geo());
+  const AlignedSiteTable& ast_in = get_aligned_site_table(in.geo(), N);
+  QLAT_DIAGNOSTIC_POP;
+  refresh_expanded_1_overlap_aligned<N>(in, geo, [&](const Long block) {
+    multiply_wilson_hop_e_o_aligned_block(out, block, in, links, nt_in, ast_in,
+                                          mp_mu_m, mp_mu_p);
+  });
+}
+
+template <class T>
+void multiply_wilson_ddag_e_o_comm_overlap(AlignedField<WilsonVectorT<T>>& out,
+                                           AlignedField<WilsonVectorT<T>>& in,
+                                           const WilsonHopLinksT<T>& hl)
+// in.geo() = geo_resize(geo, 1);
+// Same as refresh_expanded_1(in); multiply_wilson_ddag_e_o_no_comm(out, in,
+// hl); but the interior blocks are computed while the halo of in is in flight.
+{
+  TIMER("multiply_wilson_ddag_e_o_comm_overlap(af,af,hl)");
+  constexpr int N = AlignedField<WilsonVectorT<T>>::N;
+  const Geometry geo = init_wilson_hop_e_o_out(out, in, hl);
+  const AlignedField<ColorMatrixT<T>>& links = hl.links[geo.eo - 1];
+  array<SpinMatrixT<T>, 4> mp_mu_p;
+  array<SpinMatrixT<T>, 4> mp_mu_m;
+  set_wilson_hop_neg_projectors(mp_mu_p, mp_mu_m);
+  QLAT_PUSH_DIAGNOSTIC_DISABLE_DANGLING_REF;
+  const GeometryNeighborTable& nt_in =
+      get_geometry_neighbor_table(geo, in.geo());
+  const AlignedSiteTable& ast_in = get_aligned_site_table(in.geo(), N);
+  QLAT_DIAGNOSTIC_POP;
+  refresh_expanded_1_overlap_aligned<N>(in, geo, [&](const Long block) {
+    multiply_wilson_hop_e_o_aligned_block(out, block, in, links, nt_in, ast_in,
+                                          mp_mu_p, mp_mu_m);
+  });
+}
+
+template <class T>
+void multiply_m_e_e_inv(AlignedField<WilsonVectorT<T>>& out,
+                        const AlignedField<WilsonVectorT<T>>& in,
+                        const FermionAction& fa)
+// out can be the same object as in
+// works for _o_o as well
+{
+  TIMER("multiply_m_e_e_inv(af)");
+  constexpr int N = AlignedField<WilsonVectorT<T>>::N;
+  constexpr int n_real_wv = AlignedField<WilsonVectorT<T>>::n_real;
+  constexpr int n_half = 2 * NUM_COLOR;  // complex numbers of each chirality
+  constexpr int i_m = n_real_wv / 2 * N;  // start of the (1 - gamma5) / 2 part
+  if (is_initialized(out) and out.geo().eo == 3 - in.geo().eo) {
+    out.geo().eo = in.geo().eo;
+  }
+  out.init(geo_resize(in.geo()), in.multiplicity);
+  qassert(out.geo().eo == in.geo().eo);
+  qassert(in.geo().eo == 1 or in.geo().eo == 2);
+  if (&out != &in) {
+    out = in;
+  }
+  std::vector<ComplexD> lee, leem, dee, uee, ueem;
+  set_m_e_e_inv_coefs(lee, leem, dee, uee, ueem, fa);
+  const int ls = fa.ls;
+  const int n_rhs = get_num_rhs(in, fa);
+#pragma omp parallel for
+  for (Long block = 0; block < out.n_block_local; ++block) {
+    for (int k = 0; k < n_rhs; ++k) {
+      T* v0 = out.get_block(block, k * ls);
+      const auto v = [&](const int m) { return v0 + m * n_real_wv * N; };
+      // {L^m_{ee}}^{-1}
+      for (int m = 0; m < ls - 1; ++m) {
+        aligned_complex_axpy<T, N>(v(ls - 1) + i_m, (ComplexT<T>)(-leem[m]),
+                                   v(m) + i_m, n_half);
+      }
+      // {L'_{ee}}^{-1}
+      for (int m = 1; m < ls; ++m) {
+        aligned_complex_axpy<T, N>(v(m), (ComplexT<T>)(-lee[m - 1]), v(m - 1),
+                                   n_half);
+      }
+      // {D_{ee}}^{-1}
+      for (int m = 0; m < ls; ++m) {
+        aligned_complex_scale<T, N>(v(m), (ComplexT<T>)(1.0 / dee[m]), v(m),
+                                    2 * n_half);
+      }
+      // {U^'_{ee}}^{-1}
+      for (int m = ls - 2; m >= 0; --m) {
+        aligned_complex_axpy<T, N>(v(m) + i_m, (ComplexT<T>)(-uee[m]),
+                                   v(m + 1) + i_m, n_half);
+      }
+      // {U^m_{ee}}^{-1}
+      for (int m = 0; m < ls - 1; ++m) {
+        aligned_complex_axpy<T, N>(v(m), (ComplexT<T>)(-ueem[m]), v(ls - 1),
+                                   n_half);
+      }
+    }
+  }
+}
+
+template <class T>
+void multiply_mdag_e_e_inv(AlignedField<WilsonVectorT<T>>& out,
+                           const AlignedField<WilsonVectorT<T>>& in,
+                           const FermionAction& fa)
+// out can be the same object as in
+// works for _o_o as well
+{
+  TIMER("multiply_mdag_e_e_inv(af)");
+  constexpr int N = AlignedField<WilsonVectorT<T>>::N;
+  constexpr int n_real_wv = AlignedField<WilsonVectorT<T>>::n_real;
+  constexpr int n_half = 2 * NUM_COLOR;
+  constexpr int i_m = n_real_wv / 2 * N;
+  if (is_initialized(out) and out.geo().eo == 3 - in.geo().eo) {
+    out.geo().eo = in.geo().eo;
+  }
+  out.init(geo_resize(in.geo()), in.multiplicity);
+  qassert(out.geo().eo == in.geo().eo);
+  qassert(in.geo().eo == 1 or in.geo().eo == 2);
+  if (&out != &in) {
+    out = in;
+  }
+  std::vector<ComplexD> lee, leem, dee, uee, ueem;
+  set_m_e_e_inv_coefs(lee, leem, dee, uee, ueem, fa);
+  const int ls = fa.ls;
+  const int n_rhs = get_num_rhs(in, fa);
+#pragma omp parallel for
+  for (Long block = 0; block < out.n_block_local; ++block) {
+    for (int k = 0; k < n_rhs; ++k) {
+      T* v0 = out.get_block(block, k * ls);
+      const auto v = [&](const int m) { return v0 + m * n_real_wv * N; };
+      // {U^m_{ee}}^\dagger^{-1}
+      for (int m = 0; m < ls - 1; ++m) {
+        aligned_complex_axpy<T, N>(v(ls - 1), (ComplexT<T>)(-qconj(ueem[m])),
+                                   v(m), n_half);
+      }
+      // {U^'_{ee}}^\dagger^{-1}
+      for (int m = 1; m < ls; ++m) {
+        aligned_complex_axpy<T, N>(v(m) + i_m,
+                                   (ComplexT<T>)(-qconj(uee[m - 1])),
+                                   v(m - 1) + i_m, n_half);
+      }
+      // {D_{ee}}^\dagger^{-1}
+      for (int m = 0; m < ls; ++m) {
+        aligned_complex_scale<T, N>(v(m), (ComplexT<T>)(1.0 / qconj(dee[m])),
+                                    v(m), 2 * n_half);
+      }
+      // {L'_{ee}}^\dagger^{-1}
+      for (int m = ls - 2; m >= 0; --m) {
+        aligned_complex_axpy<T, N>(v(m), (ComplexT<T>)(-qconj(lee[m])),
+                                   v(m + 1), n_half);
+      }
+      // {L^m_{ee}}^\dagger^{-1}
+      for (int m = 0; m < ls - 1; ++m) {
+        aligned_complex_axpy<T, N>(v(m) + i_m, (ComplexT<T>)(-qconj(leem[m])),
+                                   v(ls - 1) + i_m, n_half);
+      }
+    }
+  }
+}
+
+template <class T>
+void multiply_m_e_o(AlignedField<WilsonVectorT<T>>& out,
+                    const AlignedField<WilsonVectorT<T>>& in,
+                    const WilsonHopLinksT<T>& hl, const FermionAction& fa)
+// out can be the same object as in
+// works for _o_e as well
+{
+  TIMER("multiply_m_e_o(af,af,hl,fa)");
+  constexpr int N = AlignedField<WilsonVectorT<T>>::N;
+  constexpr int n_real_wv = AlignedField<WilsonVectorT<T>>::n_real;
+  constexpr int n_half = 2 * NUM_COLOR;
+  constexpr int i_m = n_real_wv / 2 * N;
+  const int in_geo_eo = in.geo().eo;
+  AlignedField<WilsonVectorT<T>> in1;
+  in1.init(geo_resize(in.geo(), 1), in.multiplicity);
+  const int ls = fa.ls;
+  std::vector<ComplexT<T>> beo(ls), coef_p(ls), coef_m(ls);
+  for (int m = 0; m < ls; ++m) {
+    const ComplexD ceo = -fa.cs[m];
+    beo[m] = (ComplexT<T>)fa.bs[m];
+    coef_p[m] = (ComplexT<T>)(m < ls - 1 ? -ceo : ceo * fa.mass);
+    coef_m[m] = (ComplexT<T>)(m > 0 ? -ceo : ceo * fa.mass);
+  }
+  const int n_rhs = get_num_rhs(in, fa);
+#pragma omp parallel for
+  for (Long block = 0; block < in.n_block_local; ++block) {
+    for (int k = 0; k < n_rhs; ++k) {
+      const T* iv0 = in.get_block_const(block, k * ls);
+      T* v0 = in1.get_block(block, k * ls);
+      const auto iv = [&](const int m) { return iv0 + m * n_real_wv * N; };
+      for (int m = 0; m < ls; ++m) {
+        T* v = v0 + m * n_real_wv * N;
+        aligned_complex_scale<T, N>(v, beo[m], iv(m), 2 * n_half);
+        aligned_complex_axpy<T, N>(v + i_m, coef_p[m],
+                                   iv(m < ls - 1 ? m + 1 : 0) + i_m, n_half);
+        aligned_complex_axpy<T, N>(v, coef_m[m], iv(m > 0 ? m - 1 : ls - 1),
+                                   n_half);
+      }
+    }
+  }
+  multiply_wilson_d_e_o_comm_overlap(out, in1, hl);
+  qassert(out.geo().eo != in_geo_eo);
+}
+
+template <class T>
+void multiply_mdag_e_o(AlignedField<WilsonVectorT<T>>& out,
+                       const AlignedField<WilsonVectorT<T>>& in,
+                       const WilsonHopLinksT<T>& hl, const FermionAction& fa)
+// out can be the same object as in
+// works for _o_e as well
+{
+  TIMER("multiply_mdag_e_o(af,af,hl,fa)");
+  constexpr int N = AlignedField<WilsonVectorT<T>>::N;
+  constexpr int n_real_wv = AlignedField<WilsonVectorT<T>>::n_real;
+  constexpr int n_half = 2 * NUM_COLOR;
+  constexpr int i_m = n_real_wv / 2 * N;
+  const int in_geo_eo = in.geo().eo;
+  qassert(in.geo().eo == 1 or in.geo().eo == 2);
+  Geometry geo = geo_resize(in.geo());
+  geo.eo = 3 - in.geo().eo;
+  const int ls = fa.ls;
+  std::vector<ComplexT<T>> beo(ls), coef_p(ls), coef_m(ls);
+  for (int m = 0; m < ls; ++m) {
+    beo[m] = (ComplexT<T>)qconj(fa.bs[m]);
+    const ComplexD ceo_p = qconj(-fa.cs[m < ls - 1 ? m + 1 : 0]);
+    const ComplexD ceo_m = qconj(-fa.cs[m > 0 ? m - 1 : ls - 1]);
+    const ComplexD mmass = -qconj((ComplexD)fa.mass);
+    coef_p[m] = (ComplexT<T>)(m < ls - 1 ? -ceo_p : -mmass * ceo_p);
+    coef_m[m] = (ComplexT<T>)(m > 0 ? -ceo_m : -mmass * ceo_m);
+  }
+  AlignedField<WilsonVectorT<T>> in1;
+  in1.init(geo_resize(in.geo(), 1), in.multiplicity);
+  in1 = in;
+  AlignedField<WilsonVectorT<T>> out1;
+  multiply_wilson_ddag_e_o_comm_overlap(out1, in1, hl);
+  in1.init();
+  if (is_initialized(out) and out.geo().eo == 3 - geo.eo) {
+    out.geo().eo = geo.eo;
+  }
+  out.init(geo, in.multiplicity);
+  const int n_rhs = get_num_rhs(in, fa);
+#pragma omp parallel for
+  for (Long block = 0; block < out.n_block_local; ++block) {
+    for (int k = 0; k < n_rhs; ++k) {
+      const T* iv0 = out1.get_block_const(block, k * ls);
+      T* v0 = out.get_block(block, k * ls);
+      const auto iv = [&](const int m) { return iv0 + m * n_real_wv * N; };
+      for (int m = 0; m < ls; ++m) {
+        T* v = v0 + m * n_real_wv * N;
+        aligned_complex_scale<T, N>(v, beo[m], iv(m), 2 * n_half);
+        aligned_complex_axpy<T, N>(v, coef_p[m], iv(m < ls - 1 ? m + 1 : 0),
+                                   n_half);
+        aligned_complex_axpy<T, N>(v + i_m, coef_m[m],
+                                   iv(m > 0 ? m - 1 : ls - 1) + i_m, n_half);
+      }
+    }
+  }
+  qassert(out.geo().eo != in_geo_eo);
+}
+
+template <class T>
+void multiply_mpc_sym2(AlignedField<WilsonVectorT<T>>& out,
+                       const AlignedField<WilsonVectorT<T>>& in,
+                       const WilsonHopLinksT<T>& hl, const FermionAction& fa)
+// out can be the same object as in
+// odd <- odd (works for even <- even as well)
+{
+  TIMER("multiply_mpc_sym2(af)");
+  AlignedField<WilsonVectorT<T>> tmp;
+  multiply_m_e_e_inv(tmp, in, fa);
+  multiply_m_e_o(tmp, tmp, hl, fa);
+  multiply_m_e_e_inv(tmp, tmp, fa);
+  multiply_m_e_o(tmp, tmp, hl, fa);
+  if (is_initialized(out) and out.geo().eo == 3 - in.geo().eo) {
+    out.geo().eo = in.geo().eo;
+  }
+  out.init(geo_resize(in.geo()), in.multiplicity);
+  out = in;
+  out -= tmp;
+}
+
+template <class T>
+void multiply_mpcdag_sym2(AlignedField<WilsonVectorT<T>>& out,
+                          const AlignedField<WilsonVectorT<T>>& in,
+                          const WilsonHopLinksT<T>& hl,
+                          const FermionAction& fa)
+// out can be the same object as in
+// odd <- odd (works for even <- even as well)
+{
+  TIMER("multiply_mpcdag_sym2(af)");
+  AlignedField<WilsonVectorT<T>> tmp;
+  multiply_mdag_e_o(tmp, in, hl, fa);
+  multiply_mdag_e_e_inv(tmp, tmp, fa);
+  multiply_mdag_e_o(tmp, tmp, hl, fa);
+  multiply_mdag_e_e_inv(tmp, tmp, fa);
+  if (is_initialized(out) and out.geo().eo == 3 - in.geo().eo) {
+    out.geo().eo = in.geo().eo;
+  }
+  out.init(geo_resize(in.geo()), in.multiplicity);
+  out = in;
+  out -= tmp;
+}
+
+template <class T>
+void multiply_hermop_sym2(AlignedField<WilsonVectorT<T>>& out,
+                          const AlignedField<WilsonVectorT<T>>& in,
+                          const WilsonHopLinksT<T>& hl,
+                          const FermionAction& fa)
+// out can be the same object as in
+// odd <- odd (works for even <- even as well)
+{
+  TIMER_FLOPS("multiply_hermop_sym2(af)");
+  multiply_mpc_sym2(out, in, hl, fa);
+  multiply_mpcdag_sym2(out, out, hl, fa);
+  timer.flops += 5500 * in.multiplicity * 2 * in.geo().local_volume();
 }
 
 inline void multiply_m_e_e(FermionField5d& out, const FermionField5d& in,
@@ -1458,6 +2468,35 @@ inline void multiply_hermop_sym2(FermionField5d& out, const FermionField5d& in,
   multiply_hermop_sym2(out, in, inv.gf, inv.fa);
 }
 
+inline void multiply_hermop_sym2(FermionField5dT<RealF>& out,
+                                 const FermionField5dT<RealF>& in,
+                                 const InverterDomainWall& inv)
+// out can be the same object as in
+// odd <- odd (works for even <- even as well)
+// single precision version
+{
+  multiply_hermop_sym2(out, in, inv.get_gf_f(), inv.fa);
+}
+
+inline void multiply_hermop_sym2(AlignedField<WilsonVectorD>& out,
+                                 const AlignedField<WilsonVectorD>& in,
+                                 const InverterDomainWall& inv)
+// out can be the same object as in
+// odd <- odd (works for even <- even as well)
+{
+  multiply_hermop_sym2(out, in, inv.get_hl(), inv.fa);
+}
+
+inline void multiply_hermop_sym2(AlignedField<WilsonVectorF>& out,
+                                 const AlignedField<WilsonVectorF>& in,
+                                 const InverterDomainWall& inv)
+// out can be the same object as in
+// odd <- odd (works for even <- even as well)
+// single precision version
+{
+  multiply_hermop_sym2(out, in, inv.get_hl_f(), inv.fa);
+}
+
 inline void multiply_m_with_prec_sym2(FermionField5d& out,
                                       const FermionField5d& in,
                                       const InverterDomainWall& inv)
@@ -1486,37 +2525,572 @@ inline void multiply_m_with_prec_sym2(FermionField5d& out,
   set_half_fermion(out, out_o, 1);
 }
 
-inline ComplexD dot_product(const FermionField5d& ff1, const FermionField5d& ff2)
+// BLAS-1 style kernels for FermionField5dT.
+// They walk the field data as a contiguous array of complex numbers with
+// OpenMP threads. Reductions are summed over threads in a fixed order and
+// accumulated in double precision.
+
+template <class T>
+Vector<ComplexT<T> > get_complex_data_local(const FermionField5dT<T>& ff)
+// ff.geo().is_only_local is required
+{
+  qassert(ff.geo().is_only_local);
+  const Vector<WilsonVectorT<T> > v = get_data(ff);
+  return Vector<ComplexT<T> >((ComplexT<T>*)v.data(),
+                              v.data_size() / sizeof(ComplexT<T>));
+}
+
+template <class T>
+void check_ff5d_blas(const FermionField5dT<T>& ff1,
+                     const FermionField5dT<T>& ff2)
+{
+  qassert(is_matching_geo(ff1.geo(), ff2.geo()));
+  qassert(ff1.geo().eo == ff2.geo().eo);
+  qassert(ff1.multiplicity == ff2.multiplicity);
+  qassert(ff1.geo().is_only_local);
+  qassert(ff2.geo().is_only_local);
+}
+
+template <class T>
+ComplexD dot_product(const FermionField5dT<T>& ff1,
+                     const FermionField5dT<T>& ff2)
 // return ff1^dag * ff2
 {
   TIMER("dot_product");
+  if (not ff1.geo().is_only_local or not ff2.geo().is_only_local) {
+    FermionField5dT<T> ff1l, ff2l;
+    ff1l.init(geo_resize(ff1.geo()), ff1.multiplicity);
+    ff2l.init(geo_resize(ff2.geo()), ff2.multiplicity);
+    ff1l = ff1;
+    ff2l = ff2;
+    return dot_product(ff1l, ff2l);
+  }
+  check_ff5d_blas(ff1, ff2);
+  const Vector<ComplexT<T> > v1 = get_complex_data_local(ff1);
+  const Vector<ComplexT<T> > v2 = get_complex_data_local(ff2);
+  const Long size = v1.size();
+  std::vector<ComplexD> psums(omp_get_max_threads(), 0.0);
+#pragma omp parallel
+  {
+    RealD sr = 0.0;
+    RealD si = 0.0;
+#pragma omp for schedule(static) nowait
+    for (Long i = 0; i < size; ++i) {
+      const RealD r1 = v1[i].real();
+      const RealD i1 = v1[i].imag();
+      const RealD r2 = v2[i].real();
+      const RealD i2 = v2[i].imag();
+      sr += r1 * r2 + i1 * i2;
+      si += r1 * i2 - i1 * r2;
+    }
+    psums[omp_get_thread_num()] = ComplexD(sr, si);
+  }
+  ComplexD sum = 0.0;
+  for (size_t i = 0; i < psums.size(); ++i) {
+    sum += psums[i];
+  }
+  glb_sum(sum);
+  return sum;
+}
+
+template <class T>
+RealD qnorm(const FermionField5dT<T>& ff)
+{
+  TIMER("qnorm(ff5d)");
+  if (not ff.geo().is_only_local) {
+    return qnorm((const Field<WilsonVectorT<T> >&)ff);
+  }
+  const Vector<ComplexT<T> > v = get_complex_data_local(ff);
+  const Long size = v.size();
+  std::vector<RealD> psums(omp_get_max_threads(), 0.0);
+#pragma omp parallel
+  {
+    RealD s = 0.0;
+#pragma omp for schedule(static) nowait
+    for (Long i = 0; i < size; ++i) {
+      const RealD r = v[i].real();
+      const RealD im = v[i].imag();
+      s += r * r + im * im;
+    }
+    psums[omp_get_thread_num()] = s;
+  }
+  RealD sum = 0.0;
+  for (size_t i = 0; i < psums.size(); ++i) {
+    sum += psums[i];
+  }
+  glb_sum(sum);
+  return sum;
+}
+
+template <class T>
+void axpy(FermionField5dT<T>& y, const ComplexD& a, const FermionField5dT<T>& x)
+// y = a * x + y
+{
+  TIMER("axpy(ff5d)");
+  check_ff5d_blas(y, x);
+  Vector<ComplexT<T> > vy = get_complex_data_local(y);
+  const Vector<ComplexT<T> > vx = get_complex_data_local(x);
+  const Long size = vy.size();
+  const T ar = a.real();
+  const T ai = a.imag();
+#pragma omp parallel for schedule(static)
+  for (Long i = 0; i < size; ++i) {
+    const T xr = vx[i].real();
+    const T xi = vx[i].imag();
+    vy[i] = ComplexT<T>(vy[i].real() + ar * xr - ai * xi,
+                        vy[i].imag() + ar * xi + ai * xr);
+  }
+}
+
+template <class T>
+void xpay(FermionField5dT<T>& y, const ComplexD& a, const FermionField5dT<T>& x)
+// y = x + a * y
+{
+  TIMER("xpay(ff5d)");
+  check_ff5d_blas(y, x);
+  Vector<ComplexT<T> > vy = get_complex_data_local(y);
+  const Vector<ComplexT<T> > vx = get_complex_data_local(x);
+  const Long size = vy.size();
+  const T ar = a.real();
+  const T ai = a.imag();
+#pragma omp parallel for schedule(static)
+  for (Long i = 0; i < size; ++i) {
+    const T yr = vy[i].real();
+    const T yi = vy[i].imag();
+    vy[i] = ComplexT<T>(vx[i].real() + ar * yr - ai * yi,
+                        vx[i].imag() + ar * yi + ai * yr);
+  }
+}
+
+template <class T>
+RealD axpy_qnorm(FermionField5dT<T>& y, const ComplexD& a,
+                 const FermionField5dT<T>& x)
+// y = a * x + y
+// return qnorm(y)
+{
+  TIMER("axpy_qnorm(ff5d)");
+  check_ff5d_blas(y, x);
+  Vector<ComplexT<T> > vy = get_complex_data_local(y);
+  const Vector<ComplexT<T> > vx = get_complex_data_local(x);
+  const Long size = vy.size();
+  const T ar = a.real();
+  const T ai = a.imag();
+  std::vector<RealD> psums(omp_get_max_threads(), 0.0);
+#pragma omp parallel
+  {
+    RealD s = 0.0;
+#pragma omp for schedule(static) nowait
+    for (Long i = 0; i < size; ++i) {
+      const T xr = vx[i].real();
+      const T xi = vx[i].imag();
+      const T yr = vy[i].real() + ar * xr - ai * xi;
+      const T yi = vy[i].imag() + ar * xi + ai * xr;
+      vy[i] = ComplexT<T>(yr, yi);
+      s += (RealD)yr * (RealD)yr + (RealD)yi * (RealD)yi;
+    }
+    psums[omp_get_thread_num()] = s;
+  }
+  RealD sum = 0.0;
+  for (size_t i = 0; i < psums.size(); ++i) {
+    sum += psums[i];
+  }
+  glb_sum(sum);
+  return sum;
+}
+
+// Batched versions of the kernels above.
+// The field holds n_rhs right hand sides. The data of each site is split into
+// n_rhs consecutive blocks (e.g. multiplicity = n_rhs * ls).
+// The reductions return one value per right hand side with a single glb_sum.
+
+// The same kernels for AlignedField<WilsonVectorT<T>>.
+// Only the local blocks are used (the padding lanes are zero). The data of each
+// block is a sequence of groups of 2 * N reals: the real parts of N complex
+// numbers followed by their imaginary parts.
+
+template <class T>
+Long check_ff5d_blas(const AlignedField<WilsonVectorT<T>>& ff1,
+                     const AlignedField<WilsonVectorT<T>>& ff2)
+// return the number of groups of complex numbers of the local blocks
+{
   qassert(is_matching_geo(ff1.geo(), ff2.geo()));
   qassert(ff1.geo().eo == ff2.geo().eo);
-  const Geometry& geo = ff1.geo();
+  qassert(ff1.multiplicity == ff2.multiplicity);
+  return ff1.n_block_local * ff1.multiplicity *
+         AlignedField<WilsonVectorT<T>>::n_real / 2;
+}
+
+template <class T>
+ComplexD dot_product(const AlignedField<WilsonVectorT<T>>& ff1,
+                     const AlignedField<WilsonVectorT<T>>& ff2)
+// return ff1^dag * ff2
+{
+  TIMER("dot_product(af)");
+  constexpr int N = AlignedField<WilsonVectorT<T>>::N;
+  const Long n_group = check_ff5d_blas(ff1, ff2);
+  const T* d1 = ff1.data.data();
+  const T* d2 = ff2.data.data();
+  std::vector<ComplexD> psums(omp_get_max_threads(), 0.0);
+#pragma omp parallel
+  {
+    RealD sr = 0.0;
+    RealD si = 0.0;
+#pragma omp for schedule(static) nowait
+    for (Long g = 0; g < n_group; ++g) {
+      const T* r1 = d1 + 2 * N * g;
+      const T* i1 = r1 + N;
+      const T* r2 = d2 + 2 * N * g;
+      const T* i2 = r2 + N;
+#pragma omp simd reduction(+ : sr, si)
+      for (int l = 0; l < N; ++l) {
+        sr += (RealD)r1[l] * r2[l] + (RealD)i1[l] * i2[l];
+        si += (RealD)r1[l] * i2[l] - (RealD)i1[l] * r2[l];
+      }
+    }
+    psums[omp_get_thread_num()] = ComplexD(sr, si);
+  }
   ComplexD sum = 0.0;
-  for (Long index = 0; index < geo.local_volume(); ++index) {
-    const Coordinate xl = geo.coordinate_from_index(index);
-    const Vector<WilsonVector> v1 = ff1.get_elems_const(xl);
-    const Vector<WilsonVector> v2 = ff2.get_elems_const(xl);
-    const Vector<ComplexD> cv1((const ComplexD*)v1.data(),
-                               v1.data_size() / sizeof(ComplexD));
-    const Vector<ComplexD> cv2((const ComplexD*)v2.data(),
-                               v2.data_size() / sizeof(ComplexD));
-    qassert(cv1.size() == cv2.size());
-    for (int k = 0; k < cv1.size(); ++k) {
-      sum += qconj(cv1[k]) * cv2[k];
+  for (size_t i = 0; i < psums.size(); ++i) {
+    sum += psums[i];
+  }
+  glb_sum(sum);
+  return sum;
+}
+
+template <class T>
+RealD qnorm(const AlignedField<WilsonVectorT<T>>& ff)
+{
+  TIMER("qnorm(af)");
+  constexpr int N = AlignedField<WilsonVectorT<T>>::N;
+  const Long n_group = check_ff5d_blas(ff, ff);
+  const T* d = ff.data.data();
+  std::vector<RealD> psums(omp_get_max_threads(), 0.0);
+#pragma omp parallel
+  {
+    RealD s = 0.0;
+#pragma omp for schedule(static) nowait
+    for (Long g = 0; g < n_group; ++g) {
+      const T* p = d + 2 * N * g;
+#pragma omp simd reduction(+ : s)
+      for (int l = 0; l < 2 * N; ++l) {
+        s += (RealD)p[l] * p[l];
+      }
     }
+    psums[omp_get_thread_num()] = s;
+  }
+  RealD sum = 0.0;
+  for (size_t i = 0; i < psums.size(); ++i) {
+    sum += psums[i];
   }
   glb_sum(sum);
   return sum;
 }
 
-template <class Inv>
-inline Long cg_with_f(
-    FermionField5d& out, const FermionField5d& in, const Inv& inv,
-    void f(FermionField5d&, const FermionField5d&, const Inv&),
-    const double stop_rsd = 1e-8, const Long max_num_iter = 50000)
+template <class T>
+void axpy(AlignedField<WilsonVectorT<T>>& y, const ComplexD& a,
+          const AlignedField<WilsonVectorT<T>>& x)
+// y = a * x + y
+{
+  TIMER("axpy(af)");
+  constexpr int N = AlignedField<WilsonVectorT<T>>::N;
+  const Long n_group = check_ff5d_blas(y, x);
+  const ComplexT<T> at = (ComplexT<T>)a;
+  T* dy = y.data.data();
+  const T* dx = x.data.data();
+#pragma omp parallel for schedule(static)
+  for (Long g = 0; g < n_group; ++g) {
+    aligned_complex_axpy<T, N>(dy + 2 * N * g, at, dx + 2 * N * g, 1);
+  }
+}
+
+template <class T>
+void xpay(AlignedField<WilsonVectorT<T>>& y, const ComplexD& a,
+          const AlignedField<WilsonVectorT<T>>& x)
+// y = x + a * y
+{
+  TIMER("xpay(af)");
+  constexpr int N = AlignedField<WilsonVectorT<T>>::N;
+  const Long n_group = check_ff5d_blas(y, x);
+  const ComplexT<T> at = (ComplexT<T>)a;
+  T* dy = y.data.data();
+  const T* dx = x.data.data();
+#pragma omp parallel for schedule(static)
+  for (Long g = 0; g < n_group; ++g) {
+    T* py = dy + 2 * N * g;
+    const T* px = dx + 2 * N * g;
+    aligned_complex_scale<T, N>(py, at, py, 1);
+#pragma omp simd
+    for (int l = 0; l < 2 * N; ++l) {
+      py[l] += px[l];
+    }
+  }
+}
+
+template <class T>
+RealD axpy_qnorm(AlignedField<WilsonVectorT<T>>& y, const ComplexD& a,
+                 const AlignedField<WilsonVectorT<T>>& x)
+// y = a * x + y
+// return qnorm(y)
+{
+  TIMER("axpy_qnorm(af)");
+  constexpr int N = AlignedField<WilsonVectorT<T>>::N;
+  const Long n_group = check_ff5d_blas(y, x);
+  const ComplexT<T> at = (ComplexT<T>)a;
+  T* dy = y.data.data();
+  const T* dx = x.data.data();
+  std::vector<RealD> psums(omp_get_max_threads(), 0.0);
+#pragma omp parallel
+  {
+    RealD s = 0.0;
+#pragma omp for schedule(static) nowait
+    for (Long g = 0; g < n_group; ++g) {
+      T* py = dy + 2 * N * g;
+      aligned_complex_axpy<T, N>(py, at, dx + 2 * N * g, 1);
+#pragma omp simd reduction(+ : s)
+      for (int l = 0; l < 2 * N; ++l) {
+        s += (RealD)py[l] * py[l];
+      }
+    }
+    psums[omp_get_thread_num()] = s;
+  }
+  RealD sum = 0.0;
+  for (size_t i = 0; i < psums.size(); ++i) {
+    sum += psums[i];
+  }
+  glb_sum(sum);
+  return sum;
+}
+
+template <class T>
+std::vector<ComplexD> dot_product_multi(const FermionField5dT<T>& ff1,
+                                        const FermionField5dT<T>& ff2,
+                                        const int n_rhs)
+// return ff1[k]^dag * ff2[k] for 0 <= k < n_rhs
+{
+  TIMER("dot_product_multi");
+  check_ff5d_blas(ff1, ff2);
+  qassert(ff1.multiplicity % n_rhs == 0);
+  const Vector<ComplexT<T> > v1 = get_complex_data_local(ff1);
+  const Vector<ComplexT<T> > v2 = get_complex_data_local(ff2);
+  const Long block_size =
+      ff1.multiplicity / n_rhs * sizeof(WilsonVectorT<T>) / sizeof(ComplexT<T>);
+  const Long n_sites = v1.size() / (block_size * n_rhs);
+  std::vector<ComplexD> psums(omp_get_max_threads() * n_rhs, 0.0);
+#pragma omp parallel
+  {
+    std::vector<ComplexD> ps(n_rhs, 0.0);
+#pragma omp for schedule(static) nowait
+    for (Long index = 0; index < n_sites; ++index) {
+      for (int k = 0; k < n_rhs; ++k) {
+        const Long start = (index * n_rhs + k) * block_size;
+        RealD sr = 0.0;
+        RealD si = 0.0;
+        for (Long i = start; i < start + block_size; ++i) {
+          const RealD r1 = v1[i].real();
+          const RealD i1 = v1[i].imag();
+          const RealD r2 = v2[i].real();
+          const RealD i2 = v2[i].imag();
+          sr += r1 * r2 + i1 * i2;
+          si += r1 * i2 - i1 * r2;
+        }
+        ps[k] += ComplexD(sr, si);
+      }
+    }
+    for (int k = 0; k < n_rhs; ++k) {
+      psums[omp_get_thread_num() * n_rhs + k] = ps[k];
+    }
+  }
+  std::vector<ComplexD> sums(n_rhs, 0.0);
+  for (size_t i = 0; i < psums.size(); ++i) {
+    sums[i % n_rhs] += psums[i];
+  }
+  glb_sum(get_data(sums));
+  return sums;
+}
+
+template <class T>
+std::vector<RealD> qnorm_multi(const FermionField5dT<T>& ff, const int n_rhs)
+{
+  TIMER("qnorm_multi");
+  const std::vector<ComplexD> dots = dot_product_multi(ff, ff, n_rhs);
+  std::vector<RealD> ret(n_rhs);
+  for (int k = 0; k < n_rhs; ++k) {
+    ret[k] = dots[k].real();
+  }
+  return ret;
+}
+
+template <class T>
+void axpy_multi(FermionField5dT<T>& y, const std::vector<ComplexD>& as,
+                const FermionField5dT<T>& x)
+// y[k] = as[k] * x[k] + y[k]
+{
+  TIMER("axpy_multi");
+  check_ff5d_blas(y, x);
+  const int n_rhs = as.size();
+  qassert(y.multiplicity % n_rhs == 0);
+  Vector<ComplexT<T> > vy = get_complex_data_local(y);
+  const Vector<ComplexT<T> > vx = get_complex_data_local(x);
+  const Long block_size =
+      y.multiplicity / n_rhs * sizeof(WilsonVectorT<T>) / sizeof(ComplexT<T>);
+  const Long n_sites = vy.size() / (block_size * n_rhs);
+#pragma omp parallel for schedule(static)
+  for (Long index = 0; index < n_sites; ++index) {
+    for (int k = 0; k < n_rhs; ++k) {
+      const T ar = as[k].real();
+      const T ai = as[k].imag();
+      const Long start = (index * n_rhs + k) * block_size;
+      for (Long i = start; i < start + block_size; ++i) {
+        const T xr = vx[i].real();
+        const T xi = vx[i].imag();
+        vy[i] = ComplexT<T>(vy[i].real() + ar * xr - ai * xi,
+                            vy[i].imag() + ar * xi + ai * xr);
+      }
+    }
+  }
+}
+
+template <class T>
+void xpay_multi(FermionField5dT<T>& y, const std::vector<ComplexD>& as,
+                const FermionField5dT<T>& x)
+// y[k] = x[k] + as[k] * y[k]
+{
+  TIMER("xpay_multi");
+  check_ff5d_blas(y, x);
+  const int n_rhs = as.size();
+  qassert(y.multiplicity % n_rhs == 0);
+  Vector<ComplexT<T> > vy = get_complex_data_local(y);
+  const Vector<ComplexT<T> > vx = get_complex_data_local(x);
+  const Long block_size =
+      y.multiplicity / n_rhs * sizeof(WilsonVectorT<T>) / sizeof(ComplexT<T>);
+  const Long n_sites = vy.size() / (block_size * n_rhs);
+#pragma omp parallel for schedule(static)
+  for (Long index = 0; index < n_sites; ++index) {
+    for (int k = 0; k < n_rhs; ++k) {
+      const T ar = as[k].real();
+      const T ai = as[k].imag();
+      const Long start = (index * n_rhs + k) * block_size;
+      for (Long i = start; i < start + block_size; ++i) {
+        const T yr = vy[i].real();
+        const T yi = vy[i].imag();
+        vy[i] = ComplexT<T>(vx[i].real() + ar * yr - ai * yi,
+                            vx[i].imag() + ar * yi + ai * yr);
+      }
+    }
+  }
+}
+
+template <class T>
+std::vector<RealD> axpy_qnorm_multi(FermionField5dT<T>& y,
+                                    const std::vector<ComplexD>& as,
+                                    const FermionField5dT<T>& x)
+// y[k] = as[k] * x[k] + y[k]
+// return qnorm(y[k])
+{
+  TIMER("axpy_qnorm_multi");
+  check_ff5d_blas(y, x);
+  const int n_rhs = as.size();
+  qassert(y.multiplicity % n_rhs == 0);
+  Vector<ComplexT<T> > vy = get_complex_data_local(y);
+  const Vector<ComplexT<T> > vx = get_complex_data_local(x);
+  const Long block_size =
+      y.multiplicity / n_rhs * sizeof(WilsonVectorT<T>) / sizeof(ComplexT<T>);
+  const Long n_sites = vy.size() / (block_size * n_rhs);
+  std::vector<RealD> psums(omp_get_max_threads() * n_rhs, 0.0);
+#pragma omp parallel
+  {
+    std::vector<RealD> ps(n_rhs, 0.0);
+#pragma omp for schedule(static) nowait
+    for (Long index = 0; index < n_sites; ++index) {
+      for (int k = 0; k < n_rhs; ++k) {
+        const T ar = as[k].real();
+        const T ai = as[k].imag();
+        const Long start = (index * n_rhs + k) * block_size;
+        RealD s = 0.0;
+        for (Long i = start; i < start + block_size; ++i) {
+          const T xr = vx[i].real();
+          const T xi = vx[i].imag();
+          const T yr = vy[i].real() + ar * xr - ai * xi;
+          const T yi = vy[i].imag() + ar * xi + ai * xr;
+          vy[i] = ComplexT<T>(yr, yi);
+          s += (RealD)yr * (RealD)yr + (RealD)yi * (RealD)yi;
+        }
+        ps[k] += s;
+      }
+    }
+    for (int k = 0; k < n_rhs; ++k) {
+      psums[omp_get_thread_num() * n_rhs + k] = ps[k];
+    }
+  }
+  std::vector<RealD> sums(n_rhs, 0.0);
+  for (size_t i = 0; i < psums.size(); ++i) {
+    sums[i % n_rhs] += psums[i];
+  }
+  glb_sum(get_data(sums));
+  return sums;
+}
+
+template <class T>
+void pack_fermion_field_5d_multi(FermionField5dT<T>& ffb,
+                                 const std::vector<FermionField5dT<T> >& ffs)
+// ffb.multiplicity = ffs.size() * ffs[0].multiplicity
+{
+  TIMER("pack_fermion_field_5d_multi");
+  const int n_rhs = ffs.size();
+  qassert(n_rhs > 0);
+  const Geometry geo = geo_resize(ffs[0].geo());
+  const int mult = ffs[0].multiplicity;
+  for (int k = 0; k < n_rhs; ++k) {
+    qassert(geo_resize(ffs[k].geo()) == geo);
+    qassert(ffs[k].multiplicity == mult);
+  }
+  ffb.init(geo, n_rhs * mult);
+#pragma omp parallel for
+  for (Long index = 0; index < geo.local_volume(); ++index) {
+    const Coordinate xl = geo.coordinate_from_index(index);
+    Vector<WilsonVectorT<T> > v = ffb.get_elems(xl);
+    for (int k = 0; k < n_rhs; ++k) {
+      const Vector<WilsonVectorT<T> > iv = ffs[k].get_elems_const(xl);
+      std::memcpy((void*)&v[k * mult], (const void*)iv.data(), iv.data_size());
+    }
+  }
+}
+
+template <class T>
+void unpack_fermion_field_5d_multi(std::vector<FermionField5dT<T> >& ffs,
+                                   const FermionField5dT<T>& ffb,
+                                   const int n_rhs)
+{
+  TIMER("unpack_fermion_field_5d_multi");
+  qassert(n_rhs > 0);
+  qassert(ffb.multiplicity % n_rhs == 0);
+  const Geometry geo = geo_resize(ffb.geo());
+  const int mult = ffb.multiplicity / n_rhs;
+  ffs.resize(n_rhs);
+  for (int k = 0; k < n_rhs; ++k) {
+    if (is_initialized(ffs[k]) and ffs[k].geo().eo == 3 - geo.eo) {
+      ffs[k].geo().eo = geo.eo;
+    }
+    ffs[k].init(geo, mult);
+  }
+#pragma omp parallel for
+  for (Long index = 0; index < geo.local_volume(); ++index) {
+    const Coordinate xl = geo.coordinate_from_index(index);
+    const Vector<WilsonVectorT<T> > iv = ffb.get_elems_const(xl);
+    for (int k = 0; k < n_rhs; ++k) {
+      Vector<WilsonVectorT<T> > v = ffs[k].get_elems(xl);
+      std::memcpy((void*)v.data(), (const void*)&iv[k * mult], v.data_size());
+    }
+  }
+}
+
+template <class FF, class Inv>
+inline Long cg_with_f(FF& out, const FF& in, const Inv& inv,
+                      void f(FF&, const FF&, const Inv&),
+                      const double stop_rsd = 1e-8,
+                      const Long max_num_iter = 50000)
 // f(out, in, inv);
+// FF is FermionField5dT<T> or AlignedField<WilsonVectorT<T>>
 {
   TIMER("cg_with_f");
   qassert(&out != &in);
@@ -1530,31 +3104,25 @@ inline Long cg_with_f(
   if (max_num_iter == 0) {
     return 0;
   }
-  FermionField5d r, p, tmp, ap;
+  FF r, p, tmp, ap;
   r.init(geo, in.multiplicity);
   p.init(geo, in.multiplicity);
   tmp.init(geo, in.multiplicity);
   r = in;
   f(tmp, out, inv);
-  r -= tmp;
-  p = r;
   const double qnorm_in = qnorm(in);
   displayln_info(
       fname +
       ssprintf(
           ": start max_num_iter=%4ld        sqrt(qnorm_in)=%.3E stop_rsd=%.3E",
           max_num_iter, sqrt(qnorm_in), stop_rsd));
-  double qnorm_r = qnorm(r);
+  double qnorm_r = axpy_qnorm(r, -1.0, tmp);
+  p = r;
   for (Long iter = 1; iter <= max_num_iter; ++iter) {
     f(ap, p, inv);
     const double alpha = qnorm_r / dot_product(p, ap).real();
-    tmp = p;
-    tmp *= alpha;
-    out += tmp;
-    tmp = ap;
-    tmp *= alpha;
-    r -= tmp;
-    const double new_qnorm_r = qnorm(r);
+    axpy(out, alpha, p);
+    const double new_qnorm_r = axpy_qnorm(r, -alpha, ap);
     if (is_cg_verbose()) {
       displayln_info(
           fname +
@@ -1570,8 +3138,7 @@ inline Long cg_with_f(
       return iter;
     }
     const double beta = new_qnorm_r / qnorm_r;
-    p *= beta;
-    p += r;
+    xpay(p, beta, r);
     qnorm_r = new_qnorm_r;
   }
   displayln_info(
@@ -1582,6 +3149,116 @@ inline Long cg_with_f(
   return max_num_iter + 1;
 }
 
+template <class T, class Inv>
+inline Long cg_with_f_multi(
+    FermionField5dT<T>& out, const FermionField5dT<T>& in, const Inv& inv,
+    void f(FermionField5dT<T>&, const FermionField5dT<T>&, const Inv&),
+    const int n_rhs, const std::vector<double>& stop_rsds,
+    const Long max_num_iter, std::vector<Long>& iters)
+// f(out, in, inv);
+// in holds n_rhs right hand sides (see dot_product_multi).
+// f must act on each right hand side independently, so one call of f applies
+// the operator to all the right hand sides (the gauge links are loaded once).
+// The CG iterations of all the right hand sides proceed together. A right hand
+// side stops being updated once converged.
+// iters[k] is the number of iterations for the k-th right hand side
+// (max_num_iter + 1 if not converged).
+// return the max of iters
+{
+  TIMER("cg_with_f_multi");
+  qassert(&out != &in);
+  qassert((int)stop_rsds.size() == n_rhs);
+  const Geometry geo = geo_resize(in.geo());
+  if (not is_initialized(out)) {
+    out.init(geo, in.multiplicity);
+    set_zero(out);
+  } else {
+    out.init(geo, in.multiplicity);
+  }
+  iters.assign(n_rhs, max_num_iter + 1);
+  if (max_num_iter == 0) {
+    return 0;
+  }
+  FermionField5dT<T> r, p, tmp, ap;
+  r.init(geo, in.multiplicity);
+  p.init(geo, in.multiplicity);
+  tmp.init(geo, in.multiplicity);
+  r = in;
+  f(tmp, out, inv);
+  const std::vector<RealD> qnorm_in = qnorm_multi(in, n_rhs);
+  displayln_info(fname + ssprintf(": start n_rhs=%d max_num_iter=%4ld", n_rhs,
+                                  max_num_iter));
+  std::vector<RealD> qnorm_r =
+      axpy_qnorm_multi(r, std::vector<ComplexD>(n_rhs, -1.0), tmp);
+  p = r;
+  std::vector<bool> is_converged(n_rhs, false);
+  int n_converged = 0;
+  for (int k = 0; k < n_rhs; ++k) {
+    // eg. a zero right hand side
+    if (qnorm_r[k] <= qnorm_in[k] * sqr(stop_rsds[k])) {
+      is_converged[k] = true;
+      n_converged += 1;
+      iters[k] = 0;
+    }
+  }
+  if (n_converged == n_rhs) {
+    return 0;
+  }
+  std::vector<ComplexD> alphas(n_rhs), betas(n_rhs), malphas(n_rhs);
+  for (Long iter = 1; iter <= max_num_iter; ++iter) {
+    f(ap, p, inv);
+    const std::vector<ComplexD> p_ap = dot_product_multi(p, ap, n_rhs);
+    for (int k = 0; k < n_rhs; ++k) {
+      alphas[k] = is_converged[k] ? 0.0 : qnorm_r[k] / p_ap[k].real();
+      malphas[k] = -alphas[k];
+    }
+    axpy_multi(out, alphas, p);
+    const std::vector<RealD> new_qnorm_r = axpy_qnorm_multi(r, malphas, ap);
+    for (int k = 0; k < n_rhs; ++k) {
+      if (is_converged[k]) {
+        betas[k] = 0.0;
+        continue;
+      }
+      if (is_cg_verbose()) {
+        displayln_info(
+            fname +
+            ssprintf(
+                ": k=%2d iter=%4ld sqrt(qnorm_r/qnorm_in)=%.3E stop_rsd=%.3E",
+                k, iter, sqrt(new_qnorm_r[k] / qnorm_in[k]), stop_rsds[k]));
+      }
+      if (new_qnorm_r[k] <= qnorm_in[k] * sqr(stop_rsds[k])) {
+        displayln_info(
+            fname +
+            ssprintf(": k=%2d final iter=%4ld sqrt(qnorm_r/qnorm_in)=%.3E "
+                     "stop_rsd=%.3E",
+                     k, iter, sqrt(new_qnorm_r[k] / qnorm_in[k]),
+                     stop_rsds[k]));
+        is_converged[k] = true;
+        n_converged += 1;
+        iters[k] = iter;
+        betas[k] = 0.0;
+        continue;
+      }
+      betas[k] = new_qnorm_r[k] / qnorm_r[k];
+      qnorm_r[k] = new_qnorm_r[k];
+    }
+    if (n_converged == n_rhs) {
+      return iter;
+    }
+    xpay_multi(p, betas, r);
+  }
+  for (int k = 0; k < n_rhs; ++k) {
+    if (not is_converged[k]) {
+      displayln_info(
+          fname + ssprintf(": k=%2d final max_num_iter=%4ld "
+                           "sqrt(qnorm_r/qnorm_in)=%.3E stop_rsd=%.3E",
+                           k, max_num_iter, sqrt(qnorm_r[k] / qnorm_in[k]),
+                           stop_rsds[k]));
+    }
+  }
+  return max_num_iter + 1;
+}
+
 template <class Inv>
 void set_odd_prec_field_sym2(FermionField5d& in_o_p, FermionField5d& out_e_p,
                              const FermionField5d& in, const Inv& inv)
@@ -1756,6 +3433,32 @@ Long invert_with_cg_with_guess(FermionField5d& out, const FermionField5d& in,
   return total_iter;
 }
 
+template <class T>
+Long cg_with_herm_sym_2_aligned(FermionField5dT<T>& sol,
+                                const FermionField5dT<T>& src,
+                                const InverterDomainWall& inv,
+                                const double stop_rsd, const Long max_num_iter)
+// Same as cg_with_f(sol, src, inv, multiply_hermop_sym2, ...), but src and sol
+// are converted to AlignedField once, and the CG vectors stay in that layout
+// for all the iterations.
+// The WilsonHopLinksT of inv need to be up to date.
+{
+  TIMER("cg_with_herm_sym_2_aligned");
+  const Geometry geo = geo_resize(src.geo());
+  AlignedField<WilsonVectorT<T>> sol_a, src_a;
+  src_a.init(geo, src.multiplicity);
+  set_aligned_field(src_a, src);
+  if (is_initialized(sol)) {
+    sol_a.init(geo, src.multiplicity);
+    set_aligned_field(sol_a, sol);
+  }
+  const Long iter = cg_with_f(sol_a, src_a, inv, multiply_hermop_sym2,
+                              stop_rsd, max_num_iter);
+  sol.init(geo, src.multiplicity);
+  set_field_from_aligned_field(sol, sol_a);
+  return iter;
+}
+
 inline Long cg_with_herm_sym_2(FermionField5d& sol, const FermionField5d& src,
                                const InverterDomainWall& inv,
                                const double stop_rsd = 1e-8,
@@ -1763,16 +3466,210 @@ inline Long cg_with_herm_sym_2(FermionField5d& sol, const FermionField5d& src,
 {
   TIMER_VERBOSE_FLOPS("cg_with_herm_sym_2(5d,5d,inv)");
   qassert(&sol != &src);
-  const Long iter =
-      cg_with_f(sol, src, inv, multiply_hermop_sym2, stop_rsd, max_num_iter);
+  Long iter = 0;
+  if (is_wilson_hop_aligned()) {
+    inv.update_hl();
+    iter = cg_with_herm_sym_2_aligned(sol, src, inv, stop_rsd, max_num_iter);
+  } else {
+    iter =
+        cg_with_f(sol, src, inv, multiply_hermop_sym2, stop_rsd, max_num_iter);
+  }
+  timer.flops += 5500 * iter * inv.fa.ls * inv.geo().local_volume();
+  return iter;
+}
+
+inline Long cg_with_herm_sym_2(FermionField5dT<RealF>& sol,
+                               const FermionField5dT<RealF>& src,
+                               const InverterDomainWall& inv,
+                               const double stop_rsd = 1e-8,
+                               const Long max_num_iter = 50000)
+// single precision version
+// inv.update_gf_f() needs to be called before (see cg_with_herm_sym_2_mixed)
+{
+  TIMER_VERBOSE_FLOPS("cg_with_herm_sym_2(5d-f,5d-f,inv)");
+  qassert(&sol != &src);
+  Long iter = 0;
+  if (is_wilson_hop_aligned()) {
+    iter = cg_with_herm_sym_2_aligned(sol, src, inv, stop_rsd, max_num_iter);
+  } else {
+    iter =
+        cg_with_f(sol, src, inv, multiply_hermop_sym2, stop_rsd, max_num_iter);
+  }
   timer.flops += 5500 * iter * inv.fa.ls * inv.geo().local_volume();
   return iter;
 }
 
+inline Long cg_with_herm_sym_2_mixed(FermionField5d& sol,
+                                     const FermionField5d& src,
+                                     const InverterDomainWall& inv,
+                                     const double stop_rsd = 1e-8,
+                                     const Long max_num_iter = 50000)
+// Same interface as cg_with_herm_sym_2.
+// Defect correction: the residual is computed in double precision and the
+// correction is solved with single precision CG to a relative residual no
+// smaller than inv.ip.lower_precision_stop_rsd.
+// max_num_iter limits the total number of single precision iterations.
+{
+  TIMER_VERBOSE_FLOPS("cg_with_herm_sym_2_mixed(5d,5d,inv)");
+  qassert(&sol != &src);
+  inv.update_gf_f();
+  const Geometry geo = geo_resize(src.geo());
+  if (not is_initialized(sol)) {
+    sol.init(geo, src.multiplicity);
+    set_zero(sol);
+  } else {
+    sol.init(geo, src.multiplicity);
+  }
+  const double qnorm_src = qnorm(src);
+  FermionField5d r, ap, e;
+  FermionField5dT<RealF> r_f, e_f;
+  r.init(geo, src.multiplicity);
+  multiply_hermop_sym2(ap, sol, inv);
+  r = src;
+  double qnorm_r = axpy_qnorm(r, -1.0, ap);
+  Long total_iter = 0;
+  Long cycle = 0;
+  while (qnorm_r > qnorm_src * sqr(stop_rsd) and total_iter < max_num_iter) {
+    cycle += 1;
+    const double inner_stop_rsd =
+        std::max(stop_rsd * sqrt(qnorm_src / qnorm_r),
+                 inv.ip.lower_precision_stop_rsd);
+    convert_field_precision<RealF, RealD>(r_f, r);
+    e_f.init();
+    const Long iter = cg_with_herm_sym_2(e_f, r_f, inv, inner_stop_rsd,
+                                         max_num_iter - total_iter);
+    total_iter += std::min(iter, max_num_iter - total_iter);
+    convert_field_precision<RealD, RealF>(e, e_f);
+    sol += e;
+    multiply_hermop_sym2(ap, sol, inv);
+    r = src;
+    qnorm_r = axpy_qnorm(r, -1.0, ap);
+    displayln_info(
+        fname + ssprintf(": cycle=%ld inner_iter=%ld sqrt(qnorm_r/qnorm_src)="
+                         "%.3E stop_rsd=%.3E",
+                         cycle, iter, sqrt(qnorm_r / qnorm_src), stop_rsd));
+  }
+  timer.flops += 5500 * (total_iter + cycle) * inv.fa.ls *
+                 inv.geo().local_volume();
+  displayln_info(fname + ssprintf(": total_inner_iter=%ld cycle=%ld",
+                                  total_iter, cycle));
+  if (qnorm_r > qnorm_src * sqr(stop_rsd)) {
+    return max_num_iter + 1;
+  }
+  return total_iter;
+}
+
+inline Long cg_with_herm_sym_2_mixed_multi(FermionField5d& sol,
+                                           const FermionField5d& src,
+                                           const InverterDomainWall& inv,
+                                           const int n_rhs,
+                                           const std::vector<double>& stop_rsds,
+                                           const Long max_num_iter,
+                                           std::vector<Long>& iters)
+// Same interface as cg_with_f_multi(sol, src, inv, multiply_hermop_sym2, ...).
+// Batched version of cg_with_herm_sym_2_mixed: the residuals are computed in
+// double precision and the corrections of all the right hand sides are solved
+// together with single precision cg_with_f_multi.
+// max_num_iter limits the total number of (batched) single precision
+// iterations.
+{
+  TIMER_VERBOSE_FLOPS("cg_with_herm_sym_2_mixed_multi(5d,5d,inv)");
+  qassert(&sol != &src);
+  qassert((int)stop_rsds.size() == n_rhs);
+  inv.update_gf_f();
+  const Geometry geo = geo_resize(src.geo());
+  if (not is_initialized(sol)) {
+    sol.init(geo, src.multiplicity);
+    set_zero(sol);
+  } else {
+    sol.init(geo, src.multiplicity);
+  }
+  const std::vector<RealD> qnorm_src = qnorm_multi(src, n_rhs);
+  const std::vector<ComplexD> ms(n_rhs, -1.0);
+  FermionField5d r, ap, e;
+  FermionField5dT<RealF> r_f, e_f;
+  r.init(geo, src.multiplicity);
+  multiply_hermop_sym2(ap, sol, inv);
+  r = src;
+  std::vector<RealD> qnorm_r = axpy_qnorm_multi(r, ms, ap);
+  std::vector<double> inner_stop_rsds(n_rhs);
+  std::vector<ComplexD> ms_converged(n_rhs);
+  std::vector<Long> inner_iters;
+  std::vector<bool> is_converged(n_rhs, false);
+  iters.assign(n_rhs, 0);
+  Long total_iter = 0;
+  Long cycle = 0;
+  while (true) {
+    int n_converged = 0;
+    double max_rsd = 0.0;
+    for (int k = 0; k < n_rhs; ++k) {
+      is_converged[k] = qnorm_r[k] <= qnorm_src[k] * sqr(stop_rsds[k]);
+      n_converged += is_converged[k] ? 1 : 0;
+      max_rsd = std::max(max_rsd, sqrt(qnorm_r[k] / qnorm_src[k]));
+    }
+    if (cycle > 0) {
+      displayln_info(fname +
+                     ssprintf(": cycle=%ld n_converged=%d/%d "
+                              "max sqrt(qnorm_r/qnorm_src)=%.3E",
+                              cycle, n_converged, n_rhs, max_rsd));
+    }
+    if (n_converged == n_rhs or total_iter >= max_num_iter) {
+      break;
+    }
+    cycle += 1;
+    for (int k = 0; k < n_rhs; ++k) {
+      // converged right hand sides get a zero residual, which cg_with_f_multi
+      // treats as converged from the start, so they receive no correction
+      ms_converged[k] = is_converged[k] ? -1.0 : 0.0;
+      inner_stop_rsds[k] =
+          is_converged[k] ? 1.0
+                          : std::max(stop_rsds[k] * sqrt(qnorm_src[k] /
+                                                         qnorm_r[k]),
+                                     inv.ip.lower_precision_stop_rsd);
+    }
+    convert_field_precision<RealF, RealD>(r_f, r);
+    if (n_converged > 0) {
+      axpy_multi(r_f, ms_converged, r_f);
+    }
+    e_f.init();
+    const Long iter =
+        cg_with_f_multi(e_f, r_f, inv, multiply_hermop_sym2, n_rhs,
+                        inner_stop_rsds, max_num_iter - total_iter, inner_iters);
+    const Long n_iter = std::min(iter, max_num_iter - total_iter);
+    total_iter += n_iter;
+    for (int k = 0; k < n_rhs; ++k) {
+      if (not is_converged[k]) {
+        iters[k] += std::min(inner_iters[k], n_iter);
+      }
+    }
+    convert_field_precision<RealD, RealF>(e, e_f);
+    sol += e;
+    multiply_hermop_sym2(ap, sol, inv);
+    r = src;
+    qnorm_r = axpy_qnorm_multi(r, ms, ap);
+  }
+  timer.flops += 5500 * (total_iter + cycle) * n_rhs * inv.fa.ls *
+                 inv.geo().local_volume();
+  displayln_info(fname + ssprintf(": n_rhs=%d total_inner_iter=%ld cycle=%ld",
+                                  n_rhs, total_iter, cycle));
+  Long ret = total_iter;
+  for (int k = 0; k < n_rhs; ++k) {
+    if (not is_converged[k]) {
+      iters[k] = max_num_iter + 1;
+      ret = max_num_iter + 1;
+    }
+  }
+  return ret;
+}
+
 inline Long invert(FermionField5d& out, const FermionField5d& in,
                    const InverterDomainWall& inv)
+// inv.ip.lower_precision == 4 -> use cg_with_herm_sym_2_mixed
 {
   qassert(&out != &in);
+  if (inv.ip.lower_precision == 4) {
+    return invert_with_cg(out, in, inv, cg_with_herm_sym_2_mixed);
+  }
   return invert_with_cg(out, in, inv, cg_with_herm_sym_2);
 }
 
@@ -1783,6 +3680,158 @@ inline Long invert(FermionField4d& out, const FermionField4d& in,
   return invert_dwf(out, in, inv);
 }
 
+inline Long invert_multi(std::vector<FermionField5d>& outs,
+                         const std::vector<FermionField5d>& ins,
+                         const InverterDomainWall& inv)
+// Same as invert(outs[k], ins[k], inv) for all k, but the CG for all the right
+// hand sides runs together with batched operator applications.
+// inv.ip.lower_precision == 4 -> use cg_with_herm_sym_2_mixed_multi
+// return the total number of (batched) iterations
+{
+  TIMER_VERBOSE_FLOPS("invert_multi(5d,5d,inv)");
+  const int n_rhs_total = ins.size();
+  outs.resize(n_rhs_total);
+  const double stop_rsd = inv.stop_rsd();
+  const Long max_num_iter = inv.max_num_iter();
+  const Long max_mixed_precision_cycle = inv.max_mixed_precision_cycle();
+  qassert(inv.fa.is_using_zmobius == true and inv.fa.cg_diagonal_mee == 2);
+  std::vector<Int> ks;  // indices of the non-zero right hand sides
+  std::vector<FermionField5d> in_o_ps, out_e_ps;
+  for (int k = 0; k < n_rhs_total; ++k) {
+    qassert(&outs[k] != &ins[k]);
+    FermionField5d dm_in;
+    if (inv.fa.is_multiplying_dminus) {
+      multiply_d_minus(dm_in, ins[k], inv);
+    } else {
+      dm_in.init(geo_resize(ins[k].geo()), ins[k].multiplicity);
+      dm_in = ins[k];
+    }
+    const double dm_in_qnorm = qnorm(dm_in);
+    displayln_info(fname + ssprintf(": k=%2d dm_in sqrt(qnorm) = %E", k,
+                                    sqrt(dm_in_qnorm)));
+    if (dm_in_qnorm == 0.0) {
+      displayln_info(fname + ssprintf(": WARNING: dm_in qnorm is zero."));
+      outs[k].init(geo_resize(ins[k].geo()), ins[k].multiplicity);
+      set_zero(outs[k]);
+      continue;
+    }
+    ks.push_back(k);
+    in_o_ps.push_back(FermionField5d());
+    out_e_ps.push_back(FermionField5d());
+    set_odd_prec_field_sym2(in_o_ps.back(), out_e_ps.back(), dm_in, inv);
+  }
+  const int n_rhs = ks.size();
+  if (n_rhs == 0) {
+    return 0;
+  }
+  FermionField5d in_o_p, out_o_p, tmp, itmp;
+  pack_fermion_field_5d_multi(in_o_p, in_o_ps);
+  out_o_p.init(in_o_p.geo(), in_o_p.multiplicity);
+  set_zero(out_o_p);
+  tmp.init(in_o_p.geo(), in_o_p.multiplicity);
+  const std::vector<RealD> qnorm_in_o_p = qnorm_multi(in_o_p, n_rhs);
+  itmp = in_o_p;
+  std::vector<RealD> qnorm_itmp = qnorm_in_o_p;
+  std::vector<double> stop_rsds(n_rhs);
+  std::vector<Long> iters;
+  std::vector<FermionField5d> ffs;
+  Long total_iter = 0;
+  int cycle;
+  for (cycle = 1; cycle <= max_mixed_precision_cycle; ++cycle) {
+    if (not inv.lm.null() and inv.lm().initialized) {
+      unpack_fermion_field_5d_multi(ffs, itmp, n_rhs);
+      deflate(ffs, ffs, inv.lm());
+      pack_fermion_field_5d_multi(tmp, ffs);
+    } else {
+      set_zero(tmp);
+    }
+    for (int i = 0; i < n_rhs; ++i) {
+      stop_rsds[i] = stop_rsd * sqrt(qnorm_in_o_p[i] / qnorm_itmp[i]);
+    }
+    const Long iter =
+        inv.ip.lower_precision == 4
+            ? cg_with_herm_sym_2_mixed_multi(tmp, itmp, inv, n_rhs, stop_rsds,
+                                             max_num_iter, iters)
+            : cg_with_f_multi(tmp, itmp, inv, multiply_hermop_sym2, n_rhs,
+                              stop_rsds, max_num_iter, iters);
+    total_iter += iter;
+    out_o_p += tmp;
+    if (iter <= max_num_iter) {
+      itmp.init();
+      break;
+    }
+    multiply_hermop_sym2(itmp, out_o_p, inv);
+    itmp *= -1.0;
+    itmp += in_o_p;
+    qnorm_itmp = qnorm_multi(itmp, n_rhs);
+  }
+  timer.flops +=
+      5500 * total_iter * n_rhs * inv.fa.ls * inv.geo().local_volume();
+  displayln_info(fname +
+                 ssprintf(": n_rhs=%d total_iter=%ld cycle=%d stop_rsd=%.3E",
+                          n_rhs, total_iter, cycle, stop_rsd));
+  unpack_fermion_field_5d_multi(ffs, out_o_p, n_rhs);
+  for (int i = 0; i < n_rhs; ++i) {
+    restore_field_from_odd_prec_sym2(outs[ks[i]], ffs[i], out_e_ps[i], inv);
+  }
+  if (is_checking_invert()) {
+    for (int i = 0; i < n_rhs; ++i) {
+      const int k = ks[i];
+      FermionField5d dm_in;
+      if (inv.fa.is_multiplying_dminus) {
+        multiply_d_minus(dm_in, ins[k], inv);
+      } else {
+        dm_in = ins[k];
+      }
+      FermionField5d tmp;
+      multiply_m(tmp, outs[k], inv);
+      tmp -= dm_in;
+      displayln_info(fname + ssprintf(": k=%2d checking %E from %E", k,
+                                      sqrt(qnorm(tmp)), sqrt(qnorm(dm_in))));
+    }
+  }
+  return total_iter;
+}
+
+inline void invert(Propagator4d& sol, const Propagator4d& src,
+                   const InverterDomainWall& inv)
+// sol do not need to be initialized
+// If inv.num_rhs_batch() > 1, the spin-color columns are solved in batches of
+// inv.num_rhs_batch() with invert_multi.
+{
+  TIMER_VERBOSE("invert(p4d,p4d,inv-dwf)");
+  qassert(&sol != &src);
+  const Geometry geo = geo_resize(src.geo());
+  sol.init(geo);
+  const int n_batch = std::max(1, inv.num_rhs_batch());
+  FermionField4d ff_sol, ff_src;
+  if (n_batch == 1) {
+    for (int j = 0; j < 4 * NUM_COLOR; ++j) {
+      set_fermion_field_from_propagator_col(ff_src, src, j);
+      invert(ff_sol, ff_src, inv);
+      set_propagator_col_from_fermion_field(sol, j, ff_sol);
+    }
+    return;
+  }
+  qassert(check_matching_geo(geo, inv.geo()));
+  const int ls = inv.fa.ls;
+  const Geometry geo_ls = geo_resize(inv.geo());
+  for (int j0 = 0; j0 < 4 * NUM_COLOR; j0 += n_batch) {
+    const int n_rhs = std::min(n_batch, 4 * NUM_COLOR - j0);
+    std::vector<FermionField5d> sol5ds(n_rhs), src5ds(n_rhs);
+    for (int k = 0; k < n_rhs; ++k) {
+      set_fermion_field_from_propagator_col(ff_src, src, j0 + k);
+      src5ds[k].init(geo_ls, ls);
+      fermion_field_5d_from_4d(src5ds[k], ff_src, 0, ls - 1);
+    }
+    invert_multi(sol5ds, src5ds, inv);
+    for (int k = 0; k < n_rhs; ++k) {
+      fermion_field_4d_from_5d(ff_sol, sol5ds[k], ls - 1, 0);
+      set_propagator_col_from_fermion_field(sol, j0 + k, ff_sol);
+    }
+  }
+}
+
 inline double find_max_eigen_value_hermop_sym2(const InverterDomainWall& inv,
                                                const RngState& rs,
                                                const Long max_iter = 100)
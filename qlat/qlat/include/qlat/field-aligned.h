@@ -0,0 +1,644 @@
+#pragma once
+
+#include <qlat/field-expand.h>
+#include <qlat/field.h>
+
+namespace qlat
+{  //
+
+constexpr int get_simd_n_bytes()
+// width of the SIMD registers of the compilation target in bytes
+{
+#if defined(__AVX512F__)
+  return 64;
+#elif defined(__AVX__)
+  return 32;
+#else
+  return 16;
+#endif
+}
+
+template <class T>
+constexpr int get_simd_n_lane()
+// number of T in a SIMD register of the compilation target
+{
+  return get_simd_n_bytes() / sizeof(T);
+}
+
+struct API AlignedSiteTable {
+  // Order of the sites of geo (which may have expansion) in AlignedField.
+  // The local sites come first in index order, padded to a multiple of n_lane.
+  // The expanded sites follow in offset order, so the local sites have the
+  // same position with or without expansion.
+  //
+  // positions[offset] is the position of the site with (site) offset offset
+  // offsets[position] is the offset of the site at position (-1 if padding)
+  Geometry geo;
+  Int n_lane;
+  Long n_position_local;
+  Long n_position;
+  vector_acc<Long> positions;
+  vector_acc<Long> offsets;
+};
+
+AlignedSiteTable make_aligned_site_table(const Geometry& geo,
+                                         const Int n_lane);
+
+API inline Cache<std::string, AlignedSiteTable>& get_aligned_site_table_cache()
+{
+  static Cache<std::string, AlignedSiteTable> cache("AlignedSiteTableCache",
+                                                    32);
+  return cache;
+}
+
+const AlignedSiteTable& get_aligned_site_table(const Geometry& geo,
+                                               const Int n_lane);
+
+template <class M>
+struct API AlignedField {
+  // Structure-of-arrays layout of Field<M>.
+  // The sites are ordered as in AlignedSiteTable and grouped into blocks of N
+  // consecutive positions, one site per SIMD lane. For position = block * N +
+  // lane, the c-th real number of the m-th element of the site is stored at
+  //   data[((block * multiplicity + m) * n_real + c) * N + lane]
+  // (see the block layout below). The padding lanes are kept zero.
+  //
+  using RealType = typename IsDataValueType<M>::ElementaryType;
+  static constexpr Int N = get_simd_n_lane<RealType>();
+  static constexpr Int n_real = sizeof(M) / sizeof(RealType);
+  static_assert(n_real * sizeof(RealType) == sizeof(M), "M is not made of T");
+  //
+  bool initialized;
+  Int multiplicity;
+  box_acc<Geometry> geo;
+  Long n_block_local;  // blocks of the local sites
+  Long n_block;
+  vector_acc<RealType> data;
+  //
+  void init()
+  {
+    initialized = false;
+    multiplicity = 0;
+    geo.init();
+    n_block_local = 0;
+    n_block = 0;
+    data.init();
+  }
+  void init(const Geometry& geo_, const Int multiplicity_)
+  // only initialize if uninitialized
+  // if initialized already, then check for matching geo and multiplicity
+  // (same as Field<M>::init)
+  {
+    if (initialized) {
+      if (not(is_matching_geo_included(geo_, geo()) and
+              geo_.eo == geo().eo)) {
+        displayln("old geo = " + show(geo()));
+        displayln("new geo = " + show(geo_));
+        qassert(false);
+      }
+      qassert(multiplicity == multiplicity_);
+      return;
+    }
+    TIMER("AlignedField::init(geo,mult)");
+    init();
+    QLAT_PUSH_DIAGNOSTIC_DISABLE_DANGLING_REF;
+    const AlignedSiteTable& ast = get_aligned_site_table(geo_, N);
+    QLAT_DIAGNOSTIC_POP;
+    initialized = true;
+    multiplicity = multiplicity_;
+    geo.set(geo_);
+    n_block_local = ast.n_position_local / N;
+    n_block = ast.n_position / N;
+    data.resize(n_block * multiplicity * n_real * N);
+    set_zero(data);
+  }
+  //
+  AlignedField() { init(); }
+  AlignedField(const AlignedField<M>&) = default;
+  AlignedField(AlignedField<M>&&) noexcept = default;
+  //
+  AlignedField<M>& operator=(const AlignedField<M>& af)
+  // skip if same object
+  // otherwise init with geo_resize(af.geo()) and copy the local sites
+  {
+    if (this == &af) {
+      return *this;
+    }
+    TIMER_FLOPS("AlignedField::operator=");
+    qassert(af.initialized);
+    init(geo_resize(af.geo()), af.multiplicity);
+    const Long size = af.n_block_local * multiplicity * n_real * N;
+    std::memcpy(data.data(), af.data.data(), size * sizeof(RealType));
+    timer.flops += size * sizeof(RealType);
+    return *this;
+  }
+  AlignedField<M>& operator=(AlignedField<M>&&) noexcept = default;
+  //
+  qacc RealType* get_block(const Long block, const Int m)
+  {
+    return &data[(block * multiplicity + m) * n_real * N];
+  }
+  qacc const RealType* get_block_const(const Long block, const Int m) const
+  {
+    return &data[(block * multiplicity + m) * n_real * N];
+  }
+  //
+  qacc Long get_real_index(const Long position, const Int m) const
+  // index in data of the real number 0 of the m-th element of the site at
+  // position (the c-th real number is at c * N after it)
+  {
+    return ((position / N * multiplicity + m) * n_real) * N + position % N;
+  }
+};
+
+template <class M>
+bool is_initialized(const AlignedField<M>& af)
+{
+  return af.initialized;
+}
+
+template <class M>
+void set_zero(AlignedField<M>& af)
+{
+  TIMER("set_zero(AlignedField)");
+  set_zero(af.data);
+}
+
+template <class M>
+AlignedField<M>& operator+=(AlignedField<M>& af, const AlignedField<M>& af1)
+// local sites only
+{
+  TIMER("af_operator+=");
+  qassert(is_matching_geo(af.geo(), af1.geo()));
+  qassert(af.geo().eo == af1.geo().eo);
+  qassert(af.multiplicity == af1.multiplicity);
+  using RealType = typename AlignedField<M>::RealType;
+  const Long size =
+      af.n_block_local * af.multiplicity * AlignedField<M>::n_real *
+      AlignedField<M>::N;
+  RealType* p = af.data.data();
+  const RealType* p1 = af1.data.data();
+#pragma omp parallel for simd
+  for (Long i = 0; i < size; ++i) {
+    p[i] += p1[i];
+  }
+  return af;
+}
+
+template <class M>
+AlignedField<M>& operator-=(AlignedField<M>& af, const AlignedField<M>& af1)
+// local sites only
+{
+  TIMER("af_operator-=");
+  qassert(is_matching_geo(af.geo(), af1.geo()));
+  qassert(af.geo().eo == af1.geo().eo);
+  qassert(af.multiplicity == af1.multiplicity);
+  using RealType = typename AlignedField<M>::RealType;
+  const Long size =
+      af.n_block_local * af.multiplicity * AlignedField<M>::n_real *
+      AlignedField<M>::N;
+  RealType* p = af.data.data();
+  const RealType* p1 = af1.data.data();
+#pragma omp parallel for simd
+  for (Long i = 0; i < size; ++i) {
+    p[i] -= p1[i];
+  }
+  return af;
+}
+
+template <class M>
+void set_aligned_field(AlignedField<M>& af, const Field<M>& f)
+// af is initialized with the geo of f if it is not initialized
+// The sites of af which are also sites of f are copied (including the expanded
+// sites).
+{
+  TIMER("set_aligned_field");
+  using RealType = typename AlignedField<M>::RealType;
+  constexpr Int N = AlignedField<M>::N;
+  constexpr Int n_real = AlignedField<M>::n_real;
+  if (not is_initialized(af)) {
+    af.init(f.geo(), f.multiplicity);
+  }
+  const Geometry& geo = af.geo();
+  const Geometry& geo_f = f.geo();
+  qassert(is_matching_geo(geo, geo_f));
+  qassert(geo.eo == geo_f.eo);
+  qassert(af.multiplicity == f.multiplicity);
+  const bool is_same_layout = geo == geo_f;
+  QLAT_PUSH_DIAGNOSTIC_DISABLE_DANGLING_REF;
+  const AlignedSiteTable& ast = get_aligned_site_table(geo, N);
+  QLAT_DIAGNOSTIC_POP;
+  const Int multiplicity = f.multiplicity;
+#pragma omp parallel for
+  for (Long position = 0; position < ast.n_position; ++position) {
+    const Long offset = ast.offsets[position];
+    if (offset < 0) {
+      continue;
+    }
+    Long offset_f = offset;
+    if (not is_same_layout) {
+      const Coordinate xl = geo.coordinate_from_offset(offset, 1);
+      if (not geo_f.is_on_node(xl)) {
+        continue;
+      }
+      offset_f = geo_f.offset_from_coordinate(xl, 1);
+    }
+    for (Int m = 0; m < multiplicity; ++m) {
+      const RealType* p =
+          (const RealType*)&f.get_elem_offset(offset_f * multiplicity + m);
+      RealType* q = &af.data[af.get_real_index(position, m)];
+      for (Int c = 0; c < n_real; ++c) {
+        q[c * N] = p[c];
+      }
+    }
+  }
+}
+
+template <class M>
+void set_field_from_aligned_field(Field<M>& f, const AlignedField<M>& af)
+// f is initialized with the geo of af if it is not initialized
+// The sites of af which are also sites of f are copied (including the expanded
+// sites).
+{
+  TIMER("set_field_from_aligned_field");
+  using RealType = typename AlignedField<M>::RealType;
+  constexpr Int N = AlignedField<M>::N;
+  constexpr Int n_real = AlignedField<M>::n_real;
+  if (not is_initialized(f)) {
+    f.init(af.geo(), af.multiplicity);
+  }
+  const Geometry& geo = af.geo();
+  const Geometry& geo_f = f.geo();
+  qassert(is_matching_geo(geo, geo_f));
+  qassert(geo.eo == geo_f.eo);
+  qassert(af.multiplicity == f.multiplicity);
+  const bool is_same_layout = geo == geo_f;
+  QLAT_PUSH_DIAGNOSTIC_DISABLE_DANGLING_REF;
+  const AlignedSiteTable& ast = get_aligned_site_table(geo, N);
+  QLAT_DIAGNOSTIC_POP;
+  const Int multiplicity = af.multiplicity;
+#pragma omp parallel for
+  for (Long position = 0; position < ast.n_position; ++position) {
+    const Long offset = ast.offsets[position];
+    if (offset < 0) {
+      continue;
+    }
+    Long offset_f = offset;
+    if (not is_same_layout) {
+      const Coordinate xl = geo.coordinate_from_offset(offset, 1);
+      if (not geo_f.is_on_node(xl)) {
+        continue;
+      }
+      offset_f = geo_f.offset_from_coordinate(xl, 1);
+    }
+    for (Int m = 0; m < multiplicity; ++m) {
+      RealType* p = (RealType*)&f.get_elem_offset(offset_f * multiplicity + m);
+      const RealType* q = &af.data[af.get_real_index(position, m)];
+      for (Int c = 0; c < n_real; ++c) {
+        p[c] = q[c * N];
+      }
+    }
+  }
+}
+
+// --------------------
+// Refresh the expanded sites of an AlignedField.
+// The CommPlan of the Field<M> with the same geo and multiplicity is used. The
+// elements are packed to (unpacked from) the usual send (recv) buffers.
+
+template <class M>
+struct API AlignedRefreshExpandedHandle {
+  // Split-phase state of refresh_expanded for AlignedField
+  // (see RefreshExpandedHandle).
+  bool is_active;
+  AlignedField<M>* p_field;
+  const CommPlan* p_plan;
+  std::shared_ptr<CommPlanBuffer> buffer;
+  //
+  AlignedRefreshExpandedHandle()
+  {
+    is_active = false;
+    p_field = NULL;
+    p_plan = NULL;
+  }
+};
+
+template <class M>
+void refresh_expanded_start(AlignedRefreshExpandedHandle<M>& h,
+                            AlignedField<M>& af, const CommPlan& plan)
+// Only the local sites of af are read until refresh_expanded_finish returns.
+{
+  qassert(not h.is_active);
+  h.p_field = &af;
+  h.p_plan = &plan;
+  const Long total_bytes =
+      (plan.total_recv_size + plan.total_send_size) * sizeof(M);
+  if (0 == total_bytes) {
+    return;
+  }
+  TIMER_FLOPS("refresh_expanded_start(af)");
+  timer.flops += total_bytes / 2;
+  using RealType = typename AlignedField<M>::RealType;
+  constexpr Int N = AlignedField<M>::N;
+  constexpr Int n_real = AlignedField<M>::n_real;
+  QLAT_PUSH_DIAGNOSTIC_DISABLE_DANGLING_REF;
+  const AlignedSiteTable& ast = get_aligned_site_table(af.geo(), N);
+  QLAT_DIAGNOSTIC_POP;
+  const Int multiplicity = af.multiplicity;
+  h.is_active = true;
+  h.buffer = get_comm_plan_buffer(plan, sizeof(M));
+  M* send_buffer = (M*)h.buffer->send_buffer.data();
+#pragma omp parallel for
+  for (Long i = 0; i < (Long)plan.send_pack_infos.size(); ++i) {
+    const CommPackInfo& cpi = plan.send_pack_infos[i];
+    for (Long k = 0; k < cpi.size; ++k) {
+      const Long offset = cpi.offset + k;
+      const Long position = ast.positions[offset / multiplicity];
+      const RealType* q =
+          &af.data[af.get_real_index(position, offset % multiplicity)];
+      RealType* p = (RealType*)&send_buffer[cpi.buffer_idx + k];
+      for (Int c = 0; c < n_real; ++c) {
+        p[c] = q[c * N];
+      }
+    }
+  }
+  {
+    TIMER("refresh_expanded-comm-init");
+    h.buffer->start(plan);
+  }
+}
+
+template <class M>
+void refresh_expanded_finish(AlignedRefreshExpandedHandle<M>& h)
+{
+  if (not h.is_active) {
+    return;
+  }
+  TIMER("refresh_expanded_finish(af)");
+  qassert(h.p_field != NULL);
+  qassert(h.p_plan != NULL);
+  AlignedField<M>& af = *h.p_field;
+  const CommPlan& plan = *h.p_plan;
+  {
+    TIMER_FLOPS("refresh_expanded-comm");
+    timer.flops +=
+        (plan.total_recv_size + plan.total_send_size) * sizeof(M) / 2;
+    mpi_waitall(h.buffer->reqs);
+  }
+  using RealType = typename AlignedField<M>::RealType;
+  constexpr Int N = AlignedField<M>::N;
+  constexpr Int n_real = AlignedField<M>::n_real;
+  QLAT_PUSH_DIAGNOSTIC_DISABLE_DANGLING_REF;
+  const AlignedSiteTable& ast = get_aligned_site_table(af.geo(), N);
+  QLAT_DIAGNOSTIC_POP;
+  const Int multiplicity = af.multiplicity;
+  const M* recv_buffer = (const M*)h.buffer->recv_buffer.data();
+#pragma omp parallel for
+  for (Long i = 0; i < (Long)plan.recv_pack_infos.size(); ++i) {
+    const CommPackInfo& cpi = plan.recv_pack_infos[i];
+    for (Long k = 0; k < cpi.size; ++k) {
+      const Long offset = cpi.offset + k;
+      const Long position = ast.positions[offset / multiplicity];
+      RealType* q =
+          &af.data[af.get_real_index(position, offset % multiplicity)];
+      const RealType* p = (const RealType*)&recv_buffer[cpi.buffer_idx + k];
+      for (Int c = 0; c < n_real; ++c) {
+        q[c * N] = p[c];
+      }
+    }
+  }
+  release_comm_plan_buffer(h.buffer);
+  h.is_active = false;
+}
+
+template <class M>
+void refresh_expanded_1(AlignedField<M>& af)
+{
+  QLAT_PUSH_DIAGNOSTIC_DISABLE_DANGLING_REF;
+  const CommPlan& plan =
+      get_comm_plan(set_marks_field_1, "", af.geo(), af.multiplicity);
+  QLAT_DIAGNOSTIC_POP;
+  const Long total_bytes =
+      (plan.total_recv_size + plan.total_send_size) * sizeof(M);
+  if (0 == total_bytes) {
+    return;
+  }
+  TIMER_FLOPS("refresh_expanded(af)");
+  timer.flops += total_bytes / 2;
+  AlignedRefreshExpandedHandle<M> h;
+  sync_node();
+  refresh_expanded_start(h, af, plan);
+  refresh_expanded_finish(h);
+  sync_node();
+}
+
+template <int N, class M, class F>
+void refresh_expanded_1_overlap_aligned(AlignedField<M>& af,
+                                        const Geometry& geo, const F& kernel)
+// Call kernel(block) for the blocks of N consecutive local sites of geo
+// (0 <= block < (geo.local_volume() + N - 1) / N).
+// Same as refresh_expanded_overlap_blocks: the blocks without boundary sites
+// are computed while the expanded sites of af are in flight.
+{
+  TIMER("refresh_expanded_1_overlap_aligned");
+  QLAT_PUSH_DIAGNOSTIC_DISABLE_DANGLING_REF;
+  const CommPlan& plan =
+      get_comm_plan(set_marks_field_1, "", af.geo(), af.multiplicity);
+  const CommOverlapIndices& coi = get_comm_overlap_indices(geo, af.geo());
+  QLAT_DIAGNOSTIC_POP;
+  const Long n_block = (geo.local_volume() + N - 1) / N;
+  std::vector<int8_t> is_boundary(n_block, 0);
+  for (const Long index : coi.boundary_indices) {
+    is_boundary[index / N] = 1;
+  }
+  std::vector<Long> interior_blocks, boundary_blocks;
+  for (Long block = 0; block < n_block; ++block) {
+    if (is_boundary[block] != 0) {
+      boundary_blocks.push_back(block);
+    } else {
+      interior_blocks.push_back(block);
+    }
+  }
+  AlignedRefreshExpandedHandle<M> h;
+  refresh_expanded_start(h, af, plan);
+  {
+    TIMER("refresh_expanded_1_overlap_aligned-interior");
+#pragma omp parallel for
+    for (Long i = 0; i < (Long)interior_blocks.size(); ++i) {
+      kernel(interior_blocks[i]);
+    }
+  }
+  refresh_expanded_finish(h);
+  {
+    TIMER("refresh_expanded_1_overlap_aligned-boundary");
+#pragma omp parallel for
+    for (Long i = 0; i < (Long)boundary_blocks.size(); ++i) {
+      kernel(boundary_blocks[i]);
+    }
+  }
+}
+
+// --------------------
+// Structure-of-arrays blocks of N sites (one site per SIMD lane) with real
+// type T. The c-th real number of the site in lane l is stored at
+//   block[c * N + l]
+// A complex number k of a site is stored as real number 2 * k (real part) and
+// 2 * k + 1 (imaginary part).
+
+template <class T, int N, class M>
+qacc void aligned_block_gather(T* block, const M* const* ptrs, const Int n)
+// block[c * N + lane] = ((const T*)ptrs[lane])[c] for 0 <= lane < n
+{
+  constexpr Int n_real = sizeof(M) / sizeof(T);
+  static_assert(n_real * sizeof(T) == sizeof(M), "M is not made of T");
+  for (Int lane = 0; lane < n; ++lane) {
+    const T* p = (const T*)ptrs[lane];
+    for (Int c = 0; c < n_real; ++c) {
+      block[c * N + lane] = p[c];
+    }
+  }
+}
+
+template <class T, int N, class M>
+qacc void aligned_block_scatter(M* const* ptrs, const T* block, const Int n)
+// ((T*)ptrs[lane])[c] = block[c * N + lane] for 0 <= lane < n
+{
+  constexpr Int n_real = sizeof(M) / sizeof(T);
+  static_assert(n_real * sizeof(T) == sizeof(M), "M is not made of T");
+  for (Int lane = 0; lane < n; ++lane) {
+    T* p = (T*)ptrs[lane];
+    for (Int c = 0; c < n_real; ++c) {
+      p[c] = block[c * N + lane];
+    }
+  }
+}
+
+// --------------------
+// Kernels on the above blocks.
+// ColorMatrix blocks have 18 * N reals and WilsonVector blocks 24 * N reals.
+
+template <class T, int N>
+qacc void aligned_color_matrix_mul_add(T* ret, const T* u, const T* v)
+// ret += u * v
+// ret, v: WilsonVector ; u: ColorMatrix
+{
+  for (int s = 0; s < 4; ++s) {
+    for (int c1 = 0; c1 < NUM_COLOR; ++c1) {
+      T* r_re = ret + 2 * (s * NUM_COLOR + c1) * N;
+      T* r_im = r_re + N;
+      for (int c2 = 0; c2 < NUM_COLOR; ++c2) {
+        const T* u_re = u + 2 * (c1 * NUM_COLOR + c2) * N;
+        const T* u_im = u_re + N;
+        const T* v_re = v + 2 * (s * NUM_COLOR + c2) * N;
+        const T* v_im = v_re + N;
+#pragma omp simd
+        for (int l = 0; l < N; ++l) {
+          r_re[l] += u_re[l] * v_re[l] - u_im[l] * v_im[l];
+          r_im[l] += u_re[l] * v_im[l] + u_im[l] * v_re[l];
+        }
+      }
+    }
+  }
+}
+
+template <class T, int N>
+qacc void aligned_color_matrix_adj_mul_add(T* ret, const T* u, const T* v)
+// ret += u^\dagger * v
+// ret, v: WilsonVector ; u: ColorMatrix
+{
+  for (int s = 0; s < 4; ++s) {
+    for (int c1 = 0; c1 < NUM_COLOR; ++c1) {
+      T* r_re = ret + 2 * (s * NUM_COLOR + c1) * N;
+      T* r_im = r_re + N;
+      for (int c2 = 0; c2 < NUM_COLOR; ++c2) {
+        const T* u_re = u + 2 * (c2 * NUM_COLOR + c1) * N;
+        const T* u_im = u_re + N;
+        const T* v_re = v + 2 * (s * NUM_COLOR + c2) * N;
+        const T* v_im = v_re + N;
+#pragma omp simd
+        for (int l = 0; l < N; ++l) {
+          r_re[l] += u_re[l] * v_re[l] + u_im[l] * v_im[l];
+          r_im[l] += u_re[l] * v_im[l] - u_im[l] * v_re[l];
+        }
+      }
+    }
+  }
+}
+
+template <class T, int N>
+qacc void aligned_spin_matrix_mul(T* ret, const SpinMatrixT<T>& sm,
+                                  const T* v)
+// ret = sm * v
+// ret, v: WilsonVector ; sm is the same for all lanes
+{
+  for (int i = 0; i < 4 * NUM_COLOR * 2 * N; ++i) {
+    ret[i] = 0;
+  }
+  for (int s1 = 0; s1 < 4; ++s1) {
+    for (int s2 = 0; s2 < 4; ++s2) {
+      const ComplexT<T>& sm_s1_s2 = sm.p[s1 * 4 + s2];
+      if (sm_s1_s2 == (T)0.0) {
+        continue;
+      }
+      const T a_re = sm_s1_s2.real();
+      const T a_im = sm_s1_s2.imag();
+      for (int c = 0; c < NUM_COLOR; ++c) {
+        T* r_re = ret + 2 * (s1 * NUM_COLOR + c) * N;
+        T* r_im = r_re + N;
+        const T* v_re = v + 2 * (s2 * NUM_COLOR + c) * N;
+        const T* v_im = v_re + N;
+#pragma omp simd
+        for (int l = 0; l < N; ++l) {
+          r_re[l] += a_re * v_re[l] - a_im * v_im[l];
+          r_im[l] += a_re * v_im[l] + a_im * v_re[l];
+        }
+      }
+    }
+  }
+}
+
+template <class T, int N>
+qacc void aligned_complex_scale(T* ret, const ComplexT<T>& a, const T* v,
+                                const Int n_complex)
+// ret = a * v
+// ret, v: n_complex complex numbers ; ret can be the same as v
+{
+  const T a_re = a.real();
+  const T a_im = a.imag();
+  for (Int k = 0; k < n_complex; ++k) {
+    T* r_re = ret + 2 * k * N;
+    T* r_im = r_re + N;
+    const T* v_re = v + 2 * k * N;
+    const T* v_im = v_re + N;
+#pragma omp simd
+    for (int l = 0; l < N; ++l) {
+      const T re = a_re * v_re[l] - a_im * v_im[l];
+      const T im = a_re * v_im[l] + a_im * v_re[l];
+      r_re[l] = re;
+      r_im[l] = im;
+    }
+  }
+}
+
+template <class T, int N>
+qacc void aligned_complex_axpy(T* ret, const ComplexT<T>& a, const T* v,
+                               const Int n_complex)
+// ret += a * v
+// ret, v: n_complex complex numbers
+{
+  const T a_re = a.real();
+  const T a_im = a.imag();
+  for (Int k = 0; k < n_complex; ++k) {
+    T* r_re = ret + 2 * k * N;
+    T* r_im = r_re + N;
+    const T* v_re = v + 2 * k * N;
+    const T* v_im = v_re + N;
+#pragma omp simd
+    for (int l = 0; l < N; ++l) {
+      r_re[l] += a_re * v_re[l] - a_im * v_im[l];
+      r_im[l] += a_re * v_im[l] + a_im * v_re[l];
+    }
+  }
+}
+
+}  // namespace qlat
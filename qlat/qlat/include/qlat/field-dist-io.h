@@ -374,6 +374,7 @@ Long dist_read_dist_data(const std::vector<DistData<M>>& dds,
   Long total_ops = 0;
   const int n_cycle = std::max(1, num_node / dist_read_par_limit());
   std::vector<Long> id_counts(num_node, 0);
+  std::vector<crc32_t> crcs(num_node, 0);  // same as dist_crc32s(dds, num_node)
   for (int i = 0; i < n_cycle; i++) {
     Long bytes = 0;
     Long ops = 0;
@@ -387,7 +388,7 @@ Long dist_read_dist_data(const std::vector<DistData<M>>& dds,
           for (size_t l = k; l < dds.size(); ++l) {
             const DistData<M>& dd = dds[l];
             if (id_node == dd.id_node) {
-              bytes += qread_data(get_data(dd), fp);
+              bytes += qread_data_crc32(get_data(dd), crcs[id_node], fp);
               ops += 1;
               id_counts[id_node] += 1;
             }
@@ -416,7 +417,7 @@ Long dist_read_dist_data(const std::vector<DistData<M>>& dds,
     qassert(id_counts[id] ==
             id_counts[0]);  // every id_node has the same number of fields
   }
-  std::vector<crc32_t> crcs = dist_crc32s(dds, num_node);
+  glb_sum_byte_vec(get_data(crcs));
   crc32_t crc = dist_crc32(crcs);
   const bool is_checking = is_checksum_missmatch();
   is_checksum_missmatch() = false;
@@ -5,6 +5,7 @@
 #include <qlat/field.h>
 
 #include <map>
+#include <memory>
 #include <set>
 #include <vector>
 
@@ -46,6 +47,9 @@ void set_marks_field_all(CommMarks& marks, const Geometry& geo, const Int multip
 void set_marks_field_1(CommMarks& marks, const Geometry& geo, const Int multiplicity,
                        const std::string& tag);
 
+void set_marks_field_spatial_1(CommMarks& marks, const Geometry& geo,
+                               const Int multiplicity, const std::string& tag);
+
 void set_marks_field_gf_hamilton(CommMarks& marks, const Geometry& geo, const Int multiplicity,
                                  const std::string& tag);
 
@@ -64,6 +68,8 @@ struct API CommMsgInfo {
   Long size;
 };
 
+struct API CommPlanBuffer;
+
 struct API CommPlan {
   Long total_send_size;  // send buffer size
   std::vector<CommMsgInfo> send_msg_infos;
@@ -71,8 +77,48 @@ struct API CommPlan {
   Long total_recv_size;  // recv buffer size
   std::vector<CommMsgInfo> recv_msg_infos;
   std::vector<CommPackInfo> recv_pack_infos;
+  //
+  mutable std::map<Long, std::shared_ptr<CommPlanBuffer>> buffers;
+  // elem_size -> reusable buffers (see get_comm_plan_buffer)
+};
+
+struct API CommPlanBuffer {
+  // Send / recv buffers (and the MPI requests) of a CommPlan for one element
+  // size.
+  // If is_persistent, the buffers are kept in CommPlan::buffers and reused,
+  // and reqs are MPI persistent requests created once in init.
+  bool is_in_use;
+  bool is_persistent;
+  Long elem_size;
+  vector<Char> send_buffer;
+  vector<Char> recv_buffer;
+  std::vector<MPI_Request> reqs;
+  //
+  CommPlanBuffer()
+  {
+    is_in_use = false;
+    is_persistent = false;
+    elem_size = 0;
+  }
+  CommPlanBuffer(const CommPlanBuffer&) = delete;
+  //
+  ~CommPlanBuffer();
+  //
+  CommPlanBuffer& operator=(const CommPlanBuffer&) = delete;
+  //
+  void init(const CommPlan& plan, const Long elem_size_,
+            const bool is_persistent_);
+  //
+  void start(const CommPlan& plan);
 };
 
+API inline bool& get_comm_plan_buffer_persistent()
+// qlat parameter
+{
+  static bool b = get_env_long_default("q_comm_plan_buffer_persistent", 1) != 0;
+  return b;
+}
+
 struct API CommPlanKey {
   std::string key;
   SetMarksField set_marks_field;
@@ -108,18 +154,69 @@ const CommPlan& get_comm_plan(const SetMarksField& set_marks_field,
                               const std::string& tag, const Geometry& geo,
                               const Int multiplicity);
 
+std::shared_ptr<CommPlanBuffer> get_comm_plan_buffer(const CommPlan& plan,
+                                                     const Long elem_size);
+
+void release_comm_plan_buffer(std::shared_ptr<CommPlanBuffer>& buffer);
+
+struct API CommOverlapIndices {
+  // Local site indices (w.r.t. the geo of the stencil output) split by whether
+  // the stencil may read from the expanded (halo) region.
+  std::vector<Long> interior_indices;
+  std::vector<Long> boundary_indices;
+};
+
+CommOverlapIndices make_comm_overlap_indices(const Geometry& geo,
+                                             const Geometry& geo_ext);
+
+API inline Cache<std::string, CommOverlapIndices>&
+get_comm_overlap_indices_cache()
+{
+  static Cache<std::string, CommOverlapIndices> cache("CommOverlapIndicesCache",
+                                                      32);
+  return cache;
+}
+
+const CommOverlapIndices& get_comm_overlap_indices(const Geometry& geo,
+                                                   const Geometry& geo_ext);
+
 template <class M>
-void refresh_expanded(Field<M>& f, const CommPlan& plan)
+struct API RefreshExpandedHandle {
+  // Split-phase state of refresh_expanded.
+  // Created by refresh_expanded_start and consumed by refresh_expanded_finish.
+  bool is_active;
+  Field<M>* p_field;
+  const CommPlan* p_plan;
+  std::shared_ptr<CommPlanBuffer> buffer;
+  //
+  RefreshExpandedHandle()
+  {
+    is_active = false;
+    p_field = NULL;
+    p_plan = NULL;
+  }
+};
+
+template <class M>
+void refresh_expanded_start(RefreshExpandedHandle<M>& h, Field<M>& f,
+                            const CommPlan& plan)
+// Pack the send buffer and post all the irecv/isend.
+// Only the local sites of f are read until refresh_expanded_finish returns.
+// The expanded (halo) sites of f must not be accessed in the mean time.
 {
+  qassert(not h.is_active);
+  h.p_field = &f;
+  h.p_plan = &plan;
   const Long total_bytes =
       (plan.total_recv_size + plan.total_send_size) * sizeof(M);
   if (0 == total_bytes) {
     return;
   }
-  TIMER_FLOPS("refresh_expanded");
+  TIMER_FLOPS("refresh_expanded_start");
   timer.flops += total_bytes / 2;
-  vector<M> send_buffer(plan.total_send_size);
-  vector<M> recv_buffer(plan.total_recv_size);
+  h.is_active = true;
+  h.buffer = get_comm_plan_buffer(plan, sizeof(M));
+  M* send_buffer = (M*)h.buffer->send_buffer.data();
 #pragma omp parallel for
   for (Long i = 0; i < (Long)plan.send_pack_infos.size(); ++i) {
     const CommPackInfo& cpi = plan.send_pack_infos[i];
@@ -127,34 +224,149 @@ void refresh_expanded(Field<M>& f, const CommPlan& plan)
            cpi.size * sizeof(M));
   }
   {
-    sync_node();
+    TIMER("refresh_expanded-comm-init");
+    h.buffer->start(plan);
+  }
+}
+
+template <class M>
+void refresh_expanded_finish(RefreshExpandedHandle<M>& h)
+// Wait for the communication started by refresh_expanded_start and unpack the
+// received data to the expanded sites.
+{
+  if (not h.is_active) {
+    return;
+  }
+  TIMER("refresh_expanded_finish");
+  qassert(h.p_field != NULL);
+  qassert(h.p_plan != NULL);
+  Field<M>& f = *h.p_field;
+  const CommPlan& plan = *h.p_plan;
+  {
     TIMER_FLOPS("refresh_expanded-comm");
     timer.flops +=
         (plan.total_recv_size + plan.total_send_size) * sizeof(M) / 2;
-    std::vector<MPI_Request> reqs;
-    {
-      TIMER("refresh_expanded-comm-init");
-      const int mpi_tag = 10;
-      for (size_t i = 0; i < plan.recv_msg_infos.size(); ++i) {
-        const CommMsgInfo& cmi = plan.recv_msg_infos[i];
-        mpi_irecv(&recv_buffer[cmi.buffer_idx], cmi.size * sizeof(M), MPI_BYTE,
-                  cmi.id_node, mpi_tag, get_comm(), reqs);
-      }
-      for (size_t i = 0; i < plan.send_msg_infos.size(); ++i) {
-        const CommMsgInfo& cmi = plan.send_msg_infos[i];
-        mpi_isend(&send_buffer[cmi.buffer_idx], cmi.size * sizeof(M), MPI_BYTE,
-                  cmi.id_node, mpi_tag, get_comm(), reqs);
-      }
-    }
-    mpi_waitall(reqs);
-    sync_node();
+    mpi_waitall(h.buffer->reqs);
   }
+  const M* recv_buffer = (const M*)h.buffer->recv_buffer.data();
 #pragma omp parallel for
   for (Long i = 0; i < (Long)plan.recv_pack_infos.size(); ++i) {
     const CommPackInfo& cpi = plan.recv_pack_infos[i];
     memcpy(&f.get_elem_offset(cpi.offset), &recv_buffer[cpi.buffer_idx],
            cpi.size * sizeof(M));
   }
+  release_comm_plan_buffer(h.buffer);
+  h.is_active = false;
+}
+
+template <class M>
+void refresh_expanded(Field<M>& f, const CommPlan& plan)
+{
+  const Long total_bytes =
+      (plan.total_recv_size + plan.total_send_size) * sizeof(M);
+  if (0 == total_bytes) {
+    return;
+  }
+  TIMER_FLOPS("refresh_expanded");
+  timer.flops += total_bytes / 2;
+  RefreshExpandedHandle<M> h;
+  sync_node();
+  refresh_expanded_start(h, f, plan);
+  refresh_expanded_finish(h);
+  sync_node();
+}
+
+template <class M, class F>
+void refresh_expanded_overlap(Field<M>& f, const CommPlan& plan,
+                              const Geometry& geo, const F& kernel)
+// Call kernel(index) for all 0 <= index < geo.local_volume().
+// The kernel is first called on the interior sites (which do not read the
+// expanded sites of f) while the communication is in flight, then on the
+// boundary sites after the expanded sites of f are refreshed.
+// The kernel is called from OpenMP threads on host.
+{
+  TIMER("refresh_expanded_overlap");
+  QLAT_PUSH_DIAGNOSTIC_DISABLE_DANGLING_REF;
+  const CommOverlapIndices& coi = get_comm_overlap_indices(geo, f.geo());
+  QLAT_DIAGNOSTIC_POP;
+  const std::vector<Long>& interior_indices = coi.interior_indices;
+  const std::vector<Long>& boundary_indices = coi.boundary_indices;
+  RefreshExpandedHandle<M> h;
+  refresh_expanded_start(h, f, plan);
+  {
+    TIMER("refresh_expanded_overlap-interior");
+#pragma omp parallel for
+    for (Long i = 0; i < (Long)interior_indices.size(); ++i) {
+      kernel(interior_indices[i]);
+    }
+  }
+  refresh_expanded_finish(h);
+  {
+    TIMER("refresh_expanded_overlap-boundary");
+#pragma omp parallel for
+    for (Long i = 0; i < (Long)boundary_indices.size(); ++i) {
+      kernel(boundary_indices[i]);
+    }
+  }
+}
+
+template <class M, class F>
+void refresh_expanded_1_overlap(Field<M>& f, const Geometry& geo,
+                                const F& kernel)
+{
+  QLAT_PUSH_DIAGNOSTIC_DISABLE_DANGLING_REF;
+  const CommPlan& plan =
+      get_comm_plan(set_marks_field_1, "", f.geo(), f.multiplicity);
+  QLAT_DIAGNOSTIC_POP;
+  refresh_expanded_overlap(f, plan, geo, kernel);
+}
+
+template <int N, class M, class F>
+void refresh_expanded_overlap_blocks(Field<M>& f, const CommPlan& plan,
+                                     const Geometry& geo, const F& kernel)
+// Same as refresh_expanded_overlap, but call kernel(indices, n) with the
+// indices of up to N (interior or boundary) sites at a time (0 < n <= N).
+{
+  TIMER("refresh_expanded_overlap_blocks");
+  QLAT_PUSH_DIAGNOSTIC_DISABLE_DANGLING_REF;
+  const CommOverlapIndices& coi = get_comm_overlap_indices(geo, f.geo());
+  QLAT_DIAGNOSTIC_POP;
+  const std::vector<Long>& interior_indices = coi.interior_indices;
+  const std::vector<Long>& boundary_indices = coi.boundary_indices;
+  const Long n_block_interior = (interior_indices.size() + N - 1) / N;
+  const Long n_block_boundary = (boundary_indices.size() + N - 1) / N;
+  RefreshExpandedHandle<M> h;
+  refresh_expanded_start(h, f, plan);
+  {
+    TIMER("refresh_expanded_overlap_blocks-interior");
+#pragma omp parallel for
+    for (Long block = 0; block < n_block_interior; ++block) {
+      const Long i = block * N;
+      const Int n = std::min((Long)N, (Long)interior_indices.size() - i);
+      kernel(&interior_indices[i], n);
+    }
+  }
+  refresh_expanded_finish(h);
+  {
+    TIMER("refresh_expanded_overlap_blocks-boundary");
+#pragma omp parallel for
+    for (Long block = 0; block < n_block_boundary; ++block) {
+      const Long i = block * N;
+      const Int n = std::min((Long)N, (Long)boundary_indices.size() - i);
+      kernel(&boundary_indices[i], n);
+    }
+  }
+}
+
+template <int N, class M, class F>
+void refresh_expanded_1_overlap_blocks(Field<M>& f, const Geometry& geo,
+                                       const F& kernel)
+{
+  QLAT_PUSH_DIAGNOSTIC_DISABLE_DANGLING_REF;
+  const CommPlan& plan =
+      get_comm_plan(set_marks_field_1, "", f.geo(), f.multiplicity);
+  QLAT_DIAGNOSTIC_POP;
+  refresh_expanded_overlap_blocks<N>(f, plan, geo, kernel);
 }
 
 template <class M>
@@ -189,6 +401,13 @@ void refresh_expanded_1(Field<M>& f)
 
 #define QLAT_EXTERN_TEMPLATE(TYPENAME)                              \
                                                                     \
+  QLAT_EXTERN template void refresh_expanded_start(                 \
+      RefreshExpandedHandle<TYPENAME>& h, Field<TYPENAME>& f,       \
+      const CommPlan& plan);                                        \
+                                                                    \
+  QLAT_EXTERN template void refresh_expanded_finish(                \
+      RefreshExpandedHandle<TYPENAME>& h);                          \
+                                                                    \
   QLAT_EXTERN template void refresh_expanded(Field<TYPENAME>& f,    \
                                              const CommPlan& plan); \
                                                                     \
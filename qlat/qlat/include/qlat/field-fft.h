@@ -11,44 +11,330 @@
 namespace qlat
 {  //
 
-struct API FftComplexFieldPlan {
+template <class T>
+struct FftwTraits;
+// Precision dependent parts of FFTW.
+// T = ComplexD uses fftw and T = ComplexF uses fftwf.
+//
+// All the plans are in-place batched 1D transforms of length sizec. Element j
+// of the batch b is at data[j * howmany + b].
+
+template <>
+struct FftwTraits<ComplexD> {
+  using Plan = fftw_plan;
+  //
+  static const char* get_suffix() { return ""; }
+  //
+  static ComplexD* malloc(const Long size)
+  {
+    return (ComplexD*)fftw_malloc(size * sizeof(ComplexD));
+  }
+  static void free(ComplexD* data) { fftw_free(data); }
+  //
+  static Plan make_plan(const int sizec, const Long howmany,
+                        const bool is_forward)
+  {
+    ComplexD* fftdatac = malloc(howmany * sizec);
+    const int rank = 1;
+    const int n[1] = {sizec};
+    const Long dist = 1;
+    const Long stride = howmany;
+    const Plan plan = fftw_plan_many_dft(
+        rank, n, howmany, (fftw_complex*)fftdatac, n, stride, dist,
+        (fftw_complex*)fftdatac, n, stride, dist,
+        is_forward ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
+    free(fftdatac);
+    return plan;
+  }
+  static void destroy_plan(Plan plan) { fftw_destroy_plan(plan); }
+  static void execute(const Plan plan, ComplexD* data)
+  {
+    fftw_execute_dft(plan, (fftw_complex*)data, (fftw_complex*)data);
+  }
+};
+
+template <>
+struct FftwTraits<ComplexF> {
+  using Plan = fftwf_plan;
+  //
+  static const char* get_suffix() { return "F"; }
+  //
+  static ComplexF* malloc(const Long size)
+  {
+    return (ComplexF*)fftwf_malloc(size * sizeof(ComplexF));
+  }
+  static void free(ComplexF* data) { fftwf_free(data); }
+  //
+  static Plan make_plan(const int sizec, const Long howmany,
+                        const bool is_forward)
+  {
+    ComplexF* fftdatac = malloc(howmany * sizec);
+    const int rank = 1;
+    const int n[1] = {sizec};
+    const Long dist = 1;
+    const Long stride = howmany;
+    const Plan plan = fftwf_plan_many_dft(
+        rank, n, howmany, (fftwf_complex*)fftdatac, n, stride, dist,
+        (fftwf_complex*)fftdatac, n, stride, dist,
+        is_forward ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
+    free(fftdatac);
+    return plan;
+  }
+  static void destroy_plan(Plan plan) { fftwf_destroy_plan(plan); }
+  static void execute(const Plan plan, ComplexF* data)
+  {
+    fftwf_execute_dft(plan, (fftwf_complex*)data, (fftwf_complex*)data);
+  }
+};
+
+template <class T>
+struct API FftComplexFieldPlanT {
+  // T is ComplexD or ComplexF
   Geometry geo;     // geo.is_only_local == true
-  int mc;           // multiplicity * sizeof(M) / sizeof(ComplexD)
+  int mc;           // multiplicity * sizeof(M) / sizeof(T)
   int dir;          // direction of the fft
   bool is_forward;  // is forward fft (forward \sum_x f[x] exp(-i k x))
   //
-  fftw_plan fftplan;
+  typename FftwTraits<T>::Plan fftplan;
   ShufflePlan sp;
   //
-  FftComplexFieldPlan() {}
+  FftComplexFieldPlanT() {}
   //
-  ~FftComplexFieldPlan() { init(); }
+  ~FftComplexFieldPlanT() { init(); }
   //
   void init();
   void init(const Geometry& geo_, const int mc_, const int dir_,
             const bool is_forward_);
 };
 
-API inline Cache<std::string, FftComplexFieldPlan>& get_fft_plan_cache()
+using FftComplexFieldPlan = FftComplexFieldPlanT<ComplexD>;
+
+using FftComplexFieldPlanF = FftComplexFieldPlanT<ComplexF>;
+
+template <class T = ComplexD>
+API inline Cache<std::string, FftComplexFieldPlanT<T> >& get_fft_plan_cache()
+{
+  static Cache<std::string, FftComplexFieldPlanT<T> > cache(
+      std::string("FftComplexFieldPlan") + FftwTraits<T>::get_suffix() +
+          "Cache",
+      32);
+  return cache;
+}
+
+template <class T = ComplexD>
+FftComplexFieldPlanT<T>& get_fft_plan(const Geometry& geo, const Int mc,
+                                      const int dir, const bool is_forward);
+
+API inline bool& is_fft_pencil()
+// qlat parameter
+// use FftPencilPlan (chained transposes) in fft_complex_field
+{
+  static bool b = get_env_long_default("q_fft_pencil", 1) != 0;
+  return b;
+}
+
+struct API FftPencilTranspose {
+  // Move the data of a batch of fields from one layout to another.
+  // send_pack_infos: layout from -> send buffer
+  // recv_pack_infos: recv buffer -> layout to
+  std::vector<ShufflePlanSendPackInfo> send_pack_infos;
+  std::vector<ShufflePlanSendPackInfo> recv_pack_infos;
+  ShuffleCommPlan scp;
+};
+
+template <class T>
+struct API FftPencilPlanT {
+  // Multi-dimensional FFT with the directions in dirs.
+  // T is ComplexD or ComplexF
+  //
+  // Layouts of the data (mc T per site):
+  // layout == -1: local field order (site index of geo).
+  // layout == i (0 <= i < dirs.size()): pencil layout of dirs[i]. Each node
+  // holds n_lines[i] full lines along dirs[i] and site_idx = xg[dirs[i]] *
+  // n_lines[i] + line.
+  //
+  // transposes[i] moves layout i - 1 to layout i (i < dirs.size()).
+  // transposes[dirs.size()] moves layout dirs.size() - 1 back to layout -1.
+  // The transposes can be applied in reverse.
+  Geometry geo;  // geo.is_only_local == true
+  Int mc;        // number of complex numbers per site (for the whole batch)
+  std::vector<int> dirs;
+  //
+  std::vector<Long> n_lines;
+  std::vector<Long> line_start;
+  std::vector<FftPencilTranspose> transposes;
+  std::vector<typename FftwTraits<T>::Plan> fftplans_forward;
+  std::vector<typename FftwTraits<T>::Plan> fftplans_backward;
+  //
+  FftPencilPlanT() {}
+  //
+  ~FftPencilPlanT() { init(); }
+  //
+  void init();
+  void init(const Geometry& geo_, const Int mc_, const std::vector<int>& dirs_);
+  //
+  Long layout_size(const Int layout) const;
+  Coordinate coordinate_g_from_site_idx(const Int layout,
+                                        const Long site_idx) const;
+};
+
+using FftPencilPlan = FftPencilPlanT<ComplexD>;
+
+using FftPencilPlanF = FftPencilPlanT<ComplexF>;
+
+template <class T = ComplexD>
+API inline Cache<std::string, FftPencilPlanT<T> >& get_fft_pencil_plan_cache()
 {
-  static Cache<std::string, FftComplexFieldPlan> cache(
-      "FftComplexFieldPlanCache", 32);
+  static Cache<std::string, FftPencilPlanT<T> > cache(
+      std::string("FftPencilPlan") + FftwTraits<T>::get_suffix() + "Cache",
+      16);
   return cache;
 }
 
-FftComplexFieldPlan& get_fft_plan(const Geometry& geo, const Int mc,
-                                  const int dir, const bool is_forward);
+template <class T = ComplexD>
+FftPencilPlanT<T>& get_fft_pencil_plan(const Geometry& geo, const Int mc,
+                                       const std::vector<int>& dirs);
+
+template <class T>
+struct API FftPencilFieldT {
+  // A batch of complex fields in one of the layouts of FftPencilPlanT.
+  // T is ComplexD or ComplexF.
+  // The numbers of field k are at [site_idx * mc + k * mc / n_field + j].
+  Geometry geo;
+  Int mc;
+  Int n_field;
+  std::vector<int> dirs;
+  Int layout;
+  vector<T> data;
+  //
+  FftPencilFieldT() { init(); }
+  //
+  void init()
+  {
+    geo.init();
+    mc = 0;
+    n_field = 0;
+    dirs.clear();
+    layout = -1;
+    data.init();
+  }
+};
+
+using FftPencilField = FftPencilFieldT<ComplexD>;
+
+using FftPencilFieldF = FftPencilFieldT<ComplexF>;
+
+void fft_pencil_transpose(FftPencilField& pf, const Int layout);
+
+void fft_pencil_transpose(FftPencilFieldF& pf, const Int layout);
+
+void fft_pencil_field(FftPencilField& pf, const bool is_forward,
+                      const bool is_keep_pencil = false);
+
+void fft_pencil_field(FftPencilFieldF& pf, const bool is_forward,
+                      const bool is_keep_pencil = false);
+
+template <class T, class M>
+void set_fft_pencil_field(FftPencilFieldT<T>& pf,
+                          const std::vector<ConstHandle<Field<M> > >& vec,
+                          const std::vector<int>& dirs)
+// pf is in layout -1 after this call
+{
+  TIMER("set_fft_pencil_field");
+  qassert(vec.size() > 0);
+  const Geometry geo = geo_resize(vec[0]().geo());
+  const Int multiplicity = vec[0]().multiplicity;
+  const Int mc1 = multiplicity * sizeof(M) / sizeof(T);
+  qassert(mc1 * (Long)sizeof(T) == multiplicity * (Long)sizeof(M));
+  const Int n_field = vec.size();
+  pf.init();
+  pf.geo = geo;
+  pf.mc = mc1 * n_field;
+  pf.n_field = n_field;
+  pf.dirs = dirs;
+  pf.layout = -1;
+  pf.data.resize(geo.local_volume() * pf.mc);
+  for (Int k = 0; k < n_field; ++k) {
+    const Field<M>& f = vec[k]();
+    qassert(geo_resize(f.geo()) == geo);
+    qassert(f.multiplicity == multiplicity);
+    T* pdata = &pf.data[k * mc1];
+    const Int mc = pf.mc;
+    qthread_for(index, geo.local_volume(), {
+      const Coordinate xl = geo.coordinate_from_index(index);
+      const Vector<M> v = f.get_elems_const(xl);
+      std::memcpy((void*)&pdata[index * mc], (const void*)v.data(),
+                  mc1 * sizeof(T));
+    });
+  }
+}
+
+template <class T, class M>
+void set_fields_from_fft_pencil_field(std::vector<Handle<Field<M> > >& vec,
+                                      const FftPencilFieldT<T>& pf)
+// pf needs to be in layout -1
+// vec needs to have pf.n_field elements with correct geo and multiplicity
+{
+  TIMER("set_fields_from_fft_pencil_field");
+  qassert(pf.layout == -1);
+  qassert((Int)vec.size() == pf.n_field);
+  const Geometry& geo = pf.geo;
+  const Int mc1 = pf.mc / pf.n_field;
+  for (Int k = 0; k < pf.n_field; ++k) {
+    Field<M>& f = vec[k]();
+    qassert(geo_resize(f.geo()) == geo);
+    qassert(f.multiplicity * (Long)sizeof(M) == mc1 * (Long)sizeof(T));
+    const T* pdata = &pf.data[k * mc1];
+    const Int mc = pf.mc;
+    qthread_for(index, geo.local_volume(), {
+      const Coordinate xl = geo.coordinate_from_index(index);
+      Vector<M> v = f.get_elems(xl);
+      std::memcpy((void*)v.data(), (const void*)&pdata[index * mc],
+                  mc1 * sizeof(T));
+    });
+  }
+}
 
 template <class M>
-void fft_complex_field_dir(Field<M>& field1, const Field<M>& field,
-                           const int dir, const bool is_forward)
+void fft_complex_fields_pencil(std::vector<Handle<Field<M> > >& vec,
+                               const std::vector<int>& dirs,
+                               const bool is_forward)
+// All fields in vec need to have the same geo and multiplicity.
+// One transpose per direction (plus one back) for the whole batch.
+// Fields made of ComplexF are transformed in single precision.
 {
-  TIMER("fft_complex_field_dir");
+  TIMER_FLOPS("fft_complex_fields_pencil");
+  if (vec.size() == 0) {
+    return;
+  }
+  std::vector<ConstHandle<Field<M> > > cvec(vec.size());
+  for (Long i = 0; i < (Long)vec.size(); ++i) {
+    cvec[i].init(vec[i]());
+    timer.flops += get_data(vec[i]()).data_size() * get_num_node();
+  }
+  if (is_composed_of_complex_f<M>()) {
+    FftPencilFieldF pf;
+    set_fft_pencil_field(pf, cvec, dirs);
+    fft_pencil_field(pf, is_forward);
+    set_fields_from_fft_pencil_field(vec, pf);
+  } else {
+    FftPencilField pf;
+    set_fft_pencil_field(pf, cvec, dirs);
+    fft_pencil_field(pf, is_forward);
+    set_fields_from_fft_pencil_field(vec, pf);
+  }
+}
+
+template <class T, class M>
+void fft_complex_field_dir_t(Field<M>& field1, const Field<M>& field,
+                             const int dir, const bool is_forward)
+// T is ComplexD or ComplexF (the type M is composed of)
+{
+  TIMER(std::string("fft_complex_field_dir") + FftwTraits<T>::get_suffix());
   const Geometry geo = geo_resize(field.geo());
   const Int multiplicity = field.multiplicity;
-  const int mc = multiplicity * sizeof(M) / sizeof(ComplexD);
-  FftComplexFieldPlan& plan = get_fft_plan(geo, mc, dir, is_forward);
-  fftw_plan& fftplan = plan.fftplan;
+  const int mc = multiplicity * sizeof(M) / sizeof(T);
+  FftComplexFieldPlanT<T>& plan = get_fft_plan<T>(geo, mc, dir, is_forward);
   const int sizec = geo.total_site()[dir];
   const Long nc = geo.local_volume() / geo.node_site[dir] * mc;
   const Long chunk = ((nc / mc - 1) / geo.geon.size_node[dir] + 1) * mc;
@@ -60,15 +346,14 @@ void fft_complex_field_dir(Field<M>& field1, const Field<M>& field,
   std::vector<Field<M> > fft_fields;
   shuffle_field(fft_fields, field, sp);
   field1.init();
-  ComplexD* fftdatac = (ComplexD*)fftw_malloc(nc_size * sizec * sizeof(ComplexD));
+  T* fftdatac = FftwTraits<T>::malloc(nc_size * sizec);
 #pragma omp parallel for
   for (int i = 0; i < (int)fft_fields.size(); ++i) {
-    if (not(get_data_size(fft_fields[i]) == nc_size * (int)sizeof(ComplexD))) {
-      displayln(fname +
-                ssprintf(": get_data_size=%d ; nc_size*sizeof(ComplexD)=%d",
-                         get_data_size(fft_fields[i]),
-                         nc_size * (int)sizeof(ComplexD)));
-      qassert(get_data_size(fft_fields[i]) == nc_size * (int)sizeof(ComplexD));
+    if (not(get_data_size(fft_fields[i]) == nc_size * (int)sizeof(T))) {
+      displayln(fname + ssprintf(": get_data_size=%d ; nc_size*sizeof(T)=%d",
+                                 get_data_size(fft_fields[i]),
+                                 nc_size * (int)sizeof(T)));
+      qassert(get_data_size(fft_fields[i]) == nc_size * (int)sizeof(T));
     }
     std::memcpy((void*)&fftdatac[nc_size * i],
                 (void*)get_data(fft_fields[i]).data(),
@@ -76,18 +361,30 @@ void fft_complex_field_dir(Field<M>& field1, const Field<M>& field,
   }
   {
     TIMER("fft_complex_field_dir-fftw");
-    fftw_execute_dft(fftplan, (fftw_complex*)fftdatac, (fftw_complex*)fftdatac);
+    FftwTraits<T>::execute(plan.fftplan, fftdatac);
   }
 #pragma omp parallel for
   for (int i = 0; i < (int)fft_fields.size(); ++i) {
     std::memcpy((void*)get_data(fft_fields[i]).data(),
                 (void*)&fftdatac[nc_size * i], get_data_size(fft_fields[i]));
   }
-  fftw_free(fftdatac);
+  FftwTraits<T>::free(fftdatac);
   field1.init(geo, multiplicity);
   shuffle_field_back(field1, fft_fields, sp);
 }
 
+template <class M>
+void fft_complex_field_dir(Field<M>& field1, const Field<M>& field,
+                           const int dir, const bool is_forward)
+// Fields made of ComplexF are transformed in single precision.
+{
+  if (is_composed_of_complex_f<M>()) {
+    fft_complex_field_dir_t<ComplexF>(field1, field, dir, is_forward);
+  } else {
+    fft_complex_field_dir_t<ComplexD>(field1, field, dir, is_forward);
+  }
+}
+
 template <class M>
 void fft_complex_field_dir(Field<M>& field, const int dir,
                            const bool is_forward)
@@ -104,6 +401,12 @@ void fft_complex_field(Field<M>& field, const bool is_forward = true)
   // field(k) <- \sum_{x} exp( - ii * 2 pi * k * x ) field(x)
   // backwards compute
   // field(x) <- \sum_{k} exp( + ii * 2 pi * k * x ) field(k)
+  if (is_fft_pencil()) {
+    std::vector<Handle<Field<M> > > vec(1);
+    vec[0].init(field);
+    fft_complex_fields_pencil(vec, std::vector<int>{0, 1, 2, 3}, is_forward);
+    return;
+  }
   for (int dir = 0; dir < 4; ++dir) {
     fft_complex_field_dir(field, dir, is_forward);
   }
@@ -118,6 +421,12 @@ void fft_complex_field_spatial(Field<M>& field, const bool is_forward = true)
   // field(k) <- \sum_{x} exp( - ii * 2 pi * k * x ) field(x)
   // backwards compute
   // field(x) <- \sum_{k} exp( + ii * 2 pi * k * x ) field(k)
+  if (is_fft_pencil()) {
+    std::vector<Handle<Field<M> > > vec(1);
+    vec[0].init(field);
+    fft_complex_fields_pencil(vec, std::vector<int>{0, 1, 2}, is_forward);
+    return;
+  }
   for (int dir = 0; dir < 3; ++dir) {
     fft_complex_field_dir(field, dir, is_forward);
   }
@@ -196,6 +505,18 @@ void fft_complex_fields(std::vector<Handle<Field<M> > >& vec,
   QLAT_EXTERN template void fft_complex_field_spatial<TYPENAME>(             \
       Field<TYPENAME> & field, const bool is_forward);                       \
                                                                              \
+  QLAT_EXTERN template void fft_complex_field_dir_t<ComplexD, TYPENAME>(    \
+      Field<TYPENAME> & field1, const Field<TYPENAME>& field, const int dir, \
+      const bool is_forward);                                                \
+                                                                             \
+  QLAT_EXTERN template void fft_complex_field_dir_t<ComplexF, TYPENAME>(    \
+      Field<TYPENAME> & field1, const Field<TYPENAME>& field, const int dir, \
+      const bool is_forward);                                                \
+                                                                             \
+  QLAT_EXTERN template void fft_complex_fields_pencil<TYPENAME>(             \
+      std::vector<Handle<Field<TYPENAME> > > & vec,                          \
+      const std::vector<int>& dirs, const bool is_forward);                  \
+                                                                             \
   QLAT_EXTERN template void fft_complex_fields<TYPENAME>(                    \
       std::vector<Handle<Field<TYPENAME> > > & vec,                          \
       const std::vector<int>& fft_dirs,                                      \
@@ -311,6 +311,116 @@ inline void read_geo_info(Coordinate& total_site, Int& multiplicity,
   bcast(Vector<crc32_t>(&crc, 1));
 }
 
+// ----------------------
+
+API inline bool& is_field_io_mpi_io()
+// qlat parameter
+// use MPI-IO collective read / write in write_field and read_field
+{
+  static bool b = get_env_long_default("q_field_io_mpi_io", 0) != 0;
+  return b;
+}
+
+Long mpi_io_write_field_data(const std::string& path, const Long offset,
+                             const Geometry& geo, const Long site_size,
+                             const std::vector<char>& data);
+
+Long mpi_io_read_field_data(std::vector<char>& data, const std::string& path,
+                            const Geometry& geo, const Long site_size);
+
+template <class M>
+crc32_t set_mpi_io_buffer_from_field(std::vector<char>& data,
+                                     const Field<M>& f)
+// data: local sites ordered as in the file (same as index of geo_resize(geo))
+// return field_crc32(f), computed while filling data
+{
+  TIMER_VERBOSE_FLOPS("set_mpi_io_buffer_from_field");
+  const Geometry geo = geo_resize(f.geo());
+  qassert(geo.eo == 0);
+  const Long site_size = f.multiplicity * sizeof(M);
+  const Long total_volume = geo.total_volume();
+  const Long row_volume = geo.node_site[0];
+  const Long row_size = row_volume * site_size;
+  const Long num_row = geo.local_volume() / row_volume;
+  data.resize(geo.local_volume() * site_size);
+  const int v_limit = omp_get_max_threads();
+  std::vector<crc32_t> crcs(v_limit, 0);
+#pragma omp parallel
+  {
+    crc32_t crc = 0;
+#pragma omp for
+    for (Long row = 0; row < num_row; ++row) {
+      // one row of sites along x is contiguous in the file
+      char* p = &data[row * row_size];
+      for (Long i = 0; i < row_volume; ++i) {
+        const Coordinate xl = geo.coordinate_from_index(row * row_volume + i);
+        const Vector<M> v = f.get_elems_const(xl);
+        std::memcpy(p + i * site_size, v.data(), site_size);
+      }
+      const Coordinate xl = geo.coordinate_from_index(row * row_volume);
+      const Coordinate xg = geo.coordinate_g_from_l(xl);
+      const Long gindex = geo.g_index_from_g_coordinate(xg);
+      const Long offset = site_size * (total_volume - gindex) - row_size;
+      crc ^= crc32_shift(crc32(p, row_size), offset);
+    }
+    const int id = omp_get_thread_num();
+    crcs[id] = crc;
+  }
+  crc32_t ret = 0;
+  for (int i = 0; i < v_limit; ++i) {
+    ret ^= crcs[i];
+  }
+  glb_sum_byte(ret);
+  timer.flops += data.size();
+  return ret;
+}
+
+template <class M>
+crc32_t set_field_from_mpi_io_buffer(Field<M>& f,
+                                     const std::vector<char>& data)
+// f should already be initialized
+// return field_crc32(f), computed while reading data
+{
+  TIMER_VERBOSE_FLOPS("set_field_from_mpi_io_buffer");
+  const Geometry geo = geo_resize(f.geo());
+  qassert(geo.eo == 0);
+  const Long site_size = f.multiplicity * sizeof(M);
+  const Long total_volume = geo.total_volume();
+  const Long row_volume = geo.node_site[0];
+  const Long row_size = row_volume * site_size;
+  const Long num_row = geo.local_volume() / row_volume;
+  qassert((Long)data.size() == geo.local_volume() * site_size);
+  const int v_limit = omp_get_max_threads();
+  std::vector<crc32_t> crcs(v_limit, 0);
+#pragma omp parallel
+  {
+    crc32_t crc = 0;
+#pragma omp for
+    for (Long row = 0; row < num_row; ++row) {
+      const char* p = &data[row * row_size];
+      const Coordinate xl = geo.coordinate_from_index(row * row_volume);
+      const Coordinate xg = geo.coordinate_g_from_l(xl);
+      const Long gindex = geo.g_index_from_g_coordinate(xg);
+      const Long offset = site_size * (total_volume - gindex) - row_size;
+      crc ^= crc32_shift(crc32(p, row_size), offset);
+      for (Long i = 0; i < row_volume; ++i) {
+        const Coordinate xl = geo.coordinate_from_index(row * row_volume + i);
+        Vector<M> v = f.get_elems(xl);
+        std::memcpy(v.data(), p + i * site_size, site_size);
+      }
+    }
+    const int id = omp_get_thread_num();
+    crcs[id] = crc;
+  }
+  crc32_t ret = 0;
+  for (int i = 0; i < v_limit; ++i) {
+    ret ^= crcs[i];
+  }
+  glb_sum_byte(ret);
+  timer.flops += data.size();
+  return ret;
+}
+
 template <class M>
 Long write_field(const Field<M>& f, const std::string& path,
                  const Coordinate& new_size_node = Coordinate())
@@ -323,21 +433,30 @@ Long write_field(const Field<M>& f, const std::string& path,
   displayln_info(fname + ssprintf(": fn='%s'.", path.c_str()));
   qassert(is_initialized(f));
   const Geometry& geo = f.geo();
-  const crc32_t crc32 = field_crc32(f);
+  const bool is_mpi_io = is_field_io_mpi_io();
+  std::vector<char> data;
+  const crc32_t crc32 =
+      is_mpi_io ? set_mpi_io_buffer_from_field(data, f) : field_crc32(f);
+  std::string header;
   if (get_force_field_write_sizeof_M() == 0) {
-    qtouch_info(path + ".partial", make_field_header(geo, f.multiplicity, sizeof(M), crc32));
+    header = make_field_header(geo, f.multiplicity, sizeof(M), crc32);
   } else {
     const int sizeof_M = get_force_field_write_sizeof_M();
     qassert((f.multiplicity * sizeof(M)) % sizeof_M == 0);
     const Int multiplicity = (f.multiplicity * sizeof(M)) / sizeof_M;
-    qtouch_info(
-        path + ".partial",
-        make_field_header(geo, multiplicity, sizeof_M, crc32));
+    header = make_field_header(geo, multiplicity, sizeof_M, crc32);
     get_force_field_write_sizeof_M() = 0;
   }
-  const Long file_size = serial_write_field(
-      f, path + ".partial",
-      get_default_serial_new_size_node(geo, dist_write_par_limit()));
+  qtouch_info(path + ".partial", header);
+  Long file_size = 0;
+  if (is_mpi_io) {
+    file_size = mpi_io_write_field_data(path + ".partial", header.size(), geo,
+                                        f.multiplicity * sizeof(M), data);
+  } else {
+    file_size = serial_write_field(
+        f, path + ".partial",
+        get_default_serial_new_size_node(geo, dist_write_par_limit()));
+  }
   qrename_info(path + ".partial", path);
   timer.flops += file_size;
   return file_size;
@@ -380,8 +499,19 @@ Long read_field(Field<M>& f, const std::string& path,
       new_size_node_ == Coordinate()
           ? get_default_serial_new_size_node(geo, dist_read_par_limit())
           : new_size_node_;
-  const Long file_size =
-      serial_read_field_par(f, path, new_size_node, -data_size, SEEK_END);
+  Long file_size = 0;
+  crc32_t f_crc = 0;
+  if (is_field_io_mpi_io() and is_regular_file_sync_node(path)) {
+    std::vector<char> data;
+    file_size =
+        mpi_io_read_field_data(data, path, geo, multiplicity * sizeof(M));
+    if (file_size == data_size) {
+      f_crc = set_field_from_mpi_io_buffer(f, data);
+    }
+  } else {
+    file_size = serial_read_field_par(f, f_crc, path, new_size_node,
+                                      -data_size, SEEK_END);
+  }
   if (file_size != data_size) {
     displayln_info(
         fname +
@@ -389,7 +519,6 @@ Long read_field(Field<M>& f, const std::string& path,
                  file_size, data_size));
     qassert(false);
   }
-  const crc32_t f_crc = field_crc32(f);
   const bool is_checking = is_checksum_missmatch();
   is_checksum_missmatch() = false;
   if (crc != f_crc) {
@@ -40,14 +40,34 @@ inline Coordinate get_default_serial_new_size_node(const Geometry& geo, const in
   return new_size_node;
 }
 
+inline bool is_serial_new_size_node_ok(const Coordinate& total_site,
+                                       const Coordinate& new_size_node)
+// new_size_node is properly chosen (concatenating the new fields in the order
+// of new_id_node gives the field in the file order) if it only splits the
+// slowest dimensions: for d < 3 with new_size_node[d] > 1, every higher
+// dimension has new_size_node[d'] == total_site[d'].
+{
+  for (int d = 0; d < 3; ++d) {
+    if (new_size_node[d] > 1) {
+      for (int dd = d + 1; dd < 4; ++dd) {
+        if (new_size_node[dd] != total_site[dd]) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
 template <class M>
 Long serial_write_field(const Field<M>& f, const std::string& path,
                         const Coordinate& new_size_node)
 // will append to the file
-// assume new_size_node is properly chosen so that concatenate the new fields
-// would be correct. eg. new_size_node = Coordinate(1,1,1,2)
+// new_size_node needs to be properly chosen (see is_serial_new_size_node_ok).
+// eg. new_size_node = Coordinate(1,1,1,2)
 {
   TIMER_VERBOSE_FLOPS("serial_write_field");
+  qassert(is_serial_new_size_node_ok(f.geo().total_site(), new_size_node));
   std::vector<Field<M> > fs;
   shuffle_field(fs, f, new_size_node);
   const int mpi_tag = 6;
@@ -89,10 +109,11 @@ Long serial_read_field(Field<M>& f, const std::string& path,
                        const Coordinate& new_size_node, const Long offset = 0,
                        const int whence = SEEK_SET)
 // will read from offset relative to whence
-// assume new_size_node is properly choosen so that concatenate the new fields
-// would be correct. eg. new_size_node = Coordinate(1,1,1,2)
+// new_size_node needs to be properly chosen (see is_serial_new_size_node_ok).
+// eg. new_size_node = Coordinate(1,1,1,2)
 {
   TIMER_VERBOSE_FLOPS("serial_read_field");
+  qassert(is_serial_new_size_node_ok(f.geo().total_site(), new_size_node));
   if (not does_file_exist_qar_sync_node(path)) {
     displayln_info(fname +
                    ssprintf(": file does not exist: '%s'", path.c_str()));
@@ -144,17 +165,22 @@ Long serial_read_field(Field<M>& f, const std::string& path,
 }
 
 template <class M>
-Long serial_read_field_par(Field<M>& f, const std::string& path,
-                           const Coordinate& new_size_node,
-                           const Long offset = 0, const int whence = SEEK_SET)
-// will read from offset relative to whence
-// assume new_size_node is properly choosen so that concatenate the new fields
-// would be correct. eg. new_size_node = Coordinate(1,1,1,2)
+Long serial_read_field_par_aux(Field<M>& f, crc32_t& crc,
+                               const bool is_computing_crc,
+                               const std::string& path,
+                               const Coordinate& new_size_node,
+                               const Long offset, const int whence)
+// Body of the two serial_read_field_par below.
+// If is_computing_crc, also obtain crc, the crc32 of the data read from the
+// file, computed while the data is read. Since new_size_node is checked to be
+// properly chosen, crc = field_crc32(f). Otherwise crc = 0 and the crc pass and
+// its global sum are skipped.
 {
-  TIMER_VERBOSE_FLOPS("serial_read_field_par");
+  qassert(is_serial_new_size_node_ok(f.geo().total_site(), new_size_node));
+  crc = 0;
   if (not does_file_exist_qar_sync_node(path)) {
-    displayln_info(fname +
-                   ssprintf(": file does not exist: '%s'", path.c_str()));
+    displayln_info(ssprintf(
+        "serial_read_field_par: file does not exist: '%s'", path.c_str()));
     return 0;
   }
   const Geometry& geo = f.geo();
@@ -167,20 +193,64 @@ Long serial_read_field_par(Field<M>& f, const std::string& path,
     fs[i].init(new_geos[i], multiplicity);
   }
   if (fs.size() > 0) {
+    const Long new_id_node = fs[0].geo().geon.id_node;
+    const Long new_num_node = fs[0].geo().geon.num_node;
+    const Long data_size = get_data(fs[0]).data_size();
     QFile qfile = qfopen(path, "r");
     qassert(not qfile.null());
-    qfseek(qfile,
-           offset + fs[0].geo().geon.id_node * get_data(fs[0]).data_size(),
-           whence);
+    qfseek(qfile, offset + new_id_node * data_size, whence);
+    crc32_t crc_local = 0;
     for (size_t i = 0; i < fs.size(); ++i) {
       Vector<M> v = get_data(fs[i]);
-      qread_data(v, qfile);
+      if (is_computing_crc) {
+        qread_data_crc32(v, crc_local, qfile);
+      } else {
+        qread_data(v, qfile);
+      }
     }
     qfclose(qfile);
+    if (is_computing_crc) {
+      crc = crc32_shift(crc_local,
+                        (new_num_node - new_id_node - (Long)fs.size()) *
+                            data_size);
+    }
+  }
+  if (is_computing_crc) {
+    glb_sum_byte(crc);
   }
   shuffle_field_back(f, fs, new_size_node);
   sync_node();
-  const Long file_size = get_data(f).data_size() * f.geo().geon.num_node;
+  return get_data(f).data_size() * f.geo().geon.num_node;
+}
+
+template <class M>
+Long serial_read_field_par(Field<M>& f, crc32_t& crc, const std::string& path,
+                           const Coordinate& new_size_node,
+                           const Long offset = 0, const int whence = SEEK_SET)
+// will read from offset relative to whence
+// new_size_node needs to be properly chosen (see is_serial_new_size_node_ok).
+// eg. new_size_node = Coordinate(1,1,1,2)
+// Also obtain crc, the crc32 of the data read from the file, computed while
+// the data is read. It is field_crc32(f) as new_size_node is properly chosen.
+{
+  TIMER_VERBOSE_FLOPS("serial_read_field_par(crc)");
+  const Long file_size = serial_read_field_par_aux(
+      f, crc, true, path, new_size_node, offset, whence);
+  timer.flops += file_size;
+  return file_size;
+}
+
+template <class M>
+Long serial_read_field_par(Field<M>& f, const std::string& path,
+                           const Coordinate& new_size_node,
+                           const Long offset = 0, const int whence = SEEK_SET)
+// Same as serial_read_field_par(f, crc, path, new_size_node, offset, whence)
+// without computing the crc.
+{
+  TIMER_VERBOSE_FLOPS("serial_read_field_par");
+  crc32_t crc = 0;
+  const Long file_size = serial_read_field_par_aux(
+      f, crc, false, path, new_size_node, offset, whence);
   timer.flops += file_size;
   return file_size;
 }
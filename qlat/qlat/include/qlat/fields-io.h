@@ -38,12 +38,22 @@ OFFSET_STOP_0 OFFSET_STOP_1 OFFSET_STOP_2 ... OFFSET_STOP_N
 */
 // (DENSE_OR_SPARSE will be "dense" or "sparse", not including quote.)
 
+// The data of a segment can be encoded with a FieldsCodec. The codec is stored
+// in the header of the segment as nd = 4 + 256 * codec (nd = 4 for raw data),
+// so readers without codec support refuse the segment instead of misreading it.
+
 #include <errno.h>
 #include <qlat-utils/qar.h>
 #include <qlat/field-io.h>
 #include <qlat/selected-field.h>
 #include <qlat/selected-points.h>
 
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+
 namespace qlat
 {  //
 
@@ -134,7 +144,7 @@ std::vector<char> BitSet::compress_selected(const Vector<M>& src) const
   return dst;
 }
 
-std::vector<char> bitset_decompress(const std::vector<char>& data,
+std::vector<char> bitset_decompress(const Vector<char> data,
                                     const Long local_volume);
 
 BitSet mk_bitset_from_field_rank(const FieldRank& f_rank);
@@ -168,6 +178,54 @@ struct API FieldsSegmentInfo {
   }
 };
 
+enum struct FieldsCodec {
+  None = 0,
+  ShuffleDeflate = 1,  // byte shuffle of the real numbers then zlib deflate
+};
+
+API inline Int& get_fields_io_codec()
+// Default codec of ShuffledFieldsWriter (an integer value of FieldsCodec).
+{
+  static Int codec = get_env_long_default("q_fields_io_codec", 0);
+  return codec;
+}
+
+template <class M>
+qacc constexpr Int get_fields_codec_elem_size()
+// size of the real numbers M is composed of (1 if M is not made of reals)
+{
+  return is_composed_of_real_d<M>()   ? (Int)sizeof(RealD)
+         : is_composed_of_real_f<M>() ? (Int)sizeof(RealF)
+                                      : 1;
+}
+
+std::vector<char> fields_encode(const FieldsCodec codec, const Vector<char> data,
+                                const Int elem_size, const Long offset = 0);
+
+bool fields_decode(std::vector<char>& data, const FieldsCodec codec,
+                   const Vector<char> payload);
+
+void fields_round_mantissa(Vector<RealD> v, const Int n_mantissa_bits);
+
+void fields_round_mantissa(Vector<RealF> v, const Int n_mantissa_bits);
+
+template <class M>
+void fields_round_mantissa(Vector<M> v, const Int n_mantissa_bits)
+// lossy compression of the real numbers M is composed of
+{
+  if (is_composed_of_real_d<M>()) {
+    fields_round_mantissa(
+        Vector<RealD>((RealD*)v.data(), v.data_size() / sizeof(RealD)),
+        n_mantissa_bits);
+  } else if (is_composed_of_real_f<M>()) {
+    fields_round_mantissa(
+        Vector<RealF>((RealF*)v.data(), v.data_size() / sizeof(RealF)),
+        n_mantissa_bits);
+  }
+}
+
+// ---------------------------------------------------
+
 struct API FieldsWriter {
   //
   // should only use ShuffledFieldsWriter
@@ -238,20 +296,32 @@ Long qfwrite_convert_endian(void* ptr, const size_t size, const size_t nmemb,
                             QFile& qfile, const bool is_little_endian);
 
 Long write(FieldsWriter& fw, const std::string& fn, const Geometry& geo,
-           const Vector<char> data, const bool is_sparse_field = false);
+           const Vector<char> data, const bool is_sparse_field = false,
+           const FieldsCodec codec = FieldsCodec::None);
 
 Long qfread_convert_endian(void* ptr, const size_t size, const size_t nmemb,
                            QFile& qfile, const bool is_little_endian);
 
+bool read_tag(FieldsReader& fr, std::string& fn, Coordinate& total_site,
+              crc32_t& crc, int64_t& data_len, bool& is_sparse_field,
+              FieldsCodec& codec);
+
 bool read_tag(FieldsReader& fr, std::string& fn, Coordinate& total_site,
               crc32_t& crc, int64_t& data_len, bool& is_sparse_field);
 
 Long read_data(FieldsReader& fr, std::vector<char>& data,
                const int64_t data_len, const crc32_t crc);
 
+Long read_data(FieldsReader& fr, Vector<char>& data, std::vector<char>& buffer,
+               const int64_t data_len, const crc32_t crc);
+
 Long read_next(FieldsReader& fr, std::string& fn, Coordinate& total_site,
                std::vector<char>& data, bool& is_sparse_field);
 
+Long read_next(FieldsReader& fr, std::string& fn, Coordinate& total_site,
+               Vector<char>& data, std::vector<char>& buffer,
+               bool& is_sparse_field);
+
 Long read_skip_next(FieldsReader& fr, std::string& fn);
 
 void read_through(FieldsReader& fr);
@@ -263,6 +333,9 @@ bool does_file_exist(const FieldsWriter& fr, const std::string& fn);
 Long read(FieldsReader& fr, const std::string& fn, Coordinate& total_site,
           std::vector<char>& data, bool& is_sparse_field);
 
+Long read(FieldsReader& fr, const std::string& fn, Coordinate& total_site,
+          Vector<char>& data, std::vector<char>& buffer, bool& is_sparse_field);
+
 Long read_skip(FieldsReader& fr, const std::string& fn);
 
 Long check_file(FieldsReader& fr, const std::string& fn, const bool is_check_data);
@@ -299,24 +372,23 @@ Long write(FieldsWriter& fw, const std::string& fn, const SelectedField<M>& sf,
 
 template <class M>
 void set_field_from_data(Field<M>& field, const GeometryNode& geon,
-                         const Coordinate& total_site,
-                         const std::vector<char>& data,
+                         const Coordinate& total_site, const Vector<char> data,
                          const bool is_sparse_field)
 {
   TIMER("set_field_from_data(field,geon,total_site,data)");
   const Coordinate node_site = total_site / geon.size_node;
   const Long local_volume = product(node_site);
-  ConstHandle<std::vector<char>> hdata(data);
+  Vector<char> vdata = data;
   std::vector<char> dc_data;
   if (is_sparse_field) {
     dc_data = bitset_decompress(data, local_volume);
-    hdata.init(dc_data);
+    vdata = get_data(dc_data);
   }
-  if (hdata().size() == 0) {
+  if (vdata.size() == 0) {
     field.init();
     return;
   }
-  const Long local_data_size = hdata().size();
+  const Long local_data_size = vdata.size();
   const Long site_data_size = local_data_size / local_volume;
   qassert(site_data_size % sizeof(M) == 0);
   const Int multiplicity = site_data_size / sizeof(M);
@@ -325,13 +397,13 @@ void set_field_from_data(Field<M>& field, const GeometryNode& geon,
   field.init();
   field.init(geo, multiplicity);
   Vector<M> fv = get_data(field);
-  qassert(fv.data_size() == (Long)hdata().size());
-  memcpy(fv.data(), hdata().data(), fv.data_size());
+  qassert(fv.data_size() == vdata.size());
+  memcpy(fv.data(), vdata.data(), fv.data_size());
 }
 
 template <class M>
 void set_field_from_data(SelectedField<M>& sf, FieldRank& f_rank,
-                         const std::vector<char>& data)
+                         const Vector<char> data)
 // obtain f_rank from data
 {
   TIMER("set_field_from_data(sf,f_rank,data)");
@@ -359,7 +431,7 @@ void set_field_from_data(SelectedField<M>& sf, FieldRank& f_rank,
 }
 
 template <class M>
-void set_field_from_data(SelectedField<M>& sf, const std::vector<char>& data,
+void set_field_from_data(SelectedField<M>& sf, const Vector<char> data,
                          const FieldSelection& fsel)
 // fsel must be a subset of the actual data
 {
@@ -384,9 +456,11 @@ Long read(FieldsReader& fr, const std::string& fn, Field<M>& field)
 {
   TIMER_FLOPS("read(fr,fn,field)");
   Coordinate total_site;
-  std::vector<char> data;
+  Vector<char> data;
+  std::vector<char> buffer;
   bool is_sparse_field = false;
-  const Long total_bytes = read(fr, fn, total_site, data, is_sparse_field);
+  const Long total_bytes =
+      read(fr, fn, total_site, data, buffer, is_sparse_field);
   if (0 == total_bytes) {
     return 0;
   }
@@ -403,9 +477,11 @@ Long read(FieldsReader& fr, const std::string& fn, SelectedField<M>& sf,
 {
   TIMER_FLOPS("read(fr,fn,sf,f_rank)");
   Coordinate total_site;
-  std::vector<char> data;
+  Vector<char> data;
+  std::vector<char> buffer;
   bool is_sparse_field = false;
-  const Long total_bytes = read(fr, fn, total_site, data, is_sparse_field);
+  const Long total_bytes =
+      read(fr, fn, total_site, data, buffer, is_sparse_field);
   if (0 == total_bytes) {
     return 0;
   }
@@ -430,9 +506,11 @@ Long read(FieldsReader& fr, const std::string& fn, const FieldSelection& fsel,
 {
   TIMER_FLOPS("read(fr,fn,fsel,sf)");
   Coordinate total_site;
-  std::vector<char> data;
+  Vector<char> data;
+  std::vector<char> buffer;
   bool is_sparse_field = false;
-  const Long total_bytes = read(fr, fn, total_site, data, is_sparse_field);
+  const Long total_bytes =
+      read(fr, fn, total_site, data, buffer, is_sparse_field);
   if (0 == total_bytes) {
     return 0;
   }
@@ -470,6 +548,50 @@ ShuffledBitSet mk_shuffled_bitset(const FieldRank& f_rank,
 
 // -----------------
 
+API inline bool& is_fields_io_async()
+// Whether ShuffledFieldsWriter is opened in asynchronous (write-behind) mode.
+{
+  static bool b = get_env_long_default("q_fields_io_async", 0) != 0;
+  return b;
+}
+
+API inline Long& get_fields_io_async_max_pending_bytes()
+// Bound of the staging buffer of one asynchronous ShuffledFieldsWriter.
+{
+  static Long size = get_env_long_default("q_fields_io_async_max_pending_bytes",
+                                          2L * 1024L * 1024L * 1024L);
+  return size;
+}
+
+struct API FieldsWriteBehindTask {
+  Int i;  // index of sfw.fws
+  std::vector<char> header;
+  std::vector<char> data;
+};
+
+struct API FieldsWriteBehind {
+  // Background I/O thread of ShuffledFieldsWriter in asynchronous mode.
+  // The compute side queues the serialized segments and the thread appends
+  // them to the files in order. The thread only calls libc (no TIMER, no
+  // qassert), errors are recorded in `error` and reported by flush / close.
+  std::vector<FILE*> fps;  // one for each sfw.fws
+  std::thread thread;
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<FieldsWriteBehindTask> tasks;
+  Long pending_bytes;
+  bool is_busy;
+  bool is_stopping;
+  std::string error;
+  //
+  FieldsWriteBehind()
+  {
+    pending_bytes = 0;
+    is_busy = false;
+    is_stopping = false;
+  }
+};
+
 struct API ShuffledFieldsWriter {
   std::string path;
   Coordinate new_size_node;
@@ -477,6 +599,12 @@ struct API ShuffledFieldsWriter {
   QarFile qar_index;
   Long qar_index_idx;
   //
+  bool is_async;  // use set_async(sfw, is_async) to change
+  FieldsWriteBehind wb;
+  //
+  FieldsCodec codec;    // default get_fields_io_codec()
+  Int n_mantissa_bits;  // if > 0, round the reals before writing (lossy)
+  //
   ShuffledFieldsWriter() { init(); }
   ShuffledFieldsWriter(const std::string& path_,
                        const Coordinate& new_size_node_,
@@ -616,6 +744,18 @@ inline void clear_shuffled_fields_writer_cache()
 
 Long flush(ShuffledFieldsWriter& sfw);
 
+void set_async(ShuffledFieldsWriter& sfw, const bool is_async);
+
+Long write_behind(ShuffledFieldsWriter& sfw, const Int i, const std::string& fn,
+                  const Geometry& geo, std::vector<char>& data,
+                  const bool is_sparse_field = false,
+                  const FieldsCodec codec = FieldsCodec::None);
+
+Long write_segment(ShuffledFieldsWriter& sfw, const Int i, const std::string& fn,
+                   const Geometry& geo, const Vector<char> data,
+                   const bool is_sparse_field, const Int elem_size,
+                   const Long offset = 0);
+
 void read_through_sync_node(ShuffledFieldsReader& sfr);
 
 bool does_file_exist_sync_node(const ShuffledFieldsReader& sfr,
@@ -696,7 +836,13 @@ Long write(ShuffledFieldsWriter& sfw, const std::string& fn,
   qassert(fs.size() == sfw.fws.size());
   Long total_bytes = 0;
   for (int i = 0; i < (int)fs.size(); ++i) {
-    total_bytes += write(sfw.fws[i], fn, fs[i]);
+    const Vector<M> v = get_data(fs[i]);
+    if (sfw.n_mantissa_bits > 0) {
+      fields_round_mantissa(v, sfw.n_mantissa_bits);
+    }
+    const Vector<char> data((const char*)v.data(), v.data_size());
+    total_bytes += write_segment(sfw, i, fn, fs[i].geo(), data, false,
+                                 get_fields_codec_elem_size<M>());
   }
   glb_sum(total_bytes);
   save_fields_index(sfw, fn);
@@ -720,7 +866,14 @@ Long write(ShuffledFieldsWriter& sfw, const std::string& fn,
   qassert(sbs.vbs.size() == sfw.fws.size());
   Long total_bytes = 0;
   for (int i = 0; i < (int)sfs.size(); ++i) {
-    total_bytes += write(sfw.fws[i], fn, sfs[i], sbs.vbs[i]);
+    if (sfw.n_mantissa_bits > 0) {
+      fields_round_mantissa(get_data(sfs[i]), sfw.n_mantissa_bits);
+    }
+    const std::vector<char> data =
+        sbs.vbs[i].compress_selected(get_data(sfs[i]));
+    total_bytes +=
+        write_segment(sfw, i, fn, sfs[i].geo(), get_data(data), true,
+                      get_fields_codec_elem_size<M>(), sbs.vbs[i].bytes.size());
   }
   glb_sum(total_bytes);
   save_fields_index(sfw, fn);
@@ -1177,15 +1330,15 @@ bool does_file_exist_sync_node(const std::string& path, const std::string& fn);
                                                                                \
   QLAT_EXTERN template void set_field_from_data(                               \
       Field<TYPENAME>& field, const GeometryNode& geon,                        \
-      const Coordinate& total_site, const std::vector<char>& data,             \
+      const Coordinate& total_site, const Vector<char> data,                   \
       const bool is_sparse_field);                                             \
                                                                                \
   QLAT_EXTERN template void set_field_from_data(                               \
       SelectedField<TYPENAME>& sf, FieldRank& f_rank,                          \
-      const std::vector<char>& data);                                          \
+      const Vector<char> data);                                                \
                                                                                \
   QLAT_EXTERN template void set_field_from_data(SelectedField<TYPENAME>& sf,   \
-                                                const std::vector<char>& data, \
+                                                const Vector<char> data,       \
                                                 const FieldSelection& fsel);   \
                                                                                \
   QLAT_EXTERN template Long read(FieldsReader& fr, const std::string& fn,      \
@@ -532,7 +532,8 @@ inline void gf_flow_plaq_mask_mu_no_comm(GaugeField& gf,
     const ColorMatrix z_u_x_mu =
         -make_tr_less_anti_herm_matrix(u0_x_mu * matrix_adjoint(c_x_mu));
     const ColorMatrix e_z_u_x_mu = (ComplexD)epsilon * z_u_x_mu;
-    const ColorMatrix e_u_x_mu = make_matrix_exp(e_z_u_x_mu) * u0_x_mu;
+    const ColorMatrix e_u_x_mu =
+        make_color_matrix_exp_exact(e_z_u_x_mu) * u0_x_mu;
     ColorMatrix& u_x_mu = gf.get_elem(xl, mu);
     u_x_mu = e_u_x_mu;
   });
@@ -566,7 +567,8 @@ inline void gf_flow_inv_plaq_mask_mu_no_comm(
       const ColorMatrix x_u_x_mu =
           -make_tr_less_anti_herm_matrix(u0_x_mu * c_x_mu_dagger);
       const ColorMatrix e_x_u_x_mu = (ComplexD)epsilon * x_u_x_mu;
-      u0_x_mu = make_matrix_exp(-e_x_u_x_mu) * u1_x_mu;
+      const ColorMatrix n_e_x_u_x_mu = -e_x_u_x_mu;
+      u0_x_mu = make_color_matrix_exp_exact(n_e_x_u_x_mu) * u1_x_mu;
     }
     ColorMatrix& u_x_mu = gf.get_elem(xl, mu);
     u_x_mu = u0_x_mu;
@@ -1104,7 +1106,7 @@ qacc AdjointColorMatrix mp_mat_plaq_site_no_comm(
   const ColorMatrix c_dagger = matrix_adjoint(cf.get_elem(xl));
   const ColorMatrix x_mat =
       (ComplexD)(-epsilon) * make_tr_less_anti_herm_matrix(u * c_dagger);
-  const AdjointColorMatrix j_x_mat = make_diff_exp_map(x_mat, cmcs);
+  const AdjointColorMatrix j_x_mat = make_diff_exp_map_exact(x_mat, cmcs);
   AdjointColorMatrix m_mat;
   set_unit(m_mat);
   m_mat -= epsilon * j_x_mat * n_mat;
@@ -1232,7 +1234,7 @@ inline void set_f_det_util_plaq_mask_mu(
     const ColorMatrix c_dagger = matrix_adjoint(cf.get_elem(xl));
     const ColorMatrix x_mat =
         (ComplexD)(-epsilon) * make_tr_less_anti_herm_matrix(u * c_dagger);
-    const AdjointColorMatrix j_x_mat = make_diff_exp_map(x_mat, cmcs());
+    const AdjointColorMatrix j_x_mat = make_diff_exp_map_exact(x_mat, cmcs());
     const AdjointColorMatrix e2_n_mp_inv_mat =
         sqr(epsilon) * n_mat * mp_inv_mat;
     array<double, 8>& basis = f_e2_dj_x_n_mp_inv.get_elem(xl);
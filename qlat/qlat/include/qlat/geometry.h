@@ -19,4 +19,34 @@ inline bool check_matching_geo(const Geometry& geo1, const Geometry& geo2)
   }
 }
 
+struct API GeometryNeighborTable {
+  // Precomputed site offsets for stencil kernels.
+  // The local sites of geo (index from 0 to geo.local_volume()) are mapped to
+  // site offsets in the layout of geo_ext (the geometry of the field being
+  // read). Multiply by the multiplicity to get the element offset.
+  //
+  // site_offsets[index] is the offset of xl (empty if not in geo_ext)
+  // neighbor_offsets[index * 8 + mu] is the offset of xl + mu
+  // neighbor_offsets[index * 8 + 4 + mu] is the offset of xl - mu
+  // (empty if not in geo_ext, -1 if the neighbor is not on node)
+  Geometry geo;
+  Geometry geo_ext;
+  vector_acc<Long> site_offsets;
+  vector_acc<Long> neighbor_offsets;
+};
+
+GeometryNeighborTable make_geometry_neighbor_table(const Geometry& geo,
+                                                   const Geometry& geo_ext);
+
+API inline Cache<std::string, GeometryNeighborTable>&
+get_geometry_neighbor_table_cache()
+{
+  static Cache<std::string, GeometryNeighborTable> cache(
+      "GeometryNeighborTableCache", 32);
+  return cache;
+}
+
+const GeometryNeighborTable& get_geometry_neighbor_table(
+    const Geometry& geo, const Geometry& geo_ext);
+
 }  // namespace qlat
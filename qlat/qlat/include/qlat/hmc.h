@@ -26,6 +26,9 @@ void set_rand_gauge_momentum(GaugeMomentum& gm, const RealD sigma,
 void set_rand_gauge_momentum(GaugeMomentum& gm, const Field<RealD>& mf,
                              const RngState& rs);
 
+void set_rand_gauge_momentum(GaugeMomentum& gm, const RealD sigma,
+                             const CounterRng& crng);
+
 RealD gm_hamilton_node(const GaugeMomentum& gm);
 
 RealD gm_hamilton_node(const GaugeMomentum& gm, const Field<RealD>& mf);
@@ -141,6 +141,17 @@ int mpi_irecv(void* buf, Long count, MPI_Datatype datatype, int source, int tag,
 
 int mpi_waitall(std::vector<MPI_Request>& requests);
 
+int mpi_send_init(const void* buf, Long count, MPI_Datatype datatype,
+                  int dest, int tag, MPI_Comm comm,
+                  std::vector<MPI_Request>& requests);
+
+int mpi_recv_init(void* buf, Long count, MPI_Datatype datatype, int source,
+                  int tag, MPI_Comm comm, std::vector<MPI_Request>& requests);
+
+int mpi_startall(std::vector<MPI_Request>& requests);
+
+int mpi_request_free(std::vector<MPI_Request>& requests);
+
 int glb_sum(Vector<RealD> recv, const Vector<RealD>& send);
 
 int glb_sum(Vector<RealF> recv, const Vector<RealF>& send);
@@ -411,6 +422,17 @@ inline int receive_result(int& source, int64_t& flag, M& result)
   return ret;
 }
 
+inline bool is_result_ready()
+// Return true if a result sent with send_result can be received without
+// waiting.
+{
+  const int mpi_tag = 2;
+  int is_ready = 0;
+  MPI_Iprobe(MPI_ANY_SOURCE, mpi_tag, get_comm(), &is_ready,
+             MPI_STATUS_IGNORE);
+  return is_ready != 0;
+}
+
 template <class M>
 int get_data_dir(Vector<M> recv, const Vector<M>& send, const int dir)
 // dir = 0, 1 for Plus dir or Minus dir
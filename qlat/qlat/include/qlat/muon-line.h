@@ -753,10 +753,90 @@ inline ManyMagneticMoments muonLineSymRotateCheck(const SpatialO3Matrix& rot,
   return mmm;
 }
 
+inline void save_part_muonline_interpolation_data(
+    const std::string& path, const size_t fn_idx, const size_t start_idx,
+    const Vector<ManyMagneticMomentsCompressed> data)
+{
+  TIMER_VERBOSE("save_part_muonline_interpolation_data");
+  MuonLineInterp& interp = getMuonLineInterp();
+  std::string fn = path + ssprintf("/data.txt.%010ld", (long)fn_idx);
+  FILE* fdata = qopen(fn + ".partial", "w");
+  fprintf(fdata, "# idx params[0-4] ManyMagneticMomentsCompressed[0-91]\n");
+  for (size_t k = 0; k < (size_t)data.size(); ++k) {
+    size_t idx = start_idx + k;
+    fprintf(fdata, "%10ld", idx);
+    const std::vector<RealD> params = interp.get_coor(idx);
+    for (size_t i = 0; i < params.size(); ++i) {
+      fprintf(fdata, " %24.17E", params[i]);
+    }
+    fprintf(fdata, "  ");
+    const ManyMagneticMomentsCompressed& mmm = data[k];
+    for (size_t i = 0; i < mmm.size(); ++i) {
+      fprintf(fdata, " %24.17E", mmm[i]);
+    }
+    fprintf(fdata, "\n");
+  }
+  qfclose(fdata);
+  qrename_partial(fn);
+}
+
+inline bool is_part_muonline_interpolation_data_done(const std::string& path,
+                                                     const size_t fn_idx)
+{
+  std::string fn = path + ssprintf("/data.txt.%010ld", (long)fn_idx);
+  return does_file_exist_qar(fn);
+}
+
+inline void load_part_muonline_interpolation_data(
+    const std::string& path, const size_t fn_idx, const size_t start_idx,
+    Vector<ManyMagneticMomentsCompressed> data)
+// load the file saved by save_part_muonline_interpolation_data
+{
+  TIMER_VERBOSE("load_part_muonline_interpolation_data");
+  MuonLineInterp& interp = getMuonLineInterp();
+  std::string fn = path + ssprintf("/data.txt.%010ld", (long)fn_idx);
+  const DataTable table = qload_datatable(fn);
+  qassert((Long)table.size() == data.size());
+  for (size_t k = 0; k < table.size(); ++k) {
+    const std::vector<RealD>& data_vec = table[k];
+    qassert(data_vec.size() == 1 + 5 + 92);
+    const size_t idx = start_idx + k;
+    qassert(idx == (size_t)data_vec[0]);
+    const std::vector<RealD> params = interp.get_coor(idx);
+    for (size_t i = 0; i < params.size(); ++i) {
+      qassert(params[i] == data_vec[1 + i]);
+    }
+    ManyMagneticMomentsCompressed& mmm = data[k];
+    for (size_t i = 0; i < mmm.size(); ++i) {
+      mmm[i] = data_vec[6 + i];
+    }
+  }
+}
+
+inline void compute_part_muonline_interpolation_data(
+    Vector<ManyMagneticMomentsCompressed> data, const Long start_idx,
+    const IntegrationEps& eps)
+{
+  TIMER_VERBOSE("compute_part_muonline_interpolation_data");
+  MuonLineInterp& interp = getMuonLineInterp();
+#pragma omp parallel for schedule(dynamic)
+  for (Long i = 0; i < data.size(); ++i) {
+    TIMER_VERBOSE("interp-initial-iter");
+    data[i] = muonLineSymParamsCompressed(interp.get_coor(start_idx + i), eps);
+  }
+}
+
 inline void initializeMuonLineInterpolation(const std::vector<int>& dims,
-                                            const IntegrationEps& eps)
+                                            const IntegrationEps& eps,
+                                            const std::string& path_part = "")
 // computing the muon-line interpolation database
 // take quite some time
+// Jobs are chunks of job_chunk_size entries. Node 0 sends a new job to a node
+// as soon as the node returns its result, and computes the remaining chunks
+// itself in between.
+// If path_part is not empty, node 0 saves each finished chunk as
+// path_part/data.txt.%010ld and loads the chunks already saved there
+// instead of computing them again.
 {
   TIMER_VERBOSE("initializeMuonLineInterpolation");
   MuonLineInterp& interpolation = getMuonLineInterp();
@@ -767,39 +847,115 @@ inline void initializeMuonLineInterpolation(const std::vector<int>& dims,
   interpolation.add_dimension(dims[2], 1.0, 0.0);  // theta
   interpolation.add_dimension(dims[3], 1.0, 0.0);  // phi
   interpolation.add_dimension(dims[4], 1.0, 0.0);  // eta
+  set_zero(get_data(interpolation.data));
   const Long jobs_total = interpolation.size();
-  const Long num_nodes = get_num_node();
-  const Long jobs_per_nodes = jobs_total / num_nodes;
-  const Long jobs_parallel = jobs_per_nodes * num_nodes;
-  const Long jobs_left = jobs_total - jobs_parallel;
-  const Long my_start = jobs_left + jobs_per_nodes * get_id_node();
-  std::vector<ManyMagneticMomentsCompressed> workplace(jobs_per_nodes);
-#pragma omp parallel for schedule(dynamic)
-  for (Long i = 0; i < jobs_per_nodes; ++i) {
-    const Long idx = my_start + i;
-    TIMER_VERBOSE("interp-initial-iter");
-#pragma omp critical
-    {
-      displayln_c_stdout(ssprintf("jobs-par: %5d %10ld %10ld/%ld",
-                                  get_id_node(), my_start, i, jobs_per_nodes));
-    }
-    workplace[i] =
-        muonLineSymParamsCompressed(interpolation.get_coor(idx), eps);
+  // ADJUST ME
+  const Long job_chunk_size = 64;
+  const Long num_chunks = (jobs_total + job_chunk_size - 1) / job_chunk_size;
+  if (path_part != "") {
+    qmkdir_p_info(path_part);
   }
-  Vector<ManyMagneticMomentsCompressed> all_workspace(&interpolation[jobs_left],
-                                                      jobs_parallel);
-  all_gather(all_workspace, Vector<ManyMagneticMomentsCompressed>(workplace));
-#pragma omp parallel for schedule(dynamic)
-  for (Long idx = 0; idx < jobs_left; ++idx) {
-    TIMER_VERBOSE("interp-initial-iter");
-#pragma omp critical
-    if (0 == get_id_node()) {
-      displayln_c_stdout(ssprintf("jobs-left: %10ld/%ld", idx, jobs_left));
-      displayln_c_stdout(show(idx));
+  if (0 == get_id_node()) {
+    std::vector<Long> chunks;
+    for (Long flag = 0; flag < num_chunks; ++flag) {
+      const Long start = flag * job_chunk_size;
+      Vector<ManyMagneticMomentsCompressed> v(
+          &interpolation[start], std::min(job_chunk_size, jobs_total - start));
+      if (path_part != "" and
+          is_part_muonline_interpolation_data_done(path_part, flag)) {
+        load_part_muonline_interpolation_data(path_part, flag, start, v);
+      } else {
+        chunks.push_back(flag);
+      }
+    }
+    displayln_info(fname + ssprintf(": jobs_total=%ld num_chunks=%ld todo=%ld",
+                                    jobs_total, num_chunks, chunks.size()));
+    Long num_running_jobs = 0;
+    Long idx = 0;
+    Long num_done = 0;
+    for (int dest = 1; dest < get_num_node(); ++dest) {
+      if (idx >= (Long)chunks.size()) {
+        break;
+      }
+      send_job(chunks[idx], chunks[idx], dest);
+      idx += 1;
+      num_running_jobs += 1;
+    }
+    // Node 0 also works on a chunk of its own, a few entries at a time, and
+    // checks for finished jobs in between, so the other nodes do not wait
+    // long for their next job.
+    const Long local_step = omp_get_max_threads();
+    Long local_flag = -1;
+    Long local_pos = 0;
+    while (num_done < (Long)chunks.size()) {
+      int64_t flag;
+      if (num_running_jobs > 0 and
+          ((local_flag == -1 and idx >= (Long)chunks.size()) or
+           is_result_ready())) {
+        int source;
+        array<ManyMagneticMomentsCompressed, job_chunk_size> result;
+        receive_result(source, flag, result);
+        num_running_jobs -= 1;
+        if (idx < (Long)chunks.size()) {
+          send_job(chunks[idx], chunks[idx], source);
+          idx += 1;
+          num_running_jobs += 1;
+        }
+        const Long start = flag * job_chunk_size;
+        Vector<ManyMagneticMomentsCompressed> v(
+            &interpolation[start],
+            std::min(job_chunk_size, jobs_total - start));
+        std::memcpy(v.data(), result.data(), v.data_size());
+      } else {
+        if (local_flag == -1) {
+          local_flag = chunks[idx];
+          local_pos = 0;
+          idx += 1;
+        }
+        const Long start = local_flag * job_chunk_size;
+        const Long size = std::min(job_chunk_size, jobs_total - start);
+        const Long step = std::min(local_step, size - local_pos);
+        Vector<ManyMagneticMomentsCompressed> v(
+            &interpolation[start + local_pos], step);
+        compute_part_muonline_interpolation_data(v, start + local_pos, eps);
+        local_pos += step;
+        if (local_pos < size) {
+          continue;
+        }
+        flag = local_flag;
+        local_flag = -1;
+      }
+      const Long start = flag * job_chunk_size;
+      Vector<ManyMagneticMomentsCompressed> v(
+          &interpolation[start], std::min(job_chunk_size, jobs_total - start));
+      if (path_part != "") {
+        save_part_muonline_interpolation_data(path_part, flag, start, v);
+      }
+      num_done += 1;
+      displayln_info(fname + ssprintf(": done %ld/%ld chunk=%ld", num_done,
+                                      (Long)chunks.size(), (Long)flag));
+    }
+    for (int dest = 1; dest < get_num_node(); ++dest) {
+      const Long job = -1;
+      send_job(-1, job, dest);
+    }
+  } else {
+    while (true) {
+      int64_t flag;
+      Long job;
+      receive_job(flag, job);
+      if (-1 == flag) {
+        break;
+      }
+      const Long start = job * job_chunk_size;
+      array<ManyMagneticMomentsCompressed, job_chunk_size> result;
+      Vector<ManyMagneticMomentsCompressed> v(
+          result.data(), std::min(job_chunk_size, jobs_total - start));
+      compute_part_muonline_interpolation_data(v, start, eps);
+      send_result(flag, result);
     }
-    interpolation[idx] =
-        muonLineSymParamsCompressed(interpolation.get_coor(idx), eps);
   }
+  bcast(get_data(interpolation.data));
 }
 
 inline void saveMuonLineInterpolation(const std::string& path)
@@ -807,7 +963,7 @@ inline void saveMuonLineInterpolation(const std::string& path)
   TIMER_VERBOSE("saveMuonLineInterpolation");
   if (0 == get_id_node()) {
     MuonLineInterp& interp = getMuonLineInterp();
-    qmkdir(path);
+    qmkdir_p(path);
     FILE* fdims = qopen(path + "/dims.txt" + ".partial", "w");
     const std::vector<InterpolationDim>& dims = interp.dims;
     fprintf(fdims, "# i dims[i].n dims[i].xhigh dims[i].xlow\n");
@@ -924,45 +1080,12 @@ inline void load_or_compute_muonline_interpolation(const std::string& path,
 {
   if (!loadMuonLineInterpolation(path)) {
     test_fCalc();
-    initializeMuonLineInterpolation(dims, eps);
+    initializeMuonLineInterpolation(dims, eps, path + "/part");
     saveMuonLineInterpolation(path);
+    qremove_all_info(path + "/part");
   }
 }
 
-inline void save_part_muonline_interpolation_data(
-    const std::string& path, const size_t fn_idx, const size_t start_idx,
-    const Vector<ManyMagneticMomentsCompressed> data)
-{
-  TIMER_VERBOSE("save_part_muonline_interpolation_data");
-  MuonLineInterp& interp = getMuonLineInterp();
-  std::string fn = path + ssprintf("/data.txt.%010d", fn_idx);
-  FILE* fdata = qopen(fn + ".partial", "w");
-  fprintf(fdata, "# idx params[0-4] ManyMagneticMomentsCompressed[0-91]\n");
-  for (size_t k = 0; k < (size_t)data.size(); ++k) {
-    size_t idx = start_idx + k;
-    fprintf(fdata, "%10ld", idx);
-    const std::vector<RealD> params = interp.get_coor(idx);
-    for (size_t i = 0; i < params.size(); ++i) {
-      fprintf(fdata, " %24.17E", params[i]);
-    }
-    fprintf(fdata, "  ");
-    const ManyMagneticMomentsCompressed& mmm = data[k];
-    for (size_t i = 0; i < mmm.size(); ++i) {
-      fprintf(fdata, " %24.17E", mmm[i]);
-    }
-    fprintf(fdata, "\n");
-  }
-  qfclose(fdata);
-  qrename_partial(fn);
-}
-
-inline bool is_part_muonline_interpolation_data_done(const std::string& path,
-                                                     const size_t fn_idx)
-{
-  std::string fn = path + ssprintf("/data.txt.%010d", fn_idx);
-  return does_file_exist_qar(fn);
-}
-
 struct PointPairWeight {
   CoordinateD rxy, rxz;
   RealD weight;
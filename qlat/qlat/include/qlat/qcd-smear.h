@@ -79,6 +79,13 @@ inline ColorMatrix color_matrix_su_projection(const ColorMatrix& x,
   return y;
 }
 
+void gf_ape_smear_no_comm(GaugeField& gf, const GaugeField& gf0,
+                          const double alpha);
+
+void gf_ape_smear_no_comm(GaugeField& gf, const CompressedGaugeField& gf0,
+                          const double alpha);
+// gf0 is expanded by 1 and refreshed, links of gf0 are reconstructed on the fly
+
 void gf_ape_smear(GaugeField& gf, const GaugeField& gf0, const double alpha,
                   const Long steps = 1);
 
@@ -88,13 +95,14 @@ void gf_spatial_ape_smear(GaugeField& gf, const GaugeField& gf0,
 void gf_hyp_smear(GaugeField& gf, const GaugeField& gf0, const double alpha1,
                   const double alpha2, const double alpha3);
 
-template <class T>
-void prop_smear(Propagator4dT<T>& prop, const GaugeFieldT<T>& gf1,
+template <class T, class GM>
+void prop_smear(Propagator4dT<T>& prop, const Field<GM>& gf1,
                 const double coef, const int step,
                 const CoordinateD& mom = CoordinateD(),
                 const bool smear_in_time_dir = false)
 // gf1 is left_expanded and refreshed
 // set_left_expanded_gauge_field(gf1, gf)
+// gf1 can also be the CompressedGaugeFieldT<T> of the above
 // prop is of normal size
 {
   TIMER_FLOPS("prop_smear");
@@ -130,9 +138,9 @@ void prop_smear(Propagator4dT<T>& prop, const GaugeFieldT<T>& gf1,
       for (int dir = -dir_limit; dir < dir_limit; ++dir) {
         const Coordinate xl1 = coordinate_shifts(xl, dir);
         ColorMatrixT<T> link =
-            dir >= 0
-                ? gf1.get_elem(xl, dir)
-                : (ColorMatrixT<T>)matrix_adjoint(gf1.get_elem(xl1, -dir - 1));
+            dir >= 0 ? get_gauge_link(gf1, xl, dir)
+                     : (ColorMatrixT<T>)matrix_adjoint(
+                           get_gauge_link(gf1, xl1, -dir - 1));
         link *= mom_factors()[dir + 4];
         wm += link * prop1.get_elem(xl1);
       }
@@ -140,16 +148,135 @@ void prop_smear(Propagator4dT<T>& prop, const GaugeFieldT<T>& gf1,
   }
 }
 
+template <class T, class GM>
+void prop_smear_time_slices(Propagator4dT<T>& prop, const Field<GM>& gf1,
+                            const double coef, const int step,
+                            const std::vector<Int>& t_slices,
+                            const CoordinateD& mom = CoordinateD())
+// Same as prop_smear(prop, gf1, coef, step, mom, false) on the (global) time
+// slices t_slices. prop is not changed on the other time slices.
+// Only the selected time slices are copied, smeared and communicated (spatial
+// halo only). The two buffers are allocated per call and only hold the selected
+// local time slices: same size_node and spatial node_site as prop, with
+// node_site[3] the largest number of selected time slices on one node.
+// Need to be called by all the nodes (even those without any of t_slices).
+// gf1 is left_expanded and refreshed (or its CompressedGaugeFieldT<T>)
+// prop is of normal size
+{
+  TIMER_FLOPS("prop_smear_time_slices");
+  if (0 == step) {
+    return;
+  }
+  const Geometry& geo = prop.geo();
+  std::vector<Int> ts = t_slices;
+  std::sort(ts.begin(), ts.end());
+  ts.erase(std::unique(ts.begin(), ts.end()), ts.end());
+  const Int t_node_site = geo.node_site[3];
+  std::vector<Int> tls;  // selected local time slices
+  std::vector<Int> n_tls(geo.geon.size_node[3], 0);
+  for (Long i = 0; i < (Long)ts.size(); ++i) {
+    const Int t = ts[i];
+    qassert(0 <= t and t < geo.total_site()[3]);
+    n_tls[t / t_node_site] += 1;
+    const Int tl = t - t_node_site * geo.geon.coor_node[3];
+    if (0 <= tl and tl < t_node_site) {
+      tls.push_back(tl);
+    }
+  }
+  const Int n_tl_max = *std::max_element(n_tls.begin(), n_tls.end());
+  if (n_tl_max == 0) {
+    return;
+  }
+  Coordinate node_site_c = geo.node_site;
+  node_site_c[3] = n_tl_max;
+  Geometry geo_c;
+  geo_c.init(geo.geon, node_site_c);
+  const Geometry geo1_c =
+      geo_resize(geo_c, Coordinate(1, 1, 1, 0), Coordinate(1, 1, 1, 0));
+  const Long n_tl = tls.size();
+  const Long spatial_volume = geo.local_volume() / t_node_site;
+  const Long n_sites = n_tl * spatial_volume;
+  const int n_avg = 6;
+  timer.flops += n_sites * 12 * 4 * step * n_avg * (3 * (3 * 6 + 2 * 2));
+  array<ComplexD, 8> mom_factors_v;
+  box_acc<array<ComplexD, 8>> mom_factors(mom_factors_v);
+  for (int i = 0; i < 8; ++i) {
+    const int dir = i - 4;
+    const double phase = dir >= 0 ? mom[dir] : -mom[-dir - 1];
+    mom_factors()[i] = qpolar(coef / n_avg, -phase);
+  }
+  vector_acc<Int> tls_v;
+  tls_v = tls;
+  std::string tag;
+  for (Int i = 0; i < geo.geon.size_node[3]; ++i) {
+    for (Int k = 0; k < n_tls[i]; ++k) {
+      tag += ssprintf("%d ", i * n_tl_max + k);
+    }
+  }
+  QLAT_PUSH_DIAGNOSTIC_DISABLE_DANGLING_REF;
+  const CommPlan& plan =
+      get_comm_plan(set_marks_field_spatial_1, tag, geo1_c, 1);
+  QLAT_DIAGNOSTIC_POP;
+  Propagator4dT<T> prop1, prop2;
+  prop1.init(geo1_c);
+  prop2.init(geo1_c);
+  qacc_for(index_c, n_sites, {
+    const Coordinate xc = geo_c.coordinate_from_index(index_c);
+    const Coordinate xl(xc[0], xc[1], xc[2], tls_v[xc[3]]);
+    prop1.get_elem(xc) = prop.get_elem(xl);
+  });
+  for (int k = 0; k < step; ++k) {
+    // Nodes without the selected time slices have an empty plan, so the
+    // barrier-free pair is used (refresh_expanded calls sync_node).
+    RefreshExpandedHandle<WilsonMatrixT<T>> h;
+    refresh_expanded_start(h, prop1, plan);
+    refresh_expanded_finish(h);
+    qacc_for(index_c, n_sites, {
+      const Coordinate xc = geo_c.coordinate_from_index(index_c);
+      const Coordinate xl(xc[0], xc[1], xc[2], tls_v[xc[3]]);
+      WilsonMatrixT<T>& wm = prop2.get_elem(xc);
+      wm = prop1.get_elem(xc);
+      wm *= 1 - coef;
+      for (int dir = -3; dir < 3; ++dir) {
+        const Coordinate xl1 = coordinate_shifts(xl, dir);
+        const Coordinate xc1 = coordinate_shifts(xc, dir);
+        ColorMatrixT<T> link =
+            dir >= 0 ? get_gauge_link(gf1, xl, dir)
+                     : (ColorMatrixT<T>)matrix_adjoint(
+                           get_gauge_link(gf1, xl1, -dir - 1));
+        link *= mom_factors()[dir + 4];
+        wm += link * prop1.get_elem(xc1);
+      }
+    });
+    qswap(prop1, prop2);
+  }
+  qacc_for(index_c, n_sites, {
+    const Coordinate xc = geo_c.coordinate_from_index(index_c);
+    const Coordinate xl(xc[0], xc[1], xc[2], tls_v[xc[3]]);
+    prop.get_elem(xl) = prop1.get_elem(xc);
+  });
+}
+
 #ifdef QLAT_INSTANTIATE_SMEAR
 #define QLAT_EXTERN
 #else
 #define QLAT_EXTERN extern
 #endif
 
-QLAT_EXTERN template void prop_smear<Real>(Propagator4d&, const GaugeField&,
+QLAT_EXTERN template void prop_smear<Real>(Propagator4d&,
+                                           const Field<ColorMatrix>&,
                                            const double, const int,
                                            const CoordinateD&, const bool);
 
+QLAT_EXTERN template void prop_smear<Real>(Propagator4d&,
+                                           const Field<CompressedColorMatrix>&,
+                                           const double, const int,
+                                           const CoordinateD&, const bool);
+
+QLAT_EXTERN template void prop_smear_time_slices<Real>(
+    Propagator4d&, const Field<ColorMatrix>&, const double, const int,
+    const std::vector<Int>&, const CoordinateD&);
+
 #undef QLAT_EXTERN
 
 }  // namespace qlat
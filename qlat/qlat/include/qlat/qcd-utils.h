@@ -33,6 +33,27 @@ inline void set_g_rand_anti_hermitian_matrix_field(Field<ColorMatrix>& fc,
   }
 }
 
+inline void set_g_rand_anti_hermitian_matrix_field(Field<ColorMatrix>& fc,
+                                                   const CounterRng& crng,
+                                                   const double sigma)
+// same distribution as above with the counter-based generator
+// site with global index gindex uses make_counter_rng_state(crng, gindex)
+{
+  TIMER("set_g_rand_anti_hermitian_matrix_field(crng)");
+  const Geometry& geo = fc.geo();
+  qacc_for(index, geo.local_volume(), {
+    const Geometry& geo = fc.geo();
+    const Coordinate xl = geo.coordinate_from_index(index);
+    const Coordinate xg = geo.coordinate_g_from_l(xl);
+    const Long gindex = geo.g_index_from_g_coordinate(xg);
+    CounterRngState rsi = make_counter_rng_state(crng, gindex);
+    Vector<ColorMatrix> v = fc.get_elems(xl);
+    for (int m = 0; m < (int)v.size(); ++m) {
+      v[m] = make_g_rand_anti_hermitian_matrix(rsi, sigma);
+    }
+  });
+}
+
 inline void set_g_rand_color_matrix_field(Field<ColorMatrix>& fc,
                                           const RngState& rs,
                                           const double sigma,
@@ -155,19 +176,23 @@ inline void gf_wilson_line_no_comm(Field<ColorMatrix>& wilson_line_field,
   });
 }
 
-qacc ColorMatrix gf_staple_no_comm_v1(const GaugeField& gf,
-                                      const Coordinate& xl, const int mu)
+template <class GM>
+qacc ColorMatrix gf_staple_no_comm_v1(const Field<GM>& gf, const Coordinate& xl,
+                                      const int mu)
+// gf can be GaugeField or CompressedGaugeField
 {
   ColorMatrix ret;
   set_zero(ret);
   const Coordinate xl_mu = coordinate_shifts(xl, mu);
   for (int m = 0; m < DIMN; ++m) {
     if (mu != m) {
-      ret += gf.get_elem(xl, m) * gf.get_elem(coordinate_shifts(xl, m), mu) *
-             matrix_adjoint(gf.get_elem(xl_mu, m));
-      ret += matrix_adjoint(gf.get_elem(coordinate_shifts(xl, -m - 1), m)) *
-             gf.get_elem(coordinate_shifts(xl, -m - 1), mu) *
-             gf.get_elem(coordinate_shifts(xl_mu, -m - 1), m);
+      ret += get_gauge_link(gf, xl, m) *
+             get_gauge_link(gf, coordinate_shifts(xl, m), mu) *
+             matrix_adjoint(get_gauge_link(gf, xl_mu, m));
+      ret +=
+          matrix_adjoint(get_gauge_link(gf, coordinate_shifts(xl, -m - 1), m)) *
+          get_gauge_link(gf, coordinate_shifts(xl, -m - 1), mu) *
+          get_gauge_link(gf, coordinate_shifts(xl_mu, -m - 1), m);
     }
   }
   return ret;
@@ -197,7 +222,8 @@ qacc ColorMatrix gf_staple_no_comm_v2(const GaugeField& gf,
   return ret;
 }
 
-qacc ColorMatrix gf_staple_no_comm(const GaugeField& gf, const Coordinate& xl,
+template <class GM>
+qacc ColorMatrix gf_staple_no_comm(const Field<GM>& gf, const Coordinate& xl,
                                    const int mu)
 {
   return gf_staple_no_comm_v1(gf, xl, mu);
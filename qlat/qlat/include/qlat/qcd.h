@@ -36,6 +36,109 @@ void unitarize(Field<ColorMatrixT<T> >& gf)
   });
 }
 
+API inline bool& is_checking_compressed_gauge_field()
+// qlat parameter
+{
+  static bool b =
+      get_env_long_default("q_check_compressed_gauge_field", 0) != 0;
+  return b;
+}
+
+template <class T>
+void set_compressed_gauge_field(CompressedGaugeFieldT<T>& cgf,
+                                const GaugeFieldT<T>& gf)
+// cgf has the same geo as gf (including the expanded sites)
+// Precondition: links of gf are in SU(3). Only the first two rows are kept and
+// the third row is reconstructed, so non-unitary links or links with extra
+// phases (e.g. U(1) or twisted boundary phases) are NOT recovered.
+// If is_checking_compressed_gauge_field(), the reconstruction of the local
+// links is checked.
+{
+  TIMER("set_compressed_gauge_field");
+  cgf.init(gf.geo());
+  const Vector<ColorMatrixT<T>> v = get_data(gf);
+  Vector<CompressedColorMatrixT<T>> cv = get_data(cgf);
+  qassert(cv.size() == v.size());
+  qacc_for(offset, v.size(), { cv[offset] = compress_color_matrix(v[offset]); });
+  if (is_checking_compressed_gauge_field()) {
+    const Geometry geo = geo_resize(gf.geo());
+    FieldM<RealD, 2> nf;
+    nf.init(geo);
+    qacc_for(index, geo.local_volume(), {
+      const Coordinate xl = geo.coordinate_from_index(index);
+      const Vector<ColorMatrixT<T>> vu = gf.get_elems_const(xl);
+      Vector<RealD> vn = nf.get_elems(index);
+      vn[0] = 0.0;
+      vn[1] = 0.0;
+      for (int m = 0; m < gf.multiplicity; ++m) {
+        const ColorMatrixT<T> u =
+            uncompress_color_matrix(compress_color_matrix(vu[m]));
+        vn[0] += qnorm(u - vu[m]);
+        vn[1] += qnorm(vu[m]);
+      }
+    });
+    array<RealD, 2> sums;
+    sums[0] = 0.0;
+    sums[1] = 0.0;
+    for (Long index = 0; index < geo.local_volume(); ++index) {
+      const Vector<RealD> vn = nf.get_elems_const(index);
+      sums[0] += vn[0];
+      sums[1] += vn[1];
+    }
+    glb_sum(get_data(sums));
+    const RealD ratio = sums[0] / sums[1];
+    if (not(ratio <= 1.0e-8)) {
+      qerr(ssprintf("set_compressed_gauge_field: links not in SU(3): "
+                    "qnorm(diff)/qnorm(gf) = %.6E",
+                    ratio));
+    }
+  }
+}
+
+template <class T>
+void set_gauge_field(GaugeFieldT<T>& gf, const CompressedGaugeFieldT<T>& cgf)
+// gf has the same geo as cgf (including the expanded sites)
+{
+  TIMER("set_gauge_field(gf,cgf)");
+  gf.init(cgf.geo());
+  const Vector<CompressedColorMatrixT<T>> cv = get_data(cgf);
+  Vector<ColorMatrixT<T>> v = get_data(gf);
+  qassert(cv.size() == v.size());
+  qacc_for(offset, v.size(),
+           { v[offset] = uncompress_color_matrix(cv[offset]); });
+}
+
+template <class T>
+qacc const ColorMatrixT<T>& get_gauge_link(const Field<ColorMatrixT<T>>& gf,
+                                           const Long offset)
+{
+  return gf.get_elem_offset(offset);
+}
+
+template <class T>
+qacc ColorMatrixT<T> get_gauge_link(
+    const Field<CompressedColorMatrixT<T>>& gf, const Long offset)
+// SU(3) reconstruction on the fly
+{
+  return uncompress_color_matrix(gf.get_elem_offset(offset));
+}
+
+template <class T>
+qacc const ColorMatrixT<T>& get_gauge_link(const Field<ColorMatrixT<T>>& gf,
+                                           const Coordinate& xl, const int mu)
+{
+  return gf.get_elem(xl, mu);
+}
+
+template <class T>
+qacc ColorMatrixT<T> get_gauge_link(
+    const Field<CompressedColorMatrixT<T>>& gf, const Coordinate& xl,
+    const int mu)
+// SU(3) reconstruction on the fly
+{
+  return uncompress_color_matrix(gf.get_elem(xl, mu));
+}
+
 template <class T>
 double gf_avg_plaq_no_comm(const GaugeFieldT<T>& gf)
 // assume proper communication is done
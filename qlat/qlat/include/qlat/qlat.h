@@ -12,6 +12,7 @@
 #include <qlat/core.h>
 #include <qlat/dslash.h>
 #include <qlat/fermion-action.h>
+#include <qlat/field-aligned.h>
 #include <qlat/field-dist-io.h>
 #include <qlat/field-expand.h>
 #include <qlat/field-fft.h>
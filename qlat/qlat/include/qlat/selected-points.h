@@ -134,6 +134,159 @@ void set_sqrt_field(SelectedPoints<RealD>& sp,
 
 // -------------------------------------------
 
+struct API PointsSelectionIndex {
+  // Hash index from coordinate to idx of a PointsSelection.
+  // Open addressing with linear probing. The key packs the four components
+  // of the coordinate (16 bits each), so points outside the lattice are fine.
+  // For repeated coordinates, the smallest idx is used.
+  bool initialized;
+  Long n_points;
+  Int n_bits;             // table size is 2^n_bits
+  vector_acc<Long> keys;  // -1 if empty
+  vector_acc<Long> idxs;  // idx in psel
+  vector<Coordinate> xgs;  // copy of the points of psel (to verify the cache)
+  //
+  void init();
+  void init(const PointsSelection& psel);
+  //
+  PointsSelectionIndex() { init(); }
+  //
+  qacc static Long key_from_xg(const Coordinate& xg)
+  {
+    Long key = 0;
+    for (int mu = 0; mu < 4; ++mu) {
+      key = (key << 16) | (Long)((xg[mu] + 0x8000) & 0xFFFF);
+    }
+    return key;
+  }
+  //
+  qacc Long slot_from_key(const Long key) const
+  {
+    return (Long)(((uint64_t)key * 0x9E3779B97F4A7C15ULL) >> (64 - n_bits));
+  }
+  //
+  qacc Long find(const Coordinate& xg) const
+  // return -1 if xg is not in psel
+  {
+    const Long key = key_from_xg(xg);
+    const Long mask = ((Long)1 << n_bits) - 1;
+    Long slot = slot_from_key(key);
+    while (true) {
+      const Long k = keys[slot];
+      if (k == key) {
+        return idxs[slot];
+      } else if (k == -1) {
+        return -1;
+      }
+      slot = (slot + 1) & mask;
+    }
+  }
+};
+
+API inline Cache<std::string, PointsSelectionIndex>&
+get_points_selection_index_cache()
+// key: address of psel.xgs.data(), size and total_site
+// An entry is rebuilt if its points no longer match psel.
+{
+  static Cache<std::string, PointsSelectionIndex> cache(
+      "PointsSelectionIndexCache", 16);
+  return cache;
+}
+
+const PointsSelectionIndex& get_points_selection_index(
+    const PointsSelection& psel);
+// The points are verified against psel on every call (one memcmp).
+
+Long idx_from_xg(const Coordinate& xg, const PointsSelection& psel);
+
+bool is_containing(const PointsSelection& psel,
+                   const PointsSelection& psel_small);
+
+PointsSelection intersect(const PointsSelection& psel,
+                          const PointsSelection& psel1);
+
+// -------------------------------------------
+
+struct API PointsGatherPlan {
+  // Which node owns which point of a global PointsSelection for a Geometry.
+  // Points outside the lattice (e.g. from mk_tslice_point_selection) have no
+  // owner.
+  bool initialized;
+  Long n_points;
+  vector<Long> local_idx;        // idx (in psel) of the points owned by this node
+  vector_acc<Long> local_index;  // site index (in geo) of these points
+  vector<Int> recvcounts;        // number of points owned by each node
+  vector<Int> rdispls;
+  vector<Long> recv_idx;      // idx (in psel) of the points from all nodes
+  vector<Long> no_owner_idx;  // idx (in psel) of the points with no owner
+  vector<Coordinate> xgs;     // copy of the points of psel (to verify the cache)
+  //
+  void init();
+  void init(const PointsSelection& psel, const Geometry& geo);
+  //
+  PointsGatherPlan() { init(); }
+};
+
+API inline Cache<std::string, PointsGatherPlan>& get_points_gather_plan_cache()
+// key: geometry, address of psel.xgs.data(), size and total_site
+// An entry is rebuilt if its points no longer match psel.
+{
+  static Cache<std::string, PointsGatherPlan> cache("PointsGatherPlanCache",
+                                                    16);
+  return cache;
+}
+
+const PointsGatherPlan& get_points_gather_plan(const PointsSelection& psel,
+                                               const Geometry& geo);
+
+void gather_selected_points_char(SelectedPoints<Char>& spc,
+                                 const SelectedPoints<Char>& spc_local,
+                                 const PointsGatherPlan& pgp);
+
+template <class M>
+void gather_selected_points(SelectedPoints<M>& sp,
+                            const SelectedPoints<M>& sp_local,
+                            const PointsSelection& psel,
+                            const PointsGatherPlan& pgp)
+// sp_local from set_selected_points_local
+// sp has the same data on all nodes (PointsDistType::Global)
+{
+  TIMER("gather_selected_points(sp,sp_local,psel,pgp)");
+  qassert(sp_local.n_points == (Long)pgp.local_idx.size());
+  sp.init(psel, sp_local.multiplicity);
+  qassert(sp.n_points == pgp.n_points);
+  SelectedPoints<Char> spc(sp.view_as_char());
+  const SelectedPoints<Char> spc_local(sp_local.view_as_char());
+  gather_selected_points_char(spc, spc_local, pgp);
+}
+
+template <class M>
+void set_selected_points_local(SelectedPoints<M>& sp, const Field<M>& f,
+                               const PointsSelection& psel)
+// sp.points_dist_type == PointsDistType::Local
+// sp only has the points owned by this node, in the order of
+// get_points_gather_plan(psel, f.geo()).local_idx
+// No communication.
+{
+  TIMER("set_selected_points_local(sp,f,psel)");
+  const Geometry& geo = f.geo();
+  qassert(geo.is_only_local);
+  const PointsGatherPlan& pgp = get_points_gather_plan(psel, geo);
+  const Long n_points_local = pgp.local_idx.size();
+  const Int multiplicity = f.multiplicity;
+  sp.init();
+  sp.init(n_points_local, multiplicity, PointsDistType::Local);
+  const vector_acc<Long>& local_index = pgp.local_index;
+  qacc_for(idx, n_points_local, {
+    const Coordinate xl = geo.coordinate_from_index(local_index[idx]);
+    const Vector<M> fv = f.get_elems_const(xl);
+    Vector<M> spv = sp.get_elems(idx);
+    for (int m = 0; m < multiplicity; ++m) {
+      spv[m] = fv[m];
+    }
+  });
+}
+
 template <class M>
 void set_selected_points(SelectedPoints<M>& sp, const Field<M>& f,
                          const PointsSelection& psel)
@@ -141,6 +294,14 @@ void set_selected_points(SelectedPoints<M>& sp, const Field<M>& f,
   TIMER("set_selected_points(sp,f,psel)");
   const Geometry& geo = f.geo();
   qassert(geo.is_only_local);
+  if (psel.points_dist_type == PointsDistType::Global) {
+    // only send the points owned by each node
+    const PointsGatherPlan& pgp = get_points_gather_plan(psel, geo);
+    SelectedPoints<M> sp_local;
+    set_selected_points_local(sp_local, f, psel);
+    gather_selected_points(sp, sp_local, psel, pgp);
+    return;
+  }
   const Long n_points = psel.size();
   sp.init(psel, f.multiplicity);
   set_zero(sp);  // has to set_zero for glb_sum_byte_vec
@@ -165,6 +326,21 @@ void set_selected_points(SelectedPoints<M>& sp, const Field<M>& f,
   TIMER("set_selected_points(sp,f,psel,m)");
   const Geometry& geo = f.geo();
   qassert(geo.is_only_local);
+  if (psel.points_dist_type == PointsDistType::Global) {
+    // only send the points owned by each node
+    const PointsGatherPlan& pgp = get_points_gather_plan(psel, geo);
+    const Long n_points_local = pgp.local_idx.size();
+    SelectedPoints<M> sp_local;
+    sp_local.init(n_points_local, 1, PointsDistType::Local);
+    const vector_acc<Long>& local_index = pgp.local_index;
+    qacc_for(idx, n_points_local, {
+      const Coordinate xl = geo.coordinate_from_index(local_index[idx]);
+      const Vector<M> fv = f.get_elems_const(xl);
+      sp_local.get_elem(idx) = fv[m];
+    });
+    gather_selected_points(sp, sp_local, psel, pgp);
+    return;
+  }
   const Long n_points = psel.size();
   sp.init(psel, 1);
   set_zero(sp);  // has to set_zero for glb_sum_byte_vec
@@ -185,7 +361,7 @@ void set_selected_points(SelectedPoints<M>& sp, const SelectedPoints<M>& sp0,
                          const PointsSelection& psel0,
                          const bool is_keeping_data = true)
 // Most efficient if psel and psel0 is the same.
-// If not, more efficient if psel and psel0 has the same order.
+// If not, use the cached hash index of psel0.
 {
   if (&sp == &sp0) {
     return;
@@ -209,21 +385,9 @@ void set_selected_points(SelectedPoints<M>& sp, const SelectedPoints<M>& sp0,
   SelectedPoints<Long> sp_idx;
   sp_idx.init(psel, 1);
   qassert(sp_idx.n_points == n_points);
-  Long idx_last = -1;
-  qfor(idx, n_points, {
-    const Coordinate& xg = psel[idx];
-    Long idx0 = -1;
-    for (Long i = 0; i < n_points0; ++i) {
-      idx_last += 1;
-      if (idx_last >= n_points0) {
-        idx_last = idx_last % n_points0;
-      }
-      const Coordinate& xg0 = psel0[idx_last];
-      if (xg0 == xg) {
-        idx0 = idx_last;
-        break;
-      }
-    }
+  const PointsSelectionIndex& psi0 = get_points_selection_index(psel0);
+  qacc_for(idx, n_points, {
+    const Long idx0 = psi0.find(psel[idx]);
     qassert(idx0 < n_points0);
     sp_idx.get_elem(idx) = idx0;
   });
@@ -94,6 +94,12 @@ class InverterDomainWall(Inverter):
     def set_max_mixed_precision_cycle(self, max_mixed_precision_cycle):
         return c.set_max_mixed_precision_cycle_inverter_domain_wall(self, max_mixed_precision_cycle)
 
+    def num_rhs_batch(self):
+        return c.get_num_rhs_batch_inverter_domain_wall(self)
+
+    def set_num_rhs_batch(self, num_rhs_batch):
+        return c.set_num_rhs_batch_inverter_domain_wall(self, num_rhs_batch)
+
 class InverterGaugeTransform(Inverter):
 
     """
@@ -1,5 +1,6 @@
 #define QLAT_INSTANTIATE_FIELD_EXPAND
 
+#include <qlat/field-aligned.h>
 #include <qlat/field-expand.h>
 
 namespace qlat
@@ -50,6 +51,44 @@ void set_marks_field_1(CommMarks& marks, const Geometry& geo,
   }
 }
 
+void set_marks_field_spatial_1(CommMarks& marks, const Geometry& geo,
+                               const Int multiplicity, const std::string& tag)
+// tag is the list of global time slices separated by spaces
+// Only the spatial neighbors of the sites on these time slices are marked.
+{
+  TIMER_VERBOSE("set_marks_field_spatial_1");
+  const std::vector<Long> t_slices = read_longs(tag);
+  const Int t_size = geo.total_site()[3];
+  std::vector<int8_t> is_selected(t_size, 0);
+  for (Long i = 0; i < (Long)t_slices.size(); ++i) {
+    const Long t = t_slices[i];
+    qassert(0 <= t and t < t_size);
+    is_selected[t] = 1;
+  }
+  marks.init();
+  marks.init(geo, multiplicity);
+  set_zero(marks);
+  Geometry geo_full = geo;
+  geo_full.eo = 0;
+#pragma omp parallel for
+  for (Long index = 0; index < geo_full.local_volume(); ++index) {
+    const Coordinate xl = geo_full.coordinate_from_index(index);
+    const Coordinate xg = geo_full.coordinate_g_from_l(xl);
+    if (is_selected[xg[3]] == 0) {
+      continue;
+    }
+    for (int dir = -3; dir < 3; ++dir) {
+      const Coordinate xl1 = coordinate_shifts(xl, dir);
+      if (geo.is_on_node(xl1) and !geo.is_local(xl1)) {
+        Vector<int8_t> v = marks.get_elems(xl1);
+        for (int m = 0; m < multiplicity; ++m) {
+          v[m] = 1;
+        }
+      }
+    }
+  }
+}
+
 void g_offset_id_node_from_offset(Long& g_offset, int& id_node,
                                   const Long offset, const Geometry& geo,
                                   const Int multiplicity)
@@ -324,6 +363,192 @@ const CommPlan& get_comm_plan(const SetMarksField& set_marks_field,
   return get_comm_plan(cpk);
 }
 
+CommPlanBuffer::~CommPlanBuffer()
+{
+  if (is_persistent) {
+    mpi_request_free(reqs);
+  }
+}
+
+void CommPlanBuffer::init(const CommPlan& plan, const Long elem_size_,
+                          const bool is_persistent_)
+{
+  TIMER("CommPlanBuffer::init");
+  qassert(not is_in_use);
+  if (is_persistent) {
+    mpi_request_free(reqs);
+  }
+  reqs.clear();
+  is_persistent = is_persistent_;
+  elem_size = elem_size_;
+  send_buffer.resize(plan.total_send_size * elem_size);
+  recv_buffer.resize(plan.total_recv_size * elem_size);
+  if (is_persistent) {
+    const int mpi_tag = 10;
+    for (size_t i = 0; i < plan.recv_msg_infos.size(); ++i) {
+      const CommMsgInfo& cmi = plan.recv_msg_infos[i];
+      mpi_recv_init(&recv_buffer[cmi.buffer_idx * elem_size],
+                    cmi.size * elem_size, MPI_BYTE, cmi.id_node, mpi_tag,
+                    get_comm(), reqs);
+    }
+    for (size_t i = 0; i < plan.send_msg_infos.size(); ++i) {
+      const CommMsgInfo& cmi = plan.send_msg_infos[i];
+      mpi_send_init(&send_buffer[cmi.buffer_idx * elem_size],
+                    cmi.size * elem_size, MPI_BYTE, cmi.id_node, mpi_tag,
+                    get_comm(), reqs);
+    }
+  }
+}
+
+void CommPlanBuffer::start(const CommPlan& plan)
+{
+  if (is_persistent) {
+    mpi_startall(reqs);
+    return;
+  }
+  reqs.clear();
+  const int mpi_tag = 10;
+  for (size_t i = 0; i < plan.recv_msg_infos.size(); ++i) {
+    const CommMsgInfo& cmi = plan.recv_msg_infos[i];
+    mpi_irecv(&recv_buffer[cmi.buffer_idx * elem_size], cmi.size * elem_size,
+              MPI_BYTE, cmi.id_node, mpi_tag, get_comm(), reqs);
+  }
+  for (size_t i = 0; i < plan.send_msg_infos.size(); ++i) {
+    const CommMsgInfo& cmi = plan.send_msg_infos[i];
+    mpi_isend(&send_buffer[cmi.buffer_idx * elem_size], cmi.size * elem_size,
+              MPI_BYTE, cmi.id_node, mpi_tag, get_comm(), reqs);
+  }
+}
+
+std::shared_ptr<CommPlanBuffer> get_comm_plan_buffer(const CommPlan& plan,
+                                                     const Long elem_size)
+// Return the buffer owned by plan for elem_size.
+// If it is already in use (e.g. several refresh_expanded_start in flight with
+// the same plan), return a temporary non-persistent buffer instead.
+{
+  std::shared_ptr<CommPlanBuffer>& p = plan.buffers[elem_size];
+  std::shared_ptr<CommPlanBuffer> ret;
+  if (get_comm_plan_buffer_persistent() and (p == nullptr or not p->is_in_use)) {
+    if (p == nullptr) {
+      p = std::make_shared<CommPlanBuffer>();
+      p->init(plan, elem_size, true);
+    }
+    ret = p;
+  } else {
+    ret = std::make_shared<CommPlanBuffer>();
+    ret->init(plan, elem_size, false);
+  }
+  ret->is_in_use = true;
+  return ret;
+}
+
+void release_comm_plan_buffer(std::shared_ptr<CommPlanBuffer>& buffer)
+{
+  if (buffer != nullptr) {
+    buffer->is_in_use = false;
+    buffer.reset();
+  }
+}
+
+CommOverlapIndices make_comm_overlap_indices(const Geometry& geo,
+                                             const Geometry& geo_ext)
+// geo is the geometry of the sites where the stencil is evaluated.
+// geo_ext is the geometry of the expanded field the stencil reads from.
+// A site is interior if all the sites within the expansion of geo_ext are
+// local.
+{
+  TIMER_VERBOSE("make_comm_overlap_indices");
+  qassert(is_matching_geo(geo, geo_ext));
+  CommOverlapIndices ret;
+  const Long local_volume = geo.local_volume();
+  std::vector<int8_t> is_interior(local_volume, 0);
+#pragma omp parallel for
+  for (Long index = 0; index < local_volume; ++index) {
+    const Coordinate xl = geo.coordinate_from_index(index);
+    bool b = true;
+    for (int mu = 0; mu < DIMN; ++mu) {
+      if (xl[mu] - geo_ext.expansion_left[mu] < 0 or
+          xl[mu] + geo_ext.expansion_right[mu] >= geo.node_site[mu]) {
+        b = false;
+      }
+    }
+    is_interior[index] = b ? 1 : 0;
+  }
+  for (Long index = 0; index < local_volume; ++index) {
+    if (is_interior[index] != 0) {
+      ret.interior_indices.push_back(index);
+    } else {
+      ret.boundary_indices.push_back(index);
+    }
+  }
+  return ret;
+}
+
+const CommOverlapIndices& get_comm_overlap_indices(const Geometry& geo,
+                                                   const Geometry& geo_ext)
+{
+  std::ostringstream out;
+  out << geo.eo << "," << show(geo.node_site) << ","
+      << show(geo.geon.size_node) << "," << show(geo_ext.expansion_left)
+      << "," << show(geo_ext.expansion_right);
+  const std::string key = out.str();
+  Cache<std::string, CommOverlapIndices>& cache =
+      get_comm_overlap_indices_cache();
+  if (!cache.has(key)) {
+    cache[key] = make_comm_overlap_indices(geo, geo_ext);
+  }
+  return cache[key];
+}
+
+AlignedSiteTable make_aligned_site_table(const Geometry& geo,
+                                         const Int n_lane)
+{
+  TIMER_VERBOSE("make_aligned_site_table");
+  qassert(n_lane > 0);
+  AlignedSiteTable ret;
+  ret.geo = geo;
+  ret.n_lane = n_lane;
+  const Long local_volume = geo.local_volume();
+  const Long n_site = geo.local_volume_expanded();
+  ret.n_position_local = (local_volume + n_lane - 1) / n_lane * n_lane;
+  ret.positions.resize(n_site, -1);
+  Vector<Long> positions = get_data(ret.positions);
+#pragma omp parallel for
+  for (Long index = 0; index < local_volume; ++index) {
+    positions[geo.offset_from_index(index, 1)] = index;
+  }
+  Long position = ret.n_position_local;
+  for (Long offset = 0; offset < n_site; ++offset) {
+    if (positions[offset] < 0) {
+      positions[offset] = position;
+      position += 1;
+    }
+  }
+  ret.n_position = (position + n_lane - 1) / n_lane * n_lane;
+  ret.offsets.resize(ret.n_position, -1);
+  Vector<Long> offsets = get_data(ret.offsets);
+#pragma omp parallel for
+  for (Long offset = 0; offset < n_site; ++offset) {
+    offsets[positions[offset]] = offset;
+  }
+  return ret;
+}
+
+const AlignedSiteTable& get_aligned_site_table(const Geometry& geo,
+                                               const Int n_lane)
+{
+  std::ostringstream out;
+  out << geo.eo << "," << show(geo.node_site) << ","
+      << show(geo.geon.size_node) << "," << show(geo.expansion_left) << ","
+      << show(geo.expansion_right) << "," << n_lane;
+  const std::string key = out.str();
+  Cache<std::string, AlignedSiteTable>& cache = get_aligned_site_table_cache();
+  if (!cache.has(key)) {
+    cache[key] = make_aligned_site_table(geo, n_lane);
+  }
+  return cache[key];
+}
+
 void set_marks_field_gf_hamilton(CommMarks& marks, const Geometry& geo, const Int multiplicity,
                                  const std::string& tag)
 {
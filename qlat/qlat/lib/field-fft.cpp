@@ -2,6 +2,9 @@
 
 #include <qlat/field-fft.h>
 
+#include <algorithm>
+#include <array>
+
 namespace qlat
 {  //
 
@@ -17,19 +20,23 @@ bool check_fft_plan_key(const Geometry& geo, const int mc, const int dir,
   return b;
 }
 
-void FftComplexFieldPlan::init()
+template <class T>
+void FftComplexFieldPlanT<T>::init()
 {
   if (geo.initialized) {
-    displayln_info("FftComplexFieldPlan::end(): free a plan.");
-    fftw_destroy_plan(fftplan);
+    displayln_info(ssprintf("FftComplexFieldPlan%s::end(): free a plan.",
+                            FftwTraits<T>::get_suffix()));
+    FftwTraits<T>::destroy_plan(fftplan);
     geo.init();
   }
 }
 
-void FftComplexFieldPlan::init(const Geometry& geo_, const int mc_,
-                               const int dir_, const bool is_forward_)
+template <class T>
+void FftComplexFieldPlanT<T>::init(const Geometry& geo_, const int mc_,
+                                   const int dir_, const bool is_forward_)
 {
-  TIMER_VERBOSE("FftComplexFieldPlan::init");
+  TIMER_VERBOSE(std::string("FftComplexFieldPlan") +
+                FftwTraits<T>::get_suffix() + "::init");
   qassert(check_fft_plan_key(geo_, mc_, dir_, is_forward_));
   geo = geo_;
   mc = mc_;
@@ -43,30 +50,23 @@ void FftComplexFieldPlan::init(const Geometry& geo_, const int mc_,
   const Long nc_size = nc_stop - nc_start;
   // fftw_init_threads();
   // fftw_plan_with_nthreads(omp_get_max_threads());
-  displayln_info(ssprintf("FftComplexFieldPlan::init: malloc %ld",
-                          nc_size * sizec * sizeof(ComplexD)));
-  ComplexD* fftdatac = (ComplexD*)fftw_malloc(nc_size * sizec * sizeof(ComplexD));
-  const int rank = 1;
-  const int n[1] = {sizec};
-  const Long howmany = nc_size;
-  const Long dist = 1;
-  const Long stride = nc_size;
-  fftplan = fftw_plan_many_dft(rank, n, howmany, (fftw_complex*)fftdatac, n,
-                               stride, dist, (fftw_complex*)fftdatac, n, stride,
-                               dist, is_forward ? FFTW_FORWARD : FFTW_BACKWARD,
-                               FFTW_ESTIMATE);
-  fftw_free(fftdatac);
-  displayln_info(ssprintf("FftComplexFieldPlan::init: free %ld",
-                          nc_size * sizec * sizeof(ComplexD)));
+  displayln_info(fname + ssprintf(": plan buffer %ld",
+                                  nc_size * sizec * sizeof(T)));
+  fftplan = FftwTraits<T>::make_plan(sizec, nc_size, is_forward);
   sp = make_shuffle_plan_fft(geo.total_site(), dir);
 }
 
-FftComplexFieldPlan& get_fft_plan(const Geometry& geo, const int mc,
-                                  const int dir, const bool is_forward)
+template struct FftComplexFieldPlanT<ComplexD>;
+
+template struct FftComplexFieldPlanT<ComplexF>;
+
+template <class T>
+FftComplexFieldPlanT<T>& get_fft_plan(const Geometry& geo, const int mc,
+                                      const int dir, const bool is_forward)
 {
   TIMER("get_fft_plan");
   qassert(check_fft_plan_key(geo, mc, dir, is_forward));
-  Cache<std::string, FftComplexFieldPlan>& cache = get_fft_plan_cache();
+  Cache<std::string, FftComplexFieldPlanT<T> >& cache = get_fft_plan_cache<T>();
   const std::string key =
       ssprintf("%s %s %d %d %d %d", show(geo.node_site).c_str(),
                show(geo.geon.size_node).c_str(), geo.geon.id_node, mc, dir,
@@ -74,9 +74,389 @@ FftComplexFieldPlan& get_fft_plan(const Geometry& geo, const int mc,
   if (cache.has(key)) {
     return cache[key];
   }
-  FftComplexFieldPlan& plan = cache[key];
+  FftComplexFieldPlanT<T>& plan = cache[key];
   plan.init(geo, mc, dir, is_forward);
   return plan;
 }
 
+template FftComplexFieldPlanT<ComplexD>& get_fft_plan<ComplexD>(
+    const Geometry& geo, const int mc, const int dir, const bool is_forward);
+
+template FftComplexFieldPlanT<ComplexF>& get_fft_plan<ComplexF>(
+    const Geometry& geo, const int mc, const int dir, const bool is_forward);
+
+// --------------------
+
+static void fft_pencil_find_site(Int& id_node, Long& site_idx,
+                                 const Geometry& geo, const int dir,
+                                 const Coordinate& xg)
+// dir == -1 for the local field order
+{
+  const Coordinate& node_site = geo.node_site;
+  const Coordinate& size_node = geo.geon.size_node;
+  Coordinate coor_node = xg / node_site;
+  const Coordinate xl = xg - coor_node * node_site;
+  if (dir == -1) {
+    id_node = index_from_coordinate(coor_node, size_node);
+    site_idx = index_from_coordinate(xl, node_site);
+    return;
+  }
+  const Long vol_perp_dir = product(node_site) / node_site[dir];
+  const Long idx = index_from_coordinate_perp_dir(xl, node_site, dir);
+  coor_node[dir] = find_worker(idx, vol_perp_dir, size_node[dir]);
+  Long start, size;
+  split_work(start, size, vol_perp_dir, size_node[dir], coor_node[dir]);
+  id_node = index_from_coordinate(coor_node, size_node);
+  site_idx = xg[dir] * size + idx - start;
+}
+
+static Coordinate fft_pencil_coordinate_g(const Geometry& geo, const int dir,
+                                          const Long line_start,
+                                          const Long n_lines,
+                                          const Long site_idx)
+// dir == -1 for the local field order
+{
+  if (dir == -1) {
+    return geo.coordinate_g_from_l(geo.coordinate_from_index(site_idx));
+  }
+  const Long line = site_idx % n_lines;
+  Coordinate xl = coordinate_from_index_perp_dir(line_start + line,
+                                                 geo.node_site, dir, 0);
+  Coordinate xg = geo.geon.coor_node * geo.node_site + xl;
+  xg[dir] = site_idx / n_lines;
+  return xg;
+}
+
+static void fft_pencil_set_msg_infos(std::vector<ShufflePlanMsgInfo>& mis,
+                                     const std::vector<std::array<Long, 3> >& v)
+// v[i] = (id_node, ...) sorted, one site per buffer_idx = i
+{
+  mis.clear();
+  Long i = 0;
+  while (i < (Long)v.size()) {
+    ShufflePlanMsgInfo mi;
+    mi.id_node = v[i][0];
+    mi.idx = i;
+    mi.size = 0;
+    while (i < (Long)v.size() and v[i][0] == mi.id_node and
+           mi.size < get_shuffle_max_msg_size()) {
+      mi.size += 1;
+      i += 1;
+    }
+    mis.push_back(mi);
+  }
+}
+
+static void fft_pencil_set_pack_infos(
+    std::vector<ShufflePlanSendPackInfo>& pis,
+    const std::vector<std::array<Long, 3> >& v)
+// v[i] = (id_node, ..., field_idx) sorted, one site per buffer_idx = i
+{
+  pis.clear();
+  for (Long i = 0; i < (Long)v.size(); ++i) {
+    const Long field_idx = v[i][2];
+    if (pis.size() > 0 and
+        pis.back().field_idx + pis.back().size == field_idx and
+        pis.back().size < get_shuffle_max_pack_size()) {
+      pis.back().size += 1;
+    } else {
+      ShufflePlanSendPackInfo pi;
+      pi.field_idx = field_idx;
+      pi.buffer_idx = i;
+      pi.size = 1;
+      pis.push_back(pi);
+    }
+  }
+}
+
+template <class T>
+static FftPencilTranspose make_fft_pencil_transpose(
+    const FftPencilPlanT<T>& plan, const Int layout_from, const Int layout_to)
+// Sites are ordered by (id_node, site_idx in layout_to) in the buffers.
+{
+  TIMER("make_fft_pencil_transpose");
+  const Geometry& geo = plan.geo;
+  const int dir_from = layout_from == -1 ? -1 : plan.dirs[layout_from];
+  const int dir_to = layout_to == -1 ? -1 : plan.dirs[layout_to];
+  FftPencilTranspose tp;
+  // send: (id_node_to, site_idx_to, site_idx_from)
+  std::vector<std::array<Long, 3> > send_v(plan.layout_size(layout_from));
+#pragma omp parallel for
+  for (Long site_idx = 0; site_idx < (Long)send_v.size(); ++site_idx) {
+    const Coordinate xg =
+        plan.coordinate_g_from_site_idx(layout_from, site_idx);
+    Int id_node;
+    Long site_idx_to;
+    fft_pencil_find_site(id_node, site_idx_to, geo, dir_to, xg);
+    send_v[site_idx] = std::array<Long, 3>({id_node, site_idx_to, site_idx});
+  }
+  std::sort(send_v.begin(), send_v.end());
+  // recv: (id_node_from, site_idx_to, site_idx_to)
+  std::vector<std::array<Long, 3> > recv_v(plan.layout_size(layout_to));
+#pragma omp parallel for
+  for (Long site_idx = 0; site_idx < (Long)recv_v.size(); ++site_idx) {
+    const Coordinate xg = plan.coordinate_g_from_site_idx(layout_to, site_idx);
+    Int id_node;
+    Long site_idx_from;
+    fft_pencil_find_site(id_node, site_idx_from, geo, dir_from, xg);
+    recv_v[site_idx] = std::array<Long, 3>({id_node, site_idx, site_idx});
+  }
+  std::sort(recv_v.begin(), recv_v.end());
+  fft_pencil_set_pack_infos(tp.send_pack_infos, send_v);
+  fft_pencil_set_pack_infos(tp.recv_pack_infos, recv_v);
+  fft_pencil_set_msg_infos(tp.scp.send_msg_infos, send_v);
+  fft_pencil_set_msg_infos(tp.scp.recv_msg_infos, recv_v);
+  tp.scp.total_send_size = send_v.size();
+  tp.scp.total_recv_size = recv_v.size();
+  tp.scp.global_comm_size = tp.scp.total_send_size;
+  glb_sum(tp.scp.global_comm_size);
+  return tp;
+}
+
+template <class T>
+static void fft_pencil_destroy_plans(
+    std::vector<typename FftwTraits<T>::Plan>& fftplans)
+{
+  for (Long i = 0; i < (Long)fftplans.size(); ++i) {
+    if (fftplans[i] != NULL) {
+      FftwTraits<T>::destroy_plan(fftplans[i]);
+    }
+  }
+  fftplans.clear();
+}
+
+template <class T>
+static void fft_pencil_make_plans(
+    std::vector<typename FftwTraits<T>::Plan>& fftplans_forward,
+    std::vector<typename FftwTraits<T>::Plan>& fftplans_backward,
+    const FftPencilPlanT<T>& plan)
+// One plan per direction for all the lines of the pencil layout.
+// NULL if this node has no lines in this direction.
+{
+  const Int n_dirs = plan.dirs.size();
+  fftplans_forward.resize(n_dirs, NULL);
+  fftplans_backward.resize(n_dirs, NULL);
+  for (Int i = 0; i < n_dirs; ++i) {
+    const Long howmany = plan.n_lines[i] * plan.mc;
+    if (howmany == 0) {
+      continue;
+    }
+    const int sizec = plan.geo.total_site()[plan.dirs[i]];
+    fftplans_forward[i] = FftwTraits<T>::make_plan(sizec, howmany, true);
+    fftplans_backward[i] = FftwTraits<T>::make_plan(sizec, howmany, false);
+  }
+}
+
+template <class T>
+void FftPencilPlanT<T>::init()
+{
+  if (geo.initialized) {
+    fft_pencil_destroy_plans<T>(fftplans_forward);
+    fft_pencil_destroy_plans<T>(fftplans_backward);
+    geo.init();
+  }
+  mc = 0;
+  dirs.clear();
+  n_lines.clear();
+  line_start.clear();
+  transposes.clear();
+  fftplans_forward.clear();
+  fftplans_backward.clear();
+}
+
+template <class T>
+void FftPencilPlanT<T>::init(const Geometry& geo_, const Int mc_,
+                             const std::vector<int>& dirs_)
+{
+  TIMER_VERBOSE(std::string("FftPencilPlan") + FftwTraits<T>::get_suffix() +
+                "::init");
+  init();
+  qassert(dirs_.size() > 0);
+  for (Long i = 0; i < (Long)dirs_.size(); ++i) {
+    qassert(check_fft_plan_key(geo_, mc_, dirs_[i], true));
+  }
+  geo = geo_;
+  mc = mc_;
+  dirs = dirs_;
+  const Int n_dirs = dirs.size();
+  n_lines.resize(n_dirs);
+  line_start.resize(n_dirs);
+  for (Int i = 0; i < n_dirs; ++i) {
+    const int dir = dirs[i];
+    const Long vol_perp_dir = geo.local_volume() / geo.node_site[dir];
+    split_work(line_start[i], n_lines[i], vol_perp_dir,
+               geo.geon.size_node[dir], geo.geon.coor_node[dir]);
+  }
+  transposes.resize(n_dirs + 1);
+  for (Int i = 0; i < n_dirs; ++i) {
+    transposes[i] = make_fft_pencil_transpose(*this, i - 1, i);
+  }
+  transposes[n_dirs] = make_fft_pencil_transpose(*this, n_dirs - 1, -1);
+  fft_pencil_make_plans<T>(fftplans_forward, fftplans_backward, *this);
+}
+
+template <class T>
+Long FftPencilPlanT<T>::layout_size(const Int layout) const
+{
+  if (layout == -1) {
+    return geo.local_volume();
+  }
+  return n_lines[layout] * geo.total_site()[dirs[layout]];
+}
+
+template <class T>
+Coordinate FftPencilPlanT<T>::coordinate_g_from_site_idx(
+    const Int layout, const Long site_idx) const
+{
+  if (layout == -1) {
+    return fft_pencil_coordinate_g(geo, -1, 0, 0, site_idx);
+  }
+  return fft_pencil_coordinate_g(geo, dirs[layout], line_start[layout],
+                                 n_lines[layout], site_idx);
+}
+
+template struct FftPencilPlanT<ComplexD>;
+
+template struct FftPencilPlanT<ComplexF>;
+
+template <class T>
+FftPencilPlanT<T>& get_fft_pencil_plan(const Geometry& geo, const Int mc,
+                                       const std::vector<int>& dirs)
+{
+  TIMER("get_fft_pencil_plan");
+  Cache<std::string, FftPencilPlanT<T> >& cache =
+      get_fft_pencil_plan_cache<T>();
+  std::string key = ssprintf("%s %s %d %d", show(geo.node_site).c_str(),
+                             show(geo.geon.size_node).c_str(),
+                             geo.geon.id_node, mc);
+  for (Long i = 0; i < (Long)dirs.size(); ++i) {
+    key += ssprintf(" %d", dirs[i]);
+  }
+  if (cache.has(key)) {
+    return cache[key];
+  }
+  FftPencilPlanT<T>& plan = cache[key];
+  plan.init(geo, mc, dirs);
+  return plan;
+}
+
+template FftPencilPlanT<ComplexD>& get_fft_pencil_plan<ComplexD>(
+    const Geometry& geo, const Int mc, const std::vector<int>& dirs);
+
+template FftPencilPlanT<ComplexF>& get_fft_pencil_plan<ComplexF>(
+    const Geometry& geo, const Int mc, const std::vector<int>& dirs);
+
+template <class T>
+static void fft_pencil_transpose_step(FftPencilFieldT<T>& pf,
+                                      const FftPencilTranspose& tp,
+                                      const Long size_to,
+                                      const bool is_reverse)
+{
+  TIMER_FLOPS("fft_pencil_transpose_step");
+  const Int mc = pf.mc;
+  const ShuffleCommPlan& scp = tp.scp;
+  timer.flops += scp.global_comm_size * mc * sizeof(T);
+  vector<T> send_buffer(scp.total_send_size * mc);
+  vector<T> recv_buffer(scp.total_recv_size * mc);
+  vector<T> data(size_to * mc);
+  if (not is_reverse) {
+    qassert(pf.data.size() >= scp.total_send_size * mc);
+    shuffle_field_pack_send(get_data(send_buffer), get_data(pf.data),
+                            tp.send_pack_infos, mc);
+    pf.data.init();
+    shuffle_field_comm(get_data(recv_buffer), get_data(send_buffer), scp, mc);
+    shuffle_field_unpack_send(get_data(data), get_data(recv_buffer),
+                              tp.recv_pack_infos, mc);
+  } else {
+    qassert(pf.data.size() >= scp.total_recv_size * mc);
+    shuffle_field_pack_send(get_data(recv_buffer), get_data(pf.data),
+                            tp.recv_pack_infos, mc);
+    pf.data.init();
+    shuffle_field_comm_back(get_data(send_buffer), get_data(recv_buffer), scp,
+                            mc);
+    shuffle_field_unpack_send(get_data(data), get_data(send_buffer),
+                              tp.send_pack_infos, mc);
+  }
+  qswap(pf.data, data);
+}
+
+template <class T>
+static void fft_pencil_transpose_t(FftPencilFieldT<T>& pf, const Int layout)
+// The layouts form a cycle -1 -> 0 -> ... -> dirs.size() - 1 -> -1.
+// Take the shorter way around.
+{
+  TIMER("fft_pencil_transpose");
+  const FftPencilPlanT<T>& plan =
+      get_fft_pencil_plan<T>(pf.geo, pf.mc, pf.dirs);
+  const Int n_pos = plan.dirs.size() + 1;
+  qassert(-1 <= layout and layout < n_pos - 1);
+  const Int pos_to = layout + 1;
+  while (pf.layout != layout) {
+    const Int pos = pf.layout + 1;
+    const Int n_steps_forward = mod(pos_to - pos, n_pos);
+    if (n_steps_forward <= n_pos - n_steps_forward) {
+      const Int pos_next = mod(pos + 1, n_pos);
+      fft_pencil_transpose_step(pf, plan.transposes[pos],
+                                plan.layout_size(pos_next - 1), false);
+      pf.layout = pos_next - 1;
+    } else {
+      const Int pos_next = mod(pos - 1, n_pos);
+      fft_pencil_transpose_step(pf, plan.transposes[pos_next],
+                                plan.layout_size(pos_next - 1), true);
+      pf.layout = pos_next - 1;
+    }
+  }
+}
+
+template <class T>
+static void fft_pencil_field_t(FftPencilFieldT<T>& pf, const bool is_forward,
+                               const bool is_keep_pencil)
+// forward: layout -1 -> 0 -> ... -> n - 1 (-> -1)
+// backward: layout -1 -> n - 1 -> ... -> 0 (-> -1)
+// If is_keep_pencil, pf is left in the last pencil layout (n - 1 for forward
+// and 0 for backward), e.g. for convolution. A following backward (forward)
+// transform starts from that layout without transposes.
+{
+  TIMER_FLOPS("fft_pencil_field");
+  const FftPencilPlanT<T>& plan =
+      get_fft_pencil_plan<T>(pf.geo, pf.mc, pf.dirs);
+  const Int n_dirs = plan.dirs.size();
+  for (Int k = 0; k < n_dirs; ++k) {
+    const Int i = is_forward ? k : n_dirs - 1 - k;
+    fft_pencil_transpose_t(pf, i);
+    const typename FftwTraits<T>::Plan fftplan =
+        is_forward ? plan.fftplans_forward[i] : plan.fftplans_backward[i];
+    if (fftplan != NULL) {
+      TIMER("fft_pencil_field-fftw");
+      FftwTraits<T>::execute(fftplan, pf.data.data());
+    }
+  }
+  if (not is_keep_pencil) {
+    fft_pencil_transpose_t(pf, -1);
+  }
+  timer.flops += pf.data.size() * sizeof(T) * get_num_node();
+}
+
+void fft_pencil_transpose(FftPencilField& pf, const Int layout)
+{
+  fft_pencil_transpose_t(pf, layout);
+}
+
+void fft_pencil_transpose(FftPencilFieldF& pf, const Int layout)
+{
+  fft_pencil_transpose_t(pf, layout);
+}
+
+void fft_pencil_field(FftPencilField& pf, const bool is_forward,
+                      const bool is_keep_pencil)
+{
+  fft_pencil_field_t(pf, is_forward, is_keep_pencil);
+}
+
+void fft_pencil_field(FftPencilFieldF& pf, const bool is_forward,
+                      const bool is_keep_pencil)
+{
+  fft_pencil_field_t(pf, is_forward, is_keep_pencil);
+}
+
 }  // namespace qlat
@@ -5,6 +5,107 @@
 namespace qlat
 {  //
 
+static void set_mpi_io_field_types(MPI_Datatype& etype, MPI_Datatype& ftype,
+                                   const Geometry& geo, const Long site_size)
+// etype: one site ; ftype: the local sites of this node in the whole lattice
+// Sites are ordered with x fastest, same as g_index_from_g_coordinate.
+{
+  qassert(site_size <= INT_MAX);
+  int ret = MPI_Type_contiguous(site_size, MPI_BYTE, &etype);
+  qassert(ret == MPI_SUCCESS);
+  ret = MPI_Type_commit(&etype);
+  qassert(ret == MPI_SUCCESS);
+  const Coordinate total_site = geo.total_site();
+  const Coordinate& node_site = geo.node_site;
+  const Coordinate& coor_node = geo.geon.coor_node;
+  int sizes[4];
+  int subsizes[4];
+  int starts[4];
+  for (int mu = 0; mu < 4; ++mu) {
+    sizes[3 - mu] = total_site[mu];
+    subsizes[3 - mu] = node_site[mu];
+    starts[3 - mu] = coor_node[mu] * node_site[mu];
+  }
+  ret = MPI_Type_create_subarray(4, sizes, subsizes, starts, MPI_ORDER_C,
+                                 etype, &ftype);
+  qassert(ret == MPI_SUCCESS);
+  ret = MPI_Type_commit(&ftype);
+  qassert(ret == MPI_SUCCESS);
+}
+
+Long mpi_io_write_field_data(const std::string& path, const Long offset,
+                             const Geometry& geo, const Long site_size,
+                             const std::vector<char>& data)
+// collective
+// data: local sites ordered as in the file (see set_mpi_io_buffer_from_field)
+// write the data of all nodes starting at offset of the file
+// return total bytes of data written by all nodes
+{
+  TIMER_VERBOSE_FLOPS("mpi_io_write_field_data");
+  const Long local_volume = geo.local_volume();
+  qassert((Long)data.size() == local_volume * site_size);
+  qassert(local_volume <= INT_MAX);
+  MPI_Datatype etype, ftype;
+  set_mpi_io_field_types(etype, ftype, geo, site_size);
+  // the file (with its header) is created by node 0 before this call
+  sync_node();
+  MPI_File fh;
+  int ret = MPI_File_open(get_comm(), path.c_str(),
+                          MPI_MODE_WRONLY | MPI_MODE_CREATE, MPI_INFO_NULL,
+                          &fh);
+  qassert(ret == MPI_SUCCESS);
+  ret = MPI_File_set_view(fh, offset, etype, ftype, "native", MPI_INFO_NULL);
+  qassert(ret == MPI_SUCCESS);
+  ret = MPI_File_write_all(fh, data.data(), local_volume, etype,
+                           MPI_STATUS_IGNORE);
+  qassert(ret == MPI_SUCCESS);
+  ret = MPI_File_close(&fh);
+  qassert(ret == MPI_SUCCESS);
+  MPI_Type_free(&ftype);
+  MPI_Type_free(&etype);
+  timer.flops += data.size();
+  return geo.total_volume() * site_size;
+}
+
+Long mpi_io_read_field_data(std::vector<char>& data, const std::string& path,
+                            const Geometry& geo, const Long site_size)
+// collective
+// read the local sites from the last geo.total_volume() * site_size bytes
+// of the file into data (ordered as in the file)
+// return total bytes of data read by all nodes (0 if the file is too small)
+{
+  TIMER_VERBOSE_FLOPS("mpi_io_read_field_data");
+  const Long local_volume = geo.local_volume();
+  const Long data_size = geo.total_volume() * site_size;
+  qassert(local_volume <= INT_MAX);
+  MPI_File fh;
+  int ret = MPI_File_open(get_comm(), path.c_str(), MPI_MODE_RDONLY,
+                          MPI_INFO_NULL, &fh);
+  qassert(ret == MPI_SUCCESS);
+  MPI_Offset file_size = 0;
+  ret = MPI_File_get_size(fh, &file_size);
+  qassert(ret == MPI_SUCCESS);
+  if (file_size < data_size) {
+    MPI_File_close(&fh);
+    return 0;
+  }
+  MPI_Datatype etype, ftype;
+  set_mpi_io_field_types(etype, ftype, geo, site_size);
+  ret = MPI_File_set_view(fh, file_size - data_size, etype, ftype, "native",
+                          MPI_INFO_NULL);
+  qassert(ret == MPI_SUCCESS);
+  data.resize(local_volume * site_size);
+  ret = MPI_File_read_all(fh, data.data(), local_volume, etype,
+                          MPI_STATUS_IGNORE);
+  qassert(ret == MPI_SUCCESS);
+  ret = MPI_File_close(&fh);
+  qassert(ret == MPI_SUCCESS);
+  MPI_Type_free(&ftype);
+  MPI_Type_free(&etype);
+  timer.flops += data.size();
+  return data_size;
+}
+
 bool is_dist_field(const std::string& path)
 {
   TIMER("is_dist_field");
@@ -5,6 +5,63 @@
 namespace qlat
 {  //
 
+GeometryNeighborTable make_geometry_neighbor_table(const Geometry& geo,
+                                                   const Geometry& geo_ext)
+{
+  TIMER_VERBOSE("make_geometry_neighbor_table");
+  qassert(is_matching_geo(geo, geo_ext));
+  GeometryNeighborTable ret;
+  ret.geo = geo;
+  ret.geo_ext = geo_ext;
+  const Long local_volume = geo.local_volume();
+  // sites of geo have parity geo.eo (if geo.eo != 0), the neighbors have the
+  // opposite parity
+  const bool is_site_in_ext = geo_ext.eo == 0 or geo_ext.eo == geo.eo;
+  const bool is_neighbor_in_ext =
+      geo_ext.eo == 0 or (geo.eo != 0 and geo_ext.eo == 3 - geo.eo);
+  if (is_site_in_ext) {
+    ret.site_offsets.resize(local_volume);
+  }
+  if (is_neighbor_in_ext) {
+    ret.neighbor_offsets.resize(local_volume * 8);
+  }
+  Vector<Long> site_offsets = get_data(ret.site_offsets);
+  Vector<Long> neighbor_offsets = get_data(ret.neighbor_offsets);
+#pragma omp parallel for
+  for (Long index = 0; index < local_volume; ++index) {
+    const Coordinate xl = geo.coordinate_from_index(index);
+    if (is_site_in_ext) {
+      site_offsets[index] = geo_ext.offset_from_coordinate(xl, 1);
+    }
+    if (is_neighbor_in_ext) {
+      for (int dir = 0; dir < 8; ++dir) {
+        const Coordinate xl1 =
+            coordinate_shifts(xl, dir < 4 ? dir : -(dir - 4) - 1);
+        neighbor_offsets[index * 8 + dir] =
+            geo_ext.is_on_node(xl1) ? geo_ext.offset_from_coordinate(xl1, 1)
+                                    : -1;
+      }
+    }
+  }
+  return ret;
+}
+
+const GeometryNeighborTable& get_geometry_neighbor_table(
+    const Geometry& geo, const Geometry& geo_ext)
+{
+  std::ostringstream out;
+  out << geo.eo << "," << show(geo.node_site) << ","
+      << show(geo.geon.size_node) << "," << geo_ext.eo << ","
+      << show(geo_ext.expansion_left) << "," << show(geo_ext.expansion_right);
+  const std::string key = out.str();
+  Cache<std::string, GeometryNeighborTable>& cache =
+      get_geometry_neighbor_table_cache();
+  if (!cache.has(key)) {
+    cache[key] = make_geometry_neighbor_table(geo, geo_ext);
+  }
+  return cache[key];
+}
+
 void set_sqrt_field(Field<RealD>& f, const Field<RealD>& f1)
 {
   TIMER("set_sqrt_field(f,f1)");
@@ -2,6 +2,10 @@
 
 #include <qlat/fields-io.h>
 
+#include <zlib.h>
+
+#include <cstring>
+
 namespace qlat
 {  //
 
@@ -86,7 +90,7 @@ void BitSet::decompress(const void* src, void* dst, size_t block_size) const
   }
 }
 
-std::vector<char> bitset_decompress(const std::vector<char>& data,
+std::vector<char> bitset_decompress(const Vector<char> data,
                                     const Long local_volume)
 {
   TIMER("bitset_decompress");
@@ -270,38 +274,269 @@ Long qfwrite_convert_endian(void* ptr, const size_t size, const size_t nmemb,
   return ret;
 }
 
-Long write(FieldsWriter& fw, const std::string& fn, const Geometry& geo,
-           const Vector<char> data, const bool is_sparse_field)
+template <class T>
+static void append_convert_endian(std::vector<char>& buf, const T x,
+                                  const bool is_little_endian)
 {
-  TIMER("write(fw,fn,geo,data)");
-  Long n_elem_write;
-  Long offset;
-  // get initial offset
-  const Long offset_start = fw.qfile.tell();
-  offset = offset_start;
+  T v = x;
+  convert_endian(Vector<T>(&v, 1), is_little_endian);
+  buf.insert(buf.end(), (const char*)&v, (const char*)&v + sizeof(T));
+}
+
+template <class T>
+static bool read_convert_endian(T& x, const Vector<char> buf, Long& pos,
+                                const bool is_little_endian)
+{
+  if (pos + (Long)sizeof(T) > buf.size()) {
+    return false;
+  }
+  std::memcpy(&x, &buf[pos], sizeof(T));
+  convert_endian(Vector<T>(&x, 1), is_little_endian);
+  pos += sizeof(T);
+  return true;
+}
+
+static void fields_codec_block_range(Long& start, Long& size, const Long b,
+                                     const Long data_size, const Long offset,
+                                     const Long block_size)
+// block 0 is data[0:offset], block b > 0 starts at offset + (b - 1) * block_size
+{
+  if (b == 0) {
+    start = 0;
+    size = offset;
+  } else {
+    start = offset + (b - 1) * block_size;
+    size = std::min(block_size, data_size - start);
+  }
+}
+
+static void fields_codec_shuffle(char* dst, const char* src, const Long size,
+                                 const Int elem_size)
+// dst[j * n + k] = src[k * elem_size + j] where n = size / elem_size
+// the remaining bytes are copied
+{
+  const Long n = size / elem_size;
+  for (Int j = 0; j < elem_size; ++j) {
+    for (Long k = 0; k < n; ++k) {
+      dst[j * n + k] = src[k * elem_size + j];
+    }
+  }
+  std::memcpy(dst + n * elem_size, src + n * elem_size, size - n * elem_size);
+}
+
+static void fields_codec_unshuffle(char* dst, const char* src, const Long size,
+                                   const Int elem_size)
+// inverse of fields_codec_shuffle
+{
+  const Long n = size / elem_size;
+  for (Int j = 0; j < elem_size; ++j) {
+    for (Long k = 0; k < n; ++k) {
+      dst[k * elem_size + j] = src[j * n + k];
+    }
+  }
+  std::memcpy(dst + n * elem_size, src + n * elem_size, size - n * elem_size);
+}
+
+std::vector<char> fields_encode(const FieldsCodec codec, const Vector<char> data,
+                                const Int elem_size, const Long offset)
+// Return the encoded data (the payload of the segment).
+// ShuffleDeflate payload (integers in little endian):
+//   int64 data_size ; int32 elem_size ; int64 offset ; int64 block_size ;
+//   int64 n_block ; int64 comp_size[n_block] ; deflate streams of the blocks.
+// Block 0 is data[0:offset] (e.g. the BitSet of a sparse field) and is not
+// shuffled. The rest is cut into blocks, which are byte shuffled with
+// elem_size and compressed in parallel.
+{
+  TIMER_FLOPS("fields_encode");
+  qassert(codec == FieldsCodec::ShuffleDeflate);
+  qassert(elem_size > 0);
+  qassert(0 <= offset and offset <= data.size());
+  const Long data_size = data.size();
+  const Long block_size = (4L * 1024L * 1024L / elem_size) * elem_size;
+  const Long n_block = 1 + (data_size - offset + block_size - 1) / block_size;
+  std::vector<std::vector<char>> blocks(n_block);
+  std::vector<int> rets(n_block, Z_OK);
+#pragma omp parallel for schedule(dynamic)
+  for (Long b = 0; b < n_block; ++b) {
+    Long start, size;
+    fields_codec_block_range(start, size, b, data_size, offset, block_size);
+    std::vector<char> buf(size);
+    if (b == 0) {
+      std::memcpy(buf.data(), data.data(), size);
+    } else {
+      fields_codec_shuffle(buf.data(), &data[start], size, elem_size);
+    }
+    uLongf comp_size = compressBound(size);
+    blocks[b].resize(comp_size);
+    rets[b] = compress2((Bytef*)blocks[b].data(), &comp_size,
+                        (const Bytef*)buf.data(), size, Z_BEST_SPEED);
+    blocks[b].resize(comp_size);
+  }
+  std::vector<char> payload;
+  const bool is_little_endian = true;
+  append_convert_endian(payload, (int64_t)data_size, is_little_endian);
+  append_convert_endian(payload, (int32_t)elem_size, is_little_endian);
+  append_convert_endian(payload, (int64_t)offset, is_little_endian);
+  append_convert_endian(payload, (int64_t)block_size, is_little_endian);
+  append_convert_endian(payload, (int64_t)n_block, is_little_endian);
+  for (Long b = 0; b < n_block; ++b) {
+    qassert(rets[b] == Z_OK);
+    append_convert_endian(payload, (int64_t)blocks[b].size(), is_little_endian);
+  }
+  for (Long b = 0; b < n_block; ++b) {
+    payload.insert(payload.end(), blocks[b].begin(), blocks[b].end());
+  }
+  timer.flops += data_size;
+  return payload;
+}
+
+bool fields_decode(std::vector<char>& data, const FieldsCodec codec,
+                   const Vector<char> payload)
+// Inverse of fields_encode. Return false if payload is not valid.
+{
+  TIMER_FLOPS("fields_decode");
+  clear(data);
+  if (codec != FieldsCodec::ShuffleDeflate) {
+    qwarn(fname + ssprintf(": unknown codec %d.", (int)codec));
+    return false;
+  }
+  const bool is_little_endian = true;
+  Long pos = 0;
+  int64_t data_size = 0, offset = 0, block_size = 0, n_block = 0;
+  int32_t elem_size = 0;
+  bool is_ok = true;
+  is_ok = is_ok and read_convert_endian(data_size, payload, pos, is_little_endian);
+  is_ok = is_ok and read_convert_endian(elem_size, payload, pos, is_little_endian);
+  is_ok = is_ok and read_convert_endian(offset, payload, pos, is_little_endian);
+  is_ok = is_ok and read_convert_endian(block_size, payload, pos, is_little_endian);
+  is_ok = is_ok and read_convert_endian(n_block, payload, pos, is_little_endian);
+  // Check the header before allocating anything with its sizes.
+  // Deflate cannot compress by more than a factor of 1032, and each block
+  // needs at least its int64 comp_size entry in the payload.
+  const Long payload_size = payload.size();
+  is_ok = is_ok and data_size >= 0 and data_size <= 1032L * payload_size and
+          elem_size > 0 and 0 <= offset and offset <= data_size and
+          block_size > 0 and block_size % elem_size == 0 and
+          n_block == 1 + (data_size - offset) / block_size +
+                         ((data_size - offset) % block_size != 0 ? 1 : 0) and
+          n_block <= (payload_size - pos) / (Long)sizeof(int64_t);
+  if (not is_ok) {
+    qwarn(fname + ssprintf(": invalid payload header."));
+    return false;
+  }
+  std::vector<Long> comp_starts(n_block + 1, 0);
+  for (Long b = 0; is_ok and b < n_block; ++b) {
+    int64_t comp_size = 0;
+    is_ok = read_convert_endian(comp_size, payload, pos, is_little_endian) and
+            comp_size >= 0 and comp_size <= payload_size;
+    comp_starts[b + 1] = comp_starts[b] + comp_size;
+  }
+  if (not is_ok or pos + comp_starts[n_block] != payload_size) {
+    qwarn(fname + ssprintf(": invalid payload."));
+    return false;
+  }
+  data.resize(data_size);
+  std::vector<int> rets(n_block, Z_OK);
+#pragma omp parallel for schedule(dynamic)
+  for (Long b = 0; b < n_block; ++b) {
+    Long start, size;
+    fields_codec_block_range(start, size, b, data_size, offset, block_size);
+    std::vector<char> buf(size);
+    uLongf dst_size = size;
+    rets[b] = uncompress((Bytef*)buf.data(), &dst_size,
+                         (const Bytef*)&payload[pos + comp_starts[b]],
+                         comp_starts[b + 1] - comp_starts[b]);
+    if (rets[b] == Z_OK and (Long)dst_size != size) {
+      rets[b] = Z_DATA_ERROR;
+    }
+    if (rets[b] != Z_OK) {
+      continue;
+    }
+    if (b == 0) {
+      std::memcpy(data.data(), buf.data(), size);
+    } else {
+      fields_codec_unshuffle(&data[start], buf.data(), size, elem_size);
+    }
+  }
+  for (Long b = 0; b < n_block; ++b) {
+    if (rets[b] != Z_OK) {
+      qwarn(fname + ssprintf(": block %ld zlib error %d.", (long)b, rets[b]));
+      clear(data);
+      return false;
+    }
+  }
+  timer.flops += data_size;
+  return true;
+}
+
+void fields_round_mantissa(Vector<RealD> v, const Int n_mantissa_bits)
+// Round to the nearest number with n_mantissa_bits explicit mantissa bits.
+// Relative error is at most 2^-(n_mantissa_bits+1). Inf and NaN are kept.
+{
+  TIMER("fields_round_mantissa(v_d,n_mantissa_bits)");
+  if (n_mantissa_bits <= 0 or n_mantissa_bits >= 52) {
+    return;
+  }
+  const Int n_drop = 52 - n_mantissa_bits;
+  const uint64_t half = (uint64_t)1 << (n_drop - 1);
+  const uint64_t mask = ~(((uint64_t)1 << n_drop) - 1);
+  const uint64_t exp_mask = (uint64_t)0x7FF << 52;
+  qthread_for(i, v.size(), {
+    uint64_t u;
+    std::memcpy(&u, &v[i], sizeof(u));
+    if ((u & exp_mask) != exp_mask) {
+      uint64_t r = (u + half) & mask;
+      if ((r & exp_mask) == exp_mask) {
+        r = u & mask;
+      }
+      std::memcpy(&v[i], &r, sizeof(r));
+    }
+  });
+}
+
+void fields_round_mantissa(Vector<RealF> v, const Int n_mantissa_bits)
+// Round to the nearest number with n_mantissa_bits explicit mantissa bits.
+// Relative error is at most 2^-(n_mantissa_bits+1). Inf and NaN are kept.
+{
+  TIMER("fields_round_mantissa(v_f,n_mantissa_bits)");
+  if (n_mantissa_bits <= 0 or n_mantissa_bits >= 23) {
+    return;
+  }
+  const Int n_drop = 23 - n_mantissa_bits;
+  const uint32_t half = (uint32_t)1 << (n_drop - 1);
+  const uint32_t mask = ~(((uint32_t)1 << n_drop) - 1);
+  const uint32_t exp_mask = (uint32_t)0xFF << 23;
+  qthread_for(i, v.size(), {
+    uint32_t u;
+    std::memcpy(&u, &v[i], sizeof(u));
+    if ((u & exp_mask) != exp_mask) {
+      uint32_t r = (u + half) & mask;
+      if ((r & exp_mask) == exp_mask) {
+        r = u & mask;
+      }
+      std::memcpy(&v[i], &r, sizeof(r));
+    }
+  });
+}
+
+static std::vector<char> make_fields_segment_header(
+    const std::string& fn, const Geometry& geo, const crc32_t crc,
+    const int64_t data_len, const bool is_sparse_field, const FieldsCodec codec,
+    const bool is_little_endian)
+// Everything of a segment before the data: tag, crc, geometry info, data size.
+{
+  std::vector<char> buf;
   // first write tag
-  int32_t tag_len = fn.size() + 1;  // fn is the name of the field (say prop1)
-  n_elem_write =
-      qfwrite_convert_endian(&tag_len, 4, 1, fw.qfile, fw.is_little_endian);
-  qassert(n_elem_write == 1);
-  offset += 4;
-  n_elem_write = qfwrite(fn.c_str(), tag_len, 1, fw.qfile);
-  qassert(n_elem_write == 1);
-  offset += tag_len;
+  const int32_t tag_len = fn.size() + 1;  // fn is the name of the field (say prop1)
+  append_convert_endian(buf, tag_len, is_little_endian);
+  buf.insert(buf.end(), fn.c_str(), fn.c_str() + tag_len);
   //
   // then write crc
-  crc32_t crc = crc32_par(data);
-  n_elem_write =
-      qfwrite_convert_endian(&crc, 4, 1, fw.qfile, fw.is_little_endian);
-  qassert(n_elem_write == 1);
-  offset += 4;
+  append_convert_endian(buf, (int32_t)crc, is_little_endian);
   //
   // then write geometry info
-  int32_t nd = 4;  // <- number of dimensions of field, typically 4
-  n_elem_write =
-      qfwrite_convert_endian(&nd, 4, 1, fw.qfile, fw.is_little_endian);
-  qassert(n_elem_write == 1);
-  offset += 4;
+  const int32_t nd = 4;  // <- number of dimensions of field, typically 4
+  append_convert_endian(buf, nd + 256 * (int32_t)codec, is_little_endian);
   //
   std::vector<int32_t> gd(4, 0);
   std::vector<int32_t> num_procs(4, 0);
@@ -321,29 +556,41 @@ Long write(FieldsWriter& fw, const std::string& fn, const Geometry& geo,
     // with my old one
   }
   //
-  n_elem_write =
-      qfwrite_convert_endian(&gd[0], 4, nd, fw.qfile, fw.is_little_endian);
-  qassert(n_elem_write == nd);
-  offset += 4 * nd;
-  n_elem_write = qfwrite_convert_endian(&num_procs[0], 4, nd, fw.qfile,
-                                        fw.is_little_endian);
-  qassert(n_elem_write == nd);
-  offset += 4 * nd;
+  for (int mu = 0; mu < nd; ++mu) {
+    append_convert_endian(buf, gd[mu], is_little_endian);
+  }
+  for (int mu = 0; mu < nd; ++mu) {
+    append_convert_endian(buf, num_procs[mu], is_little_endian);
+  }
   //
   // then data size
-  int64_t data_len = data.size();
-  n_elem_write =
-      qfwrite_convert_endian(&data_len, 8, 1, fw.qfile, fw.is_little_endian);
+  append_convert_endian(buf, data_len, is_little_endian);
+  return buf;
+}
+
+Long write(FieldsWriter& fw, const std::string& fn, const Geometry& geo,
+           const Vector<char> data, const bool is_sparse_field,
+           const FieldsCodec codec)
+// data should already be encoded with codec
+{
+  TIMER("write(fw,fn,geo,data)");
+  Long n_elem_write;
+  // get initial offset
+  const Long offset_start = fw.qfile.tell();
+  const crc32_t crc = crc32_par(data);
+  const int64_t data_len = data.size();
+  const std::vector<char> header = make_fields_segment_header(
+      fn, geo, crc, data_len, is_sparse_field, codec, fw.is_little_endian);
+  n_elem_write = qfwrite(header.data(), header.size(), 1, fw.qfile);
   qassert(n_elem_write == 1);
-  offset += 8;
   //
   // then write data
   n_elem_write = qfwrite(&data[0], data_len, 1, fw.qfile);
   qassert(n_elem_write == 1);
-  offset += data_len;
   //
   const Long offset_stop = fw.qfile.tell();
-  qassert(offset_stop == offset);
+  qassert(offset_stop == offset_start + (Long)header.size() + data_len);
+  fw.max_offset = offset_stop;
   //
   // register file
   fw.fn_list.push_back(fn);
@@ -371,7 +618,8 @@ Long qfread_convert_endian(void* ptr, const size_t size, const size_t nmemb,
 }
 
 bool read_tag(FieldsReader& fr, std::string& fn, Coordinate& total_site,
-              crc32_t& crc, int64_t& data_len, bool& is_sparse_field)
+              crc32_t& crc, int64_t& data_len, bool& is_sparse_field,
+              FieldsCodec& codec)
 {
   TIMER("read_tag(fr,fn,total_site,crc,data_len,is_sparse_field)");
   fn = "";
@@ -379,6 +627,7 @@ bool read_tag(FieldsReader& fr, std::string& fn, Coordinate& total_site,
   crc = 0;
   data_len = 0;
   is_sparse_field = false;
+  codec = FieldsCodec::None;
   //
   if (fr.qfile.null()) {
     qwarn(ssprintf("read_tag: fr.qfile.null()==true fn='%s'",
@@ -422,8 +671,14 @@ bool read_tag(FieldsReader& fr, std::string& fn, Coordinate& total_site,
     fr.is_read_through = true;
     return false;
   }
+  if (nd > 4 and nd % 256 == 4 and
+      nd / 256 == (int32_t)FieldsCodec::ShuffleDeflate) {
+    codec = (FieldsCodec)(nd / 256);
+    nd = 4;
+  }
   if (not(4 == nd)) {
-    qwarn(ssprintf("read_tag: fn='%s'", get_file_path(fr).c_str()));
+    qwarn(ssprintf("read_tag: fn='%s' nd=%d", get_file_path(fr).c_str(),
+                   (int)nd));
     fr.is_read_through = true;
     return false;
   }
@@ -502,26 +757,57 @@ bool read_tag(FieldsReader& fr, std::string& fn, Coordinate& total_site,
   return true;
 }
 
+bool read_tag(FieldsReader& fr, std::string& fn, Coordinate& total_site,
+              crc32_t& crc, int64_t& data_len, bool& is_sparse_field)
+{
+  FieldsCodec codec;
+  return read_tag(fr, fn, total_site, crc, data_len, is_sparse_field, codec);
+}
+
 Long read_data(FieldsReader& fr, std::vector<char>& data,
                const int64_t data_len, const crc32_t crc)
 // return data_len (if not successful then return 0)
 {
   TIMER_FLOPS("read_data(fr,fn,geo,data)");
-  clear(data);
-  data.resize(data_len, 0);
+  Vector<char> vdata;
+  const Long total_bytes = read_data(fr, vdata, data, data_len, crc);
+  if (total_bytes > 0 and vdata.data() != data.data()) {
+    data.assign(vdata.data(), vdata.data() + vdata.size());
+  }
+  timer.flops += total_bytes;
+  return total_bytes;
+}
+
+Long read_data(FieldsReader& fr, Vector<char>& data, std::vector<char>& buffer,
+               const int64_t data_len, const crc32_t crc)
+// return data_len (if not successful then return 0)
+// If fr.qfile is opened with QFileType::MMap, data is a view of the file
+// (valid until fr is closed) and buffer is not used. Otherwise, data is a view
+// of buffer.
+{
+  TIMER_FLOPS("read_data(fr,fn,geo,data,buffer)");
+  clear(buffer);
+  data = Vector<char>();
   if (fr.qfile.null()) {
     qwarn(ssprintf("read_data: file does not exist fn='%s'",
                    get_file_path(fr).c_str()));
     return 0;
   }
-  const Long read_data_all = qfread(&data[0], data_len, 1, fr.qfile);
-  if (not(1 == read_data_all)) {
-    qwarn(ssprintf("read_data: data not complete fn='%s'",
-                   get_file_path(fr).c_str()));
-    fr.is_read_through = true;
-    return 0;
+  crc32_t crc_read = 0;
+  if (qfread_view(data, data_len, fr.qfile)) {
+    crc_read = crc32_par(data);
+  } else {
+    buffer.resize(data_len, 0);
+    const Long read_data_all =
+        qread_data_crc32(get_data(buffer), crc_read, fr.qfile);
+    if (not(data_len == read_data_all)) {
+      qwarn(ssprintf("read_data: data not complete fn='%s'",
+                     get_file_path(fr).c_str()));
+      fr.is_read_through = true;
+      return 0;
+    }
+    data = get_data(buffer);
   }
-  crc32_t crc_read = crc32_par(get_data(data));
   if (not(crc_read == crc)) {
     qwarn(ssprintf("read_data: crc does not match fn='%s'",
                    get_file_path(fr).c_str()));
@@ -535,11 +821,40 @@ Long read_next(FieldsReader& fr, std::string& fn, Coordinate& total_site,
                std::vector<char>& data, bool& is_sparse_field)
 {
   TIMER_FLOPS("read_next(fr,fn,geo,data)");
+  Vector<char> vdata;
+  const Long total_bytes =
+      read_next(fr, fn, total_site, vdata, data, is_sparse_field);
+  if (total_bytes > 0 and vdata.data() != data.data()) {
+    data.assign(vdata.data(), vdata.data() + vdata.size());
+  }
+  timer.flops += total_bytes;
+  return total_bytes;
+}
+
+Long read_next(FieldsReader& fr, std::string& fn, Coordinate& total_site,
+               Vector<char>& data, std::vector<char>& buffer,
+               bool& is_sparse_field)
+// data is a view of the file or of buffer (see read_data)
+{
+  TIMER_FLOPS("read_next(fr,fn,geo,data,buffer)");
   crc32_t crc = 0;
   int64_t data_len = 0;
+  FieldsCodec codec = FieldsCodec::None;
   const bool is_ok =
-      read_tag(fr, fn, total_site, crc, data_len, is_sparse_field);
-  const Long total_bytes = is_ok ? read_data(fr, data, data_len, crc) : 0;
+      read_tag(fr, fn, total_site, crc, data_len, is_sparse_field, codec);
+  Long total_bytes = is_ok ? read_data(fr, data, buffer, data_len, crc) : 0;
+  if (total_bytes > 0 and codec != FieldsCodec::None) {
+    std::vector<char> decoded;
+    if (fields_decode(decoded, codec, data)) {
+      std::swap(buffer, decoded);
+      data = get_data(buffer);
+      total_bytes = data.size();
+    } else {
+      qwarn(ssprintf("read_next: decode failed fn='%s'",
+                     get_file_path(fr).c_str()));
+      total_bytes = 0;
+    }
+  }
   timer.flops += total_bytes;
   return total_bytes;
 }
@@ -619,6 +934,23 @@ Long read(FieldsReader& fr, const std::string& fn, Coordinate& total_site,
   return total_bytes;
 }
 
+Long read(FieldsReader& fr, const std::string& fn, Coordinate& total_site,
+          Vector<char>& data, std::vector<char>& buffer, bool& is_sparse_field)
+// data is a view of the file or of buffer (see read_data)
+{
+  TIMER_FLOPS("read(fr,fn,site,data,buffer)");
+  if (not does_file_exist(fr, fn)) {
+    return 0;
+  }
+  qassert(has(fr.offsets_map, fn));
+  qfseek(fr.qfile, fr.offsets_map[fn].offset_start, SEEK_SET);
+  std::string fn_r;
+  const Long total_bytes =
+      read_next(fr, fn_r, total_site, data, buffer, is_sparse_field);
+  qassert(fn == fn_r);
+  return total_bytes;
+}
+
 Long read_skip(FieldsReader& fr, const std::string& fn)
 // return offset of the end of this data segment
 // return -1 if failed.
@@ -711,12 +1043,119 @@ ShuffledBitSet mk_shuffled_bitset(const FieldRank& f_rank,
 
 // ------------------------
 
+static void fields_write_behind_loop(FieldsWriteBehind* p_wb)
+// Body of the I/O thread. Only libc calls here.
+{
+  FieldsWriteBehind& wb = *p_wb;
+  std::unique_lock<std::mutex> lock(wb.mutex);
+  while (true) {
+    wb.cv.wait(lock, [&] { return wb.is_stopping or not wb.tasks.empty(); });
+    if (wb.tasks.empty()) {
+      break;
+    }
+    FieldsWriteBehindTask task = std::move(wb.tasks.front());
+    wb.tasks.pop_front();
+    wb.is_busy = true;
+    const bool is_failed = wb.error != "";
+    lock.unlock();
+    std::string error;
+    if (not is_failed) {
+      // do not append anything after a failed write
+      FILE* fp = wb.fps[task.i];
+      if (std::fwrite(task.header.data(), 1, task.header.size(), fp) !=
+              task.header.size() or
+          std::fwrite(task.data.data(), 1, task.data.size(), fp) !=
+              task.data.size()) {
+        error = ssprintf("write failed (fws[%d] errno=%d '%s')", task.i, errno,
+                         std::strerror(errno));
+      }
+    }
+    const Long size = task.header.size() + task.data.size();
+    clear(task.header);
+    clear(task.data);
+    lock.lock();
+    wb.pending_bytes -= size;
+    wb.is_busy = false;
+    if (wb.error == "") {
+      wb.error = error;
+    }
+    wb.cv.notify_all();
+  }
+}
+
+static void wait_fields_write_behind(FieldsWriteBehind& wb)
+// wait until all the queued segments are written
+{
+  TIMER("wait_fields_write_behind");
+  std::unique_lock<std::mutex> lock(wb.mutex);
+  wb.cv.wait(lock, [&] { return wb.tasks.empty() and not wb.is_busy; });
+}
+
+static void start_fields_write_behind(ShuffledFieldsWriter& sfw)
+// The files of sfw.fws are handed over to the I/O thread.
+{
+  TIMER("start_fields_write_behind");
+  FieldsWriteBehind& wb = sfw.wb;
+  qassert(not wb.thread.joinable());
+  wb.fps.resize(sfw.fws.size());
+  for (int i = 0; i < (int)sfw.fws.size(); ++i) {
+    FieldsWriter& fw = sfw.fws[i];
+    qfflush(fw.qfile);
+    fw.max_offset = qftell(fw.qfile);
+    qfclose(fw.qfile);
+    const std::string fn =
+        dist_file_name(fw.path, fw.geon.id_node, fw.geon.num_node);
+    wb.fps[i] = std::fopen(fn.c_str(), "a");
+    qassert(wb.fps[i] != NULL);
+  }
+  wb.pending_bytes = 0;
+  wb.is_busy = false;
+  wb.is_stopping = false;
+  wb.error = "";
+  wb.thread = std::thread(fields_write_behind_loop, &wb);
+  sfw.is_async = true;
+}
+
+static std::string stop_fields_write_behind(ShuffledFieldsWriter& sfw)
+// Drain the queue, join the I/O thread and close its files.
+// Return the error of the I/O thread ("" if none).
+{
+  TIMER("stop_fields_write_behind");
+  FieldsWriteBehind& wb = sfw.wb;
+  {
+    std::lock_guard<std::mutex> lock(wb.mutex);
+    wb.is_stopping = true;
+  }
+  wb.cv.notify_all();
+  if (wb.thread.joinable()) {
+    wb.thread.join();
+  }
+  std::string error = wb.error;
+  for (int i = 0; i < (int)wb.fps.size(); ++i) {
+    if (std::fclose(wb.fps[i]) != 0 and error == "") {
+      error = ssprintf("fclose failed (fws[%d])", i);
+    }
+  }
+  clear(wb.fps);
+  wb.is_stopping = false;
+  wb.error = "";
+  sfw.is_async = false;
+  if (error != "") {
+    qwarn(ssprintf("stop_fields_write_behind: '%s' %s.", sfw.path.c_str(),
+                   error.c_str()));
+  }
+  return error;
+}
+
 void ShuffledFieldsWriter::init()
 // interface function
 {
   close();
   path = "";
   new_size_node = Coordinate();
+  is_async = false;
+  codec = (FieldsCodec)get_fields_io_codec();
+  n_mantissa_bits = 0;
 }
 
 void ShuffledFieldsWriter::init(const std::string& path_,
@@ -818,12 +1257,18 @@ void ShuffledFieldsWriter::init(const std::string& path_,
     }
   }
   add_shuffled_fields_writer(*this);
+  if (is_fields_io_async()) {
+    set_async(*this, true);
+  }
 }
 
 void ShuffledFieldsWriter::close()
 // interface function
 {
   remove_shuffled_fields_writer(*this);
+  if (wb.thread.joinable()) {
+    stop_fields_write_behind(*this);
+  }
   if (fws.size() > 0) {
     TIMER_VERBOSE("ShuffledFieldsWriter::close");
     for (Long i = 0; i < (Long)fws.size(); ++i) {
@@ -1003,11 +1448,28 @@ std::vector<std::string> show_all_shuffled_fields_reader()
 
 Long flush(ShuffledFieldsWriter& sfw)
 // interface function
+// In asynchronous mode, wait for the I/O thread to finish all the queued
+// writes. Fail on all the nodes if the I/O thread failed on any node.
 {
   TIMER_VERBOSE("flush(sfw)");
   Long ret = 0;
-  for (int i = 0; i < (int)sfw.fws.size(); ++i) {
-    ret += flush(sfw.fws[i]);
+  if (sfw.is_async) {
+    FieldsWriteBehind& wb = sfw.wb;
+    wait_fields_write_behind(wb);
+    for (int i = 0; i < (int)wb.fps.size(); ++i) {
+      ret += std::fflush(wb.fps[i]);
+    }
+    Long n_failed = wb.error != "" ? 1 : 0;
+    glb_sum(n_failed);
+    if (n_failed > 0) {
+      qerr(fname + ssprintf(": '%s' async write failed on %ld node(s). '%s'",
+                            sfw.path.c_str(), (long)n_failed,
+                            wb.error.c_str()));
+    }
+  } else {
+    for (int i = 0; i < (int)sfw.fws.size(); ++i) {
+      ret += flush(sfw.fws[i]);
+    }
   }
   if (get_id_node() == 0) {
     sfw.qar_index.flush();
@@ -1016,6 +1478,100 @@ Long flush(ShuffledFieldsWriter& sfw)
   return ret;
 }
 
+void set_async(ShuffledFieldsWriter& sfw, const bool is_async)
+// interface function
+// In asynchronous mode, write(sfw,fn,...) only shuffles, computes crc and
+// queues the data (bounded by get_fields_io_async_max_pending_bytes()). A
+// background thread writes the data to disk. Use flush(sfw) to wait for
+// completion and check errors.
+{
+  TIMER_VERBOSE("set_async(sfw,is_async)");
+  if (is_async == sfw.is_async) {
+    return;
+  }
+  if (is_async) {
+    start_fields_write_behind(sfw);
+  } else {
+    flush(sfw);
+    stop_fields_write_behind(sfw);
+    for (int i = 0; i < (int)sfw.fws.size(); ++i) {
+      FieldsWriter& fw = sfw.fws[i];
+      fw.qfile = qfopen(
+          dist_file_name(fw.path, fw.geon.id_node, fw.geon.num_node), "a");
+      qassert(not fw.qfile.null());
+    }
+  }
+}
+
+Long write_behind(ShuffledFieldsWriter& sfw, const Int i, const std::string& fn,
+                  const Geometry& geo, std::vector<char>& data,
+                  const bool is_sparse_field, const FieldsCodec codec)
+// Queue a segment of sfw.fws[i] for the I/O thread. Take the content of data.
+// Wait if the staging buffer is full.
+{
+  TIMER("write_behind(sfw,i,fn,geo,data)");
+  qassert(sfw.is_async);
+  qassert(0 <= i and i < (Int)sfw.fws.size());
+  FieldsWriter& fw = sfw.fws[i];
+  FieldsWriteBehind& wb = sfw.wb;
+  FieldsWriteBehindTask task;
+  task.i = i;
+  const int64_t data_len = data.size();
+  task.header = make_fields_segment_header(fn, geo, crc32_par(get_data(data)),
+                                           data_len, is_sparse_field, codec,
+                                           fw.is_little_endian);
+  std::swap(task.data, data);
+  const Long size = task.header.size() + data_len;
+  //
+  // register file
+  const Long offset_start = fw.max_offset;
+  const Long offset_stop = offset_start + size;
+  fw.max_offset = offset_stop;
+  fw.fn_list.push_back(fn);
+  fw.offsets_map[fn] =
+      FieldsSegmentInfo(offset_start, offset_stop, is_sparse_field);
+  //
+  {
+    TIMER("write_behind-wait");
+    const Long max_pending_bytes = get_fields_io_async_max_pending_bytes();
+    std::unique_lock<std::mutex> lock(wb.mutex);
+    wb.cv.wait(lock, [&] {
+      return wb.pending_bytes == 0 or
+             wb.pending_bytes + size <= max_pending_bytes;
+    });
+    wb.tasks.push_back(std::move(task));
+    wb.pending_bytes += size;
+  }
+  wb.cv.notify_all();
+  return data_len;
+}
+
+Long write_segment(ShuffledFieldsWriter& sfw, const Int i, const std::string& fn,
+                   const Geometry& geo, const Vector<char> data,
+                   const bool is_sparse_field, const Int elem_size,
+                   const Long offset)
+// Write data to sfw.fws[i] with sfw.codec, either directly or through the I/O
+// thread if sfw.is_async. elem_size and offset are passed to fields_encode.
+// Return the number of bytes of the (encoded) data.
+{
+  TIMER("write_segment(sfw,i,fn,geo,data)");
+  if (sfw.codec == FieldsCodec::None and not sfw.is_async) {
+    return write(sfw.fws[i], fn, geo, data, is_sparse_field);
+  }
+  std::vector<char> payload;
+  if (sfw.codec == FieldsCodec::None) {
+    payload.assign(data.data(), data.data() + data.size());
+  } else {
+    payload = fields_encode(sfw.codec, data, elem_size, offset);
+  }
+  if (sfw.is_async) {
+    return write_behind(sfw, i, fn, geo, payload, is_sparse_field, sfw.codec);
+  } else {
+    return write(sfw.fws[i], fn, geo, get_data(payload), is_sparse_field,
+                 sfw.codec);
+  }
+}
+
 void read_through_sync_node(ShuffledFieldsReader& sfr)
 {
   TIMER_VERBOSE("read_through_sync_node(sfr)");
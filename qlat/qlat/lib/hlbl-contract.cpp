@@ -37,8 +37,8 @@ void set_local_current_from_props(SelectedPoints<WilsonMatrix>& scf,
 {
   (void)geo;
   TIMER_VERBOSE("set_local_current_from_props");
-  const array<SpinMatrix, 4>& gammas = SpinMatrixConstants::get_cps_gammas();
-  const SpinMatrix& gamma5 = SpinMatrixConstants::get_gamma5();
+  const array<GammaMatrix, 4> gammas = GammaMatrixConstants::get_cps_gammas();
+  const GammaMatrix gamma5 = GammaMatrixConstants::get_gamma5();
   scf.init(psel_d, 4);
   set_zero(scf);
   qacc_for(idx, psel_d.size(), {
@@ -183,7 +183,7 @@ void contract_four_loop(SelectedPoints<Complex>& f_loop_i_rho_sigma_lambda,
                         const std::string& label)
 {
   TIMER_VERBOSE("contract_four_loop");
-  const box<SpinMatrixConstantsT<>>& smc = get_spin_matrix_constants();
+  const array<GammaMatrix, 4> gammas = GammaMatrixConstants::get_cps_gammas();
   const Coordinate total_site = geo.total_site();
   f_loop_i_rho_sigma_lambda.init(psel_d, 3 * 4 * 4 * 4);
   set_zero(f_loop_i_rho_sigma_lambda);
@@ -194,7 +194,6 @@ void contract_four_loop(SelectedPoints<Complex>& f_loop_i_rho_sigma_lambda,
   f_vc_yx_g.init(psel_d, 4 * 4);
   f_vc_xy_g.init(psel_d, 4 * 4);
   qacc_for_debug(idx, psel_d.size(), {
-    const array<SpinMatrix, 4>& gammas = smc().cps_gammas;
     const RealD prob = psel_d_prob_xy.get_elem(idx);
     const RealD weight = 1.0 / prob;
     const ComplexD final_coef = coef * weight;
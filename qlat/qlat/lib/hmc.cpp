@@ -47,6 +47,15 @@ void set_rand_gauge_momentum(GaugeMomentum& gm, const RealD sigma,
   set_g_rand_anti_hermitian_matrix_field(gm, rs, sigma);
 }
 
+void set_rand_gauge_momentum(GaugeMomentum& gm, const RealD sigma,
+                             const CounterRng& crng)
+// Same distribution as set_rand_gauge_momentum(gm, sigma, rs), but with the
+// counter-based generator (no RngState hashing per site).
+{
+  TIMER_VERBOSE("set_rand_gauge_momentum(crng)");
+  set_g_rand_anti_hermitian_matrix_field(gm, crng, sigma);
+}
+
 void set_rand_gauge_momentum(GaugeMomentum& gm, const Field<RealD>& mf,
                              const RngState& rs)
 //  Creates a field of antihermitian 3x3 complex matrices with each complex
@@ -365,8 +374,22 @@ void set_gm_force(GaugeMomentum& gm_force, const GaugeField& gf,
   const CommPlan& plan = get_comm_plan(set_marks_field_gm_force, tag_comm,
                                        gf_ext.geo(), gf_ext.multiplicity);
   QLAT_DIAGNOSTIC_POP;
+#ifndef QLAT_USE_ACC
+  // Compute the force on the interior sites while the halo is in flight.
+  const Geometry geo = geo_resize(gf.geo());
+  gm_force.init(geo);
+  qassert(gm_force.multiplicity == 4);
+  refresh_expanded_overlap(gf_ext, plan, geo, [&](const Long index) {
+    const Coordinate xl = geo.coordinate_from_index(index);
+    Vector<ColorMatrix> gm_force_v = gm_force.get_elems(xl);
+    for (int mu = 0; mu < 4; ++mu) {
+      gm_force_v[mu] = gf_force_site_no_comm(gf_ext, ga, xl, mu);
+    }
+  });
+#else
   refresh_expanded(gf_ext, plan);
   set_gm_force_no_comm(gm_force, gf_ext, ga);
+#endif
   qassert(gm_force.multiplicity == 4);
 }
 
@@ -88,6 +88,82 @@ int mpi_irecv(void* buf, Long count, MPI_Datatype datatype, int source, int tag,
   }
 }
 
+int mpi_send_init(const void* buf, Long count, MPI_Datatype datatype,
+                  int dest, int tag, MPI_Comm comm,
+                  std::vector<MPI_Request>& requests)
+// persistent request version of mpi_isend
+{
+  const Long int_max = INT_MAX;
+  if (count <= int_max) {
+    MPI_Request r;
+    int ret = MPI_Send_init(buf, count, datatype, dest, tag, comm, &r);
+    requests.push_back(r);
+    qassert(ret == MPI_SUCCESS);
+    return MPI_SUCCESS;
+  } else {
+    int type_size = 0;
+    MPI_Type_size(datatype, &type_size);
+    uint8_t* cbuf = (uint8_t*)buf;
+    while (count > int_max) {
+      mpi_send_init(cbuf, int_max, datatype, dest, tag, comm, requests);
+      cbuf += (Long)int_max * type_size;
+      count -= int_max;
+    }
+    return mpi_send_init(cbuf, count, datatype, dest, tag, comm, requests);
+  }
+}
+
+int mpi_recv_init(void* buf, Long count, MPI_Datatype datatype, int source,
+                  int tag, MPI_Comm comm, std::vector<MPI_Request>& requests)
+// persistent request version of mpi_irecv
+{
+  const Long int_max = INT_MAX;
+  if (count <= int_max) {
+    MPI_Request r;
+    int ret = MPI_Recv_init(buf, count, datatype, source, tag, comm, &r);
+    requests.push_back(r);
+    qassert(ret == MPI_SUCCESS);
+    return MPI_SUCCESS;
+  } else {
+    int type_size = 0;
+    MPI_Type_size(datatype, &type_size);
+    uint8_t* cbuf = (uint8_t*)buf;
+    while (count > int_max) {
+      mpi_recv_init(cbuf, int_max, datatype, source, tag, comm, requests);
+      cbuf += (Long)int_max * type_size;
+      count -= int_max;
+    }
+    return mpi_recv_init(cbuf, count, datatype, source, tag, comm, requests);
+  }
+}
+
+int mpi_startall(std::vector<MPI_Request>& requests)
+// start persistent requests created by mpi_send_init and mpi_recv_init
+{
+  if (requests.size() > 0) {
+    int ret = MPI_Startall(requests.size(), requests.data());
+    qassert(ret == MPI_SUCCESS);
+  }
+  return MPI_SUCCESS;
+}
+
+int mpi_request_free(std::vector<MPI_Request>& requests)
+// free (inactive) persistent requests
+// do nothing if MPI is already finalized
+{
+  int is_finalized = 0;
+  MPI_Finalized(&is_finalized);
+  if (not is_finalized) {
+    for (size_t i = 0; i < requests.size(); ++i) {
+      if (requests[i] != MPI_REQUEST_NULL) {
+        MPI_Request_free(&requests[i]);
+      }
+    }
+  }
+  requests.clear();
+  return MPI_SUCCESS;
+}
+
 int mpi_waitall(std::vector<MPI_Request>& requests)
 {
   TIMER("mpi_waitall");
@@ -654,6 +730,9 @@ void end(const bool is_preserving_cache)
       if (not is_preserving_cache) {
         clear_all_caches();
       }
+      if (not Timer::profile_path().empty()) {
+        Timer::write_profile(Timer::profile_path());
+      }
       sync_node();
       displayln_info(ssprintf("qlat::end(): get_comm_list().pop_back()"));
       get_comm_list().pop_back();
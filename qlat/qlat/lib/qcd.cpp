@@ -217,8 +217,29 @@ void gf_clover_leaf_field(CloverLeafField& clf, const GaugeField& gf)
   GaugeField gf1;
   gf1.init(geo_resize(gf.geo(), 1));
   gf1 = gf;
+#ifndef QLAT_USE_ACC
+  // Compute the clover leaves on the interior sites while the halo is in
+  // flight.
+  const Geometry geo = geo_resize(gf.geo());
+  clf.init(geo, 6);
+  QLAT_PUSH_DIAGNOSTIC_DISABLE_DANGLING_REF;
+  const CommPlan& plan =
+      get_comm_plan(set_marks_field_all, "", gf1.geo(), gf1.multiplicity);
+  QLAT_DIAGNOSTIC_POP;
+  refresh_expanded_overlap(gf1, plan, geo, [&](const Long index) {
+    const Coordinate xl = geo.coordinate_from_index(index);
+    Vector<ColorMatrix> v = clf.get_elems(xl);
+    v[0] = gf_clover_leaf_no_comm(gf1, xl, 0, 1);
+    v[1] = gf_clover_leaf_no_comm(gf1, xl, 0, 2);
+    v[2] = gf_clover_leaf_no_comm(gf1, xl, 0, 3);
+    v[3] = gf_clover_leaf_no_comm(gf1, xl, 1, 2);
+    v[4] = gf_clover_leaf_no_comm(gf1, xl, 1, 3);
+    v[5] = gf_clover_leaf_no_comm(gf1, xl, 2, 3);
+  });
+#else
   refresh_expanded(gf1);
   gf_clover_leaf_field_no_comm(clf, gf1);
+#endif
 }
 
 void clf_plaq_action_density_field(Field<RealD>& paf,
@@ -2,6 +2,8 @@
 
 #include <qlat/selected-points.h>
 
+#include <set>
+
 namespace qlat
 {  //
 
@@ -43,19 +45,15 @@ PointsSelection mk_random_point_selection(const Coordinate& total_site,
   }
   PointsSelection psel(total_site, num);
   qthread_for(i, num, { psel[i] = Coordinate(-1, -1, -1, -1); });
+  std::set<Long> selected_keys;
   Long idx = 0;
   for (Long i = 0; i < (Long)psel.size(); ++i) {
     while (idx < (Long)psel_pool.size()) {
       const Coordinate xg = psel_pool[idx];
       idx += 1;
-      bool is_repeat = false;
-      for (Long j = 0; j < i; ++j) {
-        if (xg == psel[j]) {
-          is_repeat = true;
-          break;
-        }
-      }
-      if (not is_repeat) {
+      const Long key = PointsSelectionIndex::key_from_xg(xg);
+      if (selected_keys.count(key) == 0) {
+        selected_keys.insert(key);
         psel[i] = xg;
         break;
       }
@@ -158,4 +156,291 @@ void set_sqrt_field(SelectedPoints<RealD>& sp, const SelectedPoints<RealD>& sp1)
   });
 }
 
+void PointsSelectionIndex::init()
+{
+  initialized = false;
+  n_points = 0;
+  n_bits = 0;
+  keys.init();
+  idxs.init();
+  xgs.init();
+}
+
+void PointsSelectionIndex::init(const PointsSelection& psel)
+// The keys and their home slots are computed in parallel. The insertion is
+// serial in the order of idx, which makes the table deterministic and keeps
+// the smallest idx for repeated coordinates.
+{
+  TIMER("PointsSelectionIndex::init(psel)");
+  init();
+  n_points = psel.size();
+  xgs = psel.xgs;
+  n_bits = 4;
+  while (((Long)1 << n_bits) < 2 * n_points) {
+    n_bits += 1;
+  }
+  const Long size = (Long)1 << n_bits;
+  const Long mask = size - 1;
+  vector<Long> pkeys(n_points);
+  vector<Long> slots(n_points);
+  qthread_for(idx, n_points, {
+    const Coordinate& xg = psel[idx];
+    for (int mu = 0; mu < 4; ++mu) {
+      qassert(-0x8000 <= xg[mu] and xg[mu] < 0x7FFF);
+    }
+    pkeys[idx] = key_from_xg(xg);
+    slots[idx] = slot_from_key(pkeys[idx]);
+  });
+  keys.resize(size);
+  idxs.resize(size);
+  qthread_for(slot, size, {
+    keys[slot] = -1;
+    idxs[slot] = -1;
+  });
+  for (Long idx = 0; idx < n_points; ++idx) {
+    const Long key = pkeys[idx];
+    Long slot = slots[idx];
+    while (keys[slot] != -1 and keys[slot] != key) {
+      slot = (slot + 1) & mask;
+    }
+    if (keys[slot] == -1) {
+      keys[slot] = key;
+      idxs[slot] = idx;
+    }
+  }
+  initialized = true;
+}
+
+static bool is_same_points(const vector<Coordinate>& xgs,
+                           const PointsSelection& psel)
+{
+  if ((Long)xgs.size() != (Long)psel.size()) {
+    return false;
+  }
+  return 0 == std::memcmp(xgs.data(), psel.data(),
+                          psel.size() * sizeof(Coordinate));
+}
+
+static PointsSelectionIndex& get_points_selection_index_no_check(
+    const PointsSelection& psel)
+// cache keyed by the identity of psel.xgs, the points are not verified
+{
+  Cache<std::string, PointsSelectionIndex>& cache =
+      get_points_selection_index_cache();
+  const std::string key =
+      ssprintf("%p %ld %s", (const void*)psel.data(), (long)psel.size(),
+               show(psel.total_site).c_str());
+  PointsSelectionIndex& psi = cache[key];
+  if (not psi.initialized) {
+    psi.init(psel);
+  }
+  return psi;
+}
+
+const PointsSelectionIndex& get_points_selection_index(
+    const PointsSelection& psel)
+{
+  TIMER("get_points_selection_index");
+  PointsSelectionIndex& psi = get_points_selection_index_no_check(psel);
+  if (not is_same_points(psi.xgs, psel)) {
+    psi.init(psel);
+  }
+  return psi;
+}
+
+Long idx_from_xg(const Coordinate& xg, const PointsSelection& psel)
+// idx of xg in psel (-1 if not found)
+// A hit is verified directly with psel[idx]. A miss (or a wrong hit) verifies
+// the whole index, so a loop over the points of psel is O(n).
+{
+  const PointsSelectionIndex& psi = get_points_selection_index_no_check(psel);
+  const Long idx = psi.find(xg);
+  if (idx >= 0 and idx < (Long)psel.size() and psel[idx] == xg) {
+    return idx;
+  }
+  return get_points_selection_index(psel).find(xg);
+}
+
+bool is_containing(const PointsSelection& psel,
+                   const PointsSelection& psel_small)
+{
+  TIMER("is_containing(psel,psel_small)");
+  const PointsSelectionIndex& psi = get_points_selection_index(psel);
+  Long n_missing_points = 0;
+  qthread_for(idx, (Long)psel_small.size(), {
+    if (psi.find(psel_small[idx]) < 0) {
+      // May miscount due to race condition.
+      // But we only need to know if it is zero or not.
+      // Should be fine.
+      n_missing_points += 1;
+    }
+  });
+  return n_missing_points == 0;
+}
+
+PointsSelection intersect(const PointsSelection& psel,
+                          const PointsSelection& psel1)
+// points of psel which are also in psel1 (order of psel is kept)
+{
+  TIMER("intersect(psel,psel1)");
+  qassert(psel.total_site == psel1.total_site);
+  const PointsSelectionIndex& psi1 = get_points_selection_index(psel1);
+  vector<Int> is_in_psel1(psel.size());
+  qthread_for(idx, (Long)psel.size(), {
+    is_in_psel1[idx] = psi1.find(psel[idx]) >= 0 ? 1 : 0;
+  });
+  Long n_points = 0;
+  for (Long idx = 0; idx < (Long)psel.size(); ++idx) {
+    n_points += is_in_psel1[idx];
+  }
+  PointsSelection psel_new(psel.total_site, n_points,
+                           psel.points_dist_type);
+  n_points = 0;
+  for (Long idx = 0; idx < (Long)psel.size(); ++idx) {
+    if (is_in_psel1[idx] == 1) {
+      psel_new[n_points] = psel[idx];
+      n_points += 1;
+    }
+  }
+  return psel_new;
+}
+
+void PointsGatherPlan::init()
+{
+  initialized = false;
+  n_points = 0;
+  local_idx.init();
+  local_index.init();
+  recvcounts.init();
+  rdispls.init();
+  recv_idx.init();
+  no_owner_idx.init();
+  xgs.init();
+}
+
+void PointsGatherPlan::init(const PointsSelection& psel, const Geometry& geo)
+{
+  TIMER("PointsGatherPlan::init(psel,geo)");
+  qassert(psel.points_dist_type == PointsDistType::Global);
+  init();
+  xgs = psel.xgs;
+  const Coordinate total_site = geo.total_site();
+  const Coordinate& node_site = geo.node_site;
+  const Coordinate& size_node = geo.geon.size_node;
+  const Int num_node = geo.geon.num_node;
+  const Int id_node = geo.geon.id_node;
+  n_points = psel.size();
+  vector<Int> owner(n_points);
+  qthread_for(idx, n_points, {
+    const Coordinate& xg = psel[idx];
+    bool is_inside = true;
+    for (int mu = 0; mu < 4; ++mu) {
+      if (xg[mu] < 0 or xg[mu] >= total_site[mu]) {
+        is_inside = false;
+      }
+    }
+    owner[idx] =
+        is_inside ? index_from_coordinate(xg / node_site, size_node) : -1;
+  });
+  recvcounts.resize(num_node);
+  rdispls.resize(num_node);
+  set_zero(recvcounts);
+  Long n_no_owner = 0;
+  for (Long idx = 0; idx < n_points; ++idx) {
+    if (owner[idx] >= 0) {
+      recvcounts[owner[idx]] += 1;
+    } else {
+      n_no_owner += 1;
+    }
+  }
+  Long count = 0;
+  for (Int i = 0; i < num_node; ++i) {
+    rdispls[i] = count;
+    count += recvcounts[i];
+  }
+  qassert(count + n_no_owner == n_points);
+  recv_idx.resize(count);
+  no_owner_idx.resize(n_no_owner);
+  {
+    vector<Long> pos(num_node);
+    for (Int i = 0; i < num_node; ++i) {
+      pos[i] = rdispls[i];
+    }
+    Long pos_no_owner = 0;
+    for (Long idx = 0; idx < n_points; ++idx) {
+      if (owner[idx] >= 0) {
+        recv_idx[pos[owner[idx]]] = idx;
+        pos[owner[idx]] += 1;
+      } else {
+        no_owner_idx[pos_no_owner] = idx;
+        pos_no_owner += 1;
+      }
+    }
+  }
+  const Long n_points_local = recvcounts[id_node];
+  local_idx.resize(n_points_local);
+  local_index.resize(n_points_local);
+  qthread_for(i, n_points_local, {
+    const Long idx = recv_idx[rdispls[id_node] + i];
+    local_idx[i] = idx;
+    const Coordinate xl = geo.coordinate_l_from_g(psel[idx]);
+    qassert(geo.is_local(xl));
+    local_index[i] = geo.index_from_coordinate(xl);
+  });
+  initialized = true;
+}
+
+const PointsGatherPlan& get_points_gather_plan(const PointsSelection& psel,
+                                               const Geometry& geo)
+{
+  TIMER("get_points_gather_plan");
+  Cache<std::string, PointsGatherPlan>& cache = get_points_gather_plan_cache();
+  const std::string key = ssprintf(
+      "%s %s %d %p %ld %s", show(geo.node_site).c_str(),
+      show(geo.geon.size_node).c_str(), geo.geon.id_node,
+      (const void*)psel.data(), (long)psel.size(),
+      show(psel.total_site).c_str());
+  PointsGatherPlan& pgp = cache[key];
+  if (not pgp.initialized or not is_same_points(pgp.xgs, psel)) {
+    pgp.init(psel, geo);
+  }
+  return pgp;
+}
+
+void gather_selected_points_char(SelectedPoints<Char>& spc,
+                                 const SelectedPoints<Char>& spc_local,
+                                 const PointsGatherPlan& pgp)
+// spc needs to be initialized with pgp.n_points points
+// Use MPI_Allgatherv with one MPI datatype for a point.
+{
+  TIMER_FLOPS("gather_selected_points_char");
+  qassert(pgp.initialized);
+  qassert(spc.n_points == pgp.n_points);
+  qassert(spc.multiplicity == spc_local.multiplicity);
+  qassert(spc_local.n_points == (Long)pgp.local_idx.size());
+  const Int multiplicity = spc.multiplicity;
+  const Long n_recv = pgp.recv_idx.size();
+  timer.flops += n_recv * multiplicity;
+  vector<Char> recv_buffer(n_recv * multiplicity);
+  MPI_Datatype mpi_dtype;
+  MPI_Type_contiguous(multiplicity, MPI_BYTE, &mpi_dtype);
+  MPI_Type_commit(&mpi_dtype);
+  const Int mpi_ret = MPI_Allgatherv(
+      (void*)spc_local.points.data(), spc_local.n_points, mpi_dtype,
+      (void*)recv_buffer.data(), pgp.recvcounts.data(), pgp.rdispls.data(),
+      mpi_dtype, get_comm());
+  MPI_Type_free(&mpi_dtype);
+  qassert(mpi_ret == MPI_SUCCESS);
+  const vector<Long>& recv_idx = pgp.recv_idx;
+  const vector<Long>& no_owner_idx = pgp.no_owner_idx;
+  qthread_for(i, n_recv, {
+    std::memcpy((void*)&spc.points[recv_idx[i] * multiplicity],
+                (const void*)&recv_buffer[i * multiplicity], multiplicity);
+  });
+  qthread_for(i, (Long)no_owner_idx.size(), {
+    std::memset((void*)&spc.points[no_owner_idx[i] * multiplicity], 0,
+                multiplicity);
+  });
+}
+
 }  // namespace qlat
@@ -6,20 +6,20 @@
 namespace qlat
 {  //
 
-ColorMatrix gf_link_ape_smear_no_comm(const GaugeField& gf,
-                                      const Coordinate& xl, const int mu,
-                                      const double alpha)
+template <class GM>
+static ColorMatrix gf_link_ape_smear_no_comm(const Field<GM>& gf,
+                                             const Coordinate& xl, const int mu,
+                                             const double alpha)
 {
   return color_matrix_su_projection(
-      (ComplexD)(1.0 - alpha) * gf.get_elem(xl, mu) +
+      (ComplexD)(1.0 - alpha) * get_gauge_link(gf, xl, mu) +
       (ComplexD)(alpha / 6.0) * gf_staple_no_comm(gf, xl, mu));
 }
 
-void gf_ape_smear_no_comm(GaugeField& gf, const GaugeField& gf0,
-                          const double alpha)
+template <class GM>
+static void gf_ape_smear_no_comm_gm(GaugeField& gf, const Field<GM>& gf0,
+                                    const double alpha)
 {
-  TIMER_VERBOSE("gf_ape_smear_no_comm");
-  qassert(&gf != &gf0);
   const Geometry& geo = gf0.geo();
   gf.init(geo_resize(geo));
   qassert(is_matching_geo(geo, gf.geo()));
@@ -33,6 +33,21 @@ void gf_ape_smear_no_comm(GaugeField& gf, const GaugeField& gf0,
   }
 }
 
+void gf_ape_smear_no_comm(GaugeField& gf, const GaugeField& gf0,
+                          const double alpha)
+{
+  TIMER_VERBOSE("gf_ape_smear_no_comm");
+  qassert(&gf != &gf0);
+  gf_ape_smear_no_comm_gm(gf, gf0, alpha);
+}
+
+void gf_ape_smear_no_comm(GaugeField& gf, const CompressedGaugeField& gf0,
+                          const double alpha)
+{
+  TIMER_VERBOSE("gf_ape_smear_no_comm(cgf)");
+  gf_ape_smear_no_comm_gm(gf, gf0, alpha);
+}
+
 void gf_ape_smear(GaugeField& gf, const GaugeField& gf0, const double alpha,
                   const Long steps)
 {